@@ -31,6 +31,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/exception.h"
+#include "util/base/memorytracker.h"
 #include "util/log/logger.h"
 #include "loaders/native/audio/ogg_loader.h"
 
@@ -43,7 +44,8 @@ namespace FIFE {
 		IResource(createUniqueClipName(), loader),
 		m_isStream(false),
 		m_decoder(NULL),
-		m_deleteDecoder(false) {
+		m_deleteDecoder(false),
+		m_bufferedBytes(0) {
 
 	}
 
@@ -51,7 +53,8 @@ namespace FIFE {
 		IResource(name, loader),
 		m_isStream(false),
 		m_decoder(NULL),
-		m_deleteDecoder(false) {
+		m_deleteDecoder(false),
+		m_bufferedBytes(0) {
 
 	}
 
@@ -102,8 +105,10 @@ namespace FIFE {
 
 				CHECK_OPENAL_LOG(_log, LogManager::LEVEL_ERROR, "error copying data to buffers")
 
+				m_bufferedBytes += m_decoder->getBufferSize();
 				ptr->usedbufs++;
 			}
+			MemoryTracker::instance()->add(MEMORY_SOUND, m_bufferedBytes);
 
 			m_decoder->releaseBuffer();
 
@@ -123,6 +128,7 @@ namespace FIFE {
 				for (it = m_buffervec.begin(); it != m_buffervec.end(); ++it) {
 					if ((*it) && (*it)->buffers[0] != 0) {
 						alDeleteBuffers(BUFFER_NUM, (*it)->buffers);
+						MemoryTracker::instance()->remove(MEMORY_SOUND, BUFFER_NUM * BUFFER_LEN);
 					}
 					delete (*it);
 				}
@@ -133,8 +139,10 @@ namespace FIFE {
 					alDeleteBuffers(1, &ptr->buffers[i]);
 				}
 				delete ptr;
+				MemoryTracker::instance()->remove(MEMORY_SOUND, m_bufferedBytes);
 			}
 			m_buffervec.clear();
+			m_bufferedBytes = 0;
 		}
 		m_state = IResource::RES_NOT_LOADED;
 	}
@@ -175,6 +183,10 @@ namespace FIFE {
 
 		CHECK_OPENAL_LOG(_log, LogManager::LEVEL_ERROR, "error creating streaming-buffers")
 
+		// streams keep all buffers filled, so the full size is accounted
+		m_bufferedBytes += BUFFER_NUM * BUFFER_LEN;
+		MemoryTracker::instance()->add(MEMORY_SOUND, BUFFER_NUM * BUFFER_LEN);
+
 		return id;
 	}
 
@@ -262,6 +274,9 @@ namespace FIFE {
 		SoundBufferEntry* ptr = m_buffervec.at(streamid);
 		alDeleteBuffers(BUFFER_NUM, ptr->buffers);
 		ptr->buffers[0] = 0;
+
+		m_bufferedBytes -= BUFFER_NUM * BUFFER_LEN;
+		MemoryTracker::instance()->remove(MEMORY_SOUND, BUFFER_NUM * BUFFER_LEN);
 	}
 
 	void SoundClip::endStreaming(uint32_t streamid) {
@@ -285,7 +300,7 @@ namespace FIFE {
 	}
 
 	size_t SoundClip::getSize() {
-		return 0;
+		return m_bufferedBytes;
 	}
 
 	std::string SoundClip::createUniqueClipName() {
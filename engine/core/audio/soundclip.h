@@ -129,6 +129,8 @@ namespace FIFE {
 		 */
 		SoundDecoder* getDecoder() const;
 
+		/** Returns the size of the OpenAL buffers that are currently filled or reserved for streams.
+		 */
 		virtual size_t getSize();
 
 		virtual void load();
@@ -142,6 +144,8 @@ namespace FIFE {
 		// when loadFromDecoder-method is used, decoder shouldn't be deleted
 		bool m_deleteDecoder;
 		std::vector<SoundBufferEntry*> m_buffervec;
+		// bytes held by the OpenAL buffers
+		size_t m_bufferedBytes;
 
 		std::string createUniqueClipName();
 	};
@@ -32,7 +32,10 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/exception.h"
+#include "util/base/memorytracker.h"
+#include "util/concurrency/jobsystem.h"
 #include "util/log/logger.h"
+#include "util/time/profiler.h"
 #include "util/time/timemanager.h"
 #include "audio/soundmanager.h"
 #include "gui/guimanager.h"
@@ -94,6 +97,7 @@ namespace FIFE {
 		m_eventmanager(0),
 		m_soundmanager(0),
 		m_timemanager(0),
+		m_jobsystem(0),
 		m_imagemanager(0),
 		m_animationmanager(0),
 		m_soundclipmanager(0),
@@ -102,6 +106,9 @@ namespace FIFE {
 		m_logmanager(0),
 		m_cursor(0),
 		m_destroyed(false),
+		m_lastPumpTime(0),
+		m_tickAccumulator(0),
+		m_tickTimeRemainder(0),
 		m_settings(),
 		m_devcaps(),
 		m_offrenderer(0),
@@ -138,6 +145,9 @@ namespace FIFE {
 	}
 
 	void Engine::changeScreenMode(const ScreenMode& mode){
+		if (m_settings.isHeadless()) {
+			throw NotSupported("Headless engine has no screen");
+		}
 		m_cursor->invalidate();
 
 		m_imagemanager->invalidateAll();
@@ -164,8 +174,12 @@ namespace FIFE {
 		m_timemanager = new TimeManager();
 		FL_LOG(_log, "Time manager created");
 
+		m_jobsystem = new JobSystem(m_settings.getJobThreadCount());
+		FL_LOG(_log, LMsg("Job system created with ") << m_jobsystem->getThreadCount() << " threads");
+
 		FL_LOG(_log, "Creating VFS");
 		m_vfs = new VFS();
+		m_vfs->setCacheBudget(m_settings.getVFSCacheSize());
 
 		FL_LOG(_log, "Adding root directory to VFS");
 		m_vfs->addSource( new VFSDirectory(m_vfs) );
@@ -183,6 +197,11 @@ namespace FIFE {
 			throw SDLException(SDL_GetError());
 		}
 
+		if (m_settings.isHeadless()) {
+			initHeadless();
+			return;
+		}
+
 		TTF_Init();
 
 		FL_LOG(_log, "Creating event manager");
@@ -299,18 +318,39 @@ namespace FIFE {
 		m_renderers.push_back(new LightRenderer(m_renderbackend, 90));
 		m_renderers.push_back(new CellRenderer(m_renderbackend, 100));
 
+		createModel(m_renderbackend);
+
+		m_cursor = new Cursor(m_renderbackend);
+		m_cursor->setNativeImageCursorEnabled(m_settings.isNativeImageCursorEnabled());
+		FL_LOG(_log, "Engine initialized");
+	}
+
+	void Engine::initHeadless() {
+		FL_LOG(_log, "Creating resource managers");
+		m_imagemanager = new ImageManager();
+		m_animationmanager = new AnimationManager();
+		m_soundclipmanager = new SoundClipManager();
+
+		// The backend is never initialized and has no screen, it only creates
+		// the image resources of loaded objects. Images are not loaded as
+		// nothing is rendered.
+		FL_LOG(_log, "Creating image factory");
+		m_renderbackend = new RenderBackendSDL(m_settings.getColorKey());
+
+		// the model gets no backend, so cameras of loaded maps are not rendered
+		createModel(NULL);
+		FL_LOG(_log, "Headless engine initialized");
+	}
+
+	void Engine::createModel(RenderBackend* renderbackend) {
 		FL_LOG(_log, "Creating model");
-		m_model = new Model(m_renderbackend, m_renderers);
+		m_model = new Model(renderbackend, m_renderers);
 		FL_LOG(_log, "Adding pathers to model");
 		m_model->adoptPather(new RoutePather());
 		FL_LOG(_log, "Adding grid prototypes to model");
 		m_model->adoptCellGrid(new SquareGrid());
 		m_model->adoptCellGrid(new HexGrid(false));
 		m_model->adoptCellGrid(new HexGrid(true));
-
-		m_cursor = new Cursor(m_renderbackend);
-		m_cursor->setNativeImageCursorEnabled(m_settings.isNativeImageCursorEnabled());
-		FL_LOG(_log, "Engine initialized");
 	}
 
 	Engine::~Engine() {
@@ -321,6 +361,9 @@ namespace FIFE {
 
 	void Engine::destroy() {
 		FL_LOG(_log, "Destructing engine");
+		// runs the remaining jobs while the objects they use still exist
+		delete m_jobsystem;
+		m_jobsystem = NULL;
  		delete m_cursor;
 		delete m_model;
 		delete m_soundmanager;
@@ -345,7 +388,9 @@ namespace FIFE {
 		delete m_vfs;
 		delete m_timemanager;
 
-		TTF_Quit();
+		if (!m_settings.isHeadless()) {
+			TTF_Quit();
+		}
 		SDL_Quit();
 
 #ifdef USE_COCOA
@@ -357,27 +402,66 @@ namespace FIFE {
 		//delete m_logmanager;
 	}
 	void Engine::initializePumping() {
-		m_eventmanager->processEvents();
+		if (m_eventmanager) {
+			m_eventmanager->processEvents();
+		}
 	}
 
 	void Engine::pump() {
+		FIFE_PROFILE_FRAME();
+		// listeners may evict resources before the next frame allocates new ones
+		MemoryTracker::instance()->checkBudgets();
+		{
+			FIFE_PROFILE_ZONE("jobs");
+			m_jobsystem->processCompletions();
+		}
+		bool fixedStep = m_settings.getModelTickRate() > 0;
+		if (m_settings.isHeadless()) {
+			if (fixedStep) {
+				updateModelTicks(true);
+			} else {
+				m_timemanager->update();
+				m_model->update();
+			}
+			return;
+		}
+
 		m_renderbackend->startFrame();
-		m_eventmanager->processEvents();
-		m_timemanager->update();
-		m_soundmanager->update();
+		{
+			FIFE_PROFILE_ZONE("events");
+			m_eventmanager->processEvents();
+		}
+		bool modelActive = m_model->getActiveCameraCount() > 0;
+		double interpolation = 1.0;
+		{
+			FIFE_PROFILE_ZONE("time");
+			if (fixedStep) {
+				interpolation = updateModelTicks(modelActive);
+			} else {
+				m_timemanager->update();
+			}
+		}
+		{
+			FIFE_PROFILE_ZONE("sound");
+			m_soundmanager->update();
+		}
 
 		m_targetrenderer->render();
-		if (m_model->getActiveCameraCount() == 0) {
+		if (!modelActive) {
 			m_renderbackend->clearBackBuffer();
 			m_offrenderer->render();
+		} else if (fixedStep) {
+			m_model->updateCameras(interpolation);
 		} else {
 			m_model->update();
 		}
 
 		if (m_guimanager) {
+			FIFE_PROFILE_ZONE("gui");
 			m_guimanager->turn();
 		}
 
+		FIFE_PROFILE_ZONE("endFrame");
 		m_cursor->draw();
 		m_renderbackend->endFrame();
 	}
@@ -386,6 +470,45 @@ namespace FIFE {
 		// nothing here at the moment..
 	}
 
+	void Engine::step(uint32_t ms) {
+		m_timemanager->step(ms);
+		m_model->update();
+	}
+
+	double Engine::updateModelTicks(bool simulate) {
+		// the times are counted in 1/rate ms, so one step is exactly 1000 units long
+		// and rates which do not divide 1000 are kept, e.g. 60 steps per second
+		const uint32_t rate = std::min<uint32_t>(m_settings.getModelTickRate(), 1000);
+		const uint64_t tickLength = 1000;
+		uint32_t now = SDL_GetTicks();
+		// the first cycle only starts the clock
+		if (m_lastPumpTime == 0) {
+			m_lastPumpTime = now;
+		}
+		m_tickAccumulator += static_cast<uint64_t>(now - m_lastPumpTime) * rate;
+		m_lastPumpTime = now;
+
+		uint64_t ticks = m_tickAccumulator / tickLength;
+		uint16_t maxTicks = m_settings.getMaxModelTicksPerFrame();
+		if (maxTicks > 0 && ticks > maxTicks) {
+			FL_DBG(_log, LMsg("Skipping ") << (ticks - maxTicks) << " model ticks");
+			ticks = maxTicks;
+		}
+		// keeps only the part of a step that has not passed yet, skipped steps are dropped
+		m_tickAccumulator %= tickLength;
+
+		for (uint64_t i = 0; i < ticks; ++i) {
+			// the game time moves in whole ms, the fraction is carried to the next step
+			m_tickTimeRemainder += 1000;
+			m_timemanager->step(m_tickTimeRemainder / rate);
+			m_tickTimeRemainder %= rate;
+			if (simulate) {
+				m_model->updateSimulation();
+			}
+		}
+		return static_cast<double>(m_tickAccumulator) / tickLength;
+	}
+
 	void Engine::addChangeListener(IEngineChangeListener* listener) {
 		m_changelisteners.push_back(listener);
 	}
@@ -51,6 +51,7 @@ namespace FIFE {
 	class VFSSourceFactory;
 	class EventManager;
 	class TimeManager;
+	class JobSystem;
 	class Model;
 	class LogManager;
 	class Cursor;
@@ -105,6 +106,9 @@ namespace FIFE {
 		void changeScreenMode(const ScreenMode& mode);
 
 		/** Initializes the engine
+		 * A headless engine, see EngineSettings::setHeadless(), only creates the
+		 * time manager, VFS, resource managers and the model. All other
+		 * subsystems stay NULL.
 		 */
 		void init();
 
@@ -124,9 +128,19 @@ namespace FIFE {
 		void finalizePumping();
 
 		/** Runs one cycle for the engine
+		 * A headless engine only updates the time and the model.
+		 * With a model tick rate, see EngineSettings::setModelTickRate(), the model
+		 * is updated as many times as steps of the tick rate have passed since the last cycle.
 		 */
 		void pump();
 
+		/** Advances the time by the given amount and updates the model, without
+		 * rendering, processing events or waiting for the real time to pass.
+		 * Meant for headless simulations, don't mix it with pump() as pump() uses the real time.
+		 * @param ms The time to advance in milliseconds.
+		 */
+		void step(uint32_t ms);
+
 		/** Provides access point to the SoundManager
 		 */
 		SoundManager* getSoundManager() const { return m_soundmanager; }
@@ -139,6 +153,10 @@ namespace FIFE {
 		 */
 		TimeManager* getTimeManager() const { return m_timemanager; }
 
+		/** Provides access point to the JobSystem
+		 */
+		JobSystem* getJobSystem() const { return m_jobsystem; }
+
 
 		/** Sets the GUI Manager to use.  Engine takes
 		 * ownership of the manager so DONT DELETE IT!
@@ -200,11 +218,27 @@ namespace FIFE {
 		void removeChangeListener(IEngineChangeListener* listener);
 
 	private:
+		/** Creates the parts of the engine a headless simulation needs.
+		 */
+		void initHeadless();
+
+		/** Creates the model with its pathers and grids.
+		 */
+		void createModel(RenderBackend* renderbackend);
+
+		/** Advances the time and the model by the steps of the model tick rate
+		 * that have passed since the last call.
+		 * @param simulate If false only the time advances.
+		 * @return The interpolation between the last two steps for rendering.
+		 */
+		double updateModelTicks(bool simulate);
+
 		RenderBackend* m_renderbackend;
 		IGUIManager* m_guimanager;
 		EventManager* m_eventmanager;
 		SoundManager* m_soundmanager;
 		TimeManager* m_timemanager;
+		JobSystem* m_jobsystem;
 		ImageManager* m_imagemanager;
 		AnimationManager* m_animationmanager;
 		SoundClipManager* m_soundclipmanager;
@@ -216,6 +250,12 @@ namespace FIFE {
 		Cursor* m_cursor;
 		bool m_destroyed;
 
+		// real time of the last model tick update, the time not yet simulated
+		// in 1/rate ms and the game time fraction carried between steps
+		uint32_t m_lastPumpTime;
+		uint64_t m_tickAccumulator;
+		uint32_t m_tickTimeRemainder;
+
 		EngineSettings m_settings;
 		DeviceCaps m_devcaps;
 
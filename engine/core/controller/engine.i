@@ -120,6 +120,16 @@ namespace FIFE {
 		bool isNativeImageCursorEnabled() const;
 		void setJoystickSupport(bool support);
 		bool isJoystickSupport() const;
+		void setHeadless(bool headless);
+		bool isHeadless() const;
+		void setModelTickRate(uint16_t ticks);
+		uint16_t getModelTickRate() const;
+		void setMaxModelTicksPerFrame(uint16_t ticks);
+		uint16_t getMaxModelTicksPerFrame() const;
+		void setJobThreadCount(uint32_t threads);
+		uint32_t getJobThreadCount() const;
+		void setVFSCacheSize(uint32_t bytes);
+		uint32_t getVFSCacheSize() const;
 
 	private:
 		EngineSettings();
@@ -139,6 +149,7 @@ namespace FIFE {
 		void initializePumping();
 		void finalizePumping();
 		void pump();
+		void step(uint32_t ms);
 
 		EngineSettings& getSettings();
 		const DeviceCaps& getDeviceCaps() const;
@@ -22,6 +22,7 @@
 // Standard C++ library includes
 #include <algorithm>
 #include <string>
+#include <thread>
 
 // 3rd party library includes
 #include <SDL.h>
@@ -75,7 +76,12 @@ namespace FIFE {
 		m_mousesensitivity(0.0),
 		m_mouseacceleration(false),
 		m_nativeimagecursor(false),
-		m_joystickSupport(false) {
+		m_joystickSupport(false),
+		m_headless(false),
+		m_modelTickRate(0),
+		m_maxModelTicksPerFrame(5),
+		m_jobThreadCount(std::max(std::thread::hardware_concurrency(), 2u) - 1),
+		m_vfsCacheSize(0) {
 			m_colorkey.r = 255;
 			m_colorkey.g = 0;
 			m_colorkey.b = 255;
@@ -327,5 +333,45 @@ namespace FIFE {
 	bool EngineSettings::isJoystickSupport() const {
 		return m_joystickSupport;
 	}
+
+	void EngineSettings::setHeadless(bool headless) {
+		m_headless = headless;
+	}
+
+	bool EngineSettings::isHeadless() const {
+		return m_headless;
+	}
+
+	void EngineSettings::setModelTickRate(uint16_t ticks) {
+		m_modelTickRate = ticks;
+	}
+
+	uint16_t EngineSettings::getModelTickRate() const {
+		return m_modelTickRate;
+	}
+
+	void EngineSettings::setMaxModelTicksPerFrame(uint16_t ticks) {
+		m_maxModelTicksPerFrame = ticks;
+	}
+
+	uint16_t EngineSettings::getMaxModelTicksPerFrame() const {
+		return m_maxModelTicksPerFrame;
+	}
+
+	void EngineSettings::setJobThreadCount(uint32_t threads) {
+		m_jobThreadCount = threads;
+	}
+
+	uint32_t EngineSettings::getJobThreadCount() const {
+		return m_jobThreadCount;
+	}
+
+	void EngineSettings::setVFSCacheSize(uint32_t bytes) {
+		m_vfsCacheSize = bytes;
+	}
+
+	uint32_t EngineSettings::getVFSCacheSize() const {
+		return m_vfsCacheSize;
+	}
 }
 
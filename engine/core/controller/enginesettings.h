@@ -432,6 +432,62 @@ namespace FIFE {
 		 */
 		bool isJoystickSupport() const;
 
+		/** Enables or disables the headless mode.
+		 * A headless engine has no video, audio, events or gui and
+		 * only simulates the model, e.g. for servers or automated tests.
+		 * @see Engine::step()
+		 */
+		void setHeadless(bool headless);
+
+		/** Returns whether the engine runs headless or not.
+		 */
+		bool isHeadless() const;
+
+		/** Sets the number of model updates per second.
+		 * With a tick rate the model is updated in fixed steps, independent of the frame rate,
+		 * and the cameras draw moving instances interpolated between the last two steps.
+		 * 0 updates the model once per frame with the real frame time, that's the default.
+		 * Rates above 1000 are limited to one update per ms.
+		 * @see setMaxModelTicksPerFrame()
+		 */
+		void setModelTickRate(uint16_t ticks);
+
+		/** Returns the number of model updates per second, 0 means once per frame.
+		 */
+		uint16_t getModelTickRate() const;
+
+		/** Sets the maximum number of model updates within one frame.
+		 * If the model falls behind by more steps, e.g. after a long loading time
+		 * or on a slow machine, the remaining time is skipped instead of catching up.
+		 * 0 means no limit, the default is 5.
+		 */
+		void setMaxModelTicksPerFrame(uint16_t ticks);
+
+		/** Returns the maximum number of model updates within one frame.
+		 */
+		uint16_t getMaxModelTicksPerFrame() const;
+
+		/** Sets the number of worker threads of the job system.
+		 * 0 runs all jobs on the main thread. The default is one thread less
+		 * than the hardware supports, but at least one.
+		 * Has to be set before the engine is initialized.
+		 */
+		void setJobThreadCount(uint32_t threads);
+
+		/** Returns the number of worker threads of the job system.
+		 */
+		uint32_t getJobThreadCount() const;
+
+		/** Sets the byte budget of the VFS cache for decompressed archive files.
+		 * 0 disables the cache, which is the default.
+		 * @see VFS::setCacheBudget
+		 */
+		void setVFSCacheSize(uint32_t bytes);
+
+		/** Returns the byte budget of the VFS cache.
+		 */
+		uint32_t getVFSCacheSize() const;
+
 	private:
 		uint8_t m_bitsperpixel;
 		bool m_fullscreen;
@@ -469,6 +525,11 @@ namespace FIFE {
 		bool m_mouseacceleration;
 		bool m_nativeimagecursor;
 		bool m_joystickSupport;
+		bool m_headless;
+		uint16_t m_modelTickRate;
+		uint16_t m_maxModelTicksPerFrame;
+		uint32_t m_jobThreadCount;
+		uint32_t m_vfsCacheSize;
 	};
 
 }//FIFE
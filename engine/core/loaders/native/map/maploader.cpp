@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <set>
 #include <string>
 #include <vector>
 
@@ -33,6 +34,7 @@
 #include "model/model.h"
 #include "model/structures/layer.h"
 #include "model/structures/instance.h"
+#include "model/structures/mapstreamer.h"
 #include "model/structures/cell.h"
 #include "model/structures/cellcache.h"
 #include "model/structures/trigger.h"
@@ -40,6 +42,7 @@
 #include "model/metamodel/grids/cellgrid.h"
 #include "model/metamodel/modelcoords.h"
 #include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
 #include "vfs/fife_boost_filesystem.h"
 #include "vfs/vfs.h"
 #include "vfs/vfsdirectory.h"
@@ -48,7 +51,9 @@
 #include "util/log/logger.h"
 #include "util/resource/resource.h"
 #include "util/structures/rect.h"
+#include "util/time/profiler.h"
 #include "video/imagemanager.h"
+#include "video/animation.h"
 #include "video/animationmanager.h"
 #include "video/image.h"
 #include "video/renderbackend.h"
@@ -68,9 +73,61 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_NATIVE_LOADERS);
 
+	/** Adds all objects of the model to objects.
+	 */
+	static void collectObjects(Model* model, std::set<Object*>& objects) {
+		std::list<std::string> namespaces = model->getNamespaces();
+		for (std::list<std::string>::iterator name_it = namespaces.begin(); name_it != namespaces.end(); ++name_it) {
+			std::list<Object*> nsObjects = model->getObjects(*name_it);
+			objects.insert(nsObjects.begin(), nsObjects.end());
+		}
+	}
+
+	/** Adds the frames of the animation to images.
+	 */
+	static void collectAnimationImages(AnimationPtr animation, std::vector<ImagePtr>& images) {
+		if (animation) {
+			std::vector<ImagePtr> frames = animation->getFrames();
+			images.insert(images.end(), frames.begin(), frames.end());
+		}
+	}
+
+	/** Adds the static images and the action animations of the object to images.
+	 */
+	static void collectObjectImages(ImageManager* imageManager, Object* object, std::vector<ImagePtr>& images) {
+		std::vector<int32_t> angles;
+		ObjectVisual* objVisual = object->getVisual<ObjectVisual>();
+		if (objVisual) {
+			objVisual->getStaticImageAngles(angles);
+			for (std::vector<int32_t>::iterator angle_it = angles.begin(); angle_it != angles.end(); ++angle_it) {
+				int32_t index = objVisual->getStaticImageIndexByAngle(*angle_it);
+				if (index != -1 && imageManager->exists(index)) {
+					images.push_back(imageManager->getPtr(index));
+				}
+			}
+		}
+
+		std::list<std::string> actionIds = object->getActionIds();
+		for (std::list<std::string>::iterator action_it = actionIds.begin(); action_it != actionIds.end(); ++action_it) {
+			Action* action = object->getAction(*action_it, false);
+			ActionVisual* actVisual = action ? action->getVisual<ActionVisual>() : NULL;
+			if (!actVisual) {
+				continue;
+			}
+			actVisual->getActionImageAngles(angles);
+			for (std::vector<int32_t>::iterator angle_it = angles.begin(); angle_it != angles.end(); ++angle_it) {
+				collectAnimationImages(actVisual->getAnimationByAngle(*angle_it), images);
+				std::map<int32_t, AnimationPtr> overlays = actVisual->getAnimationOverlay(*angle_it);
+				for (std::map<int32_t, AnimationPtr>::iterator overlay_it = overlays.begin(); overlay_it != overlays.end(); ++overlay_it) {
+					collectAnimationImages(overlay_it->second, images);
+				}
+			}
+		}
+	}
+
 	MapLoader::MapLoader(Model* model, VFS* vfs, ImageManager* imageManager, RenderBackend* renderBackend)
 	: m_model(model), m_vfs(vfs), m_imageManager(imageManager), m_animationManager(AnimationManager::instance()), m_renderBackend(renderBackend),
-	  m_loaderName("fife"), m_mapDirectory("") {
+	  m_loaderName("fife"), m_mapDirectory(""), m_streamingChunkSize(0) {
 		AnimationLoaderPtr animationLoader(new AnimationLoader(m_vfs, m_imageManager, m_animationManager));
 		AtlasLoaderPtr atlasLoader(new AtlasLoader(m_model, m_vfs, m_imageManager, m_animationManager));
 		m_objectLoader.reset(new ObjectLoader(m_model, m_vfs, m_imageManager, m_animationManager, animationLoader, atlasLoader));
@@ -81,6 +138,7 @@ namespace FIFE {
 	}
 
 	Map* MapLoader::load(const std::string& filename) {
+		FIFE_PROFILE_ZONE("mapLoad");
 		Map* map = NULL;
 
 		// reset percent done listener just in case
@@ -167,6 +225,22 @@ namespace FIFE {
 				if (map) {
 					map->setFilename(mapFilename);
 
+					// the instances of streamed maps are kept as records until the cameras come close
+					MemoryChunkSource* chunkSource = NULL;
+					MapStreamer* streamer = NULL;
+					if (m_streamingChunkSize > 0) {
+						chunkSource = new MemoryChunkSource();
+						streamer = new MapStreamer(map, chunkSource, m_streamingChunkSize);
+						map->setStreamer(streamer);
+					}
+
+					// the objects known before are imported by other maps
+					bool decodeImages = m_imageManager && m_renderBackend && m_renderBackend->getWindow();
+					std::set<Object*> knownObjects;
+					if (decodeImages) {
+						collectObjects(m_model, knownObjects);
+					}
+
 					std::string ns = "";
 					for (const TiXmlElement *importElement = root->FirstChildElement("import"); importElement; importElement = importElement->NextSiblingElement("import")) {
 						const std::string* importDir = importElement->Attribute(std::string("dir"));
@@ -201,6 +275,19 @@ namespace FIFE {
 							loadImportFile(fullFilePath.string(), fullDirPath.string());
 						}
 					}
+					// decodes the images of the objects imported by this map in parallel, instead of one by one
+					// when they are drawn first, a headless engine has no window and draws nothing
+					if (decodeImages) {
+						std::set<Object*> objects;
+						collectObjects(m_model, objects);
+						std::vector<ImagePtr> images;
+						for (std::set<Object*>::iterator object_it = objects.begin(); object_it != objects.end(); ++object_it) {
+							if (knownObjects.find(*object_it) == knownObjects.end()) {
+								collectObjectImages(m_imageManager, *object_it, images);
+							}
+						}
+						m_imageManager->loadImages(images);
+					}
 					// converts multiobject part id to object pointer
 					std::list<std::string> namespaces = m_model->getNamespaces();
 					std::list<std::string>::iterator name_it = namespaces.begin();
@@ -244,6 +331,7 @@ namespace FIFE {
 						const std::string* layerName = layerElement->Attribute(std::string("id"));
 						const std::string* pathing = layerElement->Attribute(std::string("pathing"));
 						const std::string* sorting = layerElement->Attribute(std::string("sorting"));
+						const std::string* spatialIndex = layerElement->Attribute(std::string("spatial_index"));
 						const std::string* gridType = layerElement->Attribute(std::string("grid_type"));
 						const std::string* layerType = layerElement->Attribute(std::string("layer_type"));
 						const std::string* layerTypeName = layerElement->Attribute(std::string("layer_type_id"));
@@ -271,6 +359,11 @@ namespace FIFE {
 								}
 							}
 
+							SpatialIndexStrategy spatialStrategy = SPATIAL_QUADTREE;
+							if (spatialIndex && *spatialIndex == "grid") {
+								spatialStrategy = SPATIAL_GRID;
+							}
+
 							CellGrid* grid = NULL;
 							if (gridType) {
 								grid = m_model->getCellGrid(*gridType);
@@ -300,6 +393,7 @@ namespace FIFE {
 								if (layer) {
 									layer->setPathingStrategy(pathStrategy);
 									layer->setSortingStrategy(sortStrategy);
+									layer->setSpatialIndexStrategy(spatialStrategy);
 									if (layerType) {
 										if (*layerType == "walkable") {
 											layer->setWalkable(true);
@@ -310,19 +404,19 @@ namespace FIFE {
 
 									double curr_x = 0;
 									double curr_y = 0;
+									// instances are created in one batch per layer, the elements are kept
+									// to set the remaining attributes afterwards
+									std::vector<InstanceCreationInfo> creations;
+									std::vector<const TiXmlElement*> creationElements;
 
 									for (const TiXmlElement* instances = layerElement->FirstChildElement("instances"); instances; instances = instances->NextSiblingElement("instances")) {
 										for (const TiXmlElement* instance = instances->FirstChildElement("i"); instance; instance = instance->NextSiblingElement("i")) {
 											double x = 0;
 											double y = 0;
 											double z = 0;
-											int r = 0;
-											int stackpos = 0;
-											int cellStack = 0;
 
 											const std::string* instanceId = instance->Attribute(std::string("id"));
 											const std::string* objectId = instance->Attribute(std::string("o"));
-											const std::string* costId = instance->Attribute(std::string("cost_id"));
 
 											if (!objectId) {
 												objectId = instance->Attribute(std::string("object"));
@@ -341,7 +435,6 @@ namespace FIFE {
 											int xRetVal = instance->QueryValueAttribute("x", &x);
 											int yRetVal = instance->QueryValueAttribute("y", &y);
 											instance->QueryValueAttribute("z", &z);
-											int rRetVal = instance->QueryValueAttribute("r", &r);
 
 											if (xRetVal == TIXML_SUCCESS) {
 												curr_x = x;
@@ -357,13 +450,6 @@ namespace FIFE {
 												y = curr_y;
 											}
 
-											if (rRetVal != TIXML_SUCCESS) {
-												rRetVal = instance->QueryValueAttribute("rotation", &r);
-											}
-
-											int stackRetVal = instance->QueryValueAttribute("stackpos", &stackpos);
-											int cellStackRetVal = instance->QueryValueAttribute("cellstack", &cellStack);
-
 											if (objectId) {
 												if (namespaceId) {
 													ns = *namespaceId;
@@ -372,65 +458,98 @@ namespace FIFE {
 												Object* object = m_model->getObject(*objectId, ns);
 
 												if (object) {
-													Instance* inst = NULL;
-													if (instanceId) {
-														inst = layer->createInstance(object, ExactModelCoordinate(x,y,z), *instanceId);
-													}
-													else {
-														inst = layer->createInstance(object, ExactModelCoordinate(x,y,z));
-													}
+													creations.push_back(InstanceCreationInfo(object, ExactModelCoordinate(x,y,z),
+														instanceId ? *instanceId : ""));
+													creationElements.push_back(instance);
+												}
+											}
 
-													if (inst) {
-														if (rRetVal != TIXML_SUCCESS) {
-															ObjectVisual* objVisual = object->getVisual<ObjectVisual>();
-															std::vector<int> angles;
-															objVisual->getStaticImageAngles(angles);
-															if (!angles.empty()) {
-																r = angles[0];
-															}
-														}
+											// increment % done counter
+											m_percentDoneListener.incrementCount();
+										}
+									}
 
-														inst->setRotation(r);
+									// read the remaining attributes, so streamed and created instances get the same state
+									std::vector<StreamedInstance> records(creations.size());
+									for (uint32_t i = 0; i < creations.size(); ++i) {
+										StreamedInstance& record = records[i];
+										Object* object = creations[i].object;
+										const TiXmlElement* instance = creationElements[i];
+										record.object = object;
+										record.coordinate = creations[i].coordinate;
+										record.id = creations[i].id;
+										int r = 0;
+										int stackpos = 0;
+										int cellStack = 0;
+
+										int rRetVal = instance->QueryValueAttribute("r", &r);
+										if (rRetVal != TIXML_SUCCESS) {
+											rRetVal = instance->QueryValueAttribute("rotation", &r);
+										}
+										if (rRetVal != TIXML_SUCCESS) {
+											ObjectVisual* objVisual = object->getVisual<ObjectVisual>();
+											std::vector<int> angles;
+											objVisual->getStaticImageAngles(angles);
+											if (!angles.empty()) {
+												r = angles[0];
+											}
+										}
 
-														InstanceVisual* instVisual = InstanceVisual::create(inst);
+										record.rotation = r;
 
-														if  (instVisual && (stackRetVal == TIXML_SUCCESS)) {
-															instVisual->setStackPosition(stackpos);
-														}
+										int stackRetVal = instance->QueryValueAttribute("stackpos", &stackpos);
+										if  (stackRetVal == TIXML_SUCCESS) {
+											record.stackPosition = stackpos;
+										}
 
-														if  (cellStackRetVal == TIXML_SUCCESS) {
-															inst->setCellStackPosition(cellStack);
-														}
+										int cellStackRetVal = instance->QueryValueAttribute("cellstack", &cellStack);
+										if  (cellStackRetVal == TIXML_SUCCESS) {
+											record.cellStackPosition = cellStack;
+										}
 
-														if (costId) {
-															double cost = 0;
-															int costRetVal = instance->QueryValueAttribute("cost", &cost);
-															if (costRetVal == TIXML_SUCCESS) {
-																inst->setCost(*costId, cost);
-															}
-														}
+										const std::string* costId = instance->Attribute(std::string("cost_id"));
+										if (costId) {
+											double cost = 0;
+											int costRetVal = instance->QueryValueAttribute("cost", &cost);
+											if (costRetVal == TIXML_SUCCESS) {
+												record.costId = *costId;
+												record.cost = cost;
+											}
+										}
+									}
 
-														if (object->getAction("default")) {
-															Location target(layer);
+									std::vector<Instance*> created;
+									if (streamer) {
+										streamer->addLayer(layer);
+										for (uint32_t i = 0; i < records.size(); ++i) {
+											chunkSource->addInstance(layer->getId(), streamer->getChunk(records[i].coordinate), records[i]);
+										}
+									} else {
+										created = layer->createInstances(creations);
+									}
+									for (uint32_t i = 0; i < created.size(); ++i) {
+										Instance* inst = created[i];
+										const StreamedInstance& record = records[i];
 
-															inst->actRepeat("default", target);
-														}
-													}
-													else
-													{
-														std::ostringstream oss;
-														oss << " Failed to create instance of object "
-															<< *objectId
-															<< " : " << __FILE__
-															<< " [" << __LINE__ << "]"
-															<< std::endl;
-														FL_ERR(_log, oss.str());
-													}
-												}
-											}
+										inst->setRotation(record.rotation);
 
-											// increment % done counter
-											m_percentDoneListener.incrementCount();
+										InstanceVisual* instVisual = InstanceVisual::create(inst);
+										if  (instVisual && record.stackPosition >= 0) {
+											instVisual->setStackPosition(record.stackPosition);
+										}
+
+										if  (record.cellStackPosition >= 0) {
+											inst->setCellStackPosition(record.cellStackPosition);
+										}
+
+										if (!record.costId.empty()) {
+											inst->setCost(record.costId, record.cost);
+										}
+
+										if (record.object->getAction("default")) {
+											Location target(layer);
+
+											inst->actRepeat("default", target);
 										}
 									}
 								}
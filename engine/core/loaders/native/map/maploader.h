@@ -118,6 +118,18 @@ namespace FIFE {
 		*/
 		const std::string& getLoaderName() const;
 
+		/** Sets the chunk size in layer cells for maps loaded afterwards.
+		* Maps with a chunk size above 0 get a MapStreamer that creates the
+		* instances around the cameras only, 0 creates all instances at once.
+		* The map file is still parsed at once, the instance records of all chunks
+		* are kept in a MemoryChunkSource.
+		*/
+		void setStreamingChunkSize(uint32_t size) { m_streamingChunkSize = size; }
+
+		/** returns the chunk size for streamed maps, 0 if streaming is disabled
+		*/
+		uint32_t getStreamingChunkSize() const { return m_streamingChunkSize; }
+
 	private:
 		Model* m_model;
 		VFS* m_vfs;
@@ -130,6 +142,7 @@ namespace FIFE {
 		std::string m_loaderName;
 		std::string m_mapDirectory;
 		std::vector<std::string> m_importDirectories;
+		uint32_t m_streamingChunkSize;
 
 	};
 
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_SNAPSHOTFORMAT_H_
+#define FIFE_SNAPSHOTFORMAT_H_
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Binary model snapshots, written by SnapshotSaver and read by SnapshotLoader.
+	 *
+	 * All numbers are little endian, doubles and floats are stored as their IEEE bits.
+	 * Strings are a uint32 length followed by the bytes. Shared strings (object ids,
+	 * namespaces, action and cost ids) are written once: a uint32 index into the table
+	 * of shared strings read so far, an index equal to the table size introduces a new
+	 * string that follows as plain string.
+	 * Instances are referenced by their index in the order they were written, over all layers.
+	 *
+	 * File layout:
+	 * - magic, version, map id, map time multiplier
+	 * - layers, each followed by its instances
+	 * - cell caches
+	 * - triggers
+	 */
+
+	//! identifies snapshot files
+	static const char SNAPSHOT_MAGIC[8] = { 'F', 'I', 'F', 'E', 'S', 'N', 'A', 'P' };
+
+	//! raised with every change of the file layout, older versions are rejected
+	static const uint32_t SNAPSHOT_VERSION = 1;
+
+	//! written for missing instance or layer references
+	static const uint32_t SNAPSHOT_NO_INDEX = 0xFFFFFFFF;
+
+	/** Marks the optional parts of an instance record.
+	 */
+	enum SnapshotInstanceFlag {
+		SNAPSHOT_INSTANCE_BLOCKING = 0x0001,
+		SNAPSHOT_INSTANCE_OVERRIDE_BLOCKING = 0x0002,
+		SNAPSHOT_INSTANCE_SPECIAL_COST = 0x0004,
+		SNAPSHOT_INSTANCE_VISUAL = 0x0008,
+		SNAPSHOT_INSTANCE_VISIBLE = 0x0010,
+		SNAPSHOT_INSTANCE_ACTION = 0x0020,
+		SNAPSHOT_INSTANCE_REPEATING = 0x0040,
+		SNAPSHOT_INSTANCE_MOVING = 0x0080,
+		SNAPSHOT_INSTANCE_SAY = 0x0100,
+		SNAPSHOT_INSTANCE_TIME_MULTIPLIER = 0x0200
+	};
+
+	/** Marks the modified properties of a cell record.
+	 */
+	enum SnapshotCellFlag {
+		SNAPSHOT_CELL_COST_MULTIPLIER = 0x01,
+		SNAPSHOT_CELL_SPEED_MULTIPLIER = 0x02,
+		SNAPSHOT_CELL_BLOCKER_TYPE = 0x04,
+		SNAPSHOT_CELL_NARROW = 0x08,
+		SNAPSHOT_CELL_TRANSITION = 0x10
+	};
+}
+
+#endif
@@ -0,0 +1,601 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstring>
+#include <deque>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/model.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/cellgrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "vfs/vfs.h"
+#include "vfs/raw/rawdata.h"
+#include "view/visual.h"
+
+#include "snapshotformat.h"
+#include "snapshotloader.h"
+
+namespace FIFE {
+	/** Logger to use for this source file.
+	 *  @relates Logger
+	 */
+	static Logger _log(LM_NATIVE_LOADERS);
+
+	/** Reads the values of a snapshot that is completely in memory.
+	 */
+	class SnapshotReader {
+	public:
+		SnapshotReader(const std::vector<uint8_t>& data):
+			m_data(data),
+			m_index(0) {
+		}
+
+		uint8_t read8() {
+			require(1);
+			return m_data[m_index++];
+		}
+
+		uint16_t read16() {
+			require(2);
+			uint16_t value = m_data[m_index] | (m_data[m_index + 1] << 8);
+			m_index += 2;
+			return value;
+		}
+
+		uint32_t read32() {
+			require(4);
+			uint32_t value = static_cast<uint32_t>(m_data[m_index]) |
+				(static_cast<uint32_t>(m_data[m_index + 1]) << 8) |
+				(static_cast<uint32_t>(m_data[m_index + 2]) << 16) |
+				(static_cast<uint32_t>(m_data[m_index + 3]) << 24);
+			m_index += 4;
+			return value;
+		}
+
+		int32_t readInt32() {
+			return static_cast<int32_t>(read32());
+		}
+
+		float readFloat() {
+			uint32_t bits = read32();
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		double readDouble() {
+			uint64_t bits = read32();
+			bits |= static_cast<uint64_t>(read32()) << 32;
+			double value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		std::string readString() {
+			uint32_t length = read32();
+			require(length);
+			std::string value(reinterpret_cast<const char*>(&m_data[0]) + m_index, length);
+			m_index += length;
+			return value;
+		}
+
+		const std::string& readSharedString() {
+			uint32_t index = read32();
+			if (index == m_sharedStrings.size()) {
+				m_sharedStrings.push_back(readString());
+			} else if (index > m_sharedStrings.size()) {
+				throw InvalidFormat("invalid string reference in snapshot");
+			}
+			return m_sharedStrings[index];
+		}
+
+		ExactModelCoordinate readCoordinate() {
+			ExactModelCoordinate coordinate;
+			coordinate.x = readDouble();
+			coordinate.y = readDouble();
+			coordinate.z = readDouble();
+			return coordinate;
+		}
+
+		ModelCoordinate readCell() {
+			ModelCoordinate coordinate;
+			coordinate.x = readInt32();
+			coordinate.y = readInt32();
+			return coordinate;
+		}
+
+		void skip(uint32_t length) {
+			require(length);
+			m_index += length;
+		}
+
+	private:
+		void require(uint32_t length) {
+			if (m_data.size() - m_index < length) {
+				throw InvalidFormat("snapshot ends unexpectedly");
+			}
+		}
+
+		const std::vector<uint8_t>& m_data;
+		size_t m_index;
+		// a deque keeps the returned references valid while the table grows
+		std::deque<std::string> m_sharedStrings;
+	};
+
+	/** State of an instance, applied after the instances of the layer are created.
+	 */
+	struct SnapshotInstance {
+		Object* object;
+		ExactModelCoordinate coordinate;
+		std::string id;
+		int32_t rotation;
+		uint8_t cellStackPosition;
+		uint16_t flags;
+		std::string costId;
+		double cost;
+		int32_t stackPosition;
+		uint8_t transparency;
+		std::string action;
+		uint32_t actionRuntime;
+		uint32_t targetLayer;
+		ExactModelCoordinate target;
+		double speed;
+		std::string sayText;
+		uint32_t sayTime;
+		float timeMultiplier;
+	};
+
+	/** Action to start once the cell caches exist, as movement needs them for the route.
+	 */
+	struct SnapshotAction {
+		Instance* instance;
+		SnapshotInstance state;
+	};
+
+	/** Transition to create once all cell caches are finalized.
+	 */
+	struct SnapshotTransition {
+		Cell* cell;
+		uint32_t layer;
+		ModelCoordinate target;
+		bool immediate;
+	};
+
+	static void readInstance(SnapshotReader& reader, Model* model, SnapshotInstance& state) {
+		const std::string& name_space = reader.readSharedString();
+		const std::string& objectId = reader.readSharedString();
+		state.object = model->getObject(objectId, name_space);
+		if (!state.object) {
+			FL_WARN(_log, LMsg("SnapshotLoader::load() - skipped instance of missing object ") << name_space << ":" << objectId);
+		}
+		state.id = reader.readString();
+		state.coordinate = reader.readCoordinate();
+		state.rotation = reader.readInt32();
+		state.cellStackPosition = reader.read8();
+		state.flags = reader.read16();
+		if (state.flags & SNAPSHOT_INSTANCE_SPECIAL_COST) {
+			state.costId = reader.readSharedString();
+			state.cost = reader.readDouble();
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_VISUAL) {
+			state.stackPosition = reader.readInt32();
+			state.transparency = reader.read8();
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_ACTION) {
+			state.action = reader.readSharedString();
+			state.actionRuntime = reader.read32();
+			if (state.flags & SNAPSHOT_INSTANCE_MOVING) {
+				state.targetLayer = reader.read32();
+				state.target = reader.readCoordinate();
+				state.speed = reader.readDouble();
+			}
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_SAY) {
+			state.sayText = reader.readString();
+			state.sayTime = reader.read32();
+		}
+		state.timeMultiplier = 1.0;
+		if (state.flags & SNAPSHOT_INSTANCE_TIME_MULTIPLIER) {
+			state.timeMultiplier = reader.readFloat();
+		}
+	}
+
+	static void applyInstanceState(Instance* instance, const SnapshotInstance& state) {
+		instance->setRotation(state.rotation);
+		instance->setCellStackPosition(state.cellStackPosition);
+
+		bool blocking = (state.flags & SNAPSHOT_INSTANCE_BLOCKING) != 0;
+		bool overrideBlocking = (state.flags & SNAPSHOT_INSTANCE_OVERRIDE_BLOCKING) != 0;
+		if (overrideBlocking || blocking != instance->isBlocking()) {
+			instance->setOverrideBlocking(true);
+			instance->setBlocking(blocking);
+			instance->setOverrideBlocking(overrideBlocking);
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_SPECIAL_COST) {
+			instance->setCost(state.costId, state.cost);
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_VISUAL) {
+			InstanceVisual* visual = InstanceVisual::create(instance);
+			visual->setStackPosition(state.stackPosition);
+			visual->setTransparency(state.transparency);
+			visual->setVisible((state.flags & SNAPSHOT_INSTANCE_VISIBLE) != 0);
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_TIME_MULTIPLIER) {
+			instance->setTimeMultiplier(state.timeMultiplier);
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_SAY) {
+			instance->say(state.sayText, state.sayTime);
+		}
+	}
+
+	static Layer* getLayer(const std::vector<Layer*>& layers, uint32_t index) {
+		if (index == SNAPSHOT_NO_INDEX) {
+			return NULL;
+		}
+		if (index >= layers.size()) {
+			throw InvalidFormat("invalid layer reference in snapshot");
+		}
+		return layers[index];
+	}
+
+	static Instance* getInstance(const std::vector<Instance*>& instances, uint32_t index) {
+		if (index == SNAPSHOT_NO_INDEX) {
+			return NULL;
+		}
+		if (index >= instances.size()) {
+			throw InvalidFormat("invalid instance reference in snapshot");
+		}
+		return instances[index];
+	}
+
+	static void readLayer(SnapshotReader& reader, Model* model, Map* map, std::vector<Layer*>& layers,
+		std::vector<Instance*>& instances, std::vector<SnapshotAction>& actions) {
+
+		std::string layerId = reader.readString();
+		const std::string& gridType = reader.readSharedString();
+		CellGrid* grid = model->getCellGrid(gridType);
+		if (!grid) {
+			throw NotFound("cellgrid " + gridType);
+		}
+		grid->setXShift(reader.readDouble());
+		grid->setYShift(reader.readDouble());
+		grid->setZShift(reader.readDouble());
+		grid->setXScale(reader.readDouble());
+		grid->setYScale(reader.readDouble());
+		grid->setZScale(reader.readDouble());
+		grid->setRotation(reader.readDouble());
+		grid->setAllowDiagonals(reader.read8() != 0);
+
+		Layer* layer = map->createLayer(layerId, grid);
+		layers.push_back(layer);
+		layer->setPathingStrategy(static_cast<PathingStrategy>(reader.read8()));
+		layer->setSortingStrategy(static_cast<SortingStrategy>(reader.read8()));
+		layer->setSpatialIndexStrategy(static_cast<SpatialIndexStrategy>(reader.read8()));
+		bool walkable = reader.read8() != 0;
+		bool interact = reader.read8() != 0;
+		std::string walkableId = reader.readString();
+		if (walkable) {
+			layer->setWalkable(true);
+		} else if (interact) {
+			layer->setInteract(true, walkableId);
+		}
+		layer->setLayerTransparency(reader.read8());
+		layer->setInstancesVisible(reader.read8() != 0);
+		layer->setStatic(reader.read8() != 0);
+
+		// the instances of a layer are created in one batch
+		uint32_t count = reader.read32();
+		std::vector<SnapshotInstance> states(count);
+		std::vector<InstanceCreationInfo> creations;
+		creations.reserve(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			readInstance(reader, model, states[i]);
+			if (states[i].object) {
+				creations.push_back(InstanceCreationInfo(states[i].object, states[i].coordinate, states[i].id));
+			}
+		}
+
+		std::vector<Instance*> created = layer->createInstances(creations);
+		std::vector<Instance*>::const_iterator createdIt = created.begin();
+		instances.reserve(instances.size() + count);
+		for (uint32_t i = 0; i < count; ++i) {
+			const SnapshotInstance& state = states[i];
+			if (!state.object) {
+				instances.push_back(NULL);
+				continue;
+			}
+			Instance* instance = *createdIt++;
+			instances.push_back(instance);
+			applyInstanceState(instance, state);
+			if (state.flags & SNAPSHOT_INSTANCE_ACTION) {
+				SnapshotAction action;
+				action.instance = instance;
+				action.state = state;
+				actions.push_back(action);
+			}
+		}
+	}
+
+	static void readCells(SnapshotReader& reader, CellCache* cache, std::vector<Cell*>& cells) {
+		uint32_t count = reader.read32();
+		cells.clear();
+		cells.reserve(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			ModelCoordinate mc = reader.readCell();
+			Cell* cell = cache ? cache->getCell(mc) : NULL;
+			if (cell) {
+				cells.push_back(cell);
+			}
+		}
+	}
+
+	static void readCellCache(SnapshotReader& reader, const std::vector<Layer*>& layers,
+		std::vector<SnapshotTransition>& transitions) {
+
+		Layer* layer = getLayer(layers, reader.read32());
+		// the cache is read in any case, to get to the data behind it
+		CellCache* cache = layer ? layer->getCellCache() : NULL;
+		double defaultCost = reader.readDouble();
+		double defaultSpeed = reader.readDouble();
+		bool searchNarrow = reader.read8() != 0;
+		bool staticSize = reader.read8() != 0;
+		Rect size;
+		size.x = reader.readInt32();
+		size.y = reader.readInt32();
+		size.w = reader.readInt32();
+		size.h = reader.readInt32();
+		if (cache) {
+			cache->setDefaultCostMultiplier(defaultCost);
+			cache->setDefaultSpeedMultiplier(defaultSpeed);
+			cache->setSearchNarrowCells(searchNarrow);
+			if (!(size == cache->getSize())) {
+				cache->setSize(size);
+			}
+			cache->setStaticSize(staticSize);
+		}
+
+		std::vector<Cell*> cells;
+		uint32_t costCount = reader.read32();
+		for (uint32_t i = 0; i < costCount; ++i) {
+			std::string costId = reader.readSharedString();
+			double cost = reader.readDouble();
+			readCells(reader, cache, cells);
+			if (cache) {
+				cache->registerCost(costId, cost);
+				cache->addCellsToCost(costId, cells);
+			}
+		}
+
+		uint32_t areaCount = reader.read32();
+		for (uint32_t i = 0; i < areaCount; ++i) {
+			std::string areaId = reader.readSharedString();
+			readCells(reader, cache, cells);
+			if (cache && !cells.empty()) {
+				cache->addCellsToArea(areaId, cells);
+			}
+		}
+
+		uint32_t cellCount = reader.read32();
+		for (uint32_t i = 0; i < cellCount; ++i) {
+			ModelCoordinate mc = reader.readCell();
+			uint8_t flags = reader.read8();
+			Cell* cell = cache ? cache->getCell(mc) : NULL;
+			if (flags & SNAPSHOT_CELL_COST_MULTIPLIER) {
+				double multiplier = reader.readDouble();
+				if (cell) {
+					cell->setCostMultiplier(multiplier);
+				}
+			}
+			if (flags & SNAPSHOT_CELL_SPEED_MULTIPLIER) {
+				double multiplier = reader.readDouble();
+				if (cell) {
+					cell->setSpeedMultiplier(multiplier);
+				}
+			}
+			if (flags & SNAPSHOT_CELL_BLOCKER_TYPE) {
+				CellTypeInfo type = static_cast<CellTypeInfo>(reader.read8());
+				if (cell) {
+					cell->setCellType(type);
+				}
+			}
+			if ((flags & SNAPSHOT_CELL_NARROW) && cell) {
+				cache->addNarrowCell(cell);
+			}
+			if (flags & SNAPSHOT_CELL_TRANSITION) {
+				SnapshotTransition transition;
+				transition.cell = cell;
+				transition.layer = reader.read32();
+				transition.target.x = reader.readInt32();
+				transition.target.y = reader.readInt32();
+				transition.target.z = reader.readInt32();
+				transition.immediate = reader.read8() != 0;
+				if (cell) {
+					transitions.push_back(transition);
+				}
+			}
+		}
+	}
+
+	static void readTrigger(SnapshotReader& reader, Map* map, const std::vector<Layer*>& layers,
+		const std::vector<Instance*>& instances) {
+
+		Trigger* trigger = map->getTriggerController()->createTrigger(reader.readString());
+		if (reader.read8() != 0) {
+			trigger->setTriggered();
+		}
+		if (reader.read8() != 0) {
+			trigger->enableForAllInstances();
+		}
+		Instance* attached = getInstance(instances, reader.read32());
+		if (attached) {
+			trigger->attach(attached);
+		}
+
+		uint32_t cellCount = reader.read32();
+		for (uint32_t i = 0; i < cellCount; ++i) {
+			Layer* layer = getLayer(layers, reader.read32());
+			ModelCoordinate mc = reader.readCell();
+			if (layer) {
+				trigger->assign(layer, mc);
+			}
+		}
+
+		uint32_t instanceCount = reader.read32();
+		for (uint32_t i = 0; i < instanceCount; ++i) {
+			Instance* instance = getInstance(instances, reader.read32());
+			if (instance) {
+				trigger->enableForInstance(instance);
+			}
+		}
+
+		uint32_t conditionCount = reader.read32();
+		for (uint32_t i = 0; i < conditionCount; ++i) {
+			trigger->addTriggerCondition(static_cast<TriggerCondition>(reader.read32()));
+		}
+	}
+
+	static void startAction(const SnapshotAction& action, const std::vector<Layer*>& layers) {
+		Instance* instance = action.instance;
+		const SnapshotInstance& state = action.state;
+		if (!state.object->getAction(state.action)) {
+			FL_WARN(_log, LMsg("SnapshotLoader::load() - object ") << state.object->getId() << " has no action " << state.action);
+			return;
+		}
+		if (state.flags & SNAPSHOT_INSTANCE_MOVING) {
+			Layer* layer = getLayer(layers, state.targetLayer);
+			Location target(layer ? layer : instance->getLocationRef().getLayer());
+			target.setExactLayerCoordinates(state.target);
+			instance->move(state.action, target, state.speed);
+		} else if (state.flags & SNAPSHOT_INSTANCE_REPEATING) {
+			instance->actRepeat(state.action, state.rotation);
+		} else {
+			instance->actOnce(state.action, state.rotation);
+		}
+		instance->setActionRuntime(state.actionRuntime);
+	}
+
+	SnapshotLoader::SnapshotLoader(Model* model, VFS* vfs):
+		m_model(model),
+		m_vfs(vfs) {
+	}
+
+	SnapshotLoader::~SnapshotLoader() {
+	}
+
+	bool SnapshotLoader::isLoadable(const std::string& filename) const {
+		try {
+			RawData* data = m_vfs->open(filename);
+			bool loadable = false;
+			if (data->getDataLength() >= sizeof(SNAPSHOT_MAGIC) + 4) {
+				uint8_t header[sizeof(SNAPSHOT_MAGIC)];
+				data->readInto(header, sizeof(header));
+				loadable = std::memcmp(header, SNAPSHOT_MAGIC, sizeof(header)) == 0 &&
+					data->read32Little() == SNAPSHOT_VERSION;
+			}
+			delete data;
+			return loadable;
+		}
+		catch (NotFound& e) {
+			FL_ERR(_log, e.what());
+		}
+		return false;
+	}
+
+	Map* SnapshotLoader::load(const std::string& filename) {
+		// the whole file is read at once, it is far smaller than the model it describes
+		std::vector<uint8_t> bytes;
+		RawData* data = m_vfs->open(filename);
+		bytes.resize(data->getDataLength());
+		if (!bytes.empty()) {
+			data->readInto(&bytes[0], bytes.size());
+		}
+		delete data;
+
+		SnapshotReader reader(bytes);
+		if (bytes.size() < sizeof(SNAPSHOT_MAGIC) || std::memcmp(&bytes[0], SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+			throw InvalidFormat(filename + " is no snapshot");
+		}
+		reader.skip(sizeof(SNAPSHOT_MAGIC));
+		if (reader.read32() != SNAPSHOT_VERSION) {
+			throw InvalidFormat(filename + " has an unsupported snapshot version");
+		}
+
+		Map* map = m_model->createMap(reader.readString());
+		try {
+			map->setTimeMultiplier(reader.readFloat());
+
+			std::vector<Layer*> layers;
+			std::vector<Instance*> instances;
+			std::vector<SnapshotAction> actions;
+			uint32_t layerCount = reader.read32();
+			for (uint32_t i = 0; i < layerCount; ++i) {
+				readLayer(reader, m_model, map, layers, instances, actions);
+			}
+
+			// the cells have to exist before their state can be restored
+			map->initializeCellCaches();
+			map->finalizeCellCaches();
+			std::vector<SnapshotTransition> transitions;
+			uint32_t cacheCount = reader.read32();
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				readCellCache(reader, layers, transitions);
+			}
+			std::vector<SnapshotTransition>::const_iterator transitionIt = transitions.begin();
+			for (; transitionIt != transitions.end(); ++transitionIt) {
+				Layer* layer = getLayer(layers, transitionIt->layer);
+				transitionIt->cell->createTransition(layer ? layer : transitionIt->cell->getLayer(),
+					transitionIt->target, transitionIt->immediate);
+			}
+
+			uint32_t triggerCount = reader.read32();
+			for (uint32_t i = 0; i < triggerCount; ++i) {
+				readTrigger(reader, map, layers, instances);
+			}
+
+			// movement needs the cell caches to find its route
+			std::vector<SnapshotAction>::const_iterator actionIt = actions.begin();
+			for (; actionIt != actions.end(); ++actionIt) {
+				startAction(*actionIt, layers);
+			}
+		}
+		catch (...) {
+			m_model->deleteMap(map);
+			throw;
+		}
+		return map;
+	}
+}
@@ -0,0 +1,72 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_SNAPSHOTLOADER_H_
+#define FIFE_SNAPSHOTLOADER_H_
+
+// Standard C++ library includes
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+	class Model;
+	class Map;
+	class VFS;
+
+	/** Creates a map from a binary snapshot, @see SnapshotSaver
+	 *
+	 * The objects of the instances must be loaded already, e.g. with
+	 * MapLoader::loadImportFile(). Instances of missing objects are skipped.
+	 * The instances of each layer are created in one batch and the running
+	 * actions are started again with their saved runtime.
+	 */
+	class SnapshotLoader {
+	public:
+		SnapshotLoader(Model* model, VFS* vfs);
+
+		~SnapshotLoader();
+
+		/** Returns true if the file starts like a snapshot of a supported version.
+		 */
+		bool isLoadable(const std::string& filename) const;
+
+		/** Creates the map stored in the snapshot.
+		 * @param filename The path of the snapshot.
+		 * @return The new map.
+		 * @throws InvalidFormat if the file is no snapshot, has an unsupported version or is truncated.
+		 * @throws NameClash if the model has a map with the same id already.
+		 * @throws NotFound if the model has no cell grid of a saved type.
+		 */
+		Map* load(const std::string& filename);
+
+	private:
+		Model* m_model;
+		VFS* m_vfs;
+	};
+}
+
+#endif
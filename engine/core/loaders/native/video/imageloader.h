@@ -23,6 +23,8 @@
 #define FIFE_VIDEO_LOADERS_IMAGE_PROVIDER_H
 
 // Standard C++ library includes
+#include <string>
+#include <vector>
 
 // 3rd party library includes
 
@@ -30,15 +32,38 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
 #include "util/resource/resource.h"
 
+struct SDL_Surface;
+
 namespace FIFE {
+	class Image;
+
 	/** ImageLoader for some basic formats like jpeg, png etc.
 	 */
 	class ImageLoader : public IResourceLoader {
 	public:
 		ImageLoader() {}
 		virtual void load(IResource* res);
+
+		/** Reads the file of an image from the VFS.
+		 * @param filename The file.
+		 * @param data Receives the content of the file.
+		 */
+		static void readFile(const std::string& filename, std::vector<uint8_t>& data);
+
+		/** Decodes the content of an image file into a surface in the format of the render backend.
+		 * Doesn't use the VFS or the image, so files can be decoded by worker threads.
+		 * @param data The content of the file.
+		 * @return The new surface.
+		 * @throws SDLException if the file can't be decoded or converted.
+		 */
+		static SDL_Surface* decode(const std::vector<uint8_t>& data);
+
+		/** Gives the surface to the image and keeps the x and y shift of the image.
+		 */
+		static void setSurface(Image* img, SDL_Surface* surface);
 	};
 }
 #endif
@@ -34,7 +34,7 @@
 #include "action.h"
 
 namespace FIFE {
-	Action::Action(const std::string& identifier)
+	Action::Action(const Atom& identifier)
 		: m_id(identifier),
 		m_duration(0),
 		m_visual(NULL),
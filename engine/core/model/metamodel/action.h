@@ -34,6 +34,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/math/angles.h"
+#include "util/base/atom.h"
 #include "util/base/fifeclass.h"
 
 #include "ivisual.h"
@@ -47,7 +48,7 @@ namespace FIFE {
 		 * Actions are created by calling addAction from object, thus
 		 * this method should really be called only by object or test code
 		 */
-		Action(const std::string& identifier);
+		Action(const Atom& identifier);
 
 		/** Destructor
 		 */
@@ -55,7 +56,7 @@ namespace FIFE {
 
 		/** Get the identifier for this action.
 		 */
-		const std::string& getId() { return m_id; }
+		const std::string& getId() { return m_id.str(); }
 
 		/** Sets the duration for this action
 		 */
@@ -82,7 +83,7 @@ namespace FIFE {
 		ActionAudio* getAudio() const { return m_audio; }
 
 	private:
-		std::string m_id;
+		Atom m_id;
 
 		// duration of the action
 		uint32_t m_duration;
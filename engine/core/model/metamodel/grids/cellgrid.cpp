@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <atomic>
 #include <cassert>
 
 // 3rd party library includes
@@ -31,10 +32,14 @@
 #include "util/log/logger.h"
 
 #include "cellgrid.h"
+#include "gridkernels.h"
 
 namespace FIFE {
 	static Logger _log(LM_CELLGRID);
 
+	//! last version given to a cellgrid, 0 is never used
+	static std::atomic<uint32_t> s_lastVersion(0);
+
 	CellGrid::CellGrid():
 		FifeClass(),
 		m_matrix(),
@@ -46,7 +51,8 @@ namespace FIFE {
 		m_yscale(1),
 		m_zscale(1),
 		m_rotation(0),
-		m_allow_diagonals(false) {
+		m_allow_diagonals(false),
+		m_version(0) {
 		updateMatrices();
 	}
 
@@ -54,14 +60,16 @@ namespace FIFE {
 	}
 
 	void CellGrid::getAccessibleCoordinates(const ModelCoordinate& curpos, std::vector<ModelCoordinate>& coordinates) {
-		coordinates.clear();
-		for (int32_t x = curpos.x - 1; x <= curpos.x + 1; x++) {
-			for (int32_t y = curpos.y - 1; y <= curpos.y + 1; y++) {
-				ModelCoordinate pt(x, y);
-				if (isAccessible(curpos, pt)) {
-					coordinates.push_back(pt);
-				}
-			}
+		switch (getGridKernelType(this)) {
+			case GRID_KERNEL_SQUARE:
+				FIFE::getAccessibleCoordinates(SquareGridKernel(this), curpos, coordinates);
+				break;
+			case GRID_KERNEL_HEX:
+				FIFE::getAccessibleCoordinates(HexGridKernel(this), curpos, coordinates);
+				break;
+			default:
+				FIFE::getAccessibleCoordinates(GenericGridKernel(this), curpos, coordinates);
+				break;
 		}
 	}
 
@@ -70,12 +78,40 @@ namespace FIFE {
 		m_matrix.applyScale(m_xscale, m_yscale, m_zscale);
 		m_matrix.applyTranslate(m_xshift, m_yshift, m_zshift);
 		m_inverse_matrix = m_matrix.inverse();
+		m_version = ++s_lastVersion;
+		if (m_version == 0) {
+			m_version = ++s_lastVersion;
+		}
 	}
 
 	ExactModelCoordinate CellGrid::toMapCoordinates(const ModelCoordinate& layer_coords) {
 		return toMapCoordinates(intPt2doublePt(layer_coords));
 	}
 
+	void CellGrid::toMapCoordinatesBatch(const DoublePoint3DArray& layer_coords, DoublePoint3DArray& map_coords) {
+		const size_t count = layer_coords.size();
+		map_coords.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			map_coords.set(i, toMapCoordinates(layer_coords.get(i)));
+		}
+	}
+
+	void CellGrid::toExactLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, DoublePoint3DArray& layer_coords) {
+		const size_t count = map_coords.size();
+		layer_coords.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			layer_coords.set(i, toExactLayerCoordinates(map_coords.get(i)));
+		}
+	}
+
+	void CellGrid::toLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, std::vector<ModelCoordinate>& layer_coords) {
+		const size_t count = map_coords.size();
+		layer_coords.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			layer_coords[i] = toLayerCoordinates(map_coords.get(i));
+		}
+	}
+
 	int32_t CellGrid::orientation(const ExactModelCoordinate& pt, const ExactModelCoordinate& pt1, const ExactModelCoordinate& pt2) {
 		double o = (pt2.x - pt1.x) * (pt.y - pt1.y) - (pt.x - pt1.x) * (pt2.y - pt1.y);
 		if (o > 0.0) {
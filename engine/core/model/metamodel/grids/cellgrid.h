@@ -32,6 +32,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "model/metamodel/modelcoords.h"
+#include "util/math/batchtransform.h"
 #include "util/math/matrix.h"
 #include "util/base/fifeclass.h"
 #include "util/base/fife_stdint.h"
@@ -115,6 +116,24 @@ namespace FIFE {
 		 */
 		virtual ModelCoordinate toLayerCoordinatesFromExactLayerCoordinates(const ExactModelCoordinate& exact_layer_coords) = 0;
 
+		/** Transforms all given points from layer coordinates to map coordinates
+		 *  @param layer_coords points in exact layer coordinates
+		 *  @param map_coords receives the points in map coordinates, can be the same array as layer_coords
+		 */
+		virtual void toMapCoordinatesBatch(const DoublePoint3DArray& layer_coords, DoublePoint3DArray& map_coords);
+
+		/** Transforms all given points from map coordinates to exact layer coordinates
+		 *  @param map_coords points in map coordinates
+		 *  @param layer_coords receives the points in exact layer coordinates, can be the same array as map_coords
+		 */
+		virtual void toExactLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, DoublePoint3DArray& layer_coords);
+
+		/** Transforms all given points from map coordinates to cell precision layer coordinates
+		 *  @param map_coords points in map coordinates
+		 *  @param layer_coords receives the points in layer coordinates
+		 */
+		virtual void toLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, std::vector<ModelCoordinate>& layer_coords);
+
 		/** Fills given point vector with vertices from selected cell
 		 *  @param vtx vertices for given cell
 		 *  @param cell cell to get vertices from
@@ -243,6 +262,11 @@ namespace FIFE {
 		 */
 		virtual CellGrid* clone() = 0;
 
+		/** Returns a number that changes whenever the transformation of the cellgrid changes.
+		 *  It is unique over all cellgrids, Location uses it to validate its cached coordinates.
+		 */
+		uint32_t getVersion() const { return m_version; }
+
 	protected:
 		void updateMatrices();
 		bool ptInTriangle(const ExactModelCoordinate& pt, const ExactModelCoordinate& pt1, const ExactModelCoordinate& pt2, const ExactModelCoordinate& pt3);
@@ -257,6 +281,7 @@ namespace FIFE {
 		double m_zscale;
 		double m_rotation;
 		bool m_allow_diagonals;
+		uint32_t m_version;
 
 	private:
 		int32_t orientation(const ExactModelCoordinate& pt, const ExactModelCoordinate& pt1, const ExactModelCoordinate& pt2);
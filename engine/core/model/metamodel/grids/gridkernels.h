@@ -0,0 +1,185 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MODEL_GRIDS_GRIDKERNELS_H
+#define FIFE_MODEL_GRIDS_GRIDKERNELS_H
+
+// Standard C++ library includes
+#include <typeinfo>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/modelcoords.h"
+#include "util/math/fife_math.h"
+
+#include "cellgrid.h"
+#include "hexgrid.h"
+#include "squaregrid.h"
+
+namespace FIFE {
+
+	/** Grid kernels are non virtual stand-ins for the per cell CellGrid queries.
+	 * Hot loops are written as templates over the kernel type and pick the kernel
+	 * once per search or query, so the per cell calls can be inlined.
+	 */
+	enum GridKernelType {
+		GRID_KERNEL_GENERIC = 0,
+		GRID_KERNEL_SQUARE,
+		GRID_KERNEL_HEX
+	};
+
+	/** Returns the kernel type matching the grid.
+	 * Only the exact grid classes are specialized, derived grids use the generic kernel.
+	 */
+	inline GridKernelType getGridKernelType(const CellGrid* grid) {
+		if (typeid(*grid) == typeid(SquareGrid)) {
+			return GRID_KERNEL_SQUARE;
+		} else if (typeid(*grid) == typeid(HexGrid)) {
+			return GRID_KERNEL_HEX;
+		}
+		return GRID_KERNEL_GENERIC;
+	}
+
+	/** Kernel which forwards to the CellGrid virtuals.
+	 */
+	class GenericGridKernel {
+	public:
+		explicit GenericGridKernel(CellGrid* grid): m_grid(grid) {}
+
+		uint32_t getCellSideCount() const {
+			return m_grid->getCellSideCount();
+		}
+		bool isAccessible(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			return m_grid->isAccessible(curpos, target);
+		}
+		double getAdjacentCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			return m_grid->getAdjacentCost(curpos, target);
+		}
+		double getHeuristicCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			return m_grid->getHeuristicCost(curpos, target);
+		}
+
+	private:
+		CellGrid* m_grid;
+	};
+
+	/** Inlined SquareGrid queries, SquareGrid forwards its virtuals to it.
+	 */
+	class SquareGridKernel {
+	public:
+		explicit SquareGridKernel(const CellGrid* grid): m_allowDiagonals(grid->getAllowDiagonals()) {}
+
+		uint32_t getCellSideCount() const {
+			return 4;
+		}
+		bool isAccessible(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			if (curpos == target) {
+				return true;
+			}
+			uint8_t x = ABS(target.x-curpos.x);
+			uint8_t y = ABS(target.y-curpos.y);
+			if ((x<=1) && (y<=1)) {
+				if (m_allowDiagonals) {
+					return true;
+				} else if (x^y) {
+					return true;
+				}
+			}
+			return false;
+		}
+		double getAdjacentCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			if (curpos == target) {
+				return 0.0;
+			} else if (ABS(target.x-curpos.x)^ABS(target.y-curpos.y)) {
+				return 1.0;
+			}
+			return 1.4;
+		}
+		double getHeuristicCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			return static_cast<double>(ABS(target.x - curpos.x) + ABS(target.y - curpos.y));
+		}
+
+	private:
+		bool m_allowDiagonals;
+	};
+
+	/** Inlined HexGrid queries, HexGrid forwards its virtuals to it.
+	 */
+	class HexGridKernel {
+	public:
+		explicit HexGridKernel(const CellGrid* grid): m_axial(static_cast<const HexGrid*>(grid)->isAxial()) {}
+
+		uint32_t getCellSideCount() const {
+			return 6;
+		}
+		bool isAccessible(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			int32_t x = target.x-curpos.x;
+			int32_t y = target.y-curpos.y;
+			if (ABS(x) <= 1 && ABS(y) <= 1) {
+				if (m_axial) {
+					return y == 0 || x == 0 || x == -y;
+				} else if (y == 0) {
+					return true;
+				} else if (curpos.y & 1) {
+					return x >= 0;
+				}
+				return x <= 0;
+			}
+			return false;
+		}
+		double getAdjacentCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			if (curpos == target) {
+				return 0.0;
+			}
+			return 1.0;
+		}
+		double getHeuristicCost(const ModelCoordinate& curpos, const ModelCoordinate& target) const {
+			return static_cast<double>(ABS(target.x - curpos.x) + ABS(target.y - curpos.y));
+		}
+
+	private:
+		bool m_axial;
+	};
+
+	/** Fills coordinates with the accessible coordinates around curpos,
+	 * same as CellGrid::getAccessibleCoordinates.
+	 */
+	template<typename Kernel>
+	inline void getAccessibleCoordinates(const Kernel& kernel, const ModelCoordinate& curpos, std::vector<ModelCoordinate>& coordinates) {
+		coordinates.clear();
+		for (int32_t x = curpos.x - 1; x <= curpos.x + 1; x++) {
+			for (int32_t y = curpos.y - 1; y <= curpos.y + 1; y++) {
+				ModelCoordinate pt(x, y);
+				if (kernel.isAccessible(curpos, pt)) {
+					coordinates.push_back(pt);
+				}
+			}
+		}
+	}
+
+} // FIFE
+
+#endif
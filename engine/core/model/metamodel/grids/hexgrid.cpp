@@ -21,6 +21,9 @@
 
 // Standard C++ library includes
 #include <cassert>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // 3rd party library includes
 
@@ -31,6 +34,7 @@
 #include "util/math/fife_math.h"
 #include "util/log/logger.h"
 
+#include "gridkernels.h"
 #include "hexgrid.h"
 
 namespace FIFE {
@@ -44,6 +48,44 @@ namespace FIFE {
 	static const double VERTICAL_MULTIP_INV = 1 / VERTICAL_MULTIP;
 	static const double HEX_EDGE_GRADIENT = 1 / Mathd::Sqrt(3);
 
+	/** Adds sign * getXZigzagOffset(ys[i]) to xs[i] for all count values.
+	 */
+	static void addXZigzagOffsets(bool axial, const double* ys, double* xs, size_t count, double sign) {
+		const double factor = sign * HEX_TO_EDGE;
+		size_t i = 0;
+		if (axial) {
+			for (; i < count; ++i) {
+				xs[i] += factor * ys[i];
+			}
+			return;
+		}
+#if defined(__SSE2__)
+		const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d vfactor = _mm_set1_pd(factor);
+		const __m128i lowBit = _mm_set1_epi32(1);
+		for (; i + 2 <= count; i += 2) {
+			const __m128d ay = _mm_and_pd(_mm_loadu_pd(ys + i), absMask);
+			const __m128i iy = _mm_cvttpd_epi32(ay);
+			__m128d offset = _mm_sub_pd(ay, _mm_cvtepi32_pd(iy));
+			// widen the odd row flags of the two int32 values to 64 bit lane masks
+			__m128i odd = _mm_shuffle_epi32(_mm_and_si128(iy, lowBit), _MM_SHUFFLE(1, 1, 0, 0));
+			const __m128d mask = _mm_castsi128_pd(_mm_cmpeq_epi32(odd, lowBit));
+			offset = _mm_or_pd(_mm_and_pd(mask, _mm_sub_pd(one, offset)), _mm_andnot_pd(mask, offset));
+			_mm_storeu_pd(xs + i, _mm_add_pd(_mm_loadu_pd(xs + i), _mm_mul_pd(vfactor, offset)));
+		}
+#endif
+		for (; i < count; ++i) {
+			double ay = ABS(ys[i]);
+			int32_t i_layer_y = static_cast<int32_t>(ay);
+			double offset = ay - static_cast<double>(i_layer_y);
+			if ((i_layer_y % 2) == 1) {
+				offset = 1 - offset;
+			}
+			xs[i] += factor * offset;
+		}
+	}
+
 	HexGrid::HexGrid(bool axial):
 		CellGrid(),
 		m_axial(axial) {
@@ -72,33 +114,15 @@ namespace FIFE {
 	}
 
 	bool HexGrid::isAccessible(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		int32_t x = target.x-curpos.x;
-		int32_t y = target.y-curpos.y;
-
-		if (ABS(x) <= 1 && ABS(y) <= 1) {
-			if (m_axial) {
-				if (y == 0 || x == 0 || x == -y)
-					return true;
-			} else {
-				if (y == 0) {
-					return true;
-				} else if (curpos.y & 1) {
-					if (x >= 0) return true;
-				} else if (x <= 0) return true;
-			}
-        }
-		return false;
+		return HexGridKernel(this).isAccessible(curpos, target);
 	}
 
 	double HexGrid::getAdjacentCost(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		if (curpos == target) {
-			return 0.0;
-		}
-		return 1.0;
+		return HexGridKernel(this).getAdjacentCost(curpos, target);
 	}
 
 	double HexGrid::getHeuristicCost(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		return static_cast<double>(ABS(target.x - curpos.x) + ABS(target.y - curpos.y));
+		return HexGridKernel(this).getHeuristicCost(curpos, target);
 	}
 
 	const std::string& HexGrid::getType() const {
@@ -167,6 +191,48 @@ namespace FIFE {
 		return toLayerCoordinatesHelper(elc);
 	}
 
+	void HexGrid::toMapCoordinatesBatch(const DoublePoint3DArray& layer_coords, DoublePoint3DArray& map_coords) {
+		const size_t count = layer_coords.size();
+		if (&map_coords != &layer_coords) {
+			map_coords = layer_coords;
+		}
+		if (count == 0) {
+			return;
+		}
+		double* xs = &map_coords.x[0];
+		double* ys = &map_coords.y[0];
+		addXZigzagOffsets(m_axial, ys, xs, count, 1.0);
+		for (size_t i = 0; i < count; ++i) {
+			ys[i] *= VERTICAL_MULTIP;
+		}
+		transformPoints(m_matrix, map_coords, map_coords);
+	}
+
+	void HexGrid::toExactLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, DoublePoint3DArray& layer_coords) {
+		transformPoints(m_inverse_matrix, map_coords, layer_coords);
+		const size_t count = layer_coords.size();
+		if (count == 0) {
+			return;
+		}
+		double* xs = &layer_coords.x[0];
+		double* ys = &layer_coords.y[0];
+		for (size_t i = 0; i < count; ++i) {
+			ys[i] /= VERTICAL_MULTIP;
+		}
+		addXZigzagOffsets(m_axial, ys, xs, count, -1.0);
+	}
+
+	void HexGrid::toLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, std::vector<ModelCoordinate>& layer_coords) {
+		DoublePoint3DArray elc;
+		transformPoints(m_inverse_matrix, map_coords, elc);
+		const size_t count = elc.size();
+		layer_coords.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			elc.y[i] *= VERTICAL_MULTIP_INV;
+			layer_coords[i] = toLayerCoordinatesHelper(elc.get(i));
+		}
+	}
+
 	ModelCoordinate HexGrid::toLayerCoordinatesHelper(const ExactModelCoordinate& coords) {
 		// this helper method takes exact layer coordinates with zigzag removed
 		// and converts them to layer coordinates
@@ -50,11 +50,18 @@ namespace FIFE {
 		ModelCoordinate toLayerCoordinates(const ExactModelCoordinate& map_coord);
 		ExactModelCoordinate toExactLayerCoordinates(const ExactModelCoordinate& map_coord);
 		ModelCoordinate toLayerCoordinatesFromExactLayerCoordinates(const ExactModelCoordinate& exact_layer_coords);
+		void toMapCoordinatesBatch(const DoublePoint3DArray& layer_coords, DoublePoint3DArray& map_coords);
+		void toExactLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, DoublePoint3DArray& layer_coords);
+		void toLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, std::vector<ModelCoordinate>& layer_coords);
 		void getVertices(std::vector<ExactModelCoordinate>& vtx, const ModelCoordinate& cell);
 		std::vector<ModelCoordinate> toMultiCoordinates(const ModelCoordinate& position, const std::vector<ModelCoordinate>& orig, bool reverse);
 		std::vector<ModelCoordinate> getCoordinatesInLine(const ModelCoordinate& start, const ModelCoordinate& end);
 		CellGrid* clone();
 
+		/** Returns true if the grid uses axial coordinates, otherwise offset coordinates.
+		 */
+		bool isAxial() const { return m_axial; }
+
 	private:
 		double getXZigzagOffset(double y);
 		ModelCoordinate toLayerCoordinatesHelper(const ExactModelCoordinate& coords);
@@ -32,6 +32,7 @@
 #include "util/math/fife_math.h"
 #include "util/log/logger.h"
 
+#include "gridkernels.h"
 #include "squaregrid.h"
 
 namespace FIFE {
@@ -58,33 +59,15 @@ namespace FIFE {
 	}
 
 	bool SquareGrid::isAccessible(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		if (curpos == target) {
-			return true;
-		}
-		uint8_t x = ABS(target.x-curpos.x);
-		uint8_t y = ABS(target.y-curpos.y); 
-		if ((x<=1) && (y<=1)) {
-			if (m_allow_diagonals) {
-				return true;
-			} else if (x^y) {
-				return true;
-			}
-		}
-
-		return false;
+		return SquareGridKernel(this).isAccessible(curpos, target);
 	}
 
 	double SquareGrid::getAdjacentCost(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		if (curpos == target) {
-			return 0.0;
-		} else if (ABS(target.x-curpos.x)^ABS(target.y-curpos.y)) {
-			return 1.0;
-		}
-		return 1.4;
+		return SquareGridKernel(this).getAdjacentCost(curpos, target);
 	}
 	
 	double SquareGrid::getHeuristicCost(const ModelCoordinate& curpos, const ModelCoordinate& target) {
-		return static_cast<double>(ABS(target.x - curpos.x) + ABS(target.y - curpos.y));
+		return SquareGridKernel(this).getHeuristicCost(curpos, target);
 	}
 
 	const std::string& SquareGrid::getType() const {
@@ -115,6 +98,24 @@ namespace FIFE {
 		return result;
 	}
 
+	void SquareGrid::toMapCoordinatesBatch(const DoublePoint3DArray& layer_coords, DoublePoint3DArray& map_coords) {
+		transformPoints(m_matrix, layer_coords, map_coords);
+	}
+
+	void SquareGrid::toExactLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, DoublePoint3DArray& layer_coords) {
+		transformPoints(m_inverse_matrix, map_coords, layer_coords);
+	}
+
+	void SquareGrid::toLayerCoordinatesBatch(const DoublePoint3DArray& map_coords, std::vector<ModelCoordinate>& layer_coords) {
+		DoublePoint3DArray exact;
+		transformPoints(m_inverse_matrix, map_coords, exact);
+		const size_t count = exact.size();
+		layer_coords.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			layer_coords[i] = ModelCoordinate(round(exact.x[i]), round(exact.y[i]), round(exact.z[i]));
+		}
+	}
+
 	void SquareGrid::getVertices(std::vector<ExactModelCoordinate>& vtx, const ModelCoordinate& cell) {
 		vtx.clear();
 		double x = static_cast<double>(cell.x);
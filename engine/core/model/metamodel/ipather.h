@@ -36,6 +36,7 @@ namespace FIFE {
 	class Location;
 	class Instance;
 	class Route;
+	struct RouteStep;
 	
 	//! A path is a list with locations. Each location holds the coordinate for one cell.
 	typedef std::list<Location> Path;
@@ -78,6 +79,27 @@ namespace FIFE {
 		 */
 		virtual bool followRoute(const Location& current, Route* route, double speed, Location& nextLocation) = 0;
 
+		/** Calculates the next step like followRoute(), but doesn't change the route.
+		 * Different routes can be handled at the same time, the parallel instance update
+		 * calls it from worker threads and applies the step later with applyRouteStep().
+		 *
+		 * @param current A const reference to the current location.
+		 * @param route A pointer to the route which should be followed.
+		 * @param speed A double which holds the speed.
+		 * @param nextLocation A reference to the next location returned by the pather.
+		 * @param step A reference to the step that receives the changes for the route.
+		 * @return A boolean, true if the step could be calculated, false if the pather only supports followRoute().
+		 */
+		virtual bool computeRouteStep(const Location& current, Route* route, double speed, Location& nextLocation, RouteStep& step) { return false; }
+
+		/** Applies a step calculated by computeRouteStep() to the route.
+		 *
+		 * @param route A pointer to the route the step was calculated for.
+		 * @param step A const reference to the step.
+		 * @param nextLocation A const reference to the next location of the step.
+		 */
+		virtual void applyRouteStep(Route* route, const RouteStep& step, const Location& nextLocation) {}
+
 		/** Updates the pather (should it need updating).
 		 *
 		 * The update method is called by the model. Pathfinders which require per loop updating
@@ -45,7 +45,7 @@ namespace FIFE {
 	}
 	Object::BasicObjectProperty::~BasicObjectProperty() {
 		if (m_actions) {
-			std::map<std::string, Action*>::const_iterator i(m_actions->begin());
+			std::unordered_map<Atom, Action*>::const_iterator i(m_actions->begin());
 			while (i != m_actions->end()) {
 				delete i->second;
 				++i;
@@ -56,7 +56,6 @@ namespace FIFE {
 
 	Object::MovableObjectProperty::MovableObjectProperty():
 		m_pather(NULL),
-		m_costId(""),
 		m_cost(1.0),
 		m_speed(1.0),
 		m_zRange(0) {
@@ -89,22 +88,19 @@ namespace FIFE {
 		delete m_multiProperty;
 	}
 
-	Action* Object::createAction(const std::string& identifier, bool is_default) {
-		std::map<std::string, Action*>* actions;
+	Action* Object::createAction(const Atom& identifier, bool is_default) {
+		std::unordered_map<Atom, Action*>* actions;
 		if (!m_basicProperty) {
 			m_basicProperty = new BasicObjectProperty();
 		}
 		
 		if (!m_basicProperty->m_actions) {
-			m_basicProperty->m_actions = new std::map<std::string, Action*>;
+			m_basicProperty->m_actions = new std::unordered_map<Atom, Action*>;
 		}
 		actions = m_basicProperty->m_actions;
 
-		std::map<std::string, Action*>::const_iterator it = actions->begin();
-		for(; it != actions->end(); ++it) {
-			if(identifier == it->second->getId()) {
-				throw NameClash(identifier);
-			}
+		if (actions->find(identifier) != actions->end()) {
+			throw NameClash(identifier.str());
 		}
 
 		Action* a = getAction(identifier, false);
@@ -118,13 +114,13 @@ namespace FIFE {
 		return a;
 	}
 
-	Action* Object::getAction(const std::string& identifier, bool deepsearch) const {
-		std::map<std::string, Action*>* actions = NULL;
+	Action* Object::getAction(const Atom& identifier, bool deepsearch) const {
+		std::unordered_map<Atom, Action*>* actions = NULL;
 		if (m_basicProperty) {
 			actions = m_basicProperty->m_actions;
 		}
 
-		std::map<std::string, Action*>::const_iterator i;
+		std::unordered_map<Atom, Action*>::const_iterator i;
 		if (actions) {
 			i = actions->find(identifier);
 		}
@@ -138,24 +134,25 @@ namespace FIFE {
 	}
 
 	std::list<std::string> Object::getActionIds() const {
-		std::map<std::string, Action*>* actions = NULL;
+		std::unordered_map<Atom, Action*>* actions = NULL;
 		if (m_basicProperty) {
 			actions = m_basicProperty->m_actions;
 		}
 		std::list<std::string> action_ids;
 		if (actions) {
-			std::map<std::string, Action*>::const_iterator actions_it = actions->begin();
+			std::unordered_map<Atom, Action*>::const_iterator actions_it = actions->begin();
 			for(; actions_it != actions->end(); ++actions_it) {
-				action_ids.push_back(actions_it->first);
+				action_ids.push_back(actions_it->first.str());
 			}
+			action_ids.sort();
 		}
 		return action_ids;
 	}
 
-	void Object::setDefaultAction(const std::string& identifier) {
-		std::map<std::string, Action*>::const_iterator i;
+	void Object::setDefaultAction(const Atom& identifier) {
+		std::unordered_map<Atom, Action*>::const_iterator i;
 		Action* action = NULL;
-		std::map<std::string, Action*>* actions = NULL;
+		std::unordered_map<Atom, Action*>* actions = NULL;
 		if (m_basicProperty) {
 			actions = m_basicProperty->m_actions;
 		}
@@ -274,7 +271,7 @@ namespace FIFE {
 
 	bool Object::isSpecialCost() const {
 		if (m_moveProperty) {
-			return m_moveProperty->m_costId != "";
+			return !m_moveProperty->m_costId.empty();
 		}
 		if (m_inherited) {
 			return m_inherited->isSpecialCost();
@@ -291,7 +288,7 @@ namespace FIFE {
 
 	std::string Object::getCostId() const {
 		if (m_moveProperty) {
-			return m_moveProperty->m_costId;
+			return m_moveProperty->m_costId.str();
 		}
 		if (m_inherited) {
 			return m_inherited->getCostId();
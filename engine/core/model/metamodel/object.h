@@ -26,6 +26,7 @@
 #include <string>
 #include <map>
 #include <list>
+#include <unordered_map>
 
 // 3rd party library includes
 
@@ -33,6 +34,7 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/atom.h"
 #include "util/resource/resource.h"
 #include "util/math/angles.h"
 
@@ -82,19 +84,19 @@ namespace FIFE {
 		 *      In case there's no explicit default action created, first
 		 *      action created becomes the default
 		 */
-		Action* createAction(const std::string& identifier, bool is_default=false);
+		Action* createAction(const Atom& identifier, bool is_default=false);
 
 		/** Gets action with given id. If not found, returns NULL
 		 */
-		Action* getAction(const std::string& identifier, bool deepsearch = true) const;
+		Action* getAction(const Atom& identifier, bool deepsearch = true) const;
 
-		/** Gets all available action ids of the object and packs them into a list
+		/** Gets all available action ids of the object and packs them into a sorted list
 		 */
 		std::list<std::string> getActionIds() const;
 
 		/** Sets default action assigned to this object. If not available, then default action is not changed.
 		 */
-		void setDefaultAction(const std::string& identifier);
+		void setDefaultAction(const Atom& identifier);
 
 		/** Gets default action assigned to this object. If none available, returns NULL
 		 */
@@ -369,7 +371,7 @@ namespace FIFE {
 			std::string m_area;
 
 			//! holds action ids and assigned actions
-			std::map<std::string, Action*>* m_actions;
+			std::unordered_map<Atom, Action*>* m_actions;
 
 			//! pointer to default action
 			Action* m_defaultAction;
@@ -397,7 +399,7 @@ namespace FIFE {
 			IPather* m_pather;
 
 			//! cost identifier
-			std::string m_costId;
+			Atom m_costId;
 
 			//! cost value, default 1.0
 			double m_cost;
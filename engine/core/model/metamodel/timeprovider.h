@@ -32,6 +32,7 @@
 // Second block: files included from the same folder
 #include "util/base/fife_stdint.h"
 #include "util/base/exception.h"
+#include "util/structures/objectpool.h"
 
 namespace FIFE {
 
@@ -46,6 +47,11 @@ namespace FIFE {
 		 */
 		explicit TimeProvider(TimeProvider* master);
 		~TimeProvider();
+
+		/** Time providers of instances are taken from a pool, they are created on every activation.
+		 */
+		static void* operator new(std::size_t size) { return ObjectPool<TimeProvider>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<TimeProvider>::deallocate(ptr, size); }
 		
 		/** With multiplier, you can adjust the time speed. 0.5 means time runs half as slow,
 		 * while 2.0 means it runs twice as fast
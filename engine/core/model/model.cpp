@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 
@@ -29,6 +30,7 @@
 // Second block: files included from the same folder
 #include "util/structures/purge.h"
 #include "util/log/logger.h"
+#include "util/time/profiler.h"
 #include "model/metamodel/ipather.h"
 #include "model/metamodel/object.h"
 #include "model/metamodel/grids/cellgrid.h"
@@ -69,6 +71,7 @@ namespace FIFE {
 	:	FifeClass(),
 		m_lastNamespace(NULL),
 		m_timeprovider(NULL),
+		m_updateThreads(1),
 		m_renderbackend(renderbackend),
 		m_renderers(renderers){
 
@@ -100,6 +103,7 @@ namespace FIFE {
 
 		Map* map = new Map(identifier, m_renderbackend, m_renderers, &m_timeprovider);
 		map->addChangeListener(m_mapObserver);
+		map->setUpdateThreadCount(m_updateThreads);
 		m_maps.push_back(map);
 		return map;
 	}
@@ -325,15 +329,44 @@ namespace FIFE {
 	}
 
 	void Model::update() {
+		updateSimulation();
+		updateCameras();
+	}
+
+	void Model::updateSimulation() {
+		FIFE_PROFILE_ZONE("simulation");
 		std::list<Map*>::iterator it = m_maps.begin();
 		for(; it != m_maps.end(); ++it) {
-			(*it)->update();
+			FIFE_PROFILE_ZONE((*it)->getId());
+			(*it)->updateSimulation();
 		}
 		std::vector<IPather*>::iterator jt = m_pathers.begin();
 		for(; jt != m_pathers.end(); ++jt) {
+			FIFE_PROFILE_ZONE((*jt)->getName());
 			(*jt)->update();
 		}
 	}
 
+	void Model::updateCameras(double interpolation) {
+		FIFE_PROFILE_ZONE("render");
+		std::list<Map*>::iterator it = m_maps.begin();
+		for(; it != m_maps.end(); ++it) {
+			FIFE_PROFILE_ZONE((*it)->getId());
+			(*it)->updateCameras(interpolation);
+		}
+	}
+
+	void Model::setUpdateThreadCount(uint32_t threads) {
+		m_updateThreads = std::max<uint32_t>(threads, 1);
+		std::list<Map*>::iterator it = m_maps.begin();
+		for(; it != m_maps.end(); ++it) {
+			(*it)->setUpdateThreadCount(m_updateThreads);
+		}
+	}
+
+	uint32_t Model::getUpdateThreadCount() const {
+		return m_updateThreads;
+	}
+
 } //FIFE
 
@@ -147,9 +147,20 @@ namespace FIFE {
 		void removeCellGrid(CellGrid* grid);
 
 		/** Called periodically to update events on model
+		 * Same as updateSimulation() followed by updateCameras().
 		 */
 		void update();
 
+		/** Runs one simulation tick on all maps and updates the pathers, without rendering.
+		 */
+		void updateSimulation();
+
+		/** Updates and renders the cameras of all maps.
+		 * @param interpolation Position of the rendered frame between the previous and
+		 * the latest simulation tick. @see Map::updateCameras
+		 */
+		void updateCameras(double interpolation = 1.0);
+
 		/** Sets speed for the model. With speed 1.0, everything runs with normal speed.
 		 * With speed 2.0, clock is ticking twice as fast. With 0, everything gets paused.
 		 * Negavtive values are not supported (throws NotSupported exception).
@@ -160,6 +171,17 @@ namespace FIFE {
 		 */
 		double getTimeMultiplier() const { return m_timeprovider.getMultiplier(); }
 
+		/** Sets the number of threads that are used to update the instances on the maps.
+		 * With more than one thread the movement of the instances is calculated in parallel
+		 * by the JobSystem, split into at most this many chunks per layer, all changes are
+		 * still applied in a serial pass. 0 or 1 disables it (default).
+		 */
+		void setUpdateThreadCount(uint32_t threads);
+
+		/** Gets the number of threads used to update the instances. @see setUpdateThreadCount.
+		 */
+		uint32_t getUpdateThreadCount() const;
+
 	private:
 		// Map observer, currently only used to delete CellGrids from deleted layers
 		ModelMapObserver* m_mapObserver;
@@ -185,6 +207,9 @@ namespace FIFE {
 
 		TimeProvider m_timeprovider;
 
+		// Number of threads for the parallel instance update, 1 if disabled
+		uint32_t m_updateThreads;
+
 		RenderBackend* m_renderbackend;
 
 		std::vector<RendererBase*> m_renderers;
@@ -66,6 +66,8 @@ namespace FIFE {
 		
 		void setTimeMultiplier(float multip);
 		double getTimeMultiplier() const;
+		void setUpdateThreadCount(uint32_t threads);
+		uint32_t getUpdateThreadCount() const;
 		
 	};
 }
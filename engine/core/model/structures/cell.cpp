@@ -28,6 +28,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/log/logger.h"
+#include "util/base/memorytracker.h"
 #include "view/visual.h"
 
 #include "cell.h"
@@ -46,10 +47,13 @@ namespace FIFE {
 		m_zone(NULL),
 		m_transition(NULL),
 		m_inserted(false),
-		m_protect(false) {
+		m_protect(false),
+		m_type(CTYPE_NO_BLOCKER) {
+		MemoryTracker::instance()->add(MEMORY_CELLS, sizeof(Cell));
 	}
 
 	Cell::~Cell() {
+		MemoryTracker::instance()->remove(MEMORY_CELLS, sizeof(Cell));
 		// calls CellDeleteListener, e.g. for transition
 		if (!m_deleteListeners.empty()) {
 			std::vector<CellDeleteListener*>::iterator it = m_deleteListeners.begin();
@@ -28,6 +28,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "model/metamodel/grids/cellgrid.h"
+#include "model/metamodel/grids/gridkernels.h"
 #include "util/log/logger.h"
 #include "util/structures/purge.h"
 
@@ -218,6 +219,45 @@ namespace FIFE {
 			}
 		}
 
+		virtual void onInstancesCreate(Layer* layer, std::vector<Instance*>& instances) {
+			CellCache* cache = m_layer->getCellCache();
+			std::vector<ModelCoordinate> coordinates;
+			coordinates.reserve(instances.size());
+			// the cache is resized only once for the whole batch
+			bool resize = false;
+			Location loc(m_layer);
+			std::vector<Instance*>::iterator it = instances.begin();
+			for (; it != instances.end(); ++it) {
+				ModelCoordinate mc;
+				if (m_layer == layer) {
+					mc = (*it)->getLocationRef().getLayerCoordinates();
+				} else {
+					mc = m_layer->getCellGrid()->toLayerCoordinates(
+						layer->getCellGrid()->toMapCoordinates((*it)->getLocationRef().getExactLayerCoordinatesRef()));
+				}
+				coordinates.push_back(mc);
+				if (!resize) {
+					loc.setLayerCoordinates(mc);
+					resize = !cache->isInCellCache(loc);
+				}
+			}
+			if (resize) {
+				cache->resize();
+			}
+
+			for (uint32_t i = 0; i < instances.size(); ++i) {
+				// multi cell instances can grow the cache again, they take the slow path
+				if (instances[i]->isMultiCell()) {
+					onInstanceCreate(layer, instances[i]);
+					continue;
+				}
+				Cell* cell = cache->getCell(coordinates[i]);
+				if (cell) {
+					cell->addInstance(instances[i]);
+				}
+			}
+		}
+
 		virtual void onInstanceDelete(Layer* layer, Instance* instance)	{
 			ModelCoordinate mc;
 			if (m_layer == layer) {
@@ -555,27 +595,43 @@ namespace FIFE {
 			m_width = w;
 			m_height = h;
 
-			bool zCheck = m_neighborZ != -1;
 			// fill neighbors into cells
-			it = m_cells.begin();
-			for (; it != m_cells.end(); ++it) {
-				std::vector<Cell*>::iterator cit = (*it).begin();
-				for (; cit != (*it).end(); ++cit) {
-					int32_t cellZ = (*cit)->getLayerCoordinates().z;
-					std::vector<ModelCoordinate> coordinates;
-					m_layer->getCellGrid()->getAccessibleCoordinates((*cit)->getLayerCoordinates(), coordinates);
-					for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
-						Cell* c = getCell(*mi);
-						if (*cit == c || !c) {
+			CellGrid* grid = m_layer->getCellGrid();
+			switch (getGridKernelType(grid)) {
+				case GRID_KERNEL_SQUARE:
+					updateNeighbors(SquareGridKernel(grid));
+					break;
+				case GRID_KERNEL_HEX:
+					updateNeighbors(HexGridKernel(grid));
+					break;
+				default:
+					updateNeighbors(GenericGridKernel(grid));
+					break;
+			}
+		}
+	}
+
+	template<typename Kernel>
+	void CellCache::updateNeighbors(const Kernel& kernel) {
+		bool zCheck = m_neighborZ != -1;
+		std::vector<ModelCoordinate> coordinates;
+		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
+		for (; it != m_cells.end(); ++it) {
+			std::vector<Cell*>::iterator cit = (*it).begin();
+			for (; cit != (*it).end(); ++cit) {
+				int32_t cellZ = (*cit)->getLayerCoordinates().z;
+				getAccessibleCoordinates(kernel, (*cit)->getLayerCoordinates(), coordinates);
+				for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
+					Cell* c = getCell(*mi);
+					if (*cit == c || !c) {
+						continue;
+					}
+					if (zCheck) {
+						if (ABS(c->getLayerCoordinates().z - cellZ) > m_neighborZ) {
 							continue;
 						}
-						if (zCheck) {
-							if (ABS(c->getLayerCoordinates().z - cellZ) > m_neighborZ) {
-								continue;
-							}
-						}
-						(*cit)->addNeighbor(c);
 					}
+					(*cit)->addNeighbor(c);
 				}
 			}
 		}
@@ -617,33 +673,20 @@ namespace FIFE {
 			}
 		}
 		// fill neighbors into cells
-		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
-		for (; it != m_cells.end(); ++it) {
-			std::vector<Cell*>::iterator cit = (*it).begin();
-			for (; cit != (*it).end(); ++cit) {
-				uint8_t accessible = 0;
-				bool selfblocker = (*cit)->getCellType() == CTYPE_STATIC_BLOCKER || (*cit)->getCellType() == CTYPE_CELL_BLOCKER;
-				std::vector<ModelCoordinate> coordinates;
-				m_layer->getCellGrid()->getAccessibleCoordinates((*cit)->getLayerCoordinates(), coordinates);
-				for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
-					Cell* c = getCell(*mi);
-					if (*cit == c || !c) {
-						continue;
-					}
-					if (!selfblocker && c->getCellType() != CTYPE_STATIC_BLOCKER &&
-						c->getCellType() != CTYPE_CELL_BLOCKER) {
-						++accessible;
-					}
-					(*cit)->addNeighbor(c);
-				}
-				// add cell to narrow cells and add listener for zone change
-				if (m_searchNarrow && !selfblocker && accessible < 3) {
-					addNarrowCell(*cit);
-				}
-			}
+		CellGrid* grid = m_layer->getCellGrid();
+		switch (getGridKernelType(grid)) {
+			case GRID_KERNEL_SQUARE:
+				createNeighbors(SquareGridKernel(grid));
+				break;
+			case GRID_KERNEL_HEX:
+				createNeighbors(HexGridKernel(grid));
+				break;
+			default:
+				createNeighbors(GenericGridKernel(grid));
+				break;
 		}
 		// create Zones
-		it = m_cells.begin();
+		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
 		for (; it != m_cells.end(); ++it) {
 			std::vector<Cell*>::iterator cit = (*it).begin();
 			for (; cit != (*it).end(); ++cit) {
@@ -677,6 +720,35 @@ namespace FIFE {
 		}
 	}
 
+	template<typename Kernel>
+	void CellCache::createNeighbors(const Kernel& kernel) {
+		std::vector<ModelCoordinate> coordinates;
+		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
+		for (; it != m_cells.end(); ++it) {
+			std::vector<Cell*>::iterator cit = (*it).begin();
+			for (; cit != (*it).end(); ++cit) {
+				uint8_t accessible = 0;
+				bool selfblocker = (*cit)->getCellType() == CTYPE_STATIC_BLOCKER || (*cit)->getCellType() == CTYPE_CELL_BLOCKER;
+				getAccessibleCoordinates(kernel, (*cit)->getLayerCoordinates(), coordinates);
+				for (std::vector<ModelCoordinate>::iterator mi = coordinates.begin(); mi != coordinates.end(); ++mi) {
+					Cell* c = getCell(*mi);
+					if (*cit == c || !c) {
+						continue;
+					}
+					if (!selfblocker && c->getCellType() != CTYPE_STATIC_BLOCKER &&
+						c->getCellType() != CTYPE_CELL_BLOCKER) {
+						++accessible;
+					}
+					(*cit)->addNeighbor(c);
+				}
+				// add cell to narrow cells and add listener for zone change
+				if (m_searchNarrow && !selfblocker && accessible < 3) {
+					addNarrowCell(*cit);
+				}
+			}
+		}
+	}
+
 	void CellCache::forceUpdate() {
 		std::vector<std::vector<Cell*> >::iterator it = m_cells.begin();
 		for (; it != m_cells.end(); ++it) {
@@ -980,33 +1052,38 @@ namespace FIFE {
 		return cells;
 	}
 
-	void CellCache::registerCost(const std::string& costId, double cost) {
-		std::pair<std::map<std::string, double>::iterator, bool> insertiter;
-		insertiter = m_costsTable.insert(std::pair<std::string, double>(costId, cost));
+	void CellCache::registerCost(const Atom& costId, double cost) {
+		std::pair<std::map<Atom, double>::iterator, bool> insertiter;
+		insertiter = m_costsTable.insert(std::pair<Atom, double>(costId, cost));
 		if (insertiter.second == false) {
 			double& old_cost = insertiter.first->second;
 			old_cost = cost;
 		}
 	}
 
-	void CellCache::unregisterCost(const std::string& costId) {
-		std::map<std::string, double>::iterator it = m_costsTable.find(costId);
+	void CellCache::unregisterCost(const Atom& costId) {
+		std::map<Atom, double>::iterator it = m_costsTable.find(costId);
 		if (it != m_costsTable.end()) {
 			m_costsTable.erase(it);
-			m_costsToCells.erase(costId);
+			AtomCellIterator first = m_costsToCells.lower_bound(AtomCell(costId, NULL));
+			AtomCellIterator last = first;
+			while (last != m_costsToCells.end() && (*last).first == costId) {
+				++last;
+			}
+			m_costsToCells.erase(first, last);
 		}
 	}
 
-	double CellCache::getCost(const std::string& costId) {
-		std::map<std::string, double>::iterator it = m_costsTable.find(costId);
+	double CellCache::getCost(const Atom& costId) {
+		std::map<Atom, double>::iterator it = m_costsTable.find(costId);
 		if (it != m_costsTable.end()) {
 			return it->second;
 		}
 		return 0.0;
 	}
 
-	bool CellCache::existsCost(const std::string& costId) {
-		std::map<std::string, double>::iterator it = m_costsTable.find(costId);
+	bool CellCache::existsCost(const Atom& costId) {
+		std::map<Atom, double>::iterator it = m_costsTable.find(costId);
 		if (it != m_costsTable.end()) {
 			return true;
 		}
@@ -1015,10 +1092,12 @@ namespace FIFE {
 
 	std::list<std::string> CellCache::getCosts() {
 		std::list<std::string> costs;
-		std::map<std::string, double>::iterator it = m_costsTable.begin();
+		std::map<Atom, double>::iterator it = m_costsTable.begin();
 		for (; it != m_costsTable.end(); ++it) {
-			costs.push_back((*it).first);
+			costs.push_back((*it).first.str());
 		}
+		// atoms are ordered by address, sort the ids alphabetically
+		costs.sort();
 		return costs;
 	}
 
@@ -1027,20 +1106,13 @@ namespace FIFE {
 		m_costsToCells.clear();
 	}
 
-	void CellCache::addCellToCost(const std::string& costId, Cell* cell) {
+	void CellCache::addCellToCost(const Atom& costId, Cell* cell) {
 		if (existsCost(costId)) {
-			StringCellPair result = m_costsToCells.equal_range(costId);
-			StringCellIterator it = result.first;
-			for (; it != result.second; ++it) {
-				if ((*it).second == cell) {
-					return;
-				}
-			}
-			m_costsToCells.insert(std::pair<std::string, Cell*>(costId, cell));
+			m_costsToCells.insert(AtomCell(costId, cell));
 		}
 	}
 
-	void CellCache::addCellsToCost(const std::string& costId, const std::vector<Cell*>& cells) {
+	void CellCache::addCellsToCost(const Atom& costId, const std::vector<Cell*>& cells) {
 		std::vector<Cell*>::const_iterator it = cells.begin();
 		for (; it != cells.end(); ++it) {
 			addCellToCost(costId, *it);
@@ -1048,7 +1120,7 @@ namespace FIFE {
 	}
 
 	void CellCache::removeCellFromCost(Cell* cell) {
-		StringCellIterator it = m_costsToCells.begin();
+		AtomCellIterator it = m_costsToCells.begin();
 		for (; it != m_costsToCells.end();) {
 			if ((*it).second == cell) {
 				m_costsToCells.erase(it++);
@@ -1058,29 +1130,21 @@ namespace FIFE {
 		}
 	}
 
-	void CellCache::removeCellFromCost(const std::string& costId, Cell* cell) {
-		StringCellPair result = m_costsToCells.equal_range(costId);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
-			if ((*it).second == cell) {
-				m_costsToCells.erase(it);
-				break;
-			}
-		}
+	void CellCache::removeCellFromCost(const Atom& costId, Cell* cell) {
+		m_costsToCells.erase(AtomCell(costId, cell));
 	}
 
-	void CellCache::removeCellsFromCost(const std::string& costId, const std::vector<Cell*>& cells) {
+	void CellCache::removeCellsFromCost(const Atom& costId, const std::vector<Cell*>& cells) {
 		std::vector<Cell*>::const_iterator it = cells.begin();
 		for (; it != cells.end(); ++it) {
 			removeCellFromCost(costId, *it);
 		}
 	}
 
-	std::vector<Cell*> CellCache::getCostCells(const std::string& costId) {
+	std::vector<Cell*> CellCache::getCostCells(const Atom& costId) {
 		std::vector<Cell*> cells;
-		StringCellPair result = m_costsToCells.equal_range(costId);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
+		AtomCellIterator it = m_costsToCells.lower_bound(AtomCell(costId, NULL));
+		for (; it != m_costsToCells.end() && (*it).first == costId; ++it) {
 			cells.push_back((*it).second);
 		}
 		return cells;
@@ -1088,56 +1152,52 @@ namespace FIFE {
 
 	std::vector<std::string> CellCache::getCellCosts(Cell* cell) {
 		std::vector<std::string> costs;
-		StringCellIterator it = m_costsToCells.begin();
+		AtomCellIterator it = m_costsToCells.begin();
 		for (; it != m_costsToCells.end(); ++it) {
 			if ((*it).second == cell) {
-				costs.push_back((*it).first);
+				costs.push_back((*it).first.str());
 			}
 		}
+		std::sort(costs.begin(), costs.end());
 		return costs;
 	}
 
-	bool CellCache::existsCostForCell(const std::string& costId, Cell* cell) {
-		StringCellPair result = m_costsToCells.equal_range(costId);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
-			if ((*it).second == cell) {
-				return true;
-			}
-		}
-		return false;
+	bool CellCache::existsCostForCell(const Atom& costId, Cell* cell) {
+		return m_costsToCells.find(AtomCell(costId, cell)) != m_costsToCells.end();
 	}
 
 	double CellCache::getAdjacentCost(const ModelCoordinate& adjacent, const ModelCoordinate& next) {
 		double cost = m_layer->getCellGrid()->getAdjacentCost(adjacent, next);
 		Cell* nextcell = getCell(next);
 		if (nextcell) {
-			if (!nextcell->defaultCost()) {
-				cost *= nextcell->getCostMultiplier();
-			} else {
-				cost *= m_defaultCostMulti;
-			}
+			cost *= getAdjacentCostMultiplier(nextcell);
 		}
 		return cost;
 	}
 
-	double CellCache::getAdjacentCost(const ModelCoordinate& adjacent, const ModelCoordinate& next, const std::string& costId) {
+	double CellCache::getAdjacentCost(const ModelCoordinate& adjacent, const ModelCoordinate& next, const Atom& costId) {
 		double cost = m_layer->getCellGrid()->getAdjacentCost(adjacent, next);
 		Cell* nextcell = getCell(next);
 		if (nextcell) {
-			if (existsCostForCell(costId, nextcell)) {
-				cost *= getCost(costId);
-			} else {
-				if (!nextcell->defaultCost()) {
-					cost *= nextcell->getCostMultiplier();
-				} else {
-					cost *= m_defaultCostMulti;
-				}
-			}
+			cost *= getAdjacentCostMultiplier(nextcell, costId);
 		}
 		return cost;
 	}
 
+	double CellCache::getAdjacentCostMultiplier(Cell* next) {
+		if (!next->defaultCost()) {
+			return next->getCostMultiplier();
+		}
+		return m_defaultCostMulti;
+	}
+
+	double CellCache::getAdjacentCostMultiplier(Cell* next, const Atom& costId) {
+		if (existsCostForCell(costId, next)) {
+			return getCost(costId);
+		}
+		return getAdjacentCostMultiplier(next);
+	}
+
 	bool CellCache::getCellSpeedMultiplier(const ModelCoordinate& cell, double& multiplier) {
 		Cell* nextcell = getCell(cell);
 		if (nextcell) {
@@ -1402,11 +1462,11 @@ namespace FIFE {
 		m_searchNarrow = search;
 	}
 
-	void CellCache::addCellToArea(const std::string& id, Cell* cell) {
-		m_cellAreas.insert(std::pair<std::string, Cell*>(id, cell));
+	void CellCache::addCellToArea(const Atom& id, Cell* cell) {
+		m_cellAreas.insert(AtomCell(id, cell));
 	}
 
-	void CellCache::addCellsToArea(const std::string& id, const std::vector<Cell*>& cells) {
+	void CellCache::addCellsToArea(const Atom& id, const std::vector<Cell*>& cells) {
 		std::vector<Cell*>::const_iterator it = cells.begin();
 		for (; it != cells.end(); ++it) {
 			addCellToArea(id, *it);
@@ -1414,7 +1474,7 @@ namespace FIFE {
 	}
 
 	void CellCache::removeCellFromArea(Cell* cell) {
-		StringCellIterator it = m_cellAreas.begin();
+		AtomCellIterator it = m_cellAreas.begin();
 		while (it != m_cellAreas.end()) {
 			if ((*it).second == cell) {
 				m_cellAreas.erase(it++);
@@ -1424,31 +1484,29 @@ namespace FIFE {
 		}
 	}
 
-	void CellCache::removeCellFromArea(const std::string& id, Cell* cell) {
-		StringCellPair result = m_cellAreas.equal_range(id);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
-			if ((*it).second == cell) {
-				m_cellAreas.erase(it);
-				break;
-			}
-		}
+	void CellCache::removeCellFromArea(const Atom& id, Cell* cell) {
+		m_cellAreas.erase(AtomCell(id, cell));
 	}
 
-	void CellCache::removeCellsFromArea(const std::string& id, const std::vector<Cell*>& cells) {
+	void CellCache::removeCellsFromArea(const Atom& id, const std::vector<Cell*>& cells) {
 		std::vector<Cell*>::const_iterator it = cells.begin();
 		for (; it != cells.end(); ++it) {
 			removeCellFromArea(id, *it);
 		}
 	}
 
-	void CellCache::removeArea(const std::string& id) {
-		m_cellAreas.erase(id);
+	void CellCache::removeArea(const Atom& id) {
+		AtomCellIterator first = m_cellAreas.lower_bound(AtomCell(id, NULL));
+		AtomCellIterator last = first;
+		while (last != m_cellAreas.end() && (*last).first == id) {
+			++last;
+		}
+		m_cellAreas.erase(first, last);
 	}
 
-	bool CellCache::existsArea(const std::string& id) {
-		StringCellIterator it = m_cellAreas.find(id);
-		if (it == m_cellAreas.end()) {
+	bool CellCache::existsArea(const Atom& id) {
+		AtomCellIterator it = m_cellAreas.lower_bound(AtomCell(id, NULL));
+		if (it == m_cellAreas.end() || (*it).first != id) {
 			return false;
 		}
 		return true;
@@ -1456,47 +1514,42 @@ namespace FIFE {
 
 	std::vector<std::string> CellCache::getAreas() {
 		std::vector<std::string> areas;
-		std::string last("");
-		StringCellIterator it = m_cellAreas.begin();
+		Atom last;
+		AtomCellIterator it = m_cellAreas.begin();
 		for (; it != m_cellAreas.end(); ++it) {
 			if (last != (*it).first) {
 				last = (*it).first;
-				areas.push_back(last);
+				areas.push_back(last.str());
 			}
 		}
+		// atoms are ordered by address, sort the ids alphabetically
+		std::sort(areas.begin(), areas.end());
 		return areas;
 	}
 
 	std::vector<std::string> CellCache::getCellAreas(Cell* cell) {
 		std::vector<std::string> areas;
-		StringCellIterator it = m_cellAreas.begin();
+		AtomCellIterator it = m_cellAreas.begin();
 		for (; it != m_cellAreas.end(); ++it) {
 			if ((*it).second == cell) {
-				areas.push_back((*it).first);
+				areas.push_back((*it).first.str());
 			}
 		}
+		std::sort(areas.begin(), areas.end());
 		return areas;
 	}
 
-	std::vector<Cell*> CellCache::getAreaCells(const std::string& id) {
+	std::vector<Cell*> CellCache::getAreaCells(const Atom& id) {
 		std::vector<Cell*> cells;
-		StringCellPair result = m_cellAreas.equal_range(id);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
+		AtomCellIterator it = m_cellAreas.lower_bound(AtomCell(id, NULL));
+		for (; it != m_cellAreas.end() && (*it).first == id; ++it) {
 			cells.push_back((*it).second);
 		}
 		return cells;
 	}
 
-	bool CellCache::isCellInArea(const std::string& id, Cell* cell) {
-		StringCellPair result = m_cellAreas.equal_range(id);
-		StringCellIterator it = result.first;
-		for (; it != result.second; ++it) {
-			if ((*it).second == cell) {
-				return true;
-			}
-		}
-		return false;
+	bool CellCache::isCellInArea(const Atom& id, Cell* cell) {
+		return m_cellAreas.find(AtomCell(id, cell)) != m_cellAreas.end();
 	}
 
 	Rect CellCache::calculateCurrentSize() {
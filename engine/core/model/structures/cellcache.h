@@ -35,6 +35,7 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/atom.h"
 #include "util/base/fifeclass.h"
 #include "util/structures/rect.h"
 #include "model/metamodel/modelcoords.h"
@@ -285,23 +286,23 @@ namespace FIFE {
 			 * @param costId A const reference to a string that refs to the cost id.
 			 * @param cost A double that contains the cost value. Used as multiplier for default cost.
 			 */
-			void registerCost(const std::string& costId, double cost);
+			void registerCost(const Atom& costId, double cost);
 
 			/** Removes a cost with the given id.
 			 * @param costId A const reference to a string that refs to the cost id.
 			 */
-			void unregisterCost(const std::string& costId);
+			void unregisterCost(const Atom& costId);
 
 			/** Returns the cost value for the given id.
 			 * @param costId A const reference to a string that refs to the cost id.
 			 * @return cost value as a double, if cost id can not be found 1.0 is returned.
 			 */
-			double getCost(const std::string& costId);
+			double getCost(const Atom& costId);
 
 			/** Returns if the cost for the given id exists.
 			 * @return True if cost id could be found otherwise false.
 			 */
-			bool existsCost(const std::string& costId);
+			bool existsCost(const Atom& costId);
 
 			/** Returns all registered cost ids.
 			 * @return A list that contains the cost ids.
@@ -316,13 +317,13 @@ namespace FIFE {
 			 * @param costId A const reference to the cost identifier.
 			 * @param cell A pointer to the cell.
 			 */
-			void addCellToCost(const std::string& costId, Cell* cell);
+			void addCellToCost(const Atom& costId, Cell* cell);
 
 			/** Assigns cells to a cost identifier.
 			 * @param costId A const reference to the cost identifier.
 			 * @param cells A const reference to a vector which contains the cells.
 			 */
-			void addCellsToCost(const std::string& costId, const std::vector<Cell*>& cells);
+			void addCellsToCost(const Atom& costId, const std::vector<Cell*>& cells);
 
 			/** Removes a cell from costs.
 			 * @param cell A pointer to the cell.
@@ -333,19 +334,19 @@ namespace FIFE {
 			 * @param costId A const reference to the cost identifier.
 			 * @param cell A pointer to the cell.
 			 */
-			void removeCellFromCost(const std::string& costId, Cell* cell);
+			void removeCellFromCost(const Atom& costId, Cell* cell);
 
 			/** Removes cells from a cost identifier.
 			 * @param costId A const reference to the cost identifier.
 			 * @param cells A const reference to a vector which contains the cells.
 			 */
-			void removeCellsFromCost(const std::string& costId, const std::vector<Cell*>& cells);
+			void removeCellsFromCost(const Atom& costId, const std::vector<Cell*>& cells);
 
 			/** Returns cells for a cost identifier.
 			 * @param costId A const reference to the cost identifier.
 			 * @return A vector which contains the cells.
 			 */
-			std::vector<Cell*> getCostCells(const std::string& costId);
+			std::vector<Cell*> getCostCells(const Atom& costId);
 
 			/** Returns cost identifiers for cell.
 			 * @param cell A pointer to the cell.
@@ -358,7 +359,7 @@ namespace FIFE {
 			 * @param cell A pointer to the cell.
 			 * @return A boolean, true if the cell is assigned to the cost identifier, otherwise false.
 			 */
-			bool existsCostForCell(const std::string& costId, Cell* cell);
+			bool existsCostForCell(const Atom& costId, Cell* cell);
 
 			/** Returns cost for movement between these two adjacent coordinates.
 			 * @param adjacent A const reference to the start ModelCoordinate.
@@ -373,7 +374,20 @@ namespace FIFE {
 			 * @param costId A const reference to the string that contain a cost identifier.
 			 * @return A double which represents the cost.
 			 */
-			double getAdjacentCost(const ModelCoordinate& adjacent, const ModelCoordinate& next, const std::string& costId);
+			double getAdjacentCost(const ModelCoordinate& adjacent, const ModelCoordinate& next, const Atom& costId);
+
+			/** Returns the multiplier getAdjacentCost applies to movement into the given cell.
+			 * @param next A pointer to the end cell.
+			 * @return A double which represents the multiplier.
+			 */
+			double getAdjacentCostMultiplier(Cell* next);
+
+			/** Returns the multiplier getAdjacentCost applies to movement into the given cell.
+			 * @param next A pointer to the end cell.
+			 * @param costId A const reference to the string that contain a cost identifier.
+			 * @return A double which represents the multiplier.
+			 */
+			double getAdjacentCostMultiplier(Cell* next, const Atom& costId);
 
 			/** Returns speed value from cell.
 			 * @param cell A const reference to the cell ModelCoordinate.
@@ -532,14 +546,14 @@ namespace FIFE {
 			 * @param id A const reference to string that contains the area id.
 			 * @param cell A pointer to the cell which should be added.
 			 */
-			void addCellToArea(const std::string& id, Cell* cell);
+			void addCellToArea(const Atom& id, Cell* cell);
 
 			/** Adds few cell to a specific area group. With an area you can group cells without the need
 			 *	of checking the underlying instances or similar.
 			 * @param id A const reference to string that contains the area id.
 			 * @param cells A const reference to vector which contains the cells.
 			 */
-			void addCellsToArea(const std::string& id, const std::vector<Cell*>& cells);
+			void addCellsToArea(const Atom& id, const std::vector<Cell*>& cells);
 
 			/** Removes the cell from all areas.
 			 * @param cell A pointer to the cell which should be removed.
@@ -550,24 +564,24 @@ namespace FIFE {
 			 * @param id A const reference to string that contains the area id.
 			 * @param cell A pointer to the cell which should be removed.
 			 */
-			void removeCellFromArea(const std::string& id, Cell* cell);
+			void removeCellFromArea(const Atom& id, Cell* cell);
 
 			/** Removes few cells from a area.
 			 * @param id A const reference to string that contains the area id.
 			 * @param cells A const reference to vector which contains the cells.
 			 */
-			void removeCellsFromArea(const std::string& id, const std::vector<Cell*>& cells);
+			void removeCellsFromArea(const Atom& id, const std::vector<Cell*>& cells);
 
 			/** Removes a area.
 			 * @param id A const reference to string that contains the area id.
 			 */
-			void removeArea(const std::string& id);
+			void removeArea(const Atom& id);
 
 			/** Checks whether the area exists.
 			 * @param id A const reference to string that contains the area id.
 			 * @return A boolean, true if the area id exists, otherwise false.
 			 */
-			bool existsArea(const std::string& id);
+			bool existsArea(const Atom& id);
 
 			/** Returns all area ids.
 			 * @return A vector that contains the area ids.
@@ -584,14 +598,14 @@ namespace FIFE {
 			 * @param id A const reference to string that contains the area id.
 			 * @return A vector that contains the cells from the area.
 			 */
-			std::vector<Cell*> getAreaCells(const std::string& id);
+			std::vector<Cell*> getAreaCells(const Atom& id);
 
 			/** Returns true if cell is part of the area, otherwise false.
 			 * @param id A const reference to string that contains the area id.
 			 * @param cell A pointer to the cell which is used for the check.
 			 * @return A boolean, true if the cell is part of the area, otherwise false.
 			*/
-			bool isCellInArea(const std::string& id, Cell* cell);
+			bool isCellInArea(const Atom& id, Cell* cell);
 
 			/** Sets the cache size to static so that automatic resize is disabled.
 			 * @param staticSize A boolean, true if the cache size is static, otherwise false.
@@ -607,14 +621,28 @@ namespace FIFE {
 			void setSizeUpdate(bool update);
 			void update();
 		private:
-			typedef std::multimap<std::string, Cell*> StringCellMultimap;
-			typedef StringCellMultimap::iterator StringCellIterator;
-			typedef std::pair<StringCellIterator, StringCellIterator> StringCellPair;
+			// sorted by id and cell, so the cells of an id are adjacent and single
+			// cells can be looked up without walking all cells of the id
+			typedef std::pair<Atom, Cell*> AtomCell;
+			typedef std::set<AtomCell> AtomCellSet;
+			typedef AtomCellSet::iterator AtomCellIterator;
 
 			/** Returns the current size.
 			 * @return A rect that contains the min, max coordinates.
 			 */
 			Rect calculateCurrentSize();
+
+			/** Fills the neighbors of all cells, used after a resize.
+			 * @param kernel The grid kernel of the layer grid.
+			 */
+			template<typename Kernel>
+			void updateNeighbors(const Kernel& kernel);
+
+			/** Fills the neighbors of all cells and collects the narrow cells.
+			 * @param kernel The grid kernel of the layer grid.
+			 */
+			template<typename Kernel>
+			void createNeighbors(const Kernel& kernel);
 			
 			//! walkable layer
 			Layer* m_layer;
@@ -666,16 +694,16 @@ namespace FIFE {
 			std::set<Cell*> m_narrowCells;
 
 			//! areas with assigned cells
-			StringCellMultimap m_cellAreas;
+			AtomCellSet m_cellAreas;
 
 			//! listener for zones
 			CellChangeListener* m_cellZoneListener;
 
 			//! holds cost table
-			std::map<std::string, double> m_costsTable;
+			std::map<Atom, double> m_costsTable;
 
 			//! holds cells for each cost
-			StringCellMultimap m_costsToCells;
+			AtomCellSet m_costsToCells;
 
 			//! holds default cost multiplier, only if it is not default(1.0)
 			std::map<Cell*, double> m_costMultipliers;
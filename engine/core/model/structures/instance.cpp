@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 #include <iostream>
 
 // 3rd party library includes
@@ -32,6 +33,7 @@
 #include "audio/soundsource.h"
 #include "util/log/logger.h"
 #include "util/base/exception.h"
+#include "util/base/memorytracker.h"
 #include "util/math/fife_math.h"
 #include "util/time/timemanager.h"
 #include "model/metamodel/grids/cellgrid.h"
@@ -75,6 +77,9 @@ namespace FIFE {
 			delete m_target;
 		}
 
+		static void* operator new(std::size_t size) { return ObjectPool<ActionInfo>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<ActionInfo>::deallocate(ptr, size); }
+
 		// Current action, owned by object
 		Action* m_action;
 		// target location for ongoing movement
@@ -105,6 +110,9 @@ namespace FIFE {
 			m_duration(duration),
 			m_start_time(0) {}
 
+		static void* operator new(std::size_t size) { return ObjectPool<SayInfo>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<SayInfo>::deallocate(ptr, size); }
+
 		std::string m_txt;
 		uint32_t m_duration;
 		uint32_t m_start_time;
@@ -126,7 +134,8 @@ namespace FIFE {
 		m_sayInfo(NULL),
 		m_timeProvider(NULL),
 		m_blocking(source.m_blocking),
-		m_additional(ICHANGE_NO_CHANGES) {
+		m_additional(ICHANGE_NO_CHANGES),
+		m_preparedInfo(NULL) {
 	}
 
 	Instance::InstanceActivity::~InstanceActivity() {
@@ -136,6 +145,34 @@ namespace FIFE {
 		delete m_soundSource;
 	}
 
+	void Instance::InstanceActivity::release() {
+		delete m_actionInfo;
+		m_actionInfo = NULL;
+		delete m_sayInfo;
+		m_sayInfo = NULL;
+		delete m_timeProvider;
+		m_timeProvider = NULL;
+		delete m_soundSource;
+		m_soundSource = NULL;
+	}
+
+	void Instance::InstanceActivity::reset(Instance& source) {
+		release();
+		m_location = source.m_location;
+		m_oldLocation = source.m_location;
+		m_rotation = source.m_rotation;
+		m_oldRotation = source.m_rotation;
+		m_action = NULL;
+		m_speed = 0;
+		m_timeMultiplier = 1.0;
+		m_sayText.clear();
+		m_changeListeners.clear();
+		m_actionListeners.clear();
+		m_blocking = source.m_blocking;
+		m_additional = ICHANGE_NO_CHANGES;
+		m_preparedInfo = NULL;
+	}
+
 	void Instance::InstanceActivity::update(Instance& source) {
 		source.m_changeInfo = ICHANGE_NO_CHANGES;
 		if (m_additional != ICHANGE_NO_CHANGES) {
@@ -198,6 +235,7 @@ namespace FIFE {
 		m_id(identifier),
 		m_rotation(0),
 		m_activity(NULL),
+		m_idleActivity(NULL),
 		m_changeInfo(ICHANGE_NO_CHANGES),
 		m_object(object),
 		m_ownObject(false),
@@ -209,7 +247,11 @@ namespace FIFE {
 		m_specialCost(object->isSpecialCost()),
 		m_cost(object->getCost()),
 		m_costId(object->getCostId()),
-		m_mainMultiInstance(NULL) {
+		m_mainMultiInstance(NULL),
+		m_activeIndex(-1),
+		m_spatialBucket(NULL),
+		m_spatialIndex(-1) {
+		MemoryTracker::instance()->add(MEMORY_INSTANCES, sizeof(Instance));
 		// create multi object instances
 		if (object->isMultiObject()) {
 			m_mainMultiInstance = this;
@@ -239,6 +281,7 @@ namespace FIFE {
 	}
 
 	Instance::~Instance() {
+		MemoryTracker::instance()->remove(MEMORY_INSTANCES, sizeof(Instance));
 		std::vector<InstanceDeleteListener *>::iterator itor;
 		for(itor = m_deleteListeners.begin(); itor != m_deleteListeners.end(); ++itor) {
 			if (*itor != NULL) {
@@ -262,6 +305,7 @@ namespace FIFE {
 		}
 
 		delete m_activity;
+		delete m_idleActivity;
 		delete m_visual;
 		if (m_ownObject) {
 			delete m_object;
@@ -270,7 +314,13 @@ namespace FIFE {
 
 	void Instance::initializeChanges() {
 		if (!m_activity) {
-			m_activity = new InstanceActivity(*this);
+			if (m_idleActivity) {
+				m_activity = m_idleActivity;
+				m_idleActivity = NULL;
+				m_activity->reset(*this);
+			} else {
+				m_activity = new InstanceActivity(*this);
+			}
 		}
 		if (m_location.getLayer()) {
 			m_location.getLayer()->setInstanceActivityStatus(this, true);
@@ -289,10 +339,54 @@ namespace FIFE {
 		return (m_activity != 0);
 	}
 
+	/** Converts a delay in game time of an instance to the time of its map,
+	 * rounded down, so that the instance is never updated late.
+	 */
+	static uint32_t toMapDelay(uint32_t delay, float multiplier) {
+		if (delay <= 1) {
+			return 0;
+		}
+		return static_cast<uint32_t>(static_cast<float>(delay - 1) / multiplier);
+	}
+
+	uint32_t Instance::getUpdateDelay(uint32_t interval) const {
+		if (!m_activity || !m_activity->m_timeProvider) {
+			return 0;
+		}
+		// the pather can't catch up with skipped movement
+		ActionInfo* info = m_activity->m_actionInfo;
+		if (info && info->m_target) {
+			return 0;
+		}
+		// a stopped instance only changes from outside
+		float multiplier = m_activity->m_timeProvider->getMultiplier();
+		if (multiplier <= 0.0) {
+			return interval;
+		}
+		uint32_t now = m_activity->m_timeProvider->getGameTime();
+		uint32_t delay = interval;
+		if (info && !info->m_repeating) {
+			uint32_t end = info->m_action_start_time + info->m_action->getDuration();
+			end = end > info->m_action_offset_time ? end - info->m_action_offset_time : 0;
+			delay = std::min(delay, end > now ? toMapDelay(end - now, multiplier) : 0);
+		}
+		SayInfo* sayInfo = m_activity->m_sayInfo;
+		if (sayInfo && sayInfo->m_duration > 0) {
+			uint32_t end = sayInfo->m_start_time + sayInfo->m_duration;
+			delay = std::min(delay, end > now ? toMapDelay(end - now, multiplier) : 0);
+		}
+		return delay;
+	}
+
 	Object* Instance::getObject() {
 		return m_object;
 	}
 
+	Object* Instance::getBaseObject() {
+		// the own object inherits from the original one
+		return m_ownObject ? m_object->getInherited() : m_object;
+	}
+
 	void Instance::setLocation(const Location& loc) {
 		// ToDo: Handle the case when the layers are different
 		if(m_location != loc) {
@@ -412,7 +506,7 @@ namespace FIFE {
 		FL_WARN(_log, "Cannot remove unknown listener");
 	}
 
-	void Instance::initializeAction(const std::string& actionName) {
+	void Instance::initializeAction(const Atom& actionName) {
 		assert(m_object);
 
 		initializeChanges();
@@ -425,7 +519,7 @@ namespace FIFE {
 		if (!m_activity->m_actionInfo->m_action) {
 			delete m_activity->m_actionInfo;
 			m_activity->m_actionInfo = NULL;
-			throw NotFound(std::string("action ") + actionName + " not found");
+			throw NotFound(std::string("action ") + actionName.str() + " not found");
 		}
 		m_activity->m_actionInfo->m_prev_call_time = getRuntime();
 		if (m_activity->m_actionInfo->m_action != old_action) {
@@ -449,7 +543,7 @@ namespace FIFE {
 		}
 	}
 
-	void Instance::move(const std::string& actionName, const Location& target, const double speed, const std::string& costId) {
+	void Instance::move(const Atom& actionName, const Location& target, const double speed, const std::string& costId) {
 		// if new move is identical with the old then return
 		if (m_activity) {
 			if (m_activity->m_actionInfo) {
@@ -491,7 +585,7 @@ namespace FIFE {
 		}
 	}
 
-	void Instance::follow(const std::string& actionName, Instance* leader, const double speed) {
+	void Instance::follow(const Atom& actionName, Instance* leader, const double speed) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_target = new Location(leader->getLocationRef());
 		m_activity->m_actionInfo->m_speed = speed;
@@ -500,7 +594,7 @@ namespace FIFE {
 		FL_DBG(_log, LMsg("starting action ") <<  actionName << " from" << m_location << " to " << *m_activity->m_actionInfo->m_target << " with speed " << speed);
 	}
 
-	void Instance::follow(const std::string& actionName, Route* route, const double speed) {
+	void Instance::follow(const Atom& actionName, Route* route, const double speed) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_target = new Location(route->getEndNode());
 		m_activity->m_actionInfo->m_speed = speed;
@@ -562,36 +656,36 @@ namespace FIFE {
 		return m_mainMultiInstance;
 	}
 
-	void Instance::actOnce(const std::string& actionName, const Location& direction) {
+	void Instance::actOnce(const Atom& actionName, const Location& direction) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = false;
 		setFacingLocation(direction);
 	}
 
-	void Instance::actOnce(const std::string& actionName, int32_t rotation) {
+	void Instance::actOnce(const Atom& actionName, int32_t rotation) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = false;
 		setRotation(rotation);
 	}
 
-	void Instance::actOnce(const std::string& actionName) {
+	void Instance::actOnce(const Atom& actionName) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = false;
 	}
 
-	void Instance::actRepeat(const std::string& actionName, const Location& direction) {
+	void Instance::actRepeat(const Atom& actionName, const Location& direction) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = true;
 		setFacingLocation(direction);
 	}
 
-	void Instance::actRepeat(const std::string& actionName, int32_t rotation) {
+	void Instance::actRepeat(const Atom& actionName, int32_t rotation) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = true;
 		setRotation(rotation);
 	}
 
-	void Instance::actRepeat(const std::string& actionName) {
+	void Instance::actRepeat(const Atom& actionName) {
 		initializeAction(actionName);
 		m_activity->m_actionInfo->m_repeating = true;
 	}
@@ -614,6 +708,15 @@ namespace FIFE {
 		return NULL;
 	}
 
+	uint32_t Instance::getSayRemainingTime() {
+		if (!m_activity || !m_activity->m_sayInfo || m_activity->m_sayInfo->m_duration == 0) {
+			return 0;
+		}
+		uint32_t elapsed = getRuntime() - m_activity->m_sayInfo->m_start_time;
+		// an expired text is still shown until the next update removes it
+		return elapsed < m_activity->m_sayInfo->m_duration ? m_activity->m_sayInfo->m_duration - elapsed : 1;
+	}
+
 	bool Instance::processMovement() {
 		ActionInfo* info = m_activity->m_actionInfo;
 		Route* route = info->m_route;
@@ -668,7 +771,18 @@ namespace FIFE {
 			double distance_to_travel = (static_cast<double>(timedelta) / 1000.0) * info->m_speed;
 			// location for this movement
 			Location nextLocation = m_location;
-			bool can_follow = info->m_pather->followRoute(m_location, route, distance_to_travel, nextLocation);
+			bool can_follow;
+			// use the step from prepareUpdate(), if the instance was not moved in the meantime
+			// and the instances updated before did not change the blockers it depends on
+			if (m_activity->m_preparedInfo == info && m_activity->m_preparedFrom == m_location &&
+				m_activity->m_preparedStep.isBlockerStateUnchanged()) {
+				nextLocation = m_activity->m_preparedNext;
+				info->m_pather->applyRouteStep(route, m_activity->m_preparedStep, nextLocation);
+				can_follow = m_activity->m_preparedStep.result;
+			} else {
+				can_follow = info->m_pather->followRoute(m_location, route, distance_to_travel, nextLocation);
+			}
+			m_activity->m_preparedInfo = NULL;
 			if (can_follow) {
 				setRotation(route->getRotation());
 				// move to another layer
@@ -727,6 +841,34 @@ namespace FIFE {
 		return false;
 	}
 
+	void Instance::prepareUpdate() {
+		if (!m_activity || !m_activity->m_timeProvider) {
+			return;
+		}
+		m_activity->m_preparedInfo = NULL;
+		ActionInfo* info = m_activity->m_actionInfo;
+		// only movement along an already solved route is prepared,
+		// pathfinding, leaders and multi instances need the serial update
+		if (!info || !info->m_target || info->m_leader || !info->m_delete_route ||
+			isMultiObject() || m_mainMultiInstance) {
+			return;
+		}
+		Route* route = info->m_route;
+		if (!route || route->getRouteStatus() != ROUTE_SOLVED || route->isMultiCell() ||
+			route->getEndNode().getLayerCoordinates() != info->m_target->getLayerCoordinates()) {
+			return;
+		}
+		uint32_t timedelta = m_activity->m_timeProvider->getGameTime() - info->m_prev_call_time;
+		double distance_to_travel = (static_cast<double>(timedelta) / 1000.0) * info->m_speed;
+		m_activity->m_preparedFrom = m_location;
+		m_activity->m_preparedNext = m_location;
+		// the route itself is only changed by the serial update
+		if (info->m_pather->computeRouteStep(m_location, route, distance_to_travel,
+			m_activity->m_preparedNext, m_activity->m_preparedStep)) {
+			m_activity->m_preparedInfo = info;
+		}
+	}
+
 	InstanceChangeInfo Instance::update() {
 		if (!m_activity) {
 			return ICHANGE_NO_CHANGES;
@@ -775,8 +917,10 @@ namespace FIFE {
 				}
 			}
 		} else if (!m_activity->m_actionInfo && m_changeInfo == ICHANGE_NO_CHANGES && m_activity->m_actionListeners.empty() && m_activity->m_changeListeners.empty()) {
-			// delete superfluous activity
-			delete m_activity;
+			// superfluous activity is kept aside for the next change,
+			// its time provider and sound source are not needed until then
+			m_activity->release();
+			m_idleActivity = m_activity;
 			m_activity = 0;
 			return ICHANGE_NO_CHANGES;
 		}
@@ -795,6 +939,7 @@ namespace FIFE {
 		Action* action = m_activity->m_actionInfo->m_action;
 		delete m_activity->m_actionInfo;
 		m_activity->m_actionInfo = NULL;
+		m_activity->m_preparedInfo = NULL;
 		// this is needed in case the new action is set on the same pump and
 		// it is the same action as the finalized action
 		m_activity->m_action = NULL;
@@ -835,6 +980,7 @@ namespace FIFE {
 		Action* action = m_activity->m_actionInfo->m_action;
 		delete m_activity->m_actionInfo;
 		m_activity->m_actionInfo = NULL;
+		m_activity->m_preparedInfo = NULL;
 		// this is needed in case the new action is set on the same pump and
 		// it is the same action as the canceled action
 		m_activity->m_action = NULL;
@@ -914,6 +1060,13 @@ namespace FIFE {
 		m_activity->m_actionInfo->m_action_offset_time = time_offset;
 	}
 
+	bool Instance::isActionRepeating() const {
+		if (m_activity && m_activity->m_actionInfo) {
+			return m_activity->m_actionInfo->m_repeating;
+		}
+		return false;
+	}
+
 	void Instance::bindTimeProvider() {
 		float multiplier = 1.0;
 		if (m_activity->m_timeProvider) {
@@ -1023,7 +1176,7 @@ namespace FIFE {
 
 	std::string Instance::getCostId() {
 		if (m_specialCost) {
-			return m_costId;
+			return m_costId.str();
 		}
 		return m_object->getCostId();
 	}
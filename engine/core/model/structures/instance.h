@@ -32,9 +32,11 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/fifeclass.h"
+#include "util/structures/objectpool.h"
 
 #include "model/metamodel/object.h"
 #include "model/metamodel/ivisual.h"
+#include "pathfinder/route.h"
 #include "view/visual.h"
 
 #include "location.h"
@@ -47,6 +49,7 @@ namespace FIFE {
 	class Instance;
 	class ActionInfo;
 	class SayInfo;
+	struct InstanceTreeBucket;
 	class SoundSource;
 	class TimeProvider;
 	class Route;
@@ -104,6 +107,11 @@ namespace FIFE {
 		 */
 		virtual ~Instance();
 
+		/** Instances are taken from a pool, so spawning and removing many of them does not churn the heap.
+		 */
+		static void* operator new(std::size_t size) { return ObjectPool<Instance>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<Instance>::deallocate(ptr, size); }
+
 		/** Get the identifier for this instance; possibly null.
 		 */
 		const std::string& getId();
@@ -116,6 +124,11 @@ namespace FIFE {
 		 */
 		Object* getObject();
 
+		/** Gets the object the instance was created with. Differs from getObject() only
+		 *  if the instance works on an own copy of its object, e.g. for own action visuals.
+		 */
+		Object* getBaseObject();
+
 		/** Sets location of the instance
 		 *  @param loc new location
 		 */
@@ -247,6 +260,10 @@ namespace FIFE {
 		*/
 		void setActionRuntime(uint32_t time_offset);
 
+		/** Returns true if the current action is repeated, moving actions are not.
+		 */
+		bool isActionRepeating() const;
+
 		/** Performs given named action to the instance. While performing the action
 		 *  moves instance to given target with given speed
 		 *  @param actionName name of the action
@@ -254,41 +271,41 @@ namespace FIFE {
 		 *  @param speed speed used for movement. Units = distance 1 in layer coordinates per second
 		 *  @param costId id for special costs which is be used as extra multiplier.
 		 */
-		void move(const std::string& actionName, const Location& target, const double speed, const std::string& costId = "");
+		void move(const Atom& actionName, const Location& target, const double speed, const std::string& costId = "");
 
 		/** Performs given named action to the instance, once only. Performs no movement
 		 *  @param actionName name of the action
 		 *  @param direction coordinates for cell towards instance is heading to when performing the action
 		 */
-		void actOnce(const std::string& actionName, const Location& direction);
+		void actOnce(const Atom& actionName, const Location& direction);
 
 		/** Performs given named action to the instance, once only. Performs no movement
 		 *  @param actionName name of the action
 		 *  @param rotation rotation which the instance use when performing the action
 		 */
-		void actOnce(const std::string& actionName, int32_t rotation);
+		void actOnce(const Atom& actionName, int32_t rotation);
 
 		/** Performs given named action to the instance, once only. Performs no movement and use current rotation
 		 *  @param actionName name of the action
 		 */
-		void actOnce(const std::string& actionName);
+		void actOnce(const Atom& actionName);
 
 		/** Performs given named action to the instance, repeated. Performs no movement
 		 *  @param actionName name of the action
 		 *  @param direction coordinates for cell towards instance is heading to when performing the action
 		 */
-		void actRepeat(const std::string& actionName, const Location& direction);
+		void actRepeat(const Atom& actionName, const Location& direction);
 
 		/** Performs given named action to the instance, repeated Performs no movement
 		 *  @param actionName name of the action
 		 *  @param rotation rotation which the instance use when performing the action
 		 */
-		void actRepeat(const std::string& actionName, int32_t rotation);
+		void actRepeat(const Atom& actionName, int32_t rotation);
 
 		/** Performs given named action to the instance, repeated. Performs no movement and use current rotation
 		 *  @param actionName name of the action
 		 */
-		void actRepeat(const std::string& actionName);
+		void actRepeat(const Atom& actionName);
 
 		/** Causes instance to "say" given text (shown on screen next to the instance)
 		 *  @param text text to say. If "" given, clear the text
@@ -302,7 +319,7 @@ namespace FIFE {
 		 *  @param leader followed instance
 		 *  @param speed speed used for movement. Units = distance 1 in layer coordinates per second
 		 */
-		void follow(const std::string& actionName, Instance* leader, const double speed);
+		void follow(const Atom& actionName, Instance* leader, const double speed);
 
 		/** Performs given named action to the instance. While performing the action
 		 *  follows given route with given speed. Note: In this case route isn't deleted or resetted at the end.
@@ -310,7 +327,7 @@ namespace FIFE {
 		 *  @param route followed route
 		 *  @param speed speed used for movement. Units = distance 1 in layer coordinates per second
 		 */
-		void follow(const std::string& actionName, Route* route, const double speed);
+		void follow(const Atom& actionName, Route* route, const double speed);
 
 		/** Cancel movement after a given length.
 		 *  If no length is set then 1 is used. This means that the instance
@@ -322,6 +339,11 @@ namespace FIFE {
 		 */
 		const std::string* getSayText() const;
 
+		/** Returns the time in milliseconds until the say text disappears.
+		 *  0 if the text is shown forever or no text is set.
+		 */
+		uint32_t getSayRemainingTime();
+
 		/** Updates the instance related to the current action
 		 * @note call this only once in engine update cycle, so that tracking between
 		 *  current position and previous position keeps in sync.
@@ -329,10 +351,28 @@ namespace FIFE {
 		 */
 		InstanceChangeInfo update();
 
+		/** Calculates the next movement step without changing anything outside of the instance.
+		 * Used by the parallel layer update, it is safe to call it for different instances
+		 * at the same time. The step is applied by the following update() call.
+		 * Instances that need pathfinding or move together with other instances are skipped,
+		 * update() handles them as usual.
+		 */
+		void prepareUpdate();
+
 		/** If this returns true, the instance needs to be updated
 		 */
 		bool isActive() const;
 
+		/** Returns how long the update of the instance can be delayed, if no camera shows it.
+		 * Moving instances can't be delayed, the end of the current action or say text
+		 * limits the delay, so that they finish on time. Changes from outside
+		 * reactivate the instance, so they are never delayed either.
+		 * @param interval The longest delay in milliseconds of map time.
+		 * @return The delay in milliseconds of map time, 0 means no delay.
+		 * @see Layer::setOffscreenUpdateInterval()
+		 */
+		uint32_t getUpdateDelay(uint32_t interval) const;
+
 		/** Sets visualization to be used. Transfers ownership.
 		 */
 		void setVisual(IVisual* visual) { m_visual = visual; }
@@ -441,6 +481,28 @@ namespace FIFE {
 		 */
 		Instance* getMainMultiInstance();
 
+		/** Sets the position of the instance in the active instance list of its layer.
+		 * Only used by the layer, -1 means the instance is not in the list.
+		 */
+		void setActiveIndex(int32_t index) { m_activeIndex = index; }
+
+		/** Returns the position of the instance in the active instance list of its layer or -1.
+		 */
+		int32_t getActiveIndex() const { return m_activeIndex; }
+
+		/** Sets the bucket and the position in it, if the layer uses the grid spatial index.
+		 * Only used by the InstanceTree, NULL and -1 mean the instance is not in a bucket.
+		 */
+		void setSpatialSlot(InstanceTreeBucket* bucket, int32_t index) { m_spatialBucket = bucket; m_spatialIndex = index; }
+
+		/** Returns the bucket of the grid spatial index that holds the instance or NULL.
+		 */
+		InstanceTreeBucket* getSpatialBucket() const { return m_spatialBucket; }
+
+		/** Returns the position in the bucket of the grid spatial index or -1.
+		 */
+		int32_t getSpatialIndex() const { return m_spatialIndex; }
+
 		/** Adds new static color overlay with given angle (degrees).
 		 */
 		void addStaticColorOverlay(uint32_t angle, const OverlayColors& colors);
@@ -529,6 +591,14 @@ namespace FIFE {
 			InstanceActivity(Instance& source);
 			~InstanceActivity();
 
+			static void* operator new(std::size_t size) { return ObjectPool<InstanceActivity>::allocate(size); }
+			static void operator delete(void* ptr, std::size_t size) { ObjectPool<InstanceActivity>::deallocate(ptr, size); }
+
+			//! frees the owned helpers so a parked activity only keeps its allocation
+			void release();
+			//! brings a idle activity back to the state of a new one
+			void reset(Instance& source);
+
 			// ----- Fields related to change tracking -----
 			//! updates cached variables, marks changes
 			void update(Instance& source);
@@ -566,8 +636,20 @@ namespace FIFE {
 			bool m_blocking;
 			//! additional change info, used for visual class (transparency, visible, stackpos)
 			InstanceChangeInfo m_additional;
+
+			// ----- Fields related to the parallel update -----
+			//! action the prepared movement step belongs to, NULL if there is none
+			ActionInfo* m_preparedInfo;
+			//! location the prepared movement step starts from
+			Location m_preparedFrom;
+			//! next location calculated by prepareUpdate()
+			Location m_preparedNext;
+			//! route changes calculated by prepareUpdate(), applied by the serial update
+			RouteStep m_preparedStep;
 		};
 		InstanceActivity* m_activity;
+		//! activity that was given up on the last idle round, reused by the next change
+		InstanceActivity* m_idleActivity;
 		//! bitmask stating current changes
 		InstanceChangeInfo m_changeInfo;
 		//! listeners for deletion of the instance
@@ -592,11 +674,17 @@ namespace FIFE {
 		//! holds cost value
 		double m_cost;
 		//! holds cost id
-		std::string m_costId;
+		Atom m_costId;
 		//! vector that holds all multi instances
 		std::vector<Instance*> m_multiInstances;
 		//! pointer to the main multi instance
 		Instance* m_mainMultiInstance;
+		//! position in the active instance list of the layer, -1 if not active
+		int32_t m_activeIndex;
+		//! grid bucket of the spatial index that holds the instance
+		InstanceTreeBucket* m_spatialBucket;
+		//! position in the grid bucket, -1 if not in a bucket
+		int32_t m_spatialIndex;
 
 		Instance(const Instance&);
 		Instance& operator=(const Instance&);
@@ -605,7 +693,7 @@ namespace FIFE {
 		//! Cancel current action
 		void cancelAction();
 		//! Initialize action for use
-		void initializeAction(const std::string& actionName);
+		void initializeAction(const Atom& actionName);
 		//! Moves instance. Returns true if finished
 		bool processMovement();
 		//! Calculates movement based current location and speed
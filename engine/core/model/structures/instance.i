@@ -86,6 +86,7 @@ namespace FIFE {
 		const std::string& getId();
 		void setId(const std::string& identifier="");
 		Object* getObject();
+		Object* getBaseObject();
 		void setLocation(const Location& loc);
 		Location getLocation() const;
 		Location& getLocationRef();
@@ -109,6 +110,7 @@ namespace FIFE {
 		Location getFacingLocation();
 		uint32_t getActionRuntime();
 		void setActionRuntime(uint32_t time_offset);
+		bool isActionRepeating() const;
 		void move(const std::string& actionName, const Location& target, const double speed, const std::string& costId = "");
 		void actOnce(const std::string& actionName, const Location& direction);
 		void actOnce(const std::string& actionName, int32_t rotation);
@@ -120,6 +122,7 @@ namespace FIFE {
 		void follow(const std::string& actionName, Route* route, const double speed);
 		void cancelMovement(uint32_t length = 1);
 		void say(const std::string& text, uint32_t duration=0);
+		uint32_t getSayRemainingTime();
 		void setTimeMultiplier(float multip);
 		float getTimeMultiplier();
 		uint32_t getRuntime();
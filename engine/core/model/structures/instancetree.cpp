@@ -39,14 +39,47 @@
 namespace FIFE {
 	static Logger _log(LM_STRUCTURES);
 
-	InstanceTree::InstanceTree(): FifeClass() {
+	InstanceTree::InstanceTree(SpatialIndexStrategy strategy):
+		FifeClass(),
+		m_strategy(strategy) {
 	}
 
 	InstanceTree::~InstanceTree() {
 	}
 
+	SpatialIndexStrategy InstanceTree::getStrategy() const {
+		return m_strategy;
+	}
+
+	int32_t InstanceTree::toBucketCoordinate(int32_t value) {
+		// round towards negative infinity, so that -1 is not in the same bucket as 0
+		if (value < 0) {
+			return (value - GRID_BUCKET_SIZE + 1) / GRID_BUCKET_SIZE;
+		}
+		return value / GRID_BUCKET_SIZE;
+	}
+
+	uint64_t InstanceTree::getBucketKey(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
 	void InstanceTree::addInstance(Instance* instance) {
 		ModelCoordinate coords = instance->getLocationRef().getLayerCoordinates();
+		if (m_strategy == SPATIAL_GRID) {
+			InstanceTreeBucket* old = instance->getSpatialBucket();
+			if (old && instance->getSpatialIndex() < static_cast<int32_t>(old->instances.size()) &&
+				old->instances[instance->getSpatialIndex()] == instance) {
+				FL_WARN(_log, "InstanceTree::addInstance() - Duplicate Instance.  Ignoring.");
+				return;
+			}
+			uint64_t key = getBucketKey(toBucketCoordinate(coords.x), toBucketCoordinate(coords.y));
+			InstanceTreeBucket& bucket = m_buckets[key];
+			bucket.key = key;
+			instance->setSpatialSlot(&bucket, static_cast<int32_t>(bucket.instances.size()));
+			bucket.instances.push_back(instance);
+			return;
+		}
+
 		InstanceTreeNode * node = m_tree.find_container(coords.x,coords.y,0,0);
 		InstanceList& list = node->data();
 		list.push_back(instance);
@@ -58,6 +91,25 @@ namespace FIFE {
 	}
 
 	void InstanceTree::removeInstance(Instance* instance) {
+		if (m_strategy == SPATIAL_GRID) {
+			InstanceTreeBucket* bucket = instance->getSpatialBucket();
+			int32_t index = instance->getSpatialIndex();
+			if (!bucket || index >= static_cast<int32_t>(bucket->instances.size()) ||
+				bucket->instances[index] != instance) {
+				FL_WARN(_log, "InstanceTree::removeInstance() - Instance not part of tree.");
+				return;
+			}
+			Instance* last = bucket->instances.back();
+			bucket->instances[index] = last;
+			last->setSpatialSlot(bucket, index);
+			bucket->instances.pop_back();
+			instance->setSpatialSlot(NULL, -1);
+			// instances walk over the whole map, so buckets are not kept for cells they left
+			if (bucket->instances.empty()) {
+				m_buckets.erase(bucket->key);
+			}
+			return;
+		}
 		InstanceTreeNode * node = m_reverse[instance];
 		if( !node ) {
 			FL_WARN(_log, "InstanceTree::removeInstance() - Instance not part of tree.");
@@ -74,6 +126,10 @@ namespace FIFE {
 		FL_WARN(_log, "InstanceTree::removeInstance() - Instance part of tree but not found in the expected tree node.");
 	}
 
+	uint32_t InstanceTree::getBucketCount() const {
+		return static_cast<uint32_t>(m_buckets.size());
+	}
+
 	class InstanceListCollector {
 		public:
 			InstanceTree::InstanceList& instanceList;
@@ -97,6 +153,29 @@ namespace FIFE {
 
 	void InstanceTree::findInstances(const ModelCoordinate& point, int32_t w, int32_t h, InstanceTree::InstanceList& list) {
 		list.clear();
+		if (m_strategy == SPATIAL_GRID) {
+			Rect rect(point.x, point.y, w, h);
+			int32_t startX = toBucketCoordinate(point.x);
+			int32_t startY = toBucketCoordinate(point.y);
+			int32_t endX = toBucketCoordinate(point.x + w);
+			int32_t endY = toBucketCoordinate(point.y + h);
+			for (int32_t y = startY; y <= endY; ++y) {
+				for (int32_t x = startX; x <= endX; ++x) {
+					std::unordered_map<uint64_t, InstanceTreeBucket>::const_iterator bucket = m_buckets.find(getBucketKey(x, y));
+					if (bucket == m_buckets.end()) {
+						continue;
+					}
+					const std::vector<Instance*>& instances = bucket->second.instances;
+					for (std::vector<Instance*>::const_iterator it = instances.begin(); it != instances.end(); ++it) {
+						ModelCoordinate coords = (*it)->getLocationRef().getLayerCoordinates();
+						if (rect.contains(Point(coords.x, coords.y))) {
+							list.push_back(*it);
+						}
+					}
+				}
+			}
+			return;
+		}
 		InstanceTreeNode * node = m_tree.find_container(point.x, point.y, w, h);
 		Rect rect(point.x, point.y, w, h);
 		InstanceListCollector collector(list,rect);
@@ -24,6 +24,8 @@
 
 // Standard C++ library includes
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 // 3rd party library includes
 
@@ -39,9 +41,30 @@ namespace FIFE {
 
 	class Instance;
 
+	/** Data structure the InstanceTree uses to find instances by their position.
+	 *
+	 * SPATIAL_QUADTREE is the default, it can be drawn by the QuadTreeRenderer.
+	 * SPATIAL_GRID splits the layer into equally sized buckets. Instances remember their
+	 * bucket, so moving them is constant time. Recommended for layers with many moving instances.
+	 */
+	enum SpatialIndexStrategy {
+		SPATIAL_QUADTREE,
+		SPATIAL_GRID
+	};
+
+	/** Bucket of the grid spatial index, holds the instances of GRID_BUCKET_SIZE x GRID_BUCKET_SIZE cells.
+	 */
+	struct InstanceTreeBucket {
+		//! key of the bucket in the grid, empty buckets are erased with it
+		uint64_t key;
+		std::vector<Instance*> instances;
+	};
+
 	class InstanceTree: public FifeClass {
 	public:
 		static const int32_t MIN_TREE_SIZE = 2;
+		//! width and height of a grid bucket in layer cells
+		static const int32_t GRID_BUCKET_SIZE = 4;
 
 		typedef std::list<Instance*> InstanceList;
 		typedef QuadTree< InstanceList, MIN_TREE_SIZE > InstanceQuadTree;
@@ -49,14 +72,19 @@ namespace FIFE {
 
 		/** Constructor
 		 *
+		 * @param strategy The data structure that should be used.
 		 */
-		InstanceTree();
+		InstanceTree(SpatialIndexStrategy strategy = SPATIAL_QUADTREE);
 
 		/** Destructor
 		 *
 		 */
 		virtual ~InstanceTree();
 
+		/** Returns the data structure that is used. @see SpatialIndexStrategy
+		 */
+		SpatialIndexStrategy getStrategy() const;
+
 		/** Adds an instance to the quad tree.
 		 *
 		 * Adds an instance to the quad tree based upon it's location on the layer and it's
@@ -88,7 +116,12 @@ namespace FIFE {
 		 */
 		void findInstances(const ModelCoordinate& point, int32_t w, int32_t h, InstanceList& list);
 
+		/** Returns the number of grid buckets that hold instances, 0 for the quadtree strategy.
+		 */
+		uint32_t getBucketCount() const;
+
 		/** See QuadNode::apply_visitor
+		 * @note Only the quadtree strategy has nodes to visit.
 		 */
 		template<typename Visitor> void applyVisitor(Visitor& visitor) {
 			m_tree.apply_visitor(visitor);
@@ -96,8 +129,19 @@ namespace FIFE {
 
 
 	private:
+		/** Returns the key of the grid bucket that contains the given cell.
+		 */
+		static uint64_t getBucketKey(int32_t x, int32_t y);
+
+		/** Returns the bucket coordinate for a cell coordinate.
+		 */
+		static int32_t toBucketCoordinate(int32_t value);
+
+		SpatialIndexStrategy m_strategy;
 		InstanceQuadTree m_tree;
 		std::map<Instance*,InstanceTreeNode*> m_reverse;
+		//! buckets of the grid strategy, std::unordered_map keeps their addresses stable
+		std::unordered_map<uint64_t, InstanceTreeBucket> m_buckets;
 	};
 
 }
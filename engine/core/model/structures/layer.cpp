@@ -20,6 +20,8 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
+#include <unordered_set>
 
 // 3rd party library includes
 
@@ -29,6 +31,7 @@
 // Second block: files included from the same folder
 #include "util/log/logger.h"
 #include "util/structures/purge.h"
+#include "util/concurrency/jobsystem.h"
 #include "model/metamodel/grids/cellgrid.h"
 
 #include "layer.h"
@@ -45,11 +48,17 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_STRUCTURES);
 
+	/** Below this number of active instances the worker threads are not used,
+	 * the overhead of waking them would be higher than the gain.
+	 */
+	static const uint32_t MIN_PARALLEL_INSTANCES = 256;
+
 	Layer::Layer(const std::string& identifier, Map* map, CellGrid* grid)
 		: m_id(identifier),
 		m_map(map),
 		m_instancesVisibility(true),
 		m_transparency(0),
+		m_updatingInstances(false),
 		m_instanceTree(new InstanceTree()),
 		m_grid(grid),
 		m_pathingStrategy(CELL_EDGES_ONLY),
@@ -59,7 +68,11 @@ namespace FIFE {
 		m_walkableId(""),
 		m_cellCache(NULL),
 		m_changeListeners(),
+		m_changeLogListeners(),
 		m_changedInstances(),
+		m_changeLogEnabled(false),
+		m_changeLog(),
+		m_offscreenUpdateInterval(0),
 		m_changed(false),
 		m_static(false) {
 	}
@@ -131,6 +144,39 @@ namespace FIFE {
 		return instance;
 	}
 
+	std::vector<Instance*> Layer::createInstances(const std::vector<InstanceCreationInfo>& infos) {
+		std::vector<Instance*> instances;
+		instances.reserve(infos.size());
+		// keep the geometric growth, if many small batches are created
+		size_t required = m_instances.size() + infos.size();
+		if (required > m_instances.capacity()) {
+			m_instances.reserve(std::max(required, m_instances.capacity() * 2));
+		}
+
+		Location location(this);
+		std::vector<InstanceCreationInfo>::const_iterator it = infos.begin();
+		for (; it != infos.end(); ++it) {
+			location.setExactLayerCoordinates(it->coordinate);
+			Instance* instance = new Instance(it->object, location, it->id);
+			if (instance->isActive()) {
+				setInstanceActivityStatus(instance, instance->isActive());
+			}
+			m_instances.push_back(instance);
+			m_instanceTree->addInstance(instance);
+			instances.push_back(instance);
+		}
+
+		if (!instances.empty()) {
+			std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
+			while (i != m_changeListeners.end()) {
+				(*i)->onInstancesCreate(this, instances);
+				++i;
+			}
+			m_changed = true;
+		}
+		return instances;
+	}
+
 	bool Layer::addInstance(Instance* instance, const ExactModelCoordinate& p){
         if( !instance ){
             FL_ERR(_log, "Tried to add an instance to layer, but given instance is invalid");
@@ -156,8 +202,8 @@ namespace FIFE {
 		return true;
 	}
 
-	void Layer::removeInstance(Instance* instance) {
-		// If the instance is changed and removed on the same pump,
+	void Layer::releaseInstance(Instance* instance) {
+		// If the instance is changed and removed or deleted on the same pump,
 		// it can happen that the instance can not cleanly be removed,
 		// to avoid this we have to update the instance first and send
 		// the result to the LayerChangeListeners.
@@ -167,7 +213,9 @@ namespace FIFE {
 				updateInstances.push_back(instance);
 				std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
 				while (i != m_changeListeners.end()) {
-					(*i)->onLayerChanged(this, updateInstances);
+					if (!isChangeLogListener(*i)) {
+						(*i)->onLayerChanged(this, updateInstances);
+					}
 					++i;
 				}
 			}
@@ -178,11 +226,16 @@ namespace FIFE {
 			(*i)->onInstanceDelete(this, instance);
 			++i;
 		}
+		removeChangeLogRecords(instance);
 		setInstanceActivityStatus(instance, false);
+		m_instanceTree->removeInstance(instance);
+	}
+
+	void Layer::removeInstance(Instance* instance) {
+		releaseInstance(instance);
 		std::vector<Instance*>::iterator it = m_instances.begin();
 		for(; it != m_instances.end(); ++it) {
 			if(*it == instance) {
-				m_instanceTree->removeInstance(*it);
 				m_instances.erase(it);
 				break;
 			}
@@ -191,32 +244,10 @@ namespace FIFE {
 	}
 
 	void Layer::deleteInstance(Instance* instance) {
-		// If the instance is changed and deleted on the same pump,
-		// it can happen that the instance can not cleanly be removed,
-		// to avoid this we have to update the instance first and send
-		// the result to the LayerChangeListeners.
-		if (instance->isActive()) {
-			if (instance->update() != ICHANGE_NO_CHANGES) {
-				std::vector<Instance*> updateInstances;
-				updateInstances.push_back(instance);
-				std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
-				while (i != m_changeListeners.end()) {
-					(*i)->onLayerChanged(this, updateInstances);
-					++i;
-				}
-			}
-		}
-
-		std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
-		while (i != m_changeListeners.end()) {
-			(*i)->onInstanceDelete(this, instance);
-			++i;
-		}
-		setInstanceActivityStatus(instance, false);
+		releaseInstance(instance);
 		std::vector<Instance*>::iterator it = m_instances.begin();
 		for(; it != m_instances.end(); ++it) {
 			if(*it == instance) {
-				m_instanceTree->removeInstance(*it);
 				delete *it;
 				m_instances.erase(it);
 				break;
@@ -226,15 +257,54 @@ namespace FIFE {
 		m_changed = true;
 	}
 
+	void Layer::deleteInstances(const std::vector<Instance*>& instances) {
+		if (instances.empty()) {
+			return;
+		}
+		std::unordered_set<Instance*> deleted;
+		std::vector<Instance*>::const_iterator it = instances.begin();
+		for (; it != instances.end(); ++it) {
+			releaseInstance(*it);
+			deleted.insert(*it);
+		}
+		// one pass over the instance list, instead of one search per instance
+		m_instances.erase(std::remove_if(m_instances.begin(), m_instances.end(),
+			[&deleted](Instance* instance) { return deleted.count(instance) > 0; }), m_instances.end());
+		for (it = instances.begin(); it != instances.end(); ++it) {
+			delete *it;
+		}
+		m_changed = true;
+	}
+
 	const std::vector<Instance*>& Layer::getInstances() const {
 		return m_instances;
 	}
 
 	void Layer::setInstanceActivityStatus(Instance* instance, bool active) {
-		if(active) {
-			m_activeInstances.insert(instance);
-		} else {
-			m_activeInstances.erase(instance);
+		int32_t index = instance->getActiveIndex();
+		if (active) {
+			if (index == -1) {
+				instance->setActiveIndex(static_cast<int32_t>(m_activeInstances.size()));
+				m_activeInstances.push_back(instance);
+				m_activeUpdateTimes.push_back(0);
+			} else if (static_cast<uint32_t>(index) < m_activeUpdateTimes.size()) {
+				// changes are never delayed
+				m_activeUpdateTimes[index] = 0;
+			}
+		} else if (index != -1 && static_cast<uint32_t>(index) < m_activeInstances.size() &&
+			m_activeInstances[index] == instance) {
+			instance->setActiveIndex(-1);
+			if (m_updatingInstances) {
+				// update() compacts the list afterwards
+				m_activeInstances[index] = NULL;
+			} else {
+				Instance* last = m_activeInstances.back();
+				m_activeInstances[index] = last;
+				last->setActiveIndex(index);
+				m_activeInstances.pop_back();
+				m_activeUpdateTimes[index] = m_activeUpdateTimes.back();
+				m_activeUpdateTimes.pop_back();
+			}
 		}
 	}
 
@@ -520,6 +590,23 @@ namespace FIFE {
 		return m_sortingStrategy;
 	}
 
+	void Layer::setSpatialIndexStrategy(SpatialIndexStrategy strategy) {
+		if (m_instanceTree->getStrategy() == strategy) {
+			return;
+		}
+		delete m_instanceTree;
+		m_instanceTree = new InstanceTree(strategy);
+		std::vector<Instance*>::iterator it = m_instances.begin();
+		for (; it != m_instances.end(); ++it) {
+			(*it)->setSpatialSlot(NULL, -1);
+			m_instanceTree->addInstance(*it);
+		}
+	}
+
+	SpatialIndexStrategy Layer::getSpatialIndexStrategy() const {
+		return m_instanceTree->getStrategy();
+	}
+
 	void Layer::setWalkable(bool walkable) {
 		m_walkable = walkable;
 	}
@@ -593,31 +680,102 @@ namespace FIFE {
 
 	bool Layer::update() {
 		m_changedInstances.clear();
-		std::vector<Instance*> inactiveInstances;
-		std::set<Instance*>::iterator it = m_activeInstances.begin();
-		for(; it != m_activeInstances.end(); ++it) {
-			if ((*it)->update() != ICHANGE_NO_CHANGES) {
-				m_changedInstances.push_back(*it);
+		m_changeLog.clear();
+		// off-screen instances sleep until their update time, while the cameras stand still
+		// only the time list is checked for them, so that the instances themselves are not touched
+		bool offscreenDelay = m_offscreenUpdateInterval > 0 && m_map;
+		bool cameraView = offscreenDelay && m_map->hasCameraViewPorts();
+		bool cameraViewChanged = cameraView && m_map->isCameraViewChanged();
+		uint32_t mapTime = offscreenDelay ? m_map->getTimeProvider()->getGameTime() : 0;
+		// calculate the movement steps in parallel, the serial loop below applies them
+		// in a fixed order, so that listeners and the instance tree only see serial changes.
+		// computeRouteStep() needs the cellcache, without it the pather would use the instance tree.
+		// a model used without an engine has no job system, then the serial loop does all the work
+		uint32_t threads = m_map && JobSystem::isCreated() ? m_map->getUpdateThreadCount() : 1;
+		if (threads > 1 && m_cellCache && m_activeInstances.size() >= MIN_PARALLEL_INSTANCES) {
+			uint32_t count = static_cast<uint32_t>(m_activeInstances.size());
+			// the thread count limits the number of chunks
+			JobSystem::instance()->parallelFor(count,
+				[this, offscreenDelay, mapTime](uint32_t begin, uint32_t end) {
+					for (uint32_t i = begin; i < end; ++i) {
+						// sleeping instances don't move
+						if (!offscreenDelay || m_activeUpdateTimes[i] <= mapTime) {
+							m_activeInstances[i]->prepareUpdate();
+						}
+					}
+				}, (count + threads - 1) / threads);
+		}
+		// instances activated during the loop are appended and updated in the same round,
+		// deactivated ones leave a NULL entry behind
+		m_updatingInstances = true;
+		for (uint32_t i = 0; i < m_activeInstances.size(); ++i) {
+			Instance* instance = m_activeInstances[i];
+			if (!instance) {
+				continue;
+			}
+			if (offscreenDelay && m_activeUpdateTimes[i] > mapTime) {
+				if (!cameraViewChanged ||
+					!m_map->isInCameraViewPort(instance->getLocationRef().getMapCoordinates())) {
+					continue;
+				}
+			}
+			InstanceChangeInfo changes = instance->update();
+			// listeners called by the update may remove the instance from the layer
+			bool removed = m_activeInstances[i] != instance;
+			if (offscreenDelay && !removed && instance->isActive()) {
+				bool onScreen = cameraView &&
+					m_map->isInCameraViewPort(instance->getLocationRef().getMapCoordinates());
+				m_activeUpdateTimes[i] = onScreen ? 0 : mapTime + instance->getUpdateDelay(m_offscreenUpdateInterval);
+			}
+			// a removed instance was already reported to the listeners, it may even be deleted
+			if (!removed && changes != ICHANGE_NO_CHANGES) {
+				m_changedInstances.push_back(instance);
 				m_changed = true;
-			} else if (!(*it)->isActive()) {
-				inactiveInstances.push_back(*it);
+				if (m_changeLogEnabled) {
+					const ModelCoordinate& newCell = instance->getLocationRef().getLayerCoordinates();
+					m_changeLog.push_back(InstanceChangeRecord(instance, changes,
+						(changes & ICHANGE_CELL) ? instance->getOldLocationRef().getLayerCoordinates() : newCell, newCell));
+				}
+			}
+			// an instance only becomes idle by its own update
+			if (!removed && !instance->isActive()) {
+				instance->setActiveIndex(-1);
+				m_activeInstances[i] = NULL;
 			}
 		}
+		m_updatingInstances = false;
+		// remove inactive instances, keeps the order of the remaining ones
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < m_activeInstances.size(); ++i) {
+			Instance* instance = m_activeInstances[i];
+			if (!instance) {
+				continue;
+			}
+			if (count != i) {
+				instance->setActiveIndex(static_cast<int32_t>(count));
+				m_activeInstances[count] = instance;
+				m_activeUpdateTimes[count] = m_activeUpdateTimes[i];
+			}
+			++count;
+		}
+		m_activeInstances.resize(count);
+		m_activeUpdateTimes.resize(count);
+
 		if (!m_changedInstances.empty()) {
 			std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
 			while (i != m_changeListeners.end()) {
-				(*i)->onLayerChanged(this, m_changedInstances);
+				if (!isChangeLogListener(*i)) {
+					(*i)->onLayerChanged(this, m_changedInstances);
+				}
 				++i;
 			}
-			//std::cout << "Layer named " << Id() << " changed = 1\n";
-		}
-		// remove inactive instances from m_activeInstances
-		if (!inactiveInstances.empty()) {
-			std::vector<Instance*>::iterator i = inactiveInstances.begin();
-			while (i != inactiveInstances.end()) {
-				m_activeInstances.erase(*i);
-				++i;
+			if (m_changeLogEnabled) {
+				i = m_changeLogListeners.begin();
+				for (; i != m_changeLogListeners.end(); ++i) {
+					(*i)->onLayerChangeLog(this, m_changeLog);
+				}
 			}
+			//std::cout << "Layer named " << Id() << " changed = 1\n";
 		}
 		//std::cout << "Layer named " << Id() << " changed = 0\n";
 		bool retval = m_changed;
@@ -625,11 +783,18 @@ namespace FIFE {
 		return retval;
 	}
 
-	void Layer::addChangeListener(LayerChangeListener* listener) {
+	void Layer::addChangeListener(LayerChangeListener* listener, bool changeLog) {
 		m_changeListeners.push_back(listener);
+		if (changeLog) {
+			m_changeLogListeners.push_back(listener);
+		}
 	}
 
 	void Layer::removeChangeListener(LayerChangeListener* listener) {
+		std::vector<LayerChangeListener*>::iterator it = std::find(m_changeLogListeners.begin(), m_changeLogListeners.end(), listener);
+		if (it != m_changeLogListeners.end()) {
+			m_changeLogListeners.erase(it);
+		}
 		std::vector<LayerChangeListener*>::iterator i = m_changeListeners.begin();
 		while (i != m_changeListeners.end()) {
 			if ((*i) == listener) {
@@ -648,6 +813,79 @@ namespace FIFE {
 		return m_changedInstances;
 	}
 
+	void Layer::setChangeLogEnabled(bool enabled) {
+		m_changeLogEnabled = enabled;
+		if (!enabled) {
+			m_changeLog.clear();
+		}
+	}
+
+	void Layer::removeChangeLogRecords(Instance* instance) {
+		if (m_changeLog.empty()) {
+			return;
+		}
+		m_changeLog.erase(std::remove_if(m_changeLog.begin(), m_changeLog.end(),
+			[instance](const InstanceChangeRecord& record) { return record.instance == instance; }),
+			m_changeLog.end());
+	}
+
+	bool Layer::isChangeLogListener(LayerChangeListener* listener) const {
+		// usually empty, so the lookup is cheaper than a second listener list for the other calls
+		return !m_changeLogListeners.empty() &&
+			std::find(m_changeLogListeners.begin(), m_changeLogListeners.end(), listener) != m_changeLogListeners.end();
+	}
+
+	bool Layer::isChangeLogEnabled() const {
+		return m_changeLogEnabled;
+	}
+
+	void Layer::setOffscreenUpdateInterval(uint32_t interval) {
+		m_offscreenUpdateInterval = interval;
+		// all instances are updated in the next round and scheduled again
+		std::fill(m_activeUpdateTimes.begin(), m_activeUpdateTimes.end(), 0);
+	}
+
+	uint32_t Layer::getOffscreenUpdateInterval() const {
+		return m_offscreenUpdateInterval;
+	}
+
+	const std::vector<InstanceChangeRecord>& Layer::getChangeLog() const {
+		return m_changeLog;
+	}
+
+	std::vector<Instance*> Layer::getChangeLogInstances() const {
+		std::vector<Instance*> instances;
+		instances.reserve(m_changeLog.size());
+		std::vector<InstanceChangeRecord>::const_iterator it = m_changeLog.begin();
+		for (; it != m_changeLog.end(); ++it) {
+			instances.push_back(it->instance);
+		}
+		return instances;
+	}
+
+	std::vector<uint32_t> Layer::getChangeLogChanges() const {
+		std::vector<uint32_t> changes;
+		changes.reserve(m_changeLog.size());
+		std::vector<InstanceChangeRecord>::const_iterator it = m_changeLog.begin();
+		for (; it != m_changeLog.end(); ++it) {
+			changes.push_back(it->changes);
+		}
+		return changes;
+	}
+
+	std::vector<int32_t> Layer::getChangeLogCells(bool oldCells) const {
+		std::vector<int32_t> cells;
+		cells.reserve(m_changeLog.size() * 3);
+		std::vector<InstanceChangeRecord>::const_iterator it = m_changeLog.begin();
+		for (; it != m_changeLog.end(); ++it) {
+			const ModelCoordinate& cell = oldCells ? it->oldCell : it->newCell;
+			cells.push_back(cell.x);
+			cells.push_back(cell.y);
+			cells.push_back(cell.z);
+		}
+		return cells;
+	}
+
 	void Layer::setStatic(bool stati) {
 		m_static = stati;
 	}
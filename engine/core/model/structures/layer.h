@@ -40,6 +40,7 @@
 #include "model/metamodel/object.h"
 
 #include "instance.h"
+#include "instancetree.h"
 
 namespace FIFE {
 
@@ -66,6 +67,34 @@ namespace FIFE {
 		SORTING_CAMERA_AND_LOCATION
 	};
 
+	/** One entry of the layer change log, @see Layer::setChangeLogEnabled
+	 */
+	struct InstanceChangeRecord {
+		InstanceChangeRecord():
+			instance(NULL),
+			instanceId(0),
+			changes(ICHANGE_NO_CHANGES) {
+		}
+		InstanceChangeRecord(Instance* instance, InstanceChangeInfo changes, const ModelCoordinate& oldCell, const ModelCoordinate& newCell):
+			instance(instance),
+			instanceId(instance->getFifeId()),
+			changes(changes),
+			oldCell(oldCell),
+			newCell(newCell) {
+		}
+
+		//! changed instance
+		Instance* instance;
+		//! fife id of the changed instance
+		fifeid_t instanceId;
+		//! all changes of the instance during the update, @see InstanceChangeType
+		InstanceChangeInfo changes;
+		//! cell before the update
+		ModelCoordinate oldCell;
+		//! cell after the update, differs from oldCell only if ICHANGE_CELL is set
+		ModelCoordinate newCell;
+	};
+
 	/** Listener interface for changes happening on a layer
 	 */
 	class LayerChangeListener {
@@ -73,6 +102,7 @@ namespace FIFE {
 		virtual ~LayerChangeListener() {};
 
 		/** Called when some instance is changed on layer. @see InstanceChangeType
+		 * Change log listeners get onLayerChangeLog instead.
 		 * @param layer where change occurred
 		 * @param changedInstances list of instances containing some changes
 		 * @note Does not report creations and deletions
@@ -85,15 +115,58 @@ namespace FIFE {
 		 */
 		virtual void onInstanceCreate(Layer* layer, Instance* instance) = 0;
 
+		/** Called when a batch of instances gets created on layer, @see Layer::createInstances
+		 * The default implementation calls onInstanceCreate for each instance,
+		 * listeners can override it to handle the whole batch at once.
+		 * @param layer where change occurred
+		 * @param instances which got created
+		 */
+		virtual void onInstancesCreate(Layer* layer, std::vector<Instance*>& instances) {
+			std::vector<Instance*>::iterator it = instances.begin();
+			for (; it != instances.end(); ++it) {
+				onInstanceCreate(layer, *it);
+			}
+		}
+
 		/** Called when some instance gets deleted on layer
 		 * @param layer where change occurred
 		 * @param instance which will be deleted
 		 * @note right after this call, instance actually gets deleted!
 		 */
 		virtual void onInstanceDelete(Layer* layer, Instance* instance) = 0;
+
+		/** Called once per update with the change log of the layer, if it is enabled.
+		 * Only listeners that were added as change log listeners are called, they get
+		 * this call instead of onLayerChanged. The default implementation does nothing.
+		 * @see Layer::addChangeListener, Layer::setChangeLogEnabled
+		 * @param layer where changes occurred
+		 * @param changes one record per changed instance
+		 */
+		virtual void onLayerChangeLog(Layer* layer, const std::vector<InstanceChangeRecord>& changes) {
+		}
 	};
 
 
+	/** Describes an instance for Layer::createInstances
+	 */
+	struct InstanceCreationInfo {
+		InstanceCreationInfo():
+			object(NULL) {
+		}
+		InstanceCreationInfo(Object* object, const ExactModelCoordinate& coordinate, const std::string& id=""):
+			object(object),
+			coordinate(coordinate),
+			id(id) {
+		}
+
+		//! object of the new instance
+		Object* object;
+		//! position on the layer
+		ExactModelCoordinate coordinate;
+		//! identifier of the new instance
+		std::string id;
+	};
+
 	/** A basic layer on a map
 	 */
 	class Layer : public FifeClass {
@@ -147,6 +220,13 @@ namespace FIFE {
 			 */
 			Instance* createInstance(Object* object, const ExactModelCoordinate& p, const std::string& id="");
 
+			/** Add a batch of instances. Much faster than calling createInstance for each of them,
+			 * as storage is reserved once and the LayerChangeListeners are notified once per batch.
+			 * @param infos The instances that should be created.
+			 * @return The created instances, in the order of infos.
+			 */
+			std::vector<Instance*> createInstances(const std::vector<InstanceCreationInfo>& infos);
+
 			/** Add a valid instance at a specific position. This is temporary. It will be moved to a higher level
 			later so that we can ensure that each Instance only lives in one layer.
 			 */
@@ -160,6 +240,12 @@ namespace FIFE {
 			 */
 			void deleteInstance(Instance* instance);
 
+			/** Removes a batch of instances from the layer and deletes them.
+			 * Same as deleteInstance() for each instance, but the instance list
+			 * is only searched once.
+			 */
+			void deleteInstances(const std::vector<Instance*>& instances);
+
 			/** Get the list of instances on this layer
 			 */
 			const std::vector<Instance*>& getInstances() const;
@@ -284,6 +370,17 @@ namespace FIFE {
 			 */
 			SortingStrategy getSortingStrategy() const;
 
+			/** Sets the spatial index that is used to find instances on the layer.
+			 * The index is rebuilt from the current instances.
+			 * @see SpatialIndexStrategy
+			 */
+			void setSpatialIndexStrategy(SpatialIndexStrategy strategy);
+
+			/** Gets the spatial index strategy of the layer
+			 * @see SpatialIndexStrategy
+			 */
+			SpatialIndexStrategy getSpatialIndexStrategy() const;
+
 			/** Sets walkable for the layer. Only a walkable layer, can create a CellCache and
 			 *  only on a walkable, instances can move. Also interact layer can only be added to walkables.
 			 * @param walkable A boolean that mark a layer as walkable.
@@ -342,8 +439,10 @@ namespace FIFE {
 
 			/** Adds new change listener
 			* @param listener to add
+			* @param changeLog true if the listener gets the change log by onLayerChangeLog
+			* instead of the changed instances by onLayerChanged, @see setChangeLogEnabled
 			*/
-			void addChangeListener(LayerChangeListener* listener);
+			void addChangeListener(LayerChangeListener* listener, bool changeLog = false);
 
 			/** Removes associated change listener
 			* @param listener to remove
@@ -359,6 +458,54 @@ namespace FIFE {
 			 */
 			std::vector<Instance*>& getChangedInstances();
 
+			/** Enables or disables the change log.
+			 * If enabled, each update records one InstanceChangeRecord per changed instance
+			 * and hands the whole log to the change log listeners in one onLayerChangeLog call.
+			 * Consumers of the log do not need per instance or per cell listeners.
+			 * @param enabled A boolean, true to enable the log, otherwise false.
+			 */
+			void setChangeLogEnabled(bool enabled);
+
+			/** Returns true, if the change log is enabled.
+			 * @return A boolean, true if the change log is enabled, otherwise false.
+			 */
+			bool isChangeLogEnabled() const;
+
+			/** Returns the change log of the previous update round.
+			 * @note Records of instances that are removed or deleted afterwards are dropped.
+			 * @return A const reference to the vector of change records.
+			 */
+			const std::vector<InstanceChangeRecord>& getChangeLog() const;
+
+			/** Returns the instances of the change log, in log order.
+			 * @return A vector that contains the changed instances.
+			 */
+			std::vector<Instance*> getChangeLogInstances() const;
+
+			/** Returns the change flags of the change log, in log order. @see InstanceChangeType
+			 * @return A vector that contains the change flags.
+			 */
+			std::vector<uint32_t> getChangeLogChanges() const;
+
+			/** Returns the cells of the change log, in log order.
+			 * @param oldCells A boolean, true for the cells before the update, false for the cells after it.
+			 * @return A vector that contains x, y and z of each cell one after the other.
+			 */
+			std::vector<int32_t> getChangeLogCells(bool oldCells) const;
+
+			/** Sets the update interval of instances that no camera shows.
+			 * Such instances are only updated when the interval has passed, when they are
+			 * changed from outside or when their action or say text ends. Moving instances
+			 * are updated every round. 0 updates all instances every round, that's the default.
+			 * @param interval The interval in milliseconds of game time.
+			 * @see Instance::getUpdateDelay()
+			 */
+			void setOffscreenUpdateInterval(uint32_t interval);
+
+			/** Returns the update interval of instances that no camera shows, 0 means every round.
+			 */
+			uint32_t getOffscreenUpdateInterval() const;
+
 			/** Sets the activity status for given instance on this layer.
 			 * @param instance A pointer to the Instance whose activity is to be changed.
 			 * @param active A boolean, true if the instance should be set active otherwise false.
@@ -378,6 +525,22 @@ namespace FIFE {
 			bool isStatic();
 
 		protected:
+			/** Informs the listeners about the removal of an instance and takes it out of the
+			 * active list, the change log and the instance tree. The instance list is left as it is.
+			 * @param instance A pointer to the instance which gets removed or deleted.
+			 */
+			void releaseInstance(Instance* instance);
+
+			/** Removes the change log records of the given instance.
+			 * @param instance A pointer to the instance which gets removed or deleted.
+			 */
+			void removeChangeLogRecords(Instance* instance);
+
+			/** Returns true, if the listener was added as change log listener.
+			 * @param listener A pointer to the listener.
+			 */
+			bool isChangeLogListener(LayerChangeListener* listener) const;
+
 			//! string identifier
 			std::string m_id;
 			//! pointer to map
@@ -388,8 +551,12 @@ namespace FIFE {
 			uint8_t m_transparency;
 			//! all the instances on this layer
 			std::vector<Instance*> m_instances;
-			//! all the active instances on this layer
-			std::set<Instance*> m_activeInstances;
+			//! all the active instances on this layer, instances know their index in it
+			std::vector<Instance*> m_activeInstances;
+			//! map time of the next update of each active instance, if off-screen instances are delayed
+			std::vector<uint32_t> m_activeUpdateTimes;
+			//! true while the active instances are updated, removed entries are only set to NULL then
+			bool m_updatingInstances;
 			//! The instance tree
 			InstanceTree* m_instanceTree;
 			//! layer's cellgrid
@@ -410,8 +577,16 @@ namespace FIFE {
 			CellCache* m_cellCache;
 			//! listeners for layer changes
 			std::vector<LayerChangeListener*> m_changeListeners;
+			//! listeners that get the change log instead of the changed instances, subset of m_changeListeners
+			std::vector<LayerChangeListener*> m_changeLogListeners;
 			//! holds changed instances after each update
 			std::vector<Instance*> m_changedInstances;
+			//! true if the change log is recorded
+			bool m_changeLogEnabled;
+			//! holds one record per changed instance after each update, if enabled
+			std::vector<InstanceChangeRecord> m_changeLog;
+			//! update interval of off-screen instances, 0 if they are updated every round
+			uint32_t m_offscreenUpdateInterval;
 			//! true if layer (or it's instance) information was changed during previous update round
 			bool m_changed;
 			//! true if layer is static
@@ -48,13 +48,38 @@ namespace FIFE {
 		SORTING_CAMERA_AND_LOCATION
 	};
 
+	enum SpatialIndexStrategy {
+		SPATIAL_QUADTREE,
+		SPATIAL_GRID
+	};
+
+	struct InstanceCreationInfo {
+		InstanceCreationInfo();
+		InstanceCreationInfo(Object* object, const ExactModelCoordinate& coordinate, const std::string& id="");
+
+		Object* object;
+		ExactModelCoordinate coordinate;
+		std::string id;
+	};
+
+	struct InstanceChangeRecord {
+		InstanceChangeRecord();
+
+		Instance* instance;
+		uint32_t changes;
+		ModelCoordinate oldCell;
+		ModelCoordinate newCell;
+	};
+
 	%feature("director") LayerChangeListener;
 	class LayerChangeListener {
 	public:
 		virtual ~LayerChangeListener() {};
 		virtual void onLayerChanged(Layer* layer, std::vector<Instance*>& changedInstances) = 0;
 		virtual void onInstanceCreate(Layer* layer, Instance* instance) = 0;
+		virtual void onInstancesCreate(Layer* layer, std::vector<Instance*>& instances);
 		virtual void onInstanceDelete(Layer* layer, Instance* instance) = 0;
+		virtual void onLayerChangeLog(Layer* layer, const std::vector<InstanceChangeRecord>& changes);
 	};
 	
 
@@ -73,8 +98,10 @@ namespace FIFE {
 			bool hasInstances() const;
 			Instance* createInstance(Object* object, const ModelCoordinate& p, const std::string& id="");
 			Instance* createInstance(Object* object, const ExactModelCoordinate& p, const std::string& id="");
+			std::vector<Instance*> createInstances(const std::vector<InstanceCreationInfo>& infos);
 			bool addInstance(Instance* instance, const ExactModelCoordinate& p);
 			void deleteInstance(Instance* object);
+			void deleteInstances(const std::vector<Instance*>& instances);
 			void removeInstance(Instance* object);
 
 			const std::vector<Instance*>& getInstances() const;
@@ -101,6 +128,9 @@ namespace FIFE {
 			void setSortingStrategy(SortingStrategy strategy);
 			SortingStrategy getSortingStrategy() const;
 
+			void setSpatialIndexStrategy(SpatialIndexStrategy strategy);
+			SpatialIndexStrategy getSpatialIndexStrategy() const;
+
 			void setWalkable(bool walkable);
 			bool isWalkable();
 			
@@ -116,12 +146,25 @@ namespace FIFE {
 			CellCache* getCellCache();
 			void destroyCellCache();
 			
-			void addChangeListener(LayerChangeListener* listener);
+			void addChangeListener(LayerChangeListener* listener, bool changeLog = false);
 			void removeChangeListener(LayerChangeListener* listener);
 			bool isChanged();
 			std::vector<Instance*>& getChangedInstances();
+			void setChangeLogEnabled(bool enabled);
+			bool isChangeLogEnabled() const;
+			const std::vector<InstanceChangeRecord>& getChangeLog() const;
+			std::vector<Instance*> getChangeLogInstances() const;
+			std::vector<uint32_t> getChangeLogChanges() const;
+			std::vector<int32_t> getChangeLogCells(bool oldCells) const;
+			void setOffscreenUpdateInterval(uint32_t interval);
+			uint32_t getOffscreenUpdateInterval() const;
 
 			void setStatic(bool stati);
 			bool isStatic();
 	};
 }
+
+namespace std {
+	%template(InstanceCreationInfoVector) vector<FIFE::InstanceCreationInfo>;
+	%template(InstanceChangeRecordVector) vector<FIFE::InstanceChangeRecord>;
+}
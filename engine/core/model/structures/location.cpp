@@ -40,10 +40,13 @@ namespace FIFE {
 		reset();
 	}
 
-	Location::Location(const Location& loc) {
-		reset();
-		m_layer = loc.m_layer;
-		m_exact_layer_coords = loc.m_exact_layer_coords;
+	Location::Location(const Location& loc):
+		m_layer(loc.m_layer),
+		m_exact_layer_coords(loc.m_exact_layer_coords),
+		m_layer_coords(loc.m_layer_coords),
+		m_map_coords(loc.m_map_coords),
+		m_layerCoordsVersion(loc.m_layerCoordsVersion),
+		m_mapCoordsVersion(loc.m_mapCoordsVersion) {
 	}
 	
 	Location::Location(Layer* layer) {
@@ -59,6 +62,7 @@ namespace FIFE {
 		m_exact_layer_coords.y = 0;
 		m_exact_layer_coords.z = 0;
 		m_layer = NULL;
+		invalidateCache();
 	}
 	
 	Location& Location::operator=(const Location& rhs) {
@@ -66,6 +70,10 @@ namespace FIFE {
 		m_exact_layer_coords.x = rhs.m_exact_layer_coords.x;
 		m_exact_layer_coords.y = rhs.m_exact_layer_coords.y;
 		m_exact_layer_coords.z = rhs.m_exact_layer_coords.z;
+		m_layer_coords = rhs.m_layer_coords;
+		m_map_coords = rhs.m_map_coords;
+		m_layerCoordsVersion = rhs.m_layerCoordsVersion;
+		m_mapCoordsVersion = rhs.m_mapCoordsVersion;
 		return *this;
 	}
 	
@@ -77,7 +85,10 @@ namespace FIFE {
 	}
 		
 	void Location::setLayer(Layer* layer) {
-		m_layer = layer;
+		if (m_layer != layer) {
+			m_layer = layer;
+			invalidateCache();
+		}
 	}
 	
 	Layer* Location::getLayer() const {
@@ -89,6 +100,7 @@ namespace FIFE {
 			throw NotSet(INVALID_LAYER_SET);
 		}
 		m_exact_layer_coords = coordinates;
+		invalidateCache();
 	}
 	
 	void Location::setLayerCoordinates(const ModelCoordinate& coordinates) {
@@ -100,9 +112,10 @@ namespace FIFE {
 			throw NotSet(INVALID_LAYER_SET);
 		}
 		m_exact_layer_coords = m_layer->getCellGrid()->toExactLayerCoordinates(coordinates);
+		invalidateCache();
 	}
 	
-	ExactModelCoordinate& Location::getExactLayerCoordinatesRef() {
+	const ExactModelCoordinate& Location::getExactLayerCoordinatesRef() const {
 		return m_exact_layer_coords;
 	}
 	
@@ -111,11 +124,21 @@ namespace FIFE {
 	}
 	
 	ModelCoordinate Location::getLayerCoordinates() const {
-		return m_layer->getCellGrid()->toLayerCoordinatesFromExactLayerCoordinates(m_exact_layer_coords);
+		CellGrid* grid = m_layer->getCellGrid();
+		if (m_layerCoordsVersion != grid->getVersion()) {
+			m_layer_coords = grid->toLayerCoordinatesFromExactLayerCoordinates(m_exact_layer_coords);
+			m_layerCoordsVersion = grid->getVersion();
+		}
+		return m_layer_coords;
 	}
 	
 	ExactModelCoordinate Location::getMapCoordinates() const {
-		return m_layer->getCellGrid()->toMapCoordinates(m_exact_layer_coords);
+		CellGrid* grid = m_layer->getCellGrid();
+		if (m_mapCoordsVersion != grid->getVersion()) {
+			m_map_coords = grid->toMapCoordinates(m_exact_layer_coords);
+			m_mapCoordsVersion = grid->getVersion();
+		}
+		return m_map_coords;
 	}
 	
 	bool Location::isValid() const {
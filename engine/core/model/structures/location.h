@@ -113,11 +113,12 @@ namespace FIFE {
 		 */
 		void setMapCoordinates(const ExactModelCoordinate& coordinates);
 
-		/** Gets reference to exact layer coordinates. This means that if you
-		 *  modify the coordinates, location gets modified directly
+		/** Gets read-only reference to exact layer coordinates. Use
+		 *  setExactLayerCoordinates to modify them, so the cached layer and map
+		 *  coordinates are refreshed.
 		 * @return reference to exact layer coordinates
 		 */
-		ExactModelCoordinate& getExactLayerCoordinatesRef();
+		const ExactModelCoordinate& getExactLayerCoordinatesRef() const;
 		
 		/** Gets exact layer coordinates set to this location
 		 * @return exact layer coordinates
@@ -133,6 +134,7 @@ namespace FIFE {
 		ExactModelCoordinate getExactLayerCoordinates(const Layer* layer) const;
 		
 		/** Gets cell precision layer coordinates set to this location
+		 * The result is cached until the coordinates, the layer or the cellgrid change.
 		 * @see getExactLayerCoordinates()
 		 */
 		ModelCoordinate getLayerCoordinates() const;
@@ -143,6 +145,7 @@ namespace FIFE {
 		ModelCoordinate getLayerCoordinates(const Layer* layer) const;
 		
 		/** Gets map coordinates set to this location
+		 * The result is cached until the coordinates, the layer or the cellgrid change.
 		 * @return map coordinates
 		 */
 		ExactModelCoordinate getMapCoordinates() const;
@@ -172,9 +175,24 @@ namespace FIFE {
 		
 	private:
 		bool isValid(const Layer* layer) const;
+
+		/** Marks the cached layer and map coordinates as outdated.
+		 */
+		void invalidateCache() {
+			m_layerCoordsVersion = 0;
+			m_mapCoordsVersion = 0;
+		}
 		
 		Layer* m_layer;
 		ExactModelCoordinate m_exact_layer_coords;
+		// The cache is filled by the const getters, so one location must not be read
+		// from several threads at once. Copies can be used in parallel.
+		//! cached layer coordinates, valid if m_layerCoordsVersion matches the cellgrid version
+		mutable ModelCoordinate m_layer_coords;
+		//! cached map coordinates, valid if m_mapCoordsVersion matches the cellgrid version
+		mutable ExactModelCoordinate m_map_coords;
+		mutable uint32_t m_layerCoordsVersion;
+		mutable uint32_t m_mapCoordsVersion;
 	};
 	
 	/** Stream output operator.
@@ -53,7 +53,7 @@ namespace FIFE {
 		void setLayerCoordinates(const ModelCoordinate& coordinates);
 		void setMapCoordinates(const ExactModelCoordinate& coordinates);
 		
-		ExactModelCoordinate& getExactLayerCoordinatesRef();
+		const ExactModelCoordinate& getExactLayerCoordinatesRef() const;
 		ExactModelCoordinate getExactLayerCoordinates() const;
 		ExactModelCoordinate getExactLayerCoordinates(const Layer* layer) const;
 		
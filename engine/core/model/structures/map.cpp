@@ -32,6 +32,7 @@
 #include "util/base/exception.h"
 #include "util/structures/purge.h"
 #include "util/structures/rect.h"
+#include "util/time/profiler.h"
 #include "view/camera.h"
 #include "view/rendererbase.h"
 #include "video/renderbackend.h"
@@ -40,6 +41,7 @@
 #include "layer.h"
 #include "cellcache.h"
 #include "instance.h"
+#include "mapstreamer.h"
 #include "triggercontroller.h"
 
 namespace FIFE {
@@ -53,12 +55,20 @@ namespace FIFE {
 		m_changedLayers(),
 		m_renderBackend(renderBackend),
 		m_renderers(renderers),
-		m_changed(false) {
+		m_changed(false),
+		m_streamer(NULL),
+		m_updateThreads(1),
+		m_tickCount(0),
+		m_interpolation(1.0),
+		m_cameraViewChanged(false) {
 
 		m_triggerController = new TriggerController(this);
 	}
 
 	Map::~Map() {
+		// the streamer listens to the layers
+		delete m_streamer;
+		m_streamer = NULL;
 		delete m_triggerController;
 		// remove all cameras
 		std::vector<Camera*>::iterator iter = m_cameras.begin();
@@ -111,6 +121,9 @@ namespace FIFE {
 					(*i)->onLayerDelete(this, layer);
 					++i;
 				}
+				if (m_streamer) {
+					m_streamer->removeLayer(layer);
+				}
 				delete layer;
 				m_layers.erase(it);
 				return ;
@@ -128,6 +141,9 @@ namespace FIFE {
 				(*i)->onLayerDelete(this, *temp_it);
 				++i;
 			}
+			if (m_streamer) {
+				m_streamer->removeLayer(*temp_it);
+			}
 			std::list<Layer*>::iterator it = m_layers.begin();
 			for(; it != m_layers.end(); ++it) {
 				if(*it == *temp_it) {
@@ -172,6 +188,31 @@ namespace FIFE {
 	}
 
 	bool Map::update() {
+		bool changed = updateSimulation();
+		updateCameras();
+		return changed;
+	}
+
+	bool Map::updateSimulation() {
+		++m_tickCount;
+		// layers that delay off-screen instances need to know what the cameras show
+		std::vector<Rect> viewPorts;
+		if (m_renderBackend) {
+			std::vector<Camera*>::iterator camIter = m_cameras.begin();
+			for ( ; camIter != m_cameras.end(); ++camIter) {
+				if ((*camIter)->isEnabled()) {
+					viewPorts.push_back((*camIter)->getMapViewPort());
+				}
+			}
+		}
+		m_cameraViewChanged = viewPorts != m_cameraViewPorts;
+		if (m_cameraViewChanged) {
+			m_cameraViewPorts.swap(viewPorts);
+		}
+		// load and unload instances before the layers update them
+		if (m_streamer) {
+			m_streamer->update();
+		}
 		m_changedLayers.clear();
 		// transfer instances from one layer to another
 		if (!m_transferInstances.empty()) {
@@ -192,6 +233,7 @@ namespace FIFE {
 		std::list<Layer*>::iterator it = m_layers.begin();
 		// update Layers
 		for(; it != m_layers.end(); ++it) {
+			FIFE_PROFILE_ZONE((*it)->getId());
 			if ((*it)->update()) {
 				m_changedLayers.push_back(*it);
 			}
@@ -213,18 +255,37 @@ namespace FIFE {
 			}
 		}
 
+		bool retval = m_changed;
+		m_changed = false;
+		return retval;
+	}
+
+	void Map::updateCameras(double interpolation) {
+		m_interpolation = interpolation;
+		// a headless map has no backend to render with
+		if (!m_renderBackend) {
+			return;
+		}
 		// loop over cameras and update if enabled
 		std::vector<Camera*>::iterator camIter = m_cameras.begin();
 		for ( ; camIter != m_cameras.end(); ++camIter) {
 			if ((*camIter)->isEnabled()) {
+				FIFE_PROFILE_ZONE((*camIter)->getId());
 				(*camIter)->update();
 				(*camIter)->render();
 			}
 		}
+	}
 
-		bool retval = m_changed;
-		m_changed = false;
-		return retval;
+	bool Map::isInCameraViewPort(const ExactModelCoordinate& coords) const {
+		std::vector<Rect>::const_iterator it = m_cameraViewPorts.begin();
+		for (; it != m_cameraViewPorts.end(); ++it) {
+			if (coords.x >= it->x && coords.x <= it->right() &&
+				coords.y >= it->y && coords.y <= it->bottom()) {
+				return true;
+			}
+		}
+		return false;
 	}
 
 	void Map::addChangeListener(MapChangeListener* listener) {
@@ -354,5 +415,12 @@ namespace FIFE {
 			}
 		}
 	}
+
+	void Map::setStreamer(MapStreamer* streamer) {
+		if (m_streamer != streamer) {
+			delete m_streamer;
+			m_streamer = streamer;
+		}
+	}
 } //FIFE
 
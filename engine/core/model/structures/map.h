@@ -50,6 +50,7 @@ namespace FIFE {
 	class Camera;
 	class Instance;
 	class TriggerController;
+	class MapStreamer;
 
 	/** Listener interface for changes happening on map
 	 */
@@ -138,10 +139,49 @@ namespace FIFE {
 			void getMinMaxCoordinates(ExactModelCoordinate& min, ExactModelCoordinate& max);
 
 			/** Called periodically to update events on map
+			 * Same as updateSimulation() followed by updateCameras().
 			 * @returns true, if map was changed
 			 */
 			bool update();
 
+			/** Runs one simulation tick: moves the instances, updates the cell caches
+			 * and informs the change listeners, without rendering.
+			 * @returns true, if map was changed
+			 */
+			bool updateSimulation();
+
+			/** Updates and renders the enabled cameras.
+			 * @param interpolation Position of the rendered frame between the previous and
+			 * the latest simulation tick, from 0 to 1. Values below 1 make the cameras
+			 * interpolate moving instances, 1 renders the latest tick as it is.
+			 */
+			void updateCameras(double interpolation = 1.0);
+
+			/** Returns the number of simulation ticks run so far.
+			 */
+			uint32_t getTickCount() const { return m_tickCount; }
+
+			/** Returns the interpolation of the latest camera update. @see updateCameras
+			 */
+			double getInterpolation() const { return m_interpolation; }
+
+			/** Returns true if an enabled camera showed the given position on the last update.
+			 * @param coords The position in map coordinates.
+			 */
+			bool isInCameraViewPort(const ExactModelCoordinate& coords) const;
+
+			/** Returns true if an enabled camera was found on the last update.
+			 */
+			bool hasCameraViewPorts() const { return !m_cameraViewPorts.empty(); }
+
+			/** Returns the map viewports of the enabled cameras, taken at the start of the last tick.
+			 */
+			const std::vector<Rect>& getCameraViewPorts() const { return m_cameraViewPorts; }
+
+			/** Returns true if the camera viewports differ from the ones of the update before.
+			 */
+			bool isCameraViewChanged() const { return m_cameraViewChanged; }
+
 			/** Sets speed for the map. See Model::setTimeMultiplier.
 			 */
 			void setTimeMultiplier(float multip) { m_timeProvider.setMultiplier(multip); }
@@ -219,6 +259,25 @@ namespace FIFE {
 			 */
 			TriggerController* getTriggerController() const { return m_triggerController; };
 
+			/** Sets the streamer that loads and unloads the instances around the cameras.
+			 * The map takes the ownership and deletes a previous streamer, NULL disables streaming.
+			 */
+			void setStreamer(MapStreamer* streamer);
+
+			/** Returns the streamer, NULL if the map is not streamed.
+			 */
+			MapStreamer* getStreamer() const { return m_streamer; }
+
+			/** Sets the number of threads the layers use to update their instances in parallel.
+			 * It limits the number of chunks the JobSystem splits the update into,
+			 * 0 or 1 disables the parallel update. @see Model::setUpdateThreadCount
+			 */
+			void setUpdateThreadCount(uint32_t threads) { m_updateThreads = threads; }
+
+			/** Gets the number of threads the layers use to update their instances.
+			 */
+			uint32_t getUpdateThreadCount() const { return m_updateThreads; }
+
 		private:
 			std::string m_id;
 			std::string m_filename;
@@ -251,6 +310,24 @@ namespace FIFE {
 			std::map<Instance*, Location> m_transferInstances;
 
 			TriggerController* m_triggerController;
+
+			//! loads and unloads instances around the cameras, can be NULL
+			MapStreamer* m_streamer;
+
+			//! number of chunks for the parallel layer update, set by the model
+			uint32_t m_updateThreads;
+
+			//! number of simulation ticks
+			uint32_t m_tickCount;
+
+			//! interpolation between the last two ticks used by the latest camera update
+			double m_interpolation;
+
+			//! map viewports of the enabled cameras, taken at the start of each tick
+			std::vector<Rect> m_cameraViewPorts;
+
+			//! true if m_cameraViewPorts changed on the last tick
+			bool m_cameraViewChanged;
 	};
 
 }
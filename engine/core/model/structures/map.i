@@ -42,6 +42,7 @@ namespace FIFE {
 	class Map;
 	class Rect;
 	class TriggerController;
+	class MapStreamer;
 
 	%feature("director") MapChangeListener;
 	class MapChangeListener {
@@ -74,6 +75,9 @@ namespace FIFE {
 
 			void setTimeMultiplier(float multip);
 			double getTimeMultiplier() const;
+
+			uint32_t getTickCount() const;
+			double getInterpolation() const;
 			
 			void addChangeListener(MapChangeListener* listener);
 			void removeChangeListener(MapChangeListener* listener);
@@ -91,5 +95,6 @@ namespace FIFE {
 			void finalizeCellCaches();
 
 			TriggerController* getTriggerController() const;
+			MapStreamer* getStreamer() const;
 	};
 }
@@ -0,0 +1,532 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cmath>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/object.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "util/time/profiler.h"
+#include "view/visual.h"
+
+#include "instance.h"
+#include "layer.h"
+#include "location.h"
+#include "map.h"
+#include "mapstreamer.h"
+
+namespace FIFE {
+
+	static Logger _log(LM_STRUCTURES);
+
+	static uint64_t chunkKey(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	static ModelCoordinate chunkFromKey(uint64_t key) {
+		return ModelCoordinate(static_cast<int32_t>(static_cast<uint32_t>(key >> 32)),
+			static_cast<int32_t>(static_cast<uint32_t>(key)));
+	}
+
+	/** Returns the main instance for parts of multi object instances, so they are unloaded together.
+	 */
+	static Instance* getStreamedMainInstance(Instance* instance) {
+		Instance* main = instance->getMainMultiInstance();
+		return main ? main : instance;
+	}
+
+	static StreamedInstance toStreamedInstance(Instance* instance) {
+		StreamedInstance streamed;
+		streamed.object = instance->getBaseObject();
+		streamed.coordinate = instance->getLocationRef().getExactLayerCoordinates();
+		streamed.id = instance->getId();
+		streamed.rotation = instance->getRotation();
+		InstanceVisual* visual = instance->getVisual<InstanceVisual>();
+		if (visual) {
+			streamed.stackPosition = visual->getStackPosition();
+		}
+		streamed.cellStackPosition = instance->getCellStackPosition();
+		if (instance->isSpecialCost()) {
+			streamed.costId = instance->getCostId();
+			streamed.cost = instance->getCost();
+		}
+		return streamed;
+	}
+
+	void MemoryChunkSource::addInstance(const std::string& layerId, const ModelCoordinate& chunk, const StreamedInstance& instance) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_chunks[ChunkId(layerId, std::make_pair(chunk.x, chunk.y))].push_back(instance);
+	}
+
+	uint32_t MemoryChunkSource::getInstanceCount(const std::string& layerId, const ModelCoordinate& chunk) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::map<ChunkId, std::vector<StreamedInstance> >::const_iterator it =
+			m_chunks.find(ChunkId(layerId, std::make_pair(chunk.x, chunk.y)));
+		return it != m_chunks.end() ? it->second.size() : 0;
+	}
+
+	void MemoryChunkSource::loadChunk(const std::string& layerId, const ModelCoordinate& chunk, std::vector<StreamedInstance>& instances) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::map<ChunkId, std::vector<StreamedInstance> >::const_iterator it =
+			m_chunks.find(ChunkId(layerId, std::make_pair(chunk.x, chunk.y)));
+		if (it != m_chunks.end()) {
+			instances = it->second;
+		}
+	}
+
+	void MemoryChunkSource::saveChunk(const std::string& layerId, const ModelCoordinate& chunk, const std::vector<StreamedInstance>& instances) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		ChunkId id(layerId, std::make_pair(chunk.x, chunk.y));
+		if (instances.empty()) {
+			m_chunks.erase(id);
+		} else {
+			m_chunks[id] = instances;
+		}
+	}
+
+	MapStreamer::MapStreamer(Map* map, MapChunkSource* source, uint32_t chunkSize):
+		m_map(map),
+		m_source(source),
+		m_chunkSize(chunkSize),
+		m_loadRadius(chunkSize),
+		m_unloadRadius(chunkSize * 2),
+		m_saveOnUnload(false),
+		m_pending(0),
+		m_stop(false) {
+
+		if (m_chunkSize == 0) {
+			delete m_source;
+			throw NotSupported("MapStreamer needs a chunk size above 0");
+		}
+		m_thread = std::thread(&MapStreamer::streamingLoop, this);
+	}
+
+	MapStreamer::~MapStreamer() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wakeCondition.notify_all();
+		m_thread.join();
+
+		std::deque<ChunkJob*>::iterator jobIt = m_requests.begin();
+		for (; jobIt != m_requests.end(); ++jobIt) {
+			delete *jobIt;
+		}
+		for (jobIt = m_results.begin(); jobIt != m_results.end(); ++jobIt) {
+			delete *jobIt;
+		}
+		std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			(*it)->layer->removeChangeListener(this);
+			delete *it;
+		}
+		delete m_source;
+	}
+
+	void MapStreamer::addLayer(Layer* layer) {
+		std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			if ((*it)->layer == layer) {
+				return;
+			}
+		}
+		StreamedLayer* streamed = new StreamedLayer();
+		streamed->layer = layer;
+		m_layers.push_back(streamed);
+		layer->addChangeListener(this);
+	}
+
+	void MapStreamer::removeLayer(Layer* layer) {
+		std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			if ((*it)->layer == layer) {
+				break;
+			}
+		}
+		if (it == m_layers.end()) {
+			return;
+		}
+		layer->removeChangeListener(this);
+		delete *it;
+		m_layers.erase(it);
+
+		// chunks the streaming thread reads right now are dropped by processLoadedChunks()
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::deque<ChunkJob*>::iterator jobIt = m_requests.begin();
+		while (jobIt != m_requests.end()) {
+			if ((*jobIt)->layer == layer) {
+				delete *jobIt;
+				jobIt = m_requests.erase(jobIt);
+				--m_pending;
+			} else {
+				++jobIt;
+			}
+		}
+	}
+
+	ModelCoordinate MapStreamer::getChunk(const ExactModelCoordinate& coordinate) const {
+		double size = static_cast<double>(m_chunkSize);
+		return ModelCoordinate(static_cast<int32_t>(std::floor(coordinate.x / size)),
+			static_cast<int32_t>(std::floor(coordinate.y / size)));
+	}
+
+	void MapStreamer::setLoadRadius(uint32_t radius) {
+		m_loadRadius = radius;
+		m_unloadRadius = std::max(m_unloadRadius, m_loadRadius);
+	}
+
+	void MapStreamer::setUnloadRadius(uint32_t radius) {
+		m_unloadRadius = std::max(radius, m_loadRadius);
+	}
+
+	void MapStreamer::addFocusArea(const Rect& area) {
+		m_focusAreas.push_back(area);
+	}
+
+	void MapStreamer::clearFocusAreas() {
+		m_focusAreas.clear();
+	}
+
+	void MapStreamer::getChunkRanges(Layer* layer, const std::vector<Rect>& areas, uint32_t radius,
+		std::vector<ChunkRange>& ranges) const {
+
+		Location location(layer);
+		std::vector<Rect>::const_iterator it = areas.begin();
+		for (; it != areas.end(); ++it) {
+			// all four corners, the layer grid can be rotated against the map
+			ExactModelCoordinate corners[4] = {
+				ExactModelCoordinate(it->x, it->y),
+				ExactModelCoordinate(it->right(), it->y),
+				ExactModelCoordinate(it->x, it->bottom()),
+				ExactModelCoordinate(it->right(), it->bottom())
+			};
+			ExactModelCoordinate min;
+			ExactModelCoordinate max;
+			for (int32_t i = 0; i < 4; ++i) {
+				location.setMapCoordinates(corners[i]);
+				ExactModelCoordinate emc = location.getExactLayerCoordinates();
+				if (i == 0) {
+					min = emc;
+					max = emc;
+				} else {
+					min.x = std::min(min.x, emc.x);
+					min.y = std::min(min.y, emc.y);
+					max.x = std::max(max.x, emc.x);
+					max.y = std::max(max.y, emc.y);
+				}
+			}
+			min.x -= radius;
+			min.y -= radius;
+			max.x += radius;
+			max.y += radius;
+			ChunkRange range;
+			range.min = getChunk(min);
+			range.max = getChunk(max);
+			ranges.push_back(range);
+		}
+	}
+
+	void MapStreamer::update() {
+		processLoadedChunks();
+
+		std::vector<Rect> areas = m_map->getCameraViewPorts();
+		areas.insert(areas.end(), m_focusAreas.begin(), m_focusAreas.end());
+
+		bool requested = false;
+		std::vector<ChunkRange> loadRanges;
+		std::vector<ChunkRange> keepRanges;
+		std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			StreamedLayer& streamed = **it;
+			loadRanges.clear();
+			keepRanges.clear();
+			getChunkRanges(streamed.layer, areas, m_loadRadius, loadRanges);
+			getChunkRanges(streamed.layer, areas, m_unloadRadius, keepRanges);
+
+			// chunks that are still loading are unloaded on the update after they arrived
+			std::vector<ModelCoordinate> unload;
+			std::unordered_map<uint64_t, ChunkState>::iterator chunkIt = streamed.chunks.begin();
+			for (; chunkIt != streamed.chunks.end(); ++chunkIt) {
+				if (chunkIt->second != CHUNK_LOADED) {
+					continue;
+				}
+				ModelCoordinate chunk = chunkFromKey(chunkIt->first);
+				bool keep = false;
+				std::vector<ChunkRange>::const_iterator rangeIt = keepRanges.begin();
+				for (; rangeIt != keepRanges.end() && !keep; ++rangeIt) {
+					keep = rangeIt->contains(chunk.x, chunk.y);
+				}
+				if (!keep) {
+					unload.push_back(chunk);
+				}
+			}
+			if (!unload.empty()) {
+				unloadChunks(streamed, unload);
+			}
+
+			std::vector<ChunkRange>::const_iterator rangeIt = loadRanges.begin();
+			for (; rangeIt != loadRanges.end(); ++rangeIt) {
+				for (int32_t y = rangeIt->min.y; y <= rangeIt->max.y; ++y) {
+					for (int32_t x = rangeIt->min.x; x <= rangeIt->max.x; ++x) {
+						uint64_t key = chunkKey(x, y);
+						if (streamed.chunks.find(key) != streamed.chunks.end()) {
+							continue;
+						}
+						streamed.chunks[key] = CHUNK_LOADING;
+						ChunkJob* job = new ChunkJob();
+						job->layerId = streamed.layer->getId();
+						job->layer = streamed.layer;
+						job->chunk = ModelCoordinate(x, y);
+						std::lock_guard<std::mutex> lock(m_mutex);
+						m_requests.push_back(job);
+						++m_pending;
+						requested = true;
+					}
+				}
+			}
+		}
+		if (requested) {
+			m_wakeCondition.notify_all();
+		}
+	}
+
+	void MapStreamer::finishLoading() {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_doneCondition.wait(lock, [this] { return m_results.size() == m_pending; });
+		}
+		processLoadedChunks();
+	}
+
+	bool MapStreamer::isChunkLoaded(Layer* layer, const ModelCoordinate& chunk) const {
+		std::vector<StreamedLayer*>::const_iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			if ((*it)->layer == layer) {
+				std::unordered_map<uint64_t, ChunkState>::const_iterator chunkIt =
+					(*it)->chunks.find(chunkKey(chunk.x, chunk.y));
+				return chunkIt != (*it)->chunks.end() && chunkIt->second == CHUNK_LOADED;
+			}
+		}
+		return false;
+	}
+
+	uint32_t MapStreamer::getLoadedChunkCount() const {
+		uint32_t count = 0;
+		std::vector<StreamedLayer*>::const_iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			std::unordered_map<uint64_t, ChunkState>::const_iterator chunkIt = (*it)->chunks.begin();
+			for (; chunkIt != (*it)->chunks.end(); ++chunkIt) {
+				if (chunkIt->second == CHUNK_LOADED) {
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+
+	uint32_t MapStreamer::getPendingChunkCount() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pending;
+	}
+
+	void MapStreamer::onInstanceDelete(Layer* layer, Instance* instance) {
+		std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+		for (; it != m_layers.end(); ++it) {
+			if ((*it)->layer == layer) {
+				StreamedLayer& streamed = **it;
+				streamed.instances.erase(instance);
+				std::unordered_map<Instance*, RecordId>::iterator idIt = streamed.recordIds.find(instance);
+				if (idIt != streamed.recordIds.end()) {
+					std::unordered_map<uint32_t, Instance*>& chunkRecords = streamed.records[idIt->second.first];
+					chunkRecords.erase(idIt->second.second);
+					if (chunkRecords.empty()) {
+						streamed.records.erase(idIt->second.first);
+					}
+					streamed.recordIds.erase(idIt);
+				}
+				return;
+			}
+		}
+	}
+
+	void MapStreamer::createInstances(StreamedLayer& streamed, ChunkJob& job) {
+		uint64_t key = chunkKey(job.chunk.x, job.chunk.y);
+		std::unordered_map<uint32_t, Instance*>& chunkRecords = streamed.records[key];
+		std::vector<InstanceCreationInfo> infos;
+		std::vector<uint32_t> records;
+		infos.reserve(job.instances.size());
+		records.reserve(job.instances.size());
+		for (uint32_t i = 0; i < job.instances.size(); ++i) {
+			const StreamedInstance& record = job.instances[i];
+			// instances that walked into a chunk which stayed loaded still exist
+			if (record.object && chunkRecords.find(i) == chunkRecords.end()) {
+				infos.push_back(InstanceCreationInfo(record.object, record.coordinate, record.id));
+				records.push_back(i);
+			}
+		}
+
+		std::vector<Instance*> created = streamed.layer->createInstances(infos);
+		for (uint32_t i = 0; i < created.size(); ++i) {
+			Instance* instance = created[i];
+			const StreamedInstance& record = job.instances[records[i]];
+			instance->setRotation(record.rotation);
+			InstanceVisual* visual = InstanceVisual::create(instance);
+			if (visual && record.stackPosition >= 0) {
+				visual->setStackPosition(record.stackPosition);
+			}
+			if (record.cellStackPosition >= 0) {
+				instance->setCellStackPosition(static_cast<uint8_t>(record.cellStackPosition));
+			}
+			if (!record.costId.empty()) {
+				instance->setCost(record.costId, record.cost);
+			}
+			if (record.object->getAction("default")) {
+				Location target(streamed.layer);
+				instance->actRepeat("default", target);
+			}
+			streamed.instances.insert(instance);
+			const std::vector<Instance*>& parts = instance->getMultiInstances();
+			streamed.instances.insert(parts.begin(), parts.end());
+			chunkRecords[records[i]] = instance;
+			streamed.recordIds[instance] = RecordId(key, records[i]);
+		}
+		if (chunkRecords.empty()) {
+			streamed.records.erase(key);
+		}
+		streamed.chunks[key] = CHUNK_LOADED;
+	}
+
+	void MapStreamer::unloadChunks(StreamedLayer& streamed, const std::vector<ModelCoordinate>& chunks) {
+		std::unordered_map<uint64_t, std::vector<StreamedInstance> > records;
+		std::vector<ModelCoordinate>::const_iterator chunkIt = chunks.begin();
+		for (; chunkIt != chunks.end(); ++chunkIt) {
+			records[chunkKey(chunkIt->x, chunkIt->y)];
+		}
+
+		// one pass over the streamed instances, they are grouped by their current position
+		std::vector<Instance*> unloaded;
+		std::unordered_set<Instance*>::iterator it = streamed.instances.begin();
+		for (; it != streamed.instances.end(); ++it) {
+			Instance* main = getStreamedMainInstance(*it);
+			ModelCoordinate chunk = getChunk(main->getLocationRef().getExactLayerCoordinates());
+			std::unordered_map<uint64_t, std::vector<StreamedInstance> >::iterator recordIt =
+				records.find(chunkKey(chunk.x, chunk.y));
+			if (recordIt == records.end()) {
+				continue;
+			}
+			unloaded.push_back(*it);
+			if (m_saveOnUnload && main == *it) {
+				recordIt->second.push_back(toStreamedInstance(*it));
+			}
+		}
+
+		if (m_saveOnUnload) {
+			std::unordered_map<uint64_t, std::vector<StreamedInstance> >::iterator recordIt = records.begin();
+			for (; recordIt != records.end(); ++recordIt) {
+				m_source->saveChunk(streamed.layer->getId(), chunkFromKey(recordIt->first), recordIt->second);
+				// the saved chunk no longer has the records of instances that left it,
+				// they are saved with the chunk they are in now
+				std::unordered_map<uint64_t, std::unordered_map<uint32_t, Instance*> >::iterator chunkIt =
+					streamed.records.find(recordIt->first);
+				if (chunkIt != streamed.records.end()) {
+					std::unordered_map<uint32_t, Instance*>::iterator instanceIt = chunkIt->second.begin();
+					for (; instanceIt != chunkIt->second.end(); ++instanceIt) {
+						streamed.recordIds.erase(instanceIt->second);
+					}
+					streamed.records.erase(chunkIt);
+				}
+			}
+		}
+		// onInstanceDelete() removes them from the streamed instances
+		streamed.layer->deleteInstances(unloaded);
+		for (chunkIt = chunks.begin(); chunkIt != chunks.end(); ++chunkIt) {
+			streamed.chunks.erase(chunkKey(chunkIt->x, chunkIt->y));
+		}
+	}
+
+	void MapStreamer::processLoadedChunks() {
+		std::deque<ChunkJob*> results;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			results.swap(m_results);
+			m_pending -= results.size();
+		}
+
+		std::deque<ChunkJob*>::iterator jobIt = results.begin();
+		for (; jobIt != results.end(); ++jobIt) {
+			ChunkJob* job = *jobIt;
+			std::vector<StreamedLayer*>::iterator it = m_layers.begin();
+			for (; it != m_layers.end(); ++it) {
+				if ((*it)->layer == job->layer && job->layer->getId() == job->layerId) {
+					break;
+				}
+			}
+			// the layer could be removed while the chunk was read
+			if (it != m_layers.end()) {
+				std::unordered_map<uint64_t, ChunkState>::iterator chunkIt =
+					(*it)->chunks.find(chunkKey(job->chunk.x, job->chunk.y));
+				if (chunkIt != (*it)->chunks.end() && chunkIt->second == CHUNK_LOADING) {
+					createInstances(**it, *job);
+				}
+			}
+			delete job;
+		}
+	}
+
+	void MapStreamer::streamingLoop() {
+		TraceRecorder::instance()->setThreadName("streamer");
+		while (true) {
+			ChunkJob* job = NULL;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wakeCondition.wait(lock, [this] { return m_stop || !m_requests.empty(); });
+				if (m_stop) {
+					return;
+				}
+				job = m_requests.front();
+				m_requests.pop_front();
+			}
+
+			try {
+				FIFE_PROFILE_ZONE("loadChunk");
+				m_source->loadChunk(job->layerId, job->chunk, job->instances);
+			} catch (const Exception& e) {
+				FL_ERR(_log, LMsg("MapStreamer::streamingLoop() - failed to load chunk of layer ") << job->layerId << ": " << e.what());
+				job->instances.clear();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_results.push_back(job);
+			}
+			m_doneCondition.notify_all();
+		}
+	}
+}
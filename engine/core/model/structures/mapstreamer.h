@@ -0,0 +1,320 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MAP_MAPSTREAMER_H
+#define FIFE_MAP_MAPSTREAMER_H
+
+// Standard C++ library includes
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/modelcoords.h"
+#include "util/structures/rect.h"
+
+#include "layer.h"
+
+namespace FIFE {
+
+	class Map;
+	class Object;
+	class Instance;
+
+	/** State of one streamed instance, used to create it again when its chunk gets loaded.
+	 */
+	struct StreamedInstance {
+		StreamedInstance():
+			object(NULL),
+			rotation(0),
+			stackPosition(-1),
+			cellStackPosition(-1),
+			cost(0.0) {}
+
+		//! object of the instance
+		Object* object;
+		//! position in layer coordinates
+		ExactModelCoordinate coordinate;
+		//! instance id, can be empty
+		std::string id;
+		//! rotation in degrees
+		int32_t rotation;
+		//! stack position of the visual, -1 keeps the default
+		int32_t stackPosition;
+		//! cell stack position, -1 keeps the default
+		int32_t cellStackPosition;
+		//! special cost id, empty if the instance uses the cost of its object
+		std::string costId;
+		//! special cost
+		double cost;
+	};
+
+	/** Provides the instances of the chunks a MapStreamer loads.
+	 */
+	class MapChunkSource {
+	public:
+		virtual ~MapChunkSource() {}
+
+		/** Returns the instances of a chunk.
+		 * Called on the streaming thread, so it must not touch the model.
+		 * @param layerId The identifier of the layer.
+		 * @param chunk The chunk coordinate, @see MapStreamer::getChunk()
+		 * @param instances Receives the instances.
+		 */
+		virtual void loadChunk(const std::string& layerId, const ModelCoordinate& chunk, std::vector<StreamedInstance>& instances) = 0;
+
+		/** Stores the instances of a chunk that gets unloaded.
+		 * Called on the main thread, only if the streamer saves on unload.
+		 * @param layerId The identifier of the layer.
+		 * @param chunk The chunk coordinate, @see MapStreamer::getChunk()
+		 * @param instances The instances of the chunk.
+		 */
+		virtual void saveChunk(const std::string& layerId, const ModelCoordinate& chunk, const std::vector<StreamedInstance>& instances) = 0;
+	};
+
+	/** Chunk source that keeps all chunks in memory, as records instead of instances.
+	 */
+	class MemoryChunkSource : public MapChunkSource {
+	public:
+		/** Adds an instance to a chunk.
+		 */
+		void addInstance(const std::string& layerId, const ModelCoordinate& chunk, const StreamedInstance& instance);
+
+		/** Returns the number of instances stored for a chunk.
+		 */
+		uint32_t getInstanceCount(const std::string& layerId, const ModelCoordinate& chunk);
+
+		/** @see MapChunkSource::loadChunk
+		 */
+		virtual void loadChunk(const std::string& layerId, const ModelCoordinate& chunk, std::vector<StreamedInstance>& instances);
+
+		/** @see MapChunkSource::saveChunk
+		 */
+		virtual void saveChunk(const std::string& layerId, const ModelCoordinate& chunk, const std::vector<StreamedInstance>& instances);
+
+	private:
+		typedef std::pair<std::string, std::pair<int32_t, int32_t> > ChunkId;
+
+		std::mutex m_mutex;
+		std::map<ChunkId, std::vector<StreamedInstance> > m_chunks;
+	};
+
+	/** Loads and unloads the instances of layers in square chunks around the cameras.
+	 *
+	 * Chunks within the load radius of a camera viewport or a focus area are read
+	 * from the chunk source on a background thread. The instances are created on the
+	 * next update, so InstanceTree, CellCache and LayerCache get them like any other
+	 * new instances. Chunks beyond the unload radius are removed again, optionally
+	 * after saving the state of their instances back to the source.
+	 * Only instances created by the streamer are unloaded, instances added by
+	 * scripts stay on the layer.
+	 */
+	class MapStreamer : public LayerChangeListener {
+	public:
+		/** Constructor.
+		 * @param map The map that owns the streamer, @see Map::setStreamer
+		 * @param source The chunk source, the streamer takes the ownership.
+		 * @param chunkSize Edge length of a chunk in layer cells.
+		 */
+		MapStreamer(Map* map, MapChunkSource* source, uint32_t chunkSize);
+
+		/** Destructor. Waits for the streaming thread, the instances stay on the layers.
+		 */
+		virtual ~MapStreamer();
+
+		/** Adds a layer whose instances are streamed.
+		 */
+		void addLayer(Layer* layer);
+
+		/** Removes a layer from streaming, its instances stay on the layer.
+		 */
+		void removeLayer(Layer* layer);
+
+		/** Returns the chunk source.
+		 */
+		MapChunkSource* getSource() const { return m_source; }
+
+		/** Returns the edge length of a chunk in layer cells.
+		 */
+		uint32_t getChunkSize() const { return m_chunkSize; }
+
+		/** Returns the chunk that contains the given layer coordinates.
+		 */
+		ModelCoordinate getChunk(const ExactModelCoordinate& coordinate) const;
+
+		/** Sets the distance in layer cells around the viewports, whose chunks are loaded.
+		 * Default is one chunk.
+		 */
+		void setLoadRadius(uint32_t radius);
+
+		/** Returns the distance in layer cells around the viewports, whose chunks are loaded.
+		 */
+		uint32_t getLoadRadius() const { return m_loadRadius; }
+
+		/** Sets the distance in layer cells around the viewports, beyond which chunks are unloaded.
+		 * Values below the load radius are raised to it. Default is two chunks.
+		 */
+		void setUnloadRadius(uint32_t radius);
+
+		/** Returns the distance in layer cells around the viewports, beyond which chunks are unloaded.
+		 */
+		uint32_t getUnloadRadius() const { return m_unloadRadius; }
+
+		/** Sets whether unloaded chunks save the state of their instances to the source.
+		 * Otherwise they are loaded in their original state again, except for instances
+		 * that left the chunk and are still on the layer. Default is false.
+		 */
+		void setSaveOnUnload(bool save) { m_saveOnUnload = save; }
+
+		/** Returns whether unloaded chunks save the state of their instances to the source.
+		 */
+		bool isSaveOnUnload() const { return m_saveOnUnload; }
+
+		/** Adds an area in map coordinates that keeps chunks loaded like a camera viewport,
+		 * e.g. for headless simulations.
+		 */
+		void addFocusArea(const Rect& area);
+
+		/** Removes all focus areas.
+		 */
+		void clearFocusAreas();
+
+		/** Loads and unloads the chunks for the current viewports and focus areas.
+		 * Chunks read by the streaming thread in the meantime get their instances.
+		 * Called by the map at the start of each simulation tick.
+		 */
+		void update();
+
+		/** Waits until the streaming thread has read all requested chunks and creates their instances.
+		 */
+		void finishLoading();
+
+		/** Returns true if the instances of the chunk are on the layer.
+		 */
+		bool isChunkLoaded(Layer* layer, const ModelCoordinate& chunk) const;
+
+		/** Returns the number of chunks with instances on the layers.
+		 */
+		uint32_t getLoadedChunkCount() const;
+
+		/** Returns the number of chunks that are read by the streaming thread.
+		 */
+		uint32_t getPendingChunkCount() const;
+
+		// LayerChangeListener, keeps track of the streamed instances
+		virtual void onLayerChanged(Layer* layer, std::vector<Instance*>& instances) {}
+		virtual void onInstanceCreate(Layer* layer, Instance* instance) {}
+		virtual void onInstanceDelete(Layer* layer, Instance* instance);
+
+	private:
+		enum ChunkState {
+			CHUNK_LOADING,
+			CHUNK_LOADED
+		};
+
+		//! chunk and index of the record an instance was created from
+		typedef std::pair<uint64_t, uint32_t> RecordId;
+
+		struct StreamedLayer {
+			Layer* layer;
+			//! chunks that are loaded or loading, others are not in the map
+			std::unordered_map<uint64_t, ChunkState> chunks;
+			//! instances created by the streamer, they are unloaded with their chunk
+			std::unordered_set<Instance*> instances;
+			//! records of the instances on the layer, grouped by chunk,
+			//! they are skipped if the chunk is loaded again while the instance is elsewhere
+			std::unordered_map<uint64_t, std::unordered_map<uint32_t, Instance*> > records;
+			//! record of each instance in records
+			std::unordered_map<Instance*, RecordId> recordIds;
+		};
+
+		struct ChunkJob {
+			std::string layerId;
+			Layer* layer;
+			ModelCoordinate chunk;
+			std::vector<StreamedInstance> instances;
+		};
+
+		struct ChunkRange {
+			ModelCoordinate min;
+			ModelCoordinate max;
+			bool contains(int32_t x, int32_t y) const {
+				return x >= min.x && x <= max.x && y >= min.y && y <= max.y;
+			}
+		};
+
+		/** Returns the chunks around each area, the areas are in map coordinates
+		 * and the radius is in layer cells.
+		 */
+		void getChunkRanges(Layer* layer, const std::vector<Rect>& areas, uint32_t radius,
+			std::vector<ChunkRange>& ranges) const;
+
+		/** Creates the instances of a chunk read by the streaming thread.
+		 */
+		void createInstances(StreamedLayer& streamed, ChunkJob& job);
+
+		/** Removes the streamed instances of the chunks from their layer, after saving them if enabled.
+		 */
+		void unloadChunks(StreamedLayer& streamed, const std::vector<ModelCoordinate>& chunks);
+
+		/** Takes the chunks read by the streaming thread and creates their instances.
+		 */
+		void processLoadedChunks();
+
+		/** Main loop of the streaming thread.
+		 */
+		void streamingLoop();
+
+		Map* m_map;
+		MapChunkSource* m_source;
+		uint32_t m_chunkSize;
+		uint32_t m_loadRadius;
+		uint32_t m_unloadRadius;
+		bool m_saveOnUnload;
+		std::vector<Rect> m_focusAreas;
+		std::vector<StreamedLayer*> m_layers;
+
+		std::thread m_thread;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_wakeCondition;
+		std::condition_variable m_doneCondition;
+		//! chunks the streaming thread has to read
+		std::deque<ChunkJob*> m_requests;
+		//! chunks the streaming thread has read
+		std::deque<ChunkJob*> m_results;
+		//! chunks requested and not yet processed by update()
+		uint32_t m_pending;
+		bool m_stop;
+	};
+}
+
+#endif
@@ -0,0 +1,54 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+%module fife
+%{
+#include "model/structures/mapstreamer.h"
+%}
+
+namespace FIFE {
+	class Map;
+	class Layer;
+	class Rect;
+
+	%nodefaultctor;
+	class MapStreamer {
+	public:
+		void addLayer(Layer* layer);
+		void removeLayer(Layer* layer);
+		uint32_t getChunkSize() const;
+		ModelCoordinate getChunk(const ExactModelCoordinate& coordinate) const;
+		void setLoadRadius(uint32_t radius);
+		uint32_t getLoadRadius() const;
+		void setUnloadRadius(uint32_t radius);
+		uint32_t getUnloadRadius() const;
+		void setSaveOnUnload(bool save);
+		bool isSaveOnUnload() const;
+		void addFocusArea(const Rect& area);
+		void clearFocusAreas();
+		void update();
+		void finishLoading();
+		bool isChunkLoaded(Layer* layer, const ModelCoordinate& chunk) const;
+		uint32_t getLoadedChunkCount() const;
+		uint32_t getPendingChunkCount() const;
+	};
+	%clearnodefaultctor;
+}
@@ -38,6 +38,29 @@ namespace FIFE {
 
 	static Logger _log(LM_STRUCTURES);
 
+	bool RouteStep::checkBlocker(Layer* layer, const ModelCoordinate& cell) {
+		bool blocked = layer->cellContainsBlockingInstance(cell);
+		if (blockerChecks < MAX_BLOCKER_CHECKS) {
+			blockerLayers[blockerChecks] = layer;
+			blockerCells[blockerChecks] = cell;
+			blockerResults[blockerChecks] = blocked;
+		}
+		++blockerChecks;
+		return blocked;
+	}
+
+	bool RouteStep::isBlockerStateUnchanged() const {
+		if (blockerChecks > MAX_BLOCKER_CHECKS) {
+			return false;
+		}
+		for (uint32_t i = 0; i < blockerChecks; ++i) {
+			if (blockerLayers[i]->cellContainsBlockingInstance(blockerCells[i]) != blockerResults[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	Route::Route(const Location& start, const Location& end):
 		m_status(ROUTE_CREATED),
 		m_startNode(start),
@@ -47,7 +70,6 @@ namespace FIFE {
 		m_rotation(0),
 		m_replanned(false),
 		m_ignoresBlocker(false),
-		m_costId(""),
 		m_object(NULL) {
 	}
 
@@ -241,7 +263,7 @@ namespace FIFE {
 	}
 
 	const std::string& Route::getCostId() {
-		return m_costId;
+		return m_costId.str();
 	}
 
 	bool Route::isMultiCell() {
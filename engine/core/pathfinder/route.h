@@ -31,10 +31,14 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/atom.h"
 #include "util/base/fifeclass.h"
+#include "util/structures/objectpool.h"
+#include "model/metamodel/modelcoords.h"
 
 namespace FIFE {
 
+	class Layer;
 	class Location;
 	class Object;
 
@@ -58,6 +62,49 @@ namespace FIFE {
 	//! A path is a list with locations. Each location holds the coordinate for one cell.
 	typedef std::list<Location> Path;
 
+#ifndef SWIG
+	/** The changes a follow step makes to a route.
+	 * The step is calculated without touching the route, see IPather::computeRouteStep(),
+	 * and applied later with IPather::applyRouteStep().
+	 */
+	struct RouteStep {
+		//! Maximal number of recorded blocker checks.
+		static const uint32_t MAX_BLOCKER_CHECKS = 2;
+
+		RouteStep():
+			result(false),
+			rotation(0),
+			walk(false),
+			endHere(false),
+			blockerChecks(0) {
+		}
+
+		/** Records a blocker check the step depends on.
+		 * @return The result of the check.
+		 */
+		bool checkBlocker(Layer* layer, const ModelCoordinate& cell);
+
+		/** Returns whether all recorded blocker checks still give the same result.
+		 * If not, the step is outdated and has to be calculated again.
+		 */
+		bool isBlockerStateUnchanged() const;
+
+		//! return value of the follow call
+		bool result;
+		//! rotation of the route after the step
+		int32_t rotation;
+		//! if true the route walks to the next node
+		bool walk;
+		//! if true the route ends at the new location (immediate transition)
+		bool endHere;
+		//! number of blocker checks, can be larger than MAX_BLOCKER_CHECKS
+		uint32_t blockerChecks;
+		Layer* blockerLayers[MAX_BLOCKER_CHECKS];
+		ModelCoordinate blockerCells[MAX_BLOCKER_CHECKS];
+		bool blockerResults[MAX_BLOCKER_CHECKS];
+	};
+#endif
+
 	/** A basic route.
 	 * Holds the path and all related infos.
 	 */
@@ -73,6 +120,13 @@ namespace FIFE {
 		 */
 		~Route();
 
+#ifndef SWIG
+		/** Routes are taken from a pool, every movement creates one.
+		 */
+		static void* operator new(std::size_t size) { return ObjectPool<Route>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<Route>::deallocate(ptr, size); }
+#endif
+
 		/** Sets route status.
 		 * @param status The seach status that should be set.
 		 */
@@ -285,7 +339,7 @@ namespace FIFE {
 		bool m_ignoresBlocker;
 
 		//! used cost identifier
-		std::string m_costId;
+		Atom m_costId;
 
 		//! occupied cells by multicell object
 		std::vector<ModelCoordinate> m_area;
@@ -29,6 +29,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "model/metamodel/grids/cellgrid.h"
+#include "model/metamodel/grids/gridkernels.h"
 #include "model/structures/layer.h"
 #include "model/structures/cellcache.h"
 #include "model/structures/cell.h"
@@ -179,11 +180,29 @@ namespace FIFE {
 		if (!nextCell) {
 			return;
 		}
+		switch (getGridKernelType(grid)) {
+			case GRID_KERNEL_SQUARE:
+				expandNode(SquareGridKernel(grid), grid, nextCell, nextCoord, destCoord);
+				break;
+			case GRID_KERNEL_HEX:
+				expandNode(HexGridKernel(grid), grid, nextCell, nextCoord, destCoord);
+				break;
+			default:
+				expandNode(GenericGridKernel(grid), grid, nextCell, nextCoord, destCoord);
+				break;
+		}
+	}
+
+	template<typename Kernel>
+	void MultiLayerSearch::expandNode(const Kernel& kernel, CellGrid* grid, Cell* nextCell, const ModelCoordinate& nextCoord, const ModelCoordinate& destCoord) {
 		int32_t cellZ = nextCell->getLayerCoordinates().z;
 		int32_t maxZ = m_route->getZStepRange();
 		bool zLimited = maxZ != -1;
 		uint8_t blockerThreshold = m_ignoreDynamicBlockers ? 2 : 1;
 		bool limitedArea = m_route->isAreaLimited();
+		// the cost multiplier only depends on the expanded cell
+		double costMultiplier = m_specialCost ? m_currentCache->getAdjacentCostMultiplier(nextCell, m_costId) :
+			m_currentCache->getAdjacentCostMultiplier(nextCell);
 		const std::vector<Cell*>& adjacents = nextCell->getNeighbors();
 		if (adjacents.empty()) {
 			return;
@@ -238,9 +257,8 @@ namespace FIFE {
 						if (limitedArea) {
 							// check if cell is on one of the areas
 							bool sameAreas = false;
-							const std::list<std::string> areas = m_route->getLimitedAreas();
-							std::list<std::string>::const_iterator area_it = areas.begin();
-							for (; area_it != areas.end(); ++area_it) {
+							std::vector<Atom>::const_iterator area_it = m_limitedAreas.begin();
+							for (; area_it != m_limitedAreas.end(); ++area_it) {
 								if (m_currentCache->isCellInArea(*area_it, cell)) {
 									sameAreas = true;
 									break;
@@ -262,9 +280,8 @@ namespace FIFE {
 			} else if (limitedArea) {
 				// check if cell is on one of the areas
 				bool sameAreas = false;
-				const std::list<std::string> areas = m_route->getLimitedAreas();
-				std::list<std::string>::const_iterator area_it = areas.begin();
-				for (; area_it != areas.end(); ++area_it) {
+				std::vector<Atom>::const_iterator area_it = m_limitedAreas.begin();
+				for (; area_it != m_limitedAreas.end(); ++area_it) {
 					if (m_currentCache->isCellInArea(*area_it, *i)) {
 						sameAreas = true;
 						break;
@@ -275,13 +292,8 @@ namespace FIFE {
 				}
 			}
 
-			double gCost = m_gCosts[m_next];
-			if (m_specialCost) {
-				gCost += m_currentCache->getAdjacentCost(adjacentCoord ,nextCoord, m_route->getCostId());
-			} else {
-				gCost += m_currentCache->getAdjacentCost(adjacentCoord ,nextCoord);
-			}
-			double hCost = grid->getHeuristicCost(adjacentCoord, destCoord);
+			double gCost = m_gCosts[m_next] + kernel.getAdjacentCost(adjacentCoord, nextCoord) * costMultiplier;
+			double hCost = kernel.getHeuristicCost(adjacentCoord, destCoord);
 			if (m_sf[adjacentInt] == -1) {
 				m_sortedFrontier.pushElement(PriorityQueue<int32_t, double>::value_type(adjacentInt, gCost + hCost));
 				m_gCosts[adjacentInt] = gCost;
@@ -36,7 +36,9 @@
 
 namespace FIFE {
 
+	class Cell;
 	class CellCache;
+	class CellGrid;
 	class Route;
 	class Zone;
 
@@ -90,6 +92,17 @@ namespace FIFE {
 		 */
 		void searchBetweenTargetsMap();
 
+		/** Checks all neighbors of the expanded cell and updates the search frontier.
+		 *
+		 * @param kernel The grid kernel of the layer grid.
+		 * @param grid A pointer to the layer grid.
+		 * @param nextCell A pointer to the expanded cell.
+		 * @param nextCoord The coordinate of the expanded cell.
+		 * @param destCoord The coordinate of the destination.
+		 */
+		template<typename Kernel>
+		void expandNode(const Kernel& kernel, CellGrid* grid, Cell* nextCell, const ModelCoordinate& nextCoord, const ModelCoordinate& destCoord);
+
 		//! A location object representing where the search started.
 		Location m_to;
 		//! A location object representing where the search ended.
@@ -269,8 +269,32 @@ namespace FIFE {
 	}
 
 	bool RoutePather::followRoute(const Location& current, Route* route, double speed, Location& nextLocation) {
-		Path path = route->getPath();
-		if (path.empty()) {
+		RouteStep step;
+		computeRouteStep(current, route, speed, nextLocation, step);
+		applyRouteStep(route, step, nextLocation);
+		return step.result;
+	}
+
+	bool RoutePather::computeRouteStep(const Location& current, Route* route, double speed, Location& nextLocation, RouteStep& step) {
+		step = RouteStep();
+		step.rotation = route->getRotation();
+		step.result = calculateRouteStep(current, route, speed, nextLocation, step);
+		return true;
+	}
+
+	void RoutePather::applyRouteStep(Route* route, const RouteStep& step, const Location& nextLocation) {
+		route->setRotation(step.rotation);
+		if (step.walk) {
+			route->walkToNextNode();
+		}
+		if (step.endHere) {
+			route->setEndNode(nextLocation);
+		}
+	}
+
+	bool RoutePather::calculateRouteStep(const Location& current, Route* route, double speed, Location& nextLocation, RouteStep& step) {
+		// the path is only checked, copying it would copy every location
+		if (route->getPathLength() == 0) {
 			return false;
 		}
 		if (Mathd::Equal(speed, 0.0)) {
@@ -282,20 +306,20 @@ namespace FIFE {
 		if (!locationsEqual(current, currentNode)) {
 			// special blocker check for multicell
 			if (multiCell) {
-				int32_t oldRotation = route->getRotation();
+				int32_t oldRotation = step.rotation;
 				// old coordinates
 				std::vector<ModelCoordinate> oldCoords = current.getLayer()->getCellGrid()->
-					toMultiCoordinates(current.getLayerCoordinates(), route->getOccupiedCells(route->getRotation()));
+					toMultiCoordinates(current.getLayerCoordinates(), route->getOccupiedCells(step.rotation));
 				oldCoords.push_back(current.getLayerCoordinates());
-				route->setRotation(getAngleBetween(current, currentNode));
+				step.rotation = getAngleBetween(current, currentNode);
 				// new coordinates
 				std::vector<ModelCoordinate> newCoords = currentNode.getLayer()->getCellGrid()->
-					toMultiCoordinates(currentNode.getLayerCoordinates(), route->getOccupiedCells(route->getRotation()));
+					toMultiCoordinates(currentNode.getLayerCoordinates(), route->getOccupiedCells(step.rotation));
 				newCoords.push_back(currentNode.getLayerCoordinates());
 
 				std::vector<ModelCoordinate>::const_iterator nco_it = newCoords.begin();
 				for (; nco_it != newCoords.end(); ++nco_it) {
-					if (currentNode.getLayer()->cellContainsBlockingInstance(*nco_it)) {
+					if (step.checkBlocker(currentNode.getLayer(), *nco_it)) {
 						bool found = false;
 						std::vector<ModelCoordinate>::const_iterator oco_it = oldCoords.begin();
 						for (; oco_it != oldCoords.end(); ++oco_it) {
@@ -310,13 +334,13 @@ namespace FIFE {
 						}
 					}
 					if (nextBlocker) {
-						route->setRotation(oldRotation);
+						step.rotation = oldRotation;
 						break;
 					}
 				}
 			} else {
-				route->setRotation(getAngleBetween(current, currentNode));
-				if (currentNode.getLayer()->cellContainsBlockingInstance(currentNode.getLayerCoordinates())) {
+				step.rotation = getAngleBetween(current, currentNode);
+				if (step.checkBlocker(currentNode.getLayer(), currentNode.getLayerCoordinates())) {
 					nextBlocker = true;
 				}
 			}
@@ -386,7 +410,8 @@ namespace FIFE {
 		if (pop) {
 			nextLocation.setMapCoordinates(targetPos);
 			// if cw is false we have reached the end
-			bool cw = route->walkToNextNode();
+			bool cw = route->getWalkedLength() < route->getPathLength();
+			step.walk = cw;
 			// check transistion
 			CellCache* cache = nextLocation.getLayer()->getCellCache();
 			if (cache) {
@@ -397,7 +422,7 @@ namespace FIFE {
 						// "beam" if it is a part of path
 						if (cw &&
 							!cell->getLayer()->getCellGrid()->isAccessible(nextLocation.getLayerCoordinates(),
-							route->getCurrentNode().getLayerCoordinates())) {
+							route->getNextNode().getLayerCoordinates())) {
 							if (ti->m_difflayer) {
 								nextLocation.setLayer(ti->m_layer);
 							}
@@ -409,17 +434,17 @@ namespace FIFE {
 								nextLocation.setLayer(ti->m_layer);
 							}
 							nextLocation.setLayerCoordinates(ti->m_mc);
-							route->setEndNode(nextLocation);
+							step.endHere = true;
 							return false;
 						}
 					}
 				}
 			}
 			if (cw && !multiCell &&
-				currentNode.getLayer()->cellContainsBlockingInstance(route->getCurrentNode().getLayerCoordinates())) {
+				step.checkBlocker(currentNode.getLayer(), route->getNextNode().getLayerCoordinates())) {
 				//set facing to end blocker
-				Location facing = route->getCurrentNode();
-				route->setRotation(getAngleBetween(current, facing));
+				Location facing = route->getNextNode();
+				step.rotation = getAngleBetween(current, facing);
 
 				return false;
 			}
@@ -77,6 +77,26 @@ namespace FIFE {
 		 * @return A boolean, if true the route could be followed, otherwise false.
 		 */
 		bool followRoute(const Location& current, Route* route, double speed, Location& nextLocation);
+
+		/** Calculates the next step like followRoute(), but doesn't change the route.
+		 * The route pather only reads the cell caches, so different routes can be handled at the same time.
+		 *
+		 * @param current A const reference to the current location.
+		 * @param route A pointer to the route which should be followed.
+		 * @param speed A double which holds the speed.
+		 * @param nextLocation A reference to the next location returned by the pather.
+		 * @param step A reference to the step that receives the changes for the route.
+		 * @return Always true.
+		 */
+		bool computeRouteStep(const Location& current, Route* route, double speed, Location& nextLocation, RouteStep& step);
+
+		/** Applies a step calculated by computeRouteStep() to the route.
+		 *
+		 * @param route A pointer to the route the step was calculated for.
+		 * @param step A const reference to the step.
+		 * @param nextLocation A const reference to the next location of the step.
+		 */
+		void applyRouteStep(Route* route, const RouteStep& step, const Location& nextLocation);
 		
 		/** Updates the route pather.
 		 *
@@ -144,6 +164,17 @@ namespace FIFE {
 		 */
 		bool locationsEqual(const Location& a, const Location& b);
 
+		/** Calculates the next step of the route, used by computeRouteStep().
+		 *
+		 * @param current A const reference to the current location.
+		 * @param route A pointer to the route which should be followed, it is not changed.
+		 * @param speed A double which holds the speed.
+		 * @param nextLocation A reference to the next location.
+		 * @param step A reference to the step that receives the changes for the route.
+		 * @return A boolean, if true the route could be followed, otherwise false.
+		 */
+		bool calculateRouteStep(const Location& current, Route* route, double speed, Location& nextLocation, RouteStep& step);
+
 		/** Determines if the given session Id is valid.
 		 *
 		 * Searches the session list to determine if a search with the given session id
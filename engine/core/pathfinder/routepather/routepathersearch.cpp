@@ -46,6 +46,17 @@ namespace FIFE {
 
 		m_route->setRouteStatus(ROUTE_SEARCHING);
 		m_specialCost = route->getCostId() != "";
+		if (m_specialCost) {
+			m_costId = route->getCostId();
+		}
+		if (route->isAreaLimited()) {
+			// intern the area ids once instead of per expanded cell
+			const std::list<std::string> areas = route->getLimitedAreas();
+			std::list<std::string>::const_iterator area_it = areas.begin();
+			for (; area_it != areas.end(); ++area_it) {
+				m_limitedAreas.push_back(Atom(*area_it));
+			}
+		}
 		m_ignoreDynamicBlockers = route->isDynamicBlockerIgnored();
 		if (m_multicell) {
 			Location loc = route->getStartNode();
@@ -30,10 +30,12 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/atom.h"
 #include "util/structures/priorityqueue.h"
 
 namespace FIFE {
 
+	class Cell;
 	class CellCache;
 	class Route;
 
@@ -104,6 +106,12 @@ namespace FIFE {
 		//! Indicates if the search should use special costs.
 		bool m_specialCost;
 
+		//! The cost identifier of the route.
+		Atom m_costId;
+
+		//! The areas the route is limited to, empty if the route is not area limited.
+		std::vector<Atom> m_limitedAreas;
+
 		//! Indicates if the route is for a multi cell object.
 		bool m_multicell;
 
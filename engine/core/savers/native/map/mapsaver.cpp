@@ -156,6 +156,10 @@ namespace FIFE {
             }
             layerElement->SetAttribute("sorting", sortingStrategy);
 
+			if ((*iter)->getSpatialIndexStrategy() == SPATIAL_GRID) {
+				layerElement->SetAttribute("spatial_index", "grid");
+			}
+
 			if ((*iter)->isWalkable()) {
 				layerElement->SetAttribute("layer_type", "walkable");
 			} else if ((*iter)->isInteract()) {
@@ -0,0 +1,477 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "loaders/native/map/snapshotformat.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/cellgrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+#include "view/visual.h"
+
+#include "snapshotsaver.h"
+
+namespace FIFE {
+	static Logger _log(LM_NATIVE_SAVERS);
+
+	/** Buffers the snapshot and writes it to the file in large blocks.
+	 */
+	class SnapshotWriter {
+	public:
+		SnapshotWriter(FILE* file):
+			m_file(file),
+			m_failed(false) {
+			m_buffer.reserve(BUFFER_SIZE);
+		}
+
+		void write8(uint8_t value) {
+			writeBytes(&value, 1);
+		}
+
+		void write16(uint16_t value) {
+			uint8_t bytes[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+			writeBytes(bytes, 2);
+		}
+
+		void write32(uint32_t value) {
+			uint8_t bytes[4] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+				static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+			writeBytes(bytes, 4);
+		}
+
+		void writeInt32(int32_t value) {
+			write32(static_cast<uint32_t>(value));
+		}
+
+		void writeFloat(float value) {
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write32(bits);
+		}
+
+		void writeDouble(double value) {
+			uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write32(static_cast<uint32_t>(bits));
+			write32(static_cast<uint32_t>(bits >> 32));
+		}
+
+		void writeString(const std::string& value) {
+			write32(value.size());
+			writeBytes(value.data(), value.size());
+		}
+
+		void writeSharedString(const std::string& value) {
+			std::unordered_map<std::string, uint32_t>::const_iterator it = m_sharedStrings.find(value);
+			if (it != m_sharedStrings.end()) {
+				write32(it->second);
+				return;
+			}
+			uint32_t index = m_sharedStrings.size();
+			m_sharedStrings.insert(std::make_pair(value, index));
+			write32(index);
+			writeString(value);
+		}
+
+		void writeCoordinate(const ExactModelCoordinate& coordinate) {
+			writeDouble(coordinate.x);
+			writeDouble(coordinate.y);
+			writeDouble(coordinate.z);
+		}
+
+		void writeBytes(const void* data, size_t size) {
+			if (m_buffer.size() + size > BUFFER_SIZE) {
+				flush();
+			}
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+		}
+
+		void flush() {
+			if (!m_buffer.empty() && fwrite(&m_buffer[0], 1, m_buffer.size(), m_file) != m_buffer.size()) {
+				m_failed = true;
+			}
+			m_buffer.clear();
+		}
+
+		bool isFailed() const { return m_failed; }
+
+	private:
+		static const size_t BUFFER_SIZE = 64 * 1024;
+
+		FILE* m_file;
+		bool m_failed;
+		std::vector<uint8_t> m_buffer;
+		std::unordered_map<std::string, uint32_t> m_sharedStrings;
+	};
+
+	static void writeInstance(SnapshotWriter& writer, Instance* instance, const std::map<Layer*, uint32_t>& layerIndices) {
+		Object* object = instance->getBaseObject();
+		InstanceVisual* visual = instance->getVisual<InstanceVisual>();
+		Action* action = instance->getCurrentAction();
+		const std::string* sayText = instance->getSayText();
+		bool moving = action && instance->getMovementSpeed() > 0;
+		float timeMultiplier = instance->getTimeMultiplier();
+
+		uint16_t flags = 0;
+		if (instance->isBlocking()) {
+			flags |= SNAPSHOT_INSTANCE_BLOCKING;
+		}
+		if (instance->isOverrideBlocking()) {
+			flags |= SNAPSHOT_INSTANCE_OVERRIDE_BLOCKING;
+		}
+		if (instance->isSpecialCost()) {
+			flags |= SNAPSHOT_INSTANCE_SPECIAL_COST;
+		}
+		if (visual) {
+			flags |= SNAPSHOT_INSTANCE_VISUAL;
+			if (visual->isVisible()) {
+				flags |= SNAPSHOT_INSTANCE_VISIBLE;
+			}
+		}
+		if (action) {
+			flags |= SNAPSHOT_INSTANCE_ACTION;
+			if (instance->isActionRepeating()) {
+				flags |= SNAPSHOT_INSTANCE_REPEATING;
+			}
+			if (moving) {
+				flags |= SNAPSHOT_INSTANCE_MOVING;
+			}
+		}
+		if (sayText) {
+			flags |= SNAPSHOT_INSTANCE_SAY;
+		}
+		if (timeMultiplier != 1.0) {
+			flags |= SNAPSHOT_INSTANCE_TIME_MULTIPLIER;
+		}
+
+		writer.writeSharedString(object->getNamespace());
+		writer.writeSharedString(object->getId());
+		writer.writeString(instance->getId());
+		writer.writeCoordinate(instance->getLocationRef().getExactLayerCoordinates());
+		writer.writeInt32(instance->getRotation());
+		writer.write8(instance->getCellStackPosition());
+		writer.write16(flags);
+
+		if (flags & SNAPSHOT_INSTANCE_SPECIAL_COST) {
+			writer.writeSharedString(instance->getCostId());
+			writer.writeDouble(instance->getCost());
+		}
+		if (flags & SNAPSHOT_INSTANCE_VISUAL) {
+			writer.writeInt32(visual->getStackPosition());
+			writer.write8(visual->getTransparency());
+		}
+		if (flags & SNAPSHOT_INSTANCE_ACTION) {
+			writer.writeSharedString(action->getId());
+			writer.write32(instance->getActionRuntime());
+			if (moving) {
+				Location target = instance->getTargetLocation();
+				std::map<Layer*, uint32_t>::const_iterator it = layerIndices.find(target.getLayer());
+				writer.write32(it != layerIndices.end() ? it->second : SNAPSHOT_NO_INDEX);
+				writer.writeCoordinate(target.getExactLayerCoordinates());
+				writer.writeDouble(instance->getMovementSpeed());
+			}
+		}
+		if (flags & SNAPSHOT_INSTANCE_SAY) {
+			writer.writeString(*sayText);
+			writer.write32(instance->getSayRemainingTime());
+		}
+		if (flags & SNAPSHOT_INSTANCE_TIME_MULTIPLIER) {
+			writer.writeFloat(timeMultiplier);
+		}
+	}
+
+	static void writeCells(SnapshotWriter& writer, const std::vector<Cell*>& cells) {
+		writer.write32(cells.size());
+		std::vector<Cell*>::const_iterator it = cells.begin();
+		for (; it != cells.end(); ++it) {
+			ModelCoordinate mc = (*it)->getLayerCoordinates();
+			writer.writeInt32(mc.x);
+			writer.writeInt32(mc.y);
+		}
+	}
+
+	/** Returns true if the area comes from the object of an instance on the cell,
+	 * those are added again with the instance.
+	 */
+	static bool isObjectArea(Cell* cell, const std::string& area) {
+		const std::set<Instance*>& instances = cell->getInstances();
+		std::set<Instance*>::const_iterator it = instances.begin();
+		for (; it != instances.end(); ++it) {
+			if ((*it)->getObject()->getArea() == area) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static void writeCellCache(SnapshotWriter& writer, CellCache* cache, const std::map<Layer*, uint32_t>& layerIndices) {
+		writer.writeDouble(cache->getDefaultCostMultiplier());
+		writer.writeDouble(cache->getDefaultSpeedMultiplier());
+		writer.write8(cache->isSearchNarrowCells());
+		writer.write8(cache->isStaticSize());
+		const Rect& size = cache->getSize();
+		writer.writeInt32(size.x);
+		writer.writeInt32(size.y);
+		writer.writeInt32(size.w);
+		writer.writeInt32(size.h);
+
+		std::list<std::string> costs = cache->getCosts();
+		writer.write32(costs.size());
+		std::list<std::string>::const_iterator costIt = costs.begin();
+		for (; costIt != costs.end(); ++costIt) {
+			writer.writeSharedString(*costIt);
+			writer.writeDouble(cache->getCost(*costIt));
+			writeCells(writer, cache->getCostCells(*costIt));
+		}
+
+		std::vector<std::string> areas = cache->getAreas();
+		writer.write32(areas.size());
+		std::vector<std::string>::const_iterator areaIt = areas.begin();
+		for (; areaIt != areas.end(); ++areaIt) {
+			std::vector<Cell*> cells = cache->getAreaCells(*areaIt);
+			cells.erase(std::remove_if(cells.begin(), cells.end(),
+				[&areaIt](Cell* cell) { return isObjectArea(cell, *areaIt); }), cells.end());
+			writer.writeSharedString(*areaIt);
+			writeCells(writer, cells);
+		}
+
+		// cells with properties that differ from the defaults
+		const std::set<Cell*>& narrowCells = cache->getNarrowCells();
+		bool saveNarrows = !cache->isSearchNarrowCells() && !narrowCells.empty();
+		std::vector<std::pair<Cell*, uint8_t> > modified;
+		const std::vector<std::vector<Cell*> >& cells = cache->getCells();
+		std::vector<std::vector<Cell*> >::const_iterator rowIt = cells.begin();
+		for (; rowIt != cells.end(); ++rowIt) {
+			std::vector<Cell*>::const_iterator cellIt = rowIt->begin();
+			for (; cellIt != rowIt->end(); ++cellIt) {
+				Cell* cell = *cellIt;
+				CellTypeInfo type = cell->getCellType();
+				uint8_t flags = 0;
+				if (!cell->defaultCost()) {
+					flags |= SNAPSHOT_CELL_COST_MULTIPLIER;
+				}
+				if (!cell->defaultSpeed()) {
+					flags |= SNAPSHOT_CELL_SPEED_MULTIPLIER;
+				}
+				if (type == CTYPE_CELL_NO_BLOCKER || type == CTYPE_CELL_BLOCKER) {
+					flags |= SNAPSHOT_CELL_BLOCKER_TYPE;
+				}
+				if (saveNarrows && narrowCells.find(cell) != narrowCells.end()) {
+					flags |= SNAPSHOT_CELL_NARROW;
+				}
+				if (cell->getTransition()) {
+					flags |= SNAPSHOT_CELL_TRANSITION;
+				}
+				if (flags != 0) {
+					modified.push_back(std::make_pair(cell, flags));
+				}
+			}
+		}
+
+		writer.write32(modified.size());
+		std::vector<std::pair<Cell*, uint8_t> >::const_iterator it = modified.begin();
+		for (; it != modified.end(); ++it) {
+			Cell* cell = it->first;
+			uint8_t flags = it->second;
+			ModelCoordinate mc = cell->getLayerCoordinates();
+			writer.writeInt32(mc.x);
+			writer.writeInt32(mc.y);
+			writer.write8(flags);
+			if (flags & SNAPSHOT_CELL_COST_MULTIPLIER) {
+				writer.writeDouble(cell->getCostMultiplier());
+			}
+			if (flags & SNAPSHOT_CELL_SPEED_MULTIPLIER) {
+				writer.writeDouble(cell->getSpeedMultiplier());
+			}
+			if (flags & SNAPSHOT_CELL_BLOCKER_TYPE) {
+				writer.write8(cell->getCellType());
+			}
+			if (flags & SNAPSHOT_CELL_TRANSITION) {
+				TransitionInfo* transition = cell->getTransition();
+				std::map<Layer*, uint32_t>::const_iterator layerIt = layerIndices.find(transition->m_layer);
+				writer.write32(layerIt != layerIndices.end() ? layerIt->second : SNAPSHOT_NO_INDEX);
+				writer.writeInt32(transition->m_mc.x);
+				writer.writeInt32(transition->m_mc.y);
+				writer.writeInt32(transition->m_mc.z);
+				writer.write8(transition->m_immediate);
+			}
+		}
+	}
+
+	static void writeTrigger(SnapshotWriter& writer, Trigger* trigger, const std::map<Layer*, uint32_t>& layerIndices,
+		const std::unordered_map<Instance*, uint32_t>& instanceIndices) {
+
+		writer.writeString(trigger->getName());
+		writer.write8(trigger->isTriggered());
+		writer.write8(trigger->isEnabledForAllInstances());
+		std::unordered_map<Instance*, uint32_t>::const_iterator instanceIt = instanceIndices.find(trigger->getAttached());
+		writer.write32(instanceIt != instanceIndices.end() ? instanceIt->second : SNAPSHOT_NO_INDEX);
+
+		const std::vector<Cell*>& cells = trigger->getAssignedCells();
+		writer.write32(cells.size());
+		std::vector<Cell*>::const_iterator cellIt = cells.begin();
+		for (; cellIt != cells.end(); ++cellIt) {
+			std::map<Layer*, uint32_t>::const_iterator layerIt = layerIndices.find((*cellIt)->getLayer());
+			writer.write32(layerIt != layerIndices.end() ? layerIt->second : SNAPSHOT_NO_INDEX);
+			writer.writeInt32((*cellIt)->getLayerCoordinates().x);
+			writer.writeInt32((*cellIt)->getLayerCoordinates().y);
+		}
+
+		const std::vector<Instance*>& instances = trigger->getEnabledInstances();
+		writer.write32(instances.size());
+		std::vector<Instance*>::const_iterator it = instances.begin();
+		for (; it != instances.end(); ++it) {
+			instanceIt = instanceIndices.find(*it);
+			writer.write32(instanceIt != instanceIndices.end() ? instanceIt->second : SNAPSHOT_NO_INDEX);
+		}
+
+		const std::vector<TriggerCondition>& conditions = trigger->getTriggerConditions();
+		writer.write32(conditions.size());
+		std::vector<TriggerCondition>::const_iterator conditionIt = conditions.begin();
+		for (; conditionIt != conditions.end(); ++conditionIt) {
+			writer.write32(*conditionIt);
+		}
+	}
+
+	SnapshotSaver::SnapshotSaver() {
+	}
+
+	SnapshotSaver::~SnapshotSaver() {
+	}
+
+	void SnapshotSaver::save(const Map& map, const std::string& filename) {
+		FILE* fp = 0;
+		#if defined(_MSC_VER) && (_MSC_VER >= 1400 )
+			fp = _fsopen( filename.c_str(), "wb", _SH_DENYNO );
+		#else
+			fp = fopen( filename.c_str(), "wb" );
+		#endif
+		if (!fp) {
+			throw CannotOpenFile(filename);
+		}
+
+		SnapshotWriter writer(fp);
+		writer.writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+		writer.write32(SNAPSHOT_VERSION);
+		writer.writeString(map.getId());
+		writer.writeFloat(map.getTimeMultiplier());
+
+		const std::list<Layer*>& layers = map.getLayers();
+		std::map<Layer*, uint32_t> layerIndices;
+		std::list<Layer*>::const_iterator layerIt = layers.begin();
+		for (; layerIt != layers.end(); ++layerIt) {
+			layerIndices.insert(std::make_pair(*layerIt, layerIndices.size()));
+		}
+
+		writer.write32(layers.size());
+		std::unordered_map<Instance*, uint32_t> instanceIndices;
+		for (layerIt = layers.begin(); layerIt != layers.end(); ++layerIt) {
+			Layer* layer = *layerIt;
+			CellGrid* grid = layer->getCellGrid();
+			writer.writeString(layer->getId());
+			writer.writeSharedString(grid->getType());
+			writer.writeDouble(grid->getXShift());
+			writer.writeDouble(grid->getYShift());
+			writer.writeDouble(grid->getZShift());
+			writer.writeDouble(grid->getXScale());
+			writer.writeDouble(grid->getYScale());
+			writer.writeDouble(grid->getZScale());
+			writer.writeDouble(grid->getRotation());
+			writer.write8(grid->getAllowDiagonals());
+			writer.write8(layer->getPathingStrategy());
+			writer.write8(layer->getSortingStrategy());
+			writer.write8(layer->getSpatialIndexStrategy());
+			writer.write8(layer->isWalkable());
+			writer.write8(layer->isInteract());
+			writer.writeString(layer->getWalkableId());
+			writer.write8(layer->getLayerTransparency());
+			writer.write8(layer->areInstancesVisible());
+			writer.write8(layer->isStatic());
+
+			// part instances are created again by their main instance
+			const std::vector<Instance*>& instances = layer->getInstances();
+			uint32_t count = 0;
+			std::vector<Instance*>::const_iterator it = instances.begin();
+			for (; it != instances.end(); ++it) {
+				if (!(*it)->getObject()->isMultiPart()) {
+					++count;
+				}
+			}
+			writer.write32(count);
+			for (it = instances.begin(); it != instances.end(); ++it) {
+				if (!(*it)->getObject()->isMultiPart()) {
+					instanceIndices.insert(std::make_pair(*it, instanceIndices.size()));
+					writeInstance(writer, *it, layerIndices);
+				}
+			}
+		}
+
+		std::vector<std::pair<uint32_t, CellCache*> > caches;
+		for (layerIt = layers.begin(); layerIt != layers.end(); ++layerIt) {
+			if ((*layerIt)->getCellCache()) {
+				caches.push_back(std::make_pair(layerIndices[*layerIt], (*layerIt)->getCellCache()));
+			}
+		}
+		writer.write32(caches.size());
+		std::vector<std::pair<uint32_t, CellCache*> >::const_iterator cacheIt = caches.begin();
+		for (; cacheIt != caches.end(); ++cacheIt) {
+			writer.write32(cacheIt->first);
+			writeCellCache(writer, cacheIt->second, layerIndices);
+		}
+
+		std::vector<Trigger*> triggers = map.getTriggerController()->getAllTriggers();
+		writer.write32(triggers.size());
+		std::vector<Trigger*>::const_iterator triggerIt = triggers.begin();
+		for (; triggerIt != triggers.end(); ++triggerIt) {
+			writeTrigger(writer, *triggerIt, layerIndices, instanceIndices);
+		}
+
+		writer.flush();
+		bool failed = writer.isFailed();
+		if (fclose(fp) != 0 || failed) {
+			FL_ERR(_log, LMsg("SnapshotSaver::save() - failed to write ") << filename);
+			throw CannotOpenFile(filename);
+		}
+	}
+}
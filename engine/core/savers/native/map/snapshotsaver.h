@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_SNAPSHOTSAVER_H_
+#define FIFE_SNAPSHOTSAVER_H_
+
+// Standard C++ library includes
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+	class Map;
+
+	/** Writes the state of a map as binary snapshot, @see SnapshotLoader
+	 *
+	 * Unlike MapSaver the snapshot keeps the running state: current actions with
+	 * their runtime, movement targets, say texts and the visual state of the instances.
+	 * The objects are referenced by id and namespace and must be loaded again before
+	 * the snapshot. Cameras are not part of the snapshot.
+	 */
+	class SnapshotSaver {
+	public:
+		SnapshotSaver();
+
+		~SnapshotSaver();
+
+		/** Writes the snapshot of the map to a file.
+		 * @param map The map to save.
+		 * @param filename The path of the file, it is overwritten.
+		 * @throws CannotOpenFile if the file can not be written.
+		 */
+		void save(const Map& map, const std::string& filename);
+	};
+}
+
+#endif
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <mutex>
+#include <unordered_set>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "atom.h"
+
+namespace FIFE {
+	/** The strings of all atoms, nodes of an unordered_set keep their address.
+	 */
+	struct AtomTable {
+		std::mutex mutex;
+		std::unordered_set<std::string> strings;
+	};
+
+	static AtomTable& getAtomTable() {
+		// never destroyed, atoms in static objects stay valid until the end
+		static AtomTable* table = new AtomTable();
+		return *table;
+	}
+
+	static const std::string* intern(const std::string& str) {
+		AtomTable& table = getAtomTable();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		return &(*table.strings.insert(str).first);
+	}
+
+	static const std::string* getEmptyString() {
+		static const std::string* empty = intern(std::string());
+		return empty;
+	}
+
+	Atom::Atom():
+		m_string(getEmptyString()) {
+	}
+
+	Atom::Atom(const std::string& str):
+		m_string(str.empty() ? getEmptyString() : intern(str)) {
+	}
+
+	Atom::Atom(const char* str):
+		m_string((!str || !*str) ? getEmptyString() : intern(str)) {
+	}
+
+	bool Atom::find(const std::string& str, Atom& atom) {
+		if (str.empty()) {
+			atom = Atom();
+			return true;
+		}
+		AtomTable& table = getAtomTable();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		std::unordered_set<std::string>::const_iterator it = table.strings.find(str);
+		if (it == table.strings.end()) {
+			return false;
+		}
+		atom = Atom(&(*it));
+		return true;
+	}
+
+	std::size_t Atom::getInternedCount() {
+		AtomTable& table = getAtomTable();
+		std::lock_guard<std::mutex> lock(table.mutex);
+		return table.strings.size();
+	}
+} //FIFE
@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_ATOM_H
+#define FIFE_ATOM_H
+
+// Standard C++ library includes
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+namespace FIFE {
+
+	/** Interned identifier string.
+	 * All atoms with the same text share one engine wide copy of it, so copying,
+	 * comparing and hashing an atom only touches a pointer. Interned strings are
+	 * never released, atoms are meant for identifiers like object, action, area
+	 * and cost ids, not for arbitrary text.
+	 *
+	 * Atoms convert implicitly from strings, so functions taking an atom also
+	 * accept strings and string literals. Functions that only look up existing
+	 * identifiers should use find() to avoid interning unknown strings.
+	 */
+	class Atom {
+	public:
+		/** Constructs the empty atom.
+		 */
+		Atom();
+
+		/** Constructs the atom of the given string, interning it if needed.
+		 */
+		Atom(const std::string& str);
+
+		/** Constructs the atom of the given string, interning it if needed.
+		 */
+		Atom(const char* str);
+
+		/** Looks up the atom of an already interned string.
+		 * @param str The string to look up.
+		 * @param atom Receives the atom, if it exists.
+		 * @return A boolean, true if the string is interned, otherwise false.
+		 */
+		static bool find(const std::string& str, Atom& atom);
+
+		/** Returns the number of interned strings.
+		 */
+		static std::size_t getInternedCount();
+
+		/** Returns the interned string.
+		 */
+		const std::string& str() const { return *m_string; }
+
+		/** Returns true if this is the empty atom.
+		 */
+		bool empty() const { return m_string->empty(); }
+
+		bool operator==(const Atom& atom) const { return m_string == atom.m_string; }
+		bool operator!=(const Atom& atom) const { return m_string != atom.m_string; }
+
+		/** Orders atoms by the address of their string, which is fast but not alphabetical.
+		 */
+		bool operator<(const Atom& atom) const { return std::less<const std::string*>()(m_string, atom.m_string); }
+
+		/** Returns a hash value, identical atoms have identical hashes.
+		 */
+		std::size_t hash() const { return std::hash<const std::string*>()(m_string); }
+
+	private:
+		explicit Atom(const std::string* str): m_string(str) {}
+
+		const std::string* m_string;
+	};
+
+	/** Print the text of the atom to a stream
+	 */
+	inline std::ostream& operator<<(std::ostream& os, const Atom& atom) {
+		return os << atom.str();
+	}
+} //FIFE
+
+namespace std {
+	template<>
+	struct hash<FIFE::Atom> {
+		std::size_t operator()(const FIFE::Atom& atom) const {
+			return atom.hash();
+		}
+	};
+}
+
+#endif
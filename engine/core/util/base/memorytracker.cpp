@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/log/logger.h"
+
+#include "memorytracker.h"
+
+namespace FIFE {
+	static Logger _log(LM_UTIL);
+
+	static const char* CATEGORY_NAMES[MEMORY_CATEGORY_COUNT] = {
+		"cells",
+		"instances",
+		"render items",
+		"layer cache",
+		"images",
+		"sound",
+		"zip",
+		"text"
+	};
+
+	MemoryTracker* MemoryTracker::instance() {
+		// allocations may be reported from any thread, the first use has to be thread safe
+		static MemoryTracker* tracker = new MemoryTracker();
+		return tracker;
+	}
+
+	MemoryTracker::MemoryTracker() {
+		for (int32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+			m_usage[i] = 0;
+			m_counts[i] = 0;
+			m_budgets[i] = 0;
+			m_overBudget[i] = false;
+		}
+	}
+
+	MemoryTracker::~MemoryTracker() {
+	}
+
+	void MemoryTracker::setUsageCallback(MemoryCategory category, const std::function<size_t()>& callback) {
+		m_callbacks[category] = callback;
+	}
+
+	size_t MemoryTracker::getUsage(MemoryCategory category) const {
+		if (m_callbacks[category]) {
+			return m_callbacks[category]();
+		}
+		return m_usage[category].load(std::memory_order_relaxed);
+	}
+
+	uint32_t MemoryTracker::getCount(MemoryCategory category) const {
+		if (m_callbacks[category]) {
+			return 0;
+		}
+		return m_counts[category].load(std::memory_order_relaxed);
+	}
+
+	size_t MemoryTracker::getTotalUsage() const {
+		size_t total = 0;
+		for (int32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+			total += getUsage(static_cast<MemoryCategory>(i));
+		}
+		return total;
+	}
+
+	std::string MemoryTracker::getCategoryName(MemoryCategory category) {
+		if (category < 0 || category >= MEMORY_CATEGORY_COUNT) {
+			return "unknown";
+		}
+		return CATEGORY_NAMES[category];
+	}
+
+	void MemoryTracker::setBudget(MemoryCategory category, size_t bytes) {
+		m_budgets[category] = bytes;
+		if (bytes == 0) {
+			m_overBudget[category] = false;
+		}
+	}
+
+	size_t MemoryTracker::getBudget(MemoryCategory category) const {
+		return m_budgets[category];
+	}
+
+	bool MemoryTracker::isOverBudget(MemoryCategory category) const {
+		return m_overBudget[category];
+	}
+
+	void MemoryTracker::addBudgetListener(IMemoryBudgetListener* listener) {
+		m_listeners.push_back(listener);
+	}
+
+	void MemoryTracker::removeBudgetListener(IMemoryBudgetListener* listener) {
+		m_listeners.erase(std::remove(m_listeners.begin(), m_listeners.end(), listener), m_listeners.end());
+	}
+
+	void MemoryTracker::checkBudgets() {
+		for (int32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+			MemoryCategory category = static_cast<MemoryCategory>(i);
+			size_t budget = m_budgets[i];
+			if (budget == 0) {
+				continue;
+			}
+			size_t usage = getUsage(category);
+			if (usage <= budget) {
+				m_overBudget[i] = false;
+				continue;
+			}
+			// only warn once per excess, the listeners are called until it is resolved
+			if (!m_overBudget[i]) {
+				m_overBudget[i] = true;
+				FL_WARN(_log, LMsg("Memory budget of ") << CATEGORY_NAMES[i] << " exceeded: "
+					<< usage << " of " << budget << " bytes used");
+			}
+			// a listener may remove itself
+			std::vector<IMemoryBudgetListener*> listeners = m_listeners;
+			std::vector<IMemoryBudgetListener*>::iterator it = listeners.begin();
+			for (; it != listeners.end(); ++it) {
+				(*it)->onBudgetExceeded(category, usage, budget);
+			}
+		}
+	}
+
+	void MemoryTracker::printStatistics() const {
+		for (int32_t i = 0; i < MEMORY_CATEGORY_COUNT; ++i) {
+			MemoryCategory category = static_cast<MemoryCategory>(i);
+			FL_LOG(_log, LMsg("Memory ") << CATEGORY_NAMES[i] << ": " << getUsage(category)
+				<< " bytes, " << getCount(category) << " objects, budget " << m_budgets[i]);
+		}
+		FL_LOG(_log, LMsg("Memory total: ") << getTotalUsage() << " bytes");
+	}
+
+} //FIFE
@@ -0,0 +1,185 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MEMORYTRACKER_H
+#define FIFE_MEMORYTRACKER_H
+
+// Standard C++ library includes
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "fife_stdint.h"
+
+namespace FIFE {
+
+	/** Subsystems whose memory is accounted.
+	 */
+	enum MemoryCategory {
+		MEMORY_CELLS = 0,
+		MEMORY_INSTANCES,
+		MEMORY_RENDER_ITEMS,
+		MEMORY_LAYER_CACHE,
+		MEMORY_IMAGES,
+		MEMORY_SOUND,
+		MEMORY_ZIP,
+		MEMORY_TEXT,
+		MEMORY_CATEGORY_COUNT
+	};
+
+	/** Listener that is informed about categories above their budget.
+	 */
+	class IMemoryBudgetListener {
+	public:
+		virtual ~IMemoryBudgetListener() {}
+
+		/** Called by MemoryTracker::checkBudgets() for each category above its budget.
+		 * The listener may free memory of the category, e.g. by evicting cached resources.
+		 * @param category The category.
+		 * @param usage The used memory in bytes.
+		 * @param budget The budget in bytes.
+		 */
+		virtual void onBudgetExceeded(MemoryCategory category, size_t usage, size_t budget) = 0;
+	};
+
+	/** Accounts the memory used by the subsystems of the engine.
+	 *
+	 * The owners of the memory report their allocations with add() and remove(),
+	 * which only touch atomic counters and may be called from any thread.
+	 * Categories that are already accounted by their manager provide a usage
+	 * callback instead.
+	 *
+	 * Each category can have a soft budget. checkBudgets(), which the engine calls
+	 * once per frame, logs a warning when a category exceeds its budget and calls
+	 * the budget listeners as long as it stays above.
+	 */
+	class MemoryTracker {
+	public:
+		/** Returns the tracker, it is created on first use.
+		 */
+		static MemoryTracker* instance();
+
+		/** Destructor.
+		 */
+		~MemoryTracker();
+
+		/** Reports allocated memory.
+		 * @param category The category of the memory.
+		 * @param bytes The number of bytes.
+		 * @param count The number of objects or buffers the bytes belong to.
+		 */
+		void add(MemoryCategory category, size_t bytes, uint32_t count = 1) {
+			m_usage[category].fetch_add(bytes, std::memory_order_relaxed);
+			m_counts[category].fetch_add(count, std::memory_order_relaxed);
+		}
+
+		/** Reports freed memory.
+		 * @param category The category of the memory.
+		 * @param bytes The number of bytes.
+		 * @param count The number of objects or buffers the bytes belong to.
+		 */
+		void remove(MemoryCategory category, size_t bytes, uint32_t count = 1) {
+			m_usage[category].fetch_sub(bytes, std::memory_order_relaxed);
+			m_counts[category].fetch_sub(count, std::memory_order_relaxed);
+		}
+
+		/** Sets a callback that returns the usage of the category, it replaces the counters.
+		 * @param category The category.
+		 * @param callback The callback, an empty one switches back to the counters.
+		 */
+		void setUsageCallback(MemoryCategory category, const std::function<size_t()>& callback);
+
+		/** Returns the used memory of the category in bytes.
+		 */
+		size_t getUsage(MemoryCategory category) const;
+
+		/** Returns the number of objects or buffers of the category.
+		 * Always 0 for categories with usage callback.
+		 */
+		uint32_t getCount(MemoryCategory category) const;
+
+		/** Returns the used memory of all categories in bytes.
+		 */
+		size_t getTotalUsage() const;
+
+		/** Returns the name of the category.
+		 */
+		static std::string getCategoryName(MemoryCategory category);
+
+		/** Sets the soft budget of the category.
+		 * @param category The category.
+		 * @param bytes The budget in bytes, 0 means no budget.
+		 */
+		void setBudget(MemoryCategory category, size_t bytes);
+
+		/** Returns the budget of the category in bytes, 0 if it has none.
+		 */
+		size_t getBudget(MemoryCategory category) const;
+
+		/** Returns true if the category was above its budget at the last check.
+		 */
+		bool isOverBudget(MemoryCategory category) const;
+
+		/** Adds a listener that is called for categories above their budget.
+		 */
+		void addBudgetListener(IMemoryBudgetListener* listener);
+
+		/** Removes a budget listener.
+		 */
+		void removeBudgetListener(IMemoryBudgetListener* listener);
+
+		/** Compares the usage of all categories with their budgets.
+		 * Logs categories that exceed their budget and calls the budget listeners.
+		 */
+		void checkBudgets();
+
+		/** Logs the usage of all categories.
+		 */
+		void printStatistics() const;
+
+	private:
+		MemoryTracker();
+
+		/// Bytes per category.
+		std::atomic<size_t> m_usage[MEMORY_CATEGORY_COUNT];
+		/// Objects or buffers per category.
+		std::atomic<uint32_t> m_counts[MEMORY_CATEGORY_COUNT];
+		/// Usage callbacks per category, empty if the counters are used.
+		std::function<size_t()> m_callbacks[MEMORY_CATEGORY_COUNT];
+		/// Budgets per category, 0 means no budget.
+		size_t m_budgets[MEMORY_CATEGORY_COUNT];
+		/// True for categories that were above their budget at the last check.
+		bool m_overBudget[MEMORY_CATEGORY_COUNT];
+		/// Listeners for categories above their budget.
+		std::vector<IMemoryBudgetListener*> m_listeners;
+	};
+
+}//FIFE
+
+#endif
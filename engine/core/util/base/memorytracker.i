@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+%module fife
+%{
+#include "util/base/memorytracker.h"
+%}
+
+namespace FIFE {
+	enum MemoryCategory {
+		MEMORY_CELLS = 0,
+		MEMORY_INSTANCES,
+		MEMORY_RENDER_ITEMS,
+		MEMORY_LAYER_CACHE,
+		MEMORY_IMAGES,
+		MEMORY_SOUND,
+		MEMORY_ZIP,
+		MEMORY_TEXT,
+		MEMORY_CATEGORY_COUNT
+	};
+
+	%feature("director") IMemoryBudgetListener;
+	class IMemoryBudgetListener {
+	public:
+		virtual ~IMemoryBudgetListener() {};
+		virtual void onBudgetExceeded(MemoryCategory category, size_t usage, size_t budget) = 0;
+	};
+
+	class MemoryTracker {
+	public:
+		static MemoryTracker* instance();
+		~MemoryTracker();
+		void add(MemoryCategory category, size_t bytes, uint32_t count = 1);
+		void remove(MemoryCategory category, size_t bytes, uint32_t count = 1);
+		size_t getUsage(MemoryCategory category) const;
+		uint32_t getCount(MemoryCategory category) const;
+		size_t getTotalUsage() const;
+		static std::string getCategoryName(MemoryCategory category);
+		void setBudget(MemoryCategory category, size_t bytes);
+		size_t getBudget(MemoryCategory category) const;
+		bool isOverBudget(MemoryCategory category) const;
+		void addBudgetListener(IMemoryBudgetListener* listener);
+		void removeBudgetListener(IMemoryBudgetListener* listener);
+		void checkBudgets();
+		void printStatistics() const;
+	private:
+		MemoryTracker();
+	};
+}
@@ -86,6 +86,12 @@ namespace FIFE {
 				return m_instance;
 			}
 
+			/** Returns true if the singleton was created and not yet destroyed.
+			 */
+			static bool isCreated() {
+				return m_instance != 0;
+			}
+
 			DynamicSingleton() {
 				assert(!m_instance);
 				m_instance = static_cast<T*>(this);
@@ -21,6 +21,7 @@
 
 %module fife
 %{
+#include "util/base/atom.h"
 #include "util/base/fifeclass.h"
 %}
 
@@ -29,6 +30,27 @@
 
 namespace FIFE {
 
+	class Atom;
+
+	/** Atoms are passed from python as plain strings.
+	 */
+	%typemap(in, fragment="SWIG_AsPtr_std_string") const Atom& (FIFE::Atom temp) {
+		std::string* ptr = 0;
+		int res = SWIG_AsPtr_std_string($input, &ptr);
+		if (!SWIG_IsOK(res) || !ptr) {
+			SWIG_exception_fail(SWIG_ArgError((ptr ? res : SWIG_TypeError)), "in method '$symname', argument $argnum of type 'std::string const &'");
+		}
+		temp = FIFE::Atom(*ptr);
+		if (SWIG_IsNewObj(res)) {
+			delete ptr;
+		}
+		$1 = &temp;
+	}
+
+	%typemap(typecheck, precedence=SWIG_TYPECHECK_STRING, fragment="SWIG_AsPtr_std_string") const Atom& {
+		$1 = SWIG_IsOK(SWIG_AsPtr_std_string($input, (std::string**)0));
+	}
+
 	typedef std::size_t fifeid_t;
 	
 	class FifeClass{
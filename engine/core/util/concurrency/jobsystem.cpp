@@ -0,0 +1,389 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cassert>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/profiler.h"
+
+#include "jobsystem.h"
+
+namespace FIFE {
+
+	// queue of the calling thread, only valid if s_jobSystem is the asking system
+	static thread_local const JobSystem* s_jobSystem = NULL;
+	static thread_local uint32_t s_queueIndex = 0;
+
+	ScratchArena::ScratchArena(size_t blockSize):
+		m_blockSize(blockSize),
+		m_block(0),
+		m_offset(0) {
+	}
+
+	ScratchArena::~ScratchArena() {
+		std::vector<Block>::iterator it = m_blocks.begin();
+		for (; it != m_blocks.end(); ++it) {
+			delete[] it->data;
+		}
+	}
+
+	void* ScratchArena::allocate(size_t bytes, size_t alignment) {
+		while (m_block < m_blocks.size()) {
+			Block& block = m_blocks[m_block];
+			uintptr_t start = reinterpret_cast<uintptr_t>(block.data) + m_offset;
+			uintptr_t aligned = (start + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+			size_t offset = m_offset + static_cast<size_t>(aligned - start);
+			if (offset + bytes <= block.size) {
+				m_offset = offset + bytes;
+				return block.data + offset;
+			}
+			// the rest of the block stays unused until the arena is rewound
+			++m_block;
+			m_offset = 0;
+			// blocks after the current one are unused, so a too small one can go
+			if (m_block < m_blocks.size() && m_blocks[m_block].size < bytes + alignment) {
+				delete[] m_blocks[m_block].data;
+				m_blocks.erase(m_blocks.begin() + m_block);
+			}
+		}
+		Block block;
+		block.size = std::max(m_blockSize, bytes + alignment);
+		block.data = new uint8_t[block.size];
+		m_blocks.push_back(block);
+		m_block = static_cast<uint32_t>(m_blocks.size() - 1);
+		m_offset = 0;
+		return allocate(bytes, alignment);
+	}
+
+	ScratchArena::Marker ScratchArena::getMarker() const {
+		Marker marker;
+		marker.block = m_block;
+		marker.offset = m_offset;
+		return marker;
+	}
+
+	void ScratchArena::rewind(const Marker& marker) {
+		m_block = marker.block;
+		m_offset = marker.offset;
+	}
+
+	void ScratchArena::reset() {
+		m_block = 0;
+		m_offset = 0;
+	}
+
+	size_t ScratchArena::getUsed() const {
+		size_t used = m_offset;
+		for (uint32_t i = 0; i < m_block && i < m_blocks.size(); ++i) {
+			used += m_blocks[i].size;
+		}
+		return used;
+	}
+
+	size_t ScratchArena::getCapacity() const {
+		size_t capacity = 0;
+		std::vector<Block>::const_iterator it = m_blocks.begin();
+		for (; it != m_blocks.end(); ++it) {
+			capacity += it->size;
+		}
+		return capacity;
+	}
+
+	ScratchScope::ScratchScope():
+		m_arena(JobSystem::getScratchArena()),
+		m_marker(m_arena.getMarker()) {
+	}
+
+	ScratchScope::~ScratchScope() {
+		m_arena.rewind(m_marker);
+	}
+
+	Job::Job(const std::function<void()>& task):
+		m_task(task),
+		m_waiting(1),
+		m_finished(false),
+		m_submitted(false) {
+	}
+
+	JobSystem::JobSystem(uint32_t threads):
+		m_queuedJobs(0),
+		m_waitingThreads(0),
+		m_stop(false) {
+		for (uint32_t i = 0; i <= threads; ++i) {
+			m_queues.push_back(new JobQueue());
+		}
+		for (uint32_t i = 1; i <= threads; ++i) {
+			m_threads.push_back(std::thread(&JobSystem::workerLoop, this, i));
+		}
+	}
+
+	JobSystem::~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_workCondition.notify_all();
+		std::vector<std::thread>::iterator it = m_threads.begin();
+		for (; it != m_threads.end(); ++it) {
+			it->join();
+		}
+		std::vector<JobQueue*>::iterator qit = m_queues.begin();
+		for (; qit != m_queues.end(); ++qit) {
+			delete *qit;
+		}
+	}
+
+	uint32_t JobSystem::getThreadCount() const {
+		return static_cast<uint32_t>(m_threads.size());
+	}
+
+	JobPtr JobSystem::createJob(const Task& task) {
+		return JobPtr(new Job(task));
+	}
+
+	void JobSystem::addDependency(const JobPtr& job, const JobPtr& dependency) {
+		assert(!job->m_submitted);
+		std::lock_guard<std::mutex> lock(dependency->m_mutex);
+		if (dependency->isFinished()) {
+			return;
+		}
+		job->m_waiting.fetch_add(1);
+		dependency->m_dependents.push_back(job);
+	}
+
+	void JobSystem::setCompletion(const JobPtr& job, const Task& completion) {
+		assert(!job->m_submitted);
+		job->m_completion = completion;
+	}
+
+	void JobSystem::submit(const JobPtr& job) {
+		assert(!job->m_submitted);
+		job->m_submitted = true;
+		if (job->m_waiting.fetch_sub(1) == 1) {
+			enqueue(job);
+		}
+	}
+
+	JobPtr JobSystem::run(const Task& task) {
+		JobPtr job = createJob(task);
+		submit(job);
+		return job;
+	}
+
+	void JobSystem::wait(const JobPtr& job) {
+		assert(job->m_submitted);
+		helpUntil([&job]() { return job->isFinished(); });
+		if (job->m_exception) {
+			std::rethrow_exception(job->m_exception);
+		}
+	}
+
+	void JobSystem::parallelFor(uint32_t count, const RangeJob& job, uint32_t grain) {
+		if (count == 0) {
+			return;
+		}
+		grain = std::max(grain, 1u);
+		if (m_threads.empty() || count <= grain) {
+			job(0, count);
+			return;
+		}
+		// a few chunks per thread keep the threads busy if chunks differ in costs
+		uint32_t chunk = std::max(grain, count / ((getThreadCount() + 1) * 4));
+		uint32_t chunks = (count + chunk - 1) / chunk;
+		std::atomic<uint32_t> remaining(chunks);
+		std::mutex exceptionMutex;
+		std::exception_ptr exception;
+		for (uint32_t i = 0; i < chunks; ++i) {
+			uint32_t begin = i * chunk;
+			uint32_t end = std::min(begin + chunk, count);
+			run([&job, &remaining, &exceptionMutex, &exception, begin, end]() {
+				try {
+					job(begin, end);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(exceptionMutex);
+					if (!exception) {
+						exception = std::current_exception();
+					}
+				}
+				remaining.fetch_sub(1);
+			});
+		}
+		helpUntil([&remaining]() { return remaining.load() == 0; });
+		if (exception) {
+			std::rethrow_exception(exception);
+		}
+	}
+
+	void JobSystem::postToMainThread(const Task& task) {
+		std::lock_guard<std::mutex> lock(m_completionMutex);
+		m_completions.push_back(task);
+	}
+
+	uint32_t JobSystem::processCompletions() {
+		std::vector<Task> completions;
+		{
+			std::lock_guard<std::mutex> lock(m_completionMutex);
+			completions.swap(m_completions);
+		}
+		// callbacks posted by the callbacks run in the next call
+		std::vector<Task>::iterator it = completions.begin();
+		for (; it != completions.end(); ++it) {
+			(*it)();
+		}
+		return static_cast<uint32_t>(completions.size());
+	}
+
+	ScratchArena& JobSystem::getScratchArena() {
+		static thread_local ScratchArena arena;
+		return arena;
+	}
+
+	void JobSystem::workerLoop(uint32_t queue) {
+		s_jobSystem = this;
+		s_queueIndex = queue;
+		TraceRecorder::instance()->setThreadName("jobs");
+		while (true) {
+			JobPtr job = takeJob();
+			if (job) {
+				execute(job);
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (m_stop && m_queuedJobs.load() == 0) {
+				return;
+			}
+			m_workCondition.wait(lock, [this] { return m_stop || m_queuedJobs.load() > 0; });
+		}
+	}
+
+	void JobSystem::enqueue(const JobPtr& job) {
+		if (m_threads.empty()) {
+			execute(job);
+			return;
+		}
+		JobQueue* queue = m_queues[getQueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			queue->jobs.push_back(job);
+		}
+		m_queuedJobs.fetch_add(1);
+		{
+			// sleeping threads check the counter under the lock, so they can't miss the wakeup
+			std::lock_guard<std::mutex> lock(m_mutex);
+		}
+		m_workCondition.notify_one();
+		if (m_waitingThreads.load() > 0) {
+			m_doneCondition.notify_all();
+		}
+	}
+
+	JobPtr JobSystem::takeJob() {
+		if (m_queuedJobs.load() == 0) {
+			return JobPtr();
+		}
+		uint32_t index = getQueueIndex();
+		uint32_t queues = static_cast<uint32_t>(m_queues.size());
+		// workers take their newest job, it is most likely still in the cache
+		if (index != 0) {
+			JobQueue* own = m_queues[index];
+			std::lock_guard<std::mutex> lock(own->mutex);
+			if (!own->jobs.empty()) {
+				JobPtr job = own->jobs.back();
+				own->jobs.pop_back();
+				m_queuedJobs.fetch_sub(1);
+				return job;
+			}
+		}
+		// otherwise the oldest job of another queue is stolen
+		for (uint32_t i = 0; i < queues; ++i) {
+			uint32_t victim = (index + i + (index != 0 ? 1 : 0)) % queues;
+			if (victim == index && index != 0) {
+				continue;
+			}
+			JobQueue* queue = m_queues[victim];
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			if (!queue->jobs.empty()) {
+				JobPtr job = queue->jobs.front();
+				queue->jobs.pop_front();
+				m_queuedJobs.fetch_sub(1);
+				return job;
+			}
+		}
+		return JobPtr();
+	}
+
+	void JobSystem::execute(const JobPtr& job) {
+		try {
+			FIFE_PROFILE_ZONE("job");
+			job->m_task();
+		} catch (...) {
+			job->m_exception = std::current_exception();
+		}
+		// the task may hold references, they are released before the job is finished
+		job->m_task = Task();
+		std::vector<JobPtr> dependents;
+		{
+			std::lock_guard<std::mutex> lock(job->m_mutex);
+			job->m_finished.store(true);
+			dependents.swap(job->m_dependents);
+		}
+		if (job->m_completion) {
+			postToMainThread(job->m_completion);
+		}
+		std::vector<JobPtr>::iterator it = dependents.begin();
+		for (; it != dependents.end(); ++it) {
+			if ((*it)->m_waiting.fetch_sub(1) == 1) {
+				enqueue(*it);
+			}
+		}
+		if (m_waitingThreads.load() > 0) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_doneCondition.notify_all();
+		}
+	}
+
+	void JobSystem::helpUntil(const std::function<bool()>& done) {
+		while (!done()) {
+			JobPtr job = takeJob();
+			if (job) {
+				execute(job);
+				continue;
+			}
+			m_waitingThreads.fetch_add(1);
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_doneCondition.wait(lock, [this, &done] { return done() || m_queuedJobs.load() > 0; });
+			}
+			m_waitingThreads.fetch_sub(1);
+		}
+	}
+
+	uint32_t JobSystem::getQueueIndex() const {
+		return s_jobSystem == this ? s_queueIndex : 0;
+	}
+}
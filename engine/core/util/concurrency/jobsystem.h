@@ -0,0 +1,307 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_JOBSYSTEM_H
+#define FIFE_JOBSYSTEM_H
+
+// Standard C++ library includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+#include "util/base/singleton.h"
+
+namespace FIFE {
+
+	class Job;
+	typedef std::shared_ptr<Job> JobPtr;
+
+	/** Bump allocator for temporary memory of jobs.
+	 *
+	 * Every thread has its own arena, see JobSystem::getScratchArena().
+	 * Memory is never freed one by one, the arena is rewound to a marker
+	 * instead, usually by a ScratchScope. The blocks are kept for reuse.
+	 * Destructors of objects placed in the arena are not called.
+	 */
+	class ScratchArena {
+	public:
+		/** Position in the arena, returned by getMarker().
+		 */
+		struct Marker {
+			uint32_t block;
+			size_t offset;
+		};
+
+		/** Constructor.
+		 * @param blockSize Size of the blocks the memory is taken from.
+		 */
+		ScratchArena(size_t blockSize = 64 * 1024);
+
+		/** Destructor. Frees all blocks.
+		 */
+		~ScratchArena();
+
+		/** Returns uninitialized memory that stays valid until the arena is rewound.
+		 * @param bytes The number of bytes.
+		 * @param alignment The alignment, must be a power of two.
+		 */
+		void* allocate(size_t bytes, size_t alignment = sizeof(void*));
+
+		/** Returns uninitialized memory for count objects of type T.
+		 */
+		template <typename T>
+		T* allocateArray(size_t count) {
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		/** Returns the current position.
+		 */
+		Marker getMarker() const;
+
+		/** Releases all memory allocated after the marker was taken.
+		 */
+		void rewind(const Marker& marker);
+
+		/** Releases all memory, the blocks are kept.
+		 */
+		void reset();
+
+		/** Returns the number of bytes in use, including alignment padding.
+		 */
+		size_t getUsed() const;
+
+		/** Returns the size of all blocks.
+		 */
+		size_t getCapacity() const;
+
+	private:
+		struct Block {
+			uint8_t* data;
+			size_t size;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t m_blockSize;
+		// current block and the used bytes in it
+		uint32_t m_block;
+		size_t m_offset;
+	};
+
+	/** Rewinds the scratch arena of the calling thread when it goes out of scope.
+	 */
+	class ScratchScope {
+	public:
+		ScratchScope();
+		~ScratchScope();
+
+		/** Returns the scratch arena of the calling thread.
+		 */
+		ScratchArena& getArena() { return m_arena; }
+
+	private:
+		ScratchArena& m_arena;
+		ScratchArena::Marker m_marker;
+	};
+
+	/** A task that is run by the JobSystem.
+	 *
+	 * Jobs are created by JobSystem::createJob() and run once after submit()
+	 * was called and all their dependencies are finished.
+	 */
+	class Job {
+	public:
+		/** Returns true if the task was run.
+		 */
+		bool isFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+
+		Job(const std::function<void()>& task);
+
+		std::function<void()> m_task;
+		// called on the main thread after the task, may be empty
+		std::function<void()> m_completion;
+		// unfinished dependencies, plus one until the job is submitted
+		std::atomic<int32_t> m_waiting;
+		std::atomic<bool> m_finished;
+		bool m_submitted;
+		// guards m_dependents and the transition to finished
+		std::mutex m_mutex;
+		std::vector<JobPtr> m_dependents;
+		// exception thrown by the task, rethrown by JobSystem::wait()
+		std::exception_ptr m_exception;
+	};
+
+	/** Engine wide pool of worker threads.
+	 *
+	 * Each worker has its own job queue. It runs its newest jobs first and
+	 * steals the oldest jobs from the other queues once its own is empty.
+	 * Threads that are not workers submit to a shared queue. Threads that
+	 * wait for jobs help running them, so waiting never blocks the pool.
+	 *
+	 * Jobs can depend on other jobs and can have a completion callback
+	 * that runs on the main thread in processCompletions(), which the engine
+	 * calls once per frame. Everything that touches the model, the GUI or
+	 * the render backend belongs into such a callback.
+	 *
+	 * Without worker threads all jobs run inline when they are submitted.
+	 */
+	class JobSystem : public DynamicSingleton<JobSystem> {
+	public:
+		typedef std::function<void()> Task;
+
+		/** Job callback for parallelFor(), gets a half open range [begin, end) of items to process.
+		 */
+		typedef std::function<void(uint32_t, uint32_t)> RangeJob;
+
+		/** Constructor.
+		 * @param threads The number of worker threads, the calling thread is not included.
+		 */
+		JobSystem(uint32_t threads);
+
+		/** Destructor. Runs the submitted jobs and joins the worker threads.
+		 * Jobs whose dependencies were never submitted are dropped.
+		 */
+		virtual ~JobSystem();
+
+		/** Returns the number of worker threads.
+		 */
+		uint32_t getThreadCount() const;
+
+		/** Creates a job, it is not run before it is submitted.
+		 */
+		JobPtr createJob(const Task& task);
+
+		/** Makes the job wait for another job. Must be called before the job is submitted.
+		 * A dependency that throws still releases its dependents.
+		 * @param job The job that waits.
+		 * @param dependency The job that has to finish first.
+		 */
+		void addDependency(const JobPtr& job, const JobPtr& dependency);
+
+		/** Sets a callback that is called on the main thread after the job finished.
+		 * Must be called before the job is submitted.
+		 */
+		void setCompletion(const JobPtr& job, const Task& completion);
+
+		/** Queues the job, it runs as soon as all dependencies are finished.
+		 */
+		void submit(const JobPtr& job);
+
+		/** Creates and submits a job.
+		 */
+		JobPtr run(const Task& task);
+
+		/** Blocks until the job is finished and runs other jobs in the meantime.
+		 * Rethrows an exception thrown by the job.
+		 */
+		void wait(const JobPtr& job);
+
+		/** Splits count items into chunks and processes them on all threads.
+		 * Blocks until all chunks are done. An exception thrown by the job
+		 * is rethrown after all chunks finished.
+		 *
+		 * @param count The number of items.
+		 * @param job The job that is called for every chunk.
+		 * @param grain The minimal number of items per chunk.
+		 */
+		void parallelFor(uint32_t count, const RangeJob& job, uint32_t grain = 64);
+
+		/** Queues a callback that is called on the main thread in processCompletions().
+		 * Can be called from any thread.
+		 */
+		void postToMainThread(const Task& task);
+
+		/** Calls the queued main thread callbacks. Called by the engine once per frame.
+		 * @return The number of called callbacks.
+		 */
+		uint32_t processCompletions();
+
+		/** Returns the scratch arena of the calling thread.
+		 */
+		static ScratchArena& getScratchArena();
+
+	private:
+		struct JobQueue {
+			std::mutex mutex;
+			std::deque<JobPtr> jobs;
+		};
+
+		/** Main loop of the worker threads.
+		 */
+		void workerLoop(uint32_t queue);
+
+		/** Adds a job whose dependencies are finished to the queue of the calling thread.
+		 */
+		void enqueue(const JobPtr& job);
+
+		/** Takes a job from the queue of the calling thread or steals one from another queue.
+		 */
+		JobPtr takeJob();
+
+		/** Runs the job and releases its dependents.
+		 */
+		void execute(const JobPtr& job);
+
+		/** Runs jobs until done returns true, sleeps if there is nothing to run.
+		 */
+		void helpUntil(const std::function<bool()>& done);
+
+		/** Returns the index of the queue of the calling thread, 0 for non worker threads.
+		 */
+		uint32_t getQueueIndex() const;
+
+		std::vector<std::thread> m_threads;
+		// queue 0 is shared by all non worker threads, the others belong to one worker each
+		std::vector<JobQueue*> m_queues;
+		// number of jobs in all queues
+		std::atomic<uint32_t> m_queuedJobs;
+		// number of threads that wait for jobs to finish
+		std::atomic<uint32_t> m_waitingThreads;
+
+		std::mutex m_mutex;
+		// wakes idle workers if jobs are queued
+		std::condition_variable m_workCondition;
+		// wakes waiting threads if jobs are finished
+		std::condition_variable m_doneCondition;
+		bool m_stop;
+
+		std::mutex m_completionMutex;
+		std::vector<Task> m_completions;
+	};
+}
+
+#endif
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// the AVX2 kernel is compiled for its own target and selected at runtime
+#define FIFE_BATCHTRANSFORM_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "batchtransform.h"
+
+namespace FIFE {
+#if defined(FIFE_BATCHTRANSFORM_AVX2)
+	/** Transforms four points per iteration with AVX2 and FMA, only called if the cpu supports both.
+	 * @return The number of transformed points, the caller handles the remainder.
+	 */
+	__attribute__((target("avx2,fma")))
+	static size_t transformPointsAVX2(const double* m,
+		const double* inX, const double* inY, const double* inZ,
+		double* outX, double* outY, double* outZ, size_t count) {
+		const __m256d m0 = _mm256_set1_pd(m[0]), m1 = _mm256_set1_pd(m[1]), m2 = _mm256_set1_pd(m[2]);
+		const __m256d m4 = _mm256_set1_pd(m[4]), m5 = _mm256_set1_pd(m[5]), m6 = _mm256_set1_pd(m[6]);
+		const __m256d m8 = _mm256_set1_pd(m[8]), m9 = _mm256_set1_pd(m[9]), m10 = _mm256_set1_pd(m[10]);
+		const __m256d m12 = _mm256_set1_pd(m[12]), m13 = _mm256_set1_pd(m[13]), m14 = _mm256_set1_pd(m[14]);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m256d x = _mm256_loadu_pd(inX + i);
+			const __m256d y = _mm256_loadu_pd(inY + i);
+			const __m256d z = _mm256_loadu_pd(inZ + i);
+			const __m256d rx = _mm256_fmadd_pd(x, m0, _mm256_fmadd_pd(y, m4, _mm256_fmadd_pd(z, m8, m12)));
+			const __m256d ry = _mm256_fmadd_pd(x, m1, _mm256_fmadd_pd(y, m5, _mm256_fmadd_pd(z, m9, m13)));
+			const __m256d rz = _mm256_fmadd_pd(x, m2, _mm256_fmadd_pd(y, m6, _mm256_fmadd_pd(z, m10, m14)));
+			_mm256_storeu_pd(outX + i, rx);
+			_mm256_storeu_pd(outY + i, ry);
+			_mm256_storeu_pd(outZ + i, rz);
+		}
+		return i;
+	}
+#endif
+
+	bool isAVX2TransformSupported() {
+#if defined(FIFE_BATCHTRANSFORM_AVX2)
+		static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	void transformPoints(const DoubleMatrix& matrix,
+		const double* inX, const double* inY, const double* inZ,
+		double* outX, double* outY, double* outZ, size_t count) {
+		const double* m = matrix.m;
+		size_t i = 0;
+#if defined(FIFE_BATCHTRANSFORM_AVX2)
+		if (isAVX2TransformSupported()) {
+			i = transformPointsAVX2(m, inX, inY, inZ, outX, outY, outZ, count);
+		}
+#endif
+#if defined(__SSE2__)
+		const __m128d m0 = _mm_set1_pd(m[0]), m1 = _mm_set1_pd(m[1]), m2 = _mm_set1_pd(m[2]);
+		const __m128d m4 = _mm_set1_pd(m[4]), m5 = _mm_set1_pd(m[5]), m6 = _mm_set1_pd(m[6]);
+		const __m128d m8 = _mm_set1_pd(m[8]), m9 = _mm_set1_pd(m[9]), m10 = _mm_set1_pd(m[10]);
+		const __m128d m12 = _mm_set1_pd(m[12]), m13 = _mm_set1_pd(m[13]), m14 = _mm_set1_pd(m[14]);
+		for (; i + 2 <= count; i += 2) {
+			const __m128d x = _mm_loadu_pd(inX + i);
+			const __m128d y = _mm_loadu_pd(inY + i);
+			const __m128d z = _mm_loadu_pd(inZ + i);
+			__m128d rx = _mm_add_pd(_mm_mul_pd(x, m0), _mm_mul_pd(y, m4));
+			rx = _mm_add_pd(_mm_add_pd(rx, _mm_mul_pd(z, m8)), m12);
+			__m128d ry = _mm_add_pd(_mm_mul_pd(x, m1), _mm_mul_pd(y, m5));
+			ry = _mm_add_pd(_mm_add_pd(ry, _mm_mul_pd(z, m9)), m13);
+			__m128d rz = _mm_add_pd(_mm_mul_pd(x, m2), _mm_mul_pd(y, m6));
+			rz = _mm_add_pd(_mm_add_pd(rz, _mm_mul_pd(z, m10)), m14);
+			_mm_storeu_pd(outX + i, rx);
+			_mm_storeu_pd(outY + i, ry);
+			_mm_storeu_pd(outZ + i, rz);
+		}
+#endif
+		// scalar fallback and remainder
+		for (; i < count; ++i) {
+			const double x = inX[i];
+			const double y = inY[i];
+			const double z = inZ[i];
+			outX[i] = x * m[0] + y * m[4] + z * m[8] + m[12];
+			outY[i] = x * m[1] + y * m[5] + z * m[9] + m[13];
+			outZ[i] = x * m[2] + y * m[6] + z * m[10] + m[14];
+		}
+	}
+
+	void transformPoints(const DoubleMatrix& matrix, const DoublePoint3DArray& in, DoublePoint3DArray& out) {
+		const size_t count = in.size();
+		out.resize(count);
+		if (count == 0) {
+			return;
+		}
+		transformPoints(matrix, &in.x[0], &in.y[0], &in.z[0], &out.x[0], &out.y[0], &out.z[0], count);
+	}
+} //FIFE
@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_BATCHTRANSFORM_H
+#define FIFE_BATCHTRANSFORM_H
+
+// Standard C++ library includes
+#include <cstddef>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/structures/point.h"
+
+#include "matrix.h"
+
+namespace FIFE {
+
+	/** Structure of arrays holding three dimensional double precision points.
+	 * Keeping the components in separate contiguous arrays allows the batch
+	 * transforms to process several points per instruction.
+	 */
+	struct DoublePoint3DArray {
+		std::vector<double> x;
+		std::vector<double> y;
+		std::vector<double> z;
+
+		size_t size() const {
+			return x.size();
+		}
+
+		bool empty() const {
+			return x.empty();
+		}
+
+		void resize(size_t count) {
+			x.resize(count);
+			y.resize(count);
+			z.resize(count);
+		}
+
+		void reserve(size_t count) {
+			x.reserve(count);
+			y.reserve(count);
+			z.reserve(count);
+		}
+
+		void clear() {
+			x.clear();
+			y.clear();
+			z.clear();
+		}
+
+		void push_back(const DoublePoint3D& point) {
+			x.push_back(point.x);
+			y.push_back(point.y);
+			z.push_back(point.z);
+		}
+
+		DoublePoint3D get(size_t index) const {
+			return DoublePoint3D(x[index], y[index], z[index]);
+		}
+
+		void set(size_t index, const DoublePoint3D& point) {
+			x[index] = point.x;
+			y[index] = point.y;
+			z[index] = point.z;
+		}
+	};
+
+	/** Transforms count points with the given matrix, same as matrix * point for each of them.
+	 * Uses AVX2 if the cpu supports it, @see isAVX2TransformSupported. Otherwise SSE2
+	 * if the compiler targets it, otherwise a scalar loop.
+	 * The output arrays may be the same as the input arrays.
+	 */
+	void transformPoints(const DoubleMatrix& matrix,
+		const double* inX, const double* inY, const double* inZ,
+		double* outX, double* outY, double* outZ, size_t count);
+
+	/** Transforms all points of in with the given matrix and stores them in out.
+	 * out is resized to the size of in, in and out may be the same array.
+	 */
+	void transformPoints(const DoubleMatrix& matrix, const DoublePoint3DArray& in, DoublePoint3DArray& out);
+
+	/** Returns true, if transformPoints uses the AVX2 path.
+	 * It is built on x86 with gcc or clang and selected if the cpu supports AVX2 and FMA,
+	 * independent of the instruction set the rest of the engine is compiled for.
+	 */
+	bool isAVX2TransformSupported();
+
+} //FIFE
+
+#endif
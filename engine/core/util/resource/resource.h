@@ -67,6 +67,8 @@ namespace FIFE {
 
 		ResourceHandle getHandle() { return m_handle; }
 
+		IResourceLoader* getLoader() const { return m_loader; }
+
 		virtual ResourceState getState() { return m_state; }
 		virtual void setState(const ResourceState& state) { m_state = state; }
 
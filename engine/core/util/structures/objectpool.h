@@ -0,0 +1,148 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_UTIL_OBJECTPOOL_H
+#define FIFE_UTIL_OBJECTPOOL_H
+
+// Standard C++ library includes
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** Free list allocator for objects of one type.
+	 *
+	 * Memory is taken from the system in chunks of ChunkSize objects and
+	 * released objects are kept on a free list for the next allocation.
+	 * Chunks are never given back, so the pool only grows to the highest
+	 * number of objects that were alive at the same time.
+	 *
+	 * A class uses the pool by forwarding its operator new and delete:
+	 * @code
+	 * static void* operator new(std::size_t size) { return ObjectPool<Foo>::allocate(size); }
+	 * static void operator delete(void* ptr, std::size_t size) { ObjectPool<Foo>::deallocate(ptr, size); }
+	 * @endcode
+	 * Objects of derived classes have a different size and use the global operators.
+	 */
+	template<typename T, uint32_t ChunkSize = 256>
+	class ObjectPool {
+	public:
+		/** Returns memory for one object.
+		 * @param size The size of the object, the global operator new is used if it's not sizeof(T).
+		 */
+		static void* allocate(std::size_t size) {
+			if (size != sizeof(T)) {
+				return ::operator new(size);
+			}
+			return pool().pop();
+		}
+
+		/** Gives the memory of an object back to the pool.
+		 * @param ptr The pointer returned by allocate, can be NULL.
+		 * @param size The size that was given to allocate.
+		 */
+		static void deallocate(void* ptr, std::size_t size) {
+			if (!ptr) {
+				return;
+			}
+			if (size != sizeof(T)) {
+				::operator delete(ptr);
+				return;
+			}
+			pool().push(ptr);
+		}
+
+		/** Returns the number of chunks that were requested from the system.
+		 */
+		static uint32_t getChunkCount() {
+			Pool& p = pool();
+			std::lock_guard<std::mutex> lock(p.m_mutex);
+			return static_cast<uint32_t>(p.m_chunks.size());
+		}
+
+		/** Returns the number of objects that are currently allocated from the pool.
+		 */
+		static uint32_t getUsedCount() {
+			Pool& p = pool();
+			std::lock_guard<std::mutex> lock(p.m_mutex);
+			return p.m_used;
+		}
+
+	private:
+		union Slot {
+			Slot* m_next;
+			typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type m_storage;
+		};
+
+		struct Pool {
+			Pool(): m_free(NULL), m_used(0) {}
+
+			void* pop() {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_free) {
+					Slot* chunk = static_cast<Slot*>(::operator new(sizeof(Slot) * ChunkSize));
+					m_chunks.push_back(chunk);
+					for (uint32_t i = 0; i < ChunkSize; ++i) {
+						chunk[i].m_next = m_free;
+						m_free = &chunk[i];
+					}
+				}
+				Slot* slot = m_free;
+				m_free = slot->m_next;
+				++m_used;
+				return slot;
+			}
+
+			void push(void* ptr) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				Slot* slot = static_cast<Slot*>(ptr);
+				slot->m_next = m_free;
+				m_free = slot;
+				--m_used;
+			}
+
+			std::mutex m_mutex;
+			Slot* m_free;
+			uint32_t m_used;
+			std::vector<Slot*> m_chunks;
+		};
+
+		/** The pool is never destroyed, objects can still be released during static destruction.
+		 */
+		static Pool& pool() {
+			static Pool* p = new Pool();
+			return *p;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,278 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+
+#include "profiler.h"
+
+namespace FIFE {
+	static Logger _log(LM_UTIL);
+
+	static const uint32_t DEFAULT_HISTORY_SIZE = 120;
+	static const std::string FRAME_ZONE = "frame";
+
+	ProfilerNode::ProfilerNode(const std::string& name, ProfilerNode* parent, uint32_t historySize):
+		name(name),
+		parent(parent),
+		start(0),
+		frameTicks(0),
+		frameCalls(0),
+		lastCalls(0),
+		history(historySize, 0.0),
+		recorded(0) {
+	}
+
+	ProfilerNode::~ProfilerNode() {
+		std::vector<ProfilerNode*>::iterator it = children.begin();
+		for (; it != children.end(); ++it) {
+			delete *it;
+		}
+	}
+
+	static void recordNode(ProfilerNode* node, uint32_t index, double ticksPerMs) {
+		node->history[index] = static_cast<double>(node->frameTicks) / ticksPerMs;
+		node->recorded = std::min(node->recorded + 1, static_cast<uint32_t>(node->history.size()));
+		node->lastCalls = node->frameCalls;
+		node->frameTicks = 0;
+		node->frameCalls = 0;
+		std::vector<ProfilerNode*>::iterator it = node->children.begin();
+		for (; it != node->children.end(); ++it) {
+			recordNode(*it, index, ticksPerMs);
+		}
+	}
+
+	static void resizeHistory(ProfilerNode* node, uint32_t size) {
+		node->history.assign(size, 0.0);
+		node->recorded = 0;
+		std::vector<ProfilerNode*>::iterator it = node->children.begin();
+		for (; it != node->children.end(); ++it) {
+			resizeHistory(*it, size);
+		}
+	}
+
+	static void collectZones(const ProfilerNode* node, const std::string& path, std::vector<std::string>& zones) {
+		zones.push_back(path);
+		std::vector<ProfilerNode*>::const_iterator it = node->children.begin();
+		for (; it != node->children.end(); ++it) {
+			collectZones(*it, path + "/" + (*it)->name, zones);
+		}
+	}
+
+	Profiler* Profiler::instance() {
+		// zones on worker threads ask for the profiler too, the first use has to be thread safe
+		static Profiler* profiler = new Profiler();
+		return profiler;
+	}
+
+	Profiler::Profiler():
+		m_root(new ProfilerNode(FRAME_ZONE, NULL, DEFAULT_HISTORY_SIZE)),
+		m_current(NULL),
+		m_thread(std::thread::id()),
+		m_ticksPerMs(static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0),
+		m_historySize(DEFAULT_HISTORY_SIZE),
+		m_historyIndex(0),
+		m_enabled(false) {
+	}
+
+	Profiler::~Profiler() {
+		delete m_root;
+	}
+
+	void Profiler::setEnabled(bool enabled) {
+		m_enabled = enabled;
+	}
+
+	bool Profiler::isEnabled() const {
+		return m_enabled;
+	}
+
+	void Profiler::setHistorySize(uint32_t frames) {
+		m_historySize = std::max(frames, 1u);
+		m_historyIndex = 0;
+		resizeHistory(m_root, m_historySize);
+	}
+
+	uint32_t Profiler::getHistorySize() const {
+		return m_historySize;
+	}
+
+	void Profiler::beginFrame() {
+		if (isRecording()) {
+			endFrame();
+		}
+		if (!m_enabled) {
+			return;
+		}
+		m_thread.store(std::this_thread::get_id(), std::memory_order_release);
+		m_current = m_root;
+		m_root->frameCalls = 1;
+		m_root->start = SDL_GetPerformanceCounter();
+	}
+
+	void Profiler::endFrame() {
+		if (!isRecording()) {
+			return;
+		}
+		uint64_t now = SDL_GetPerformanceCounter();
+		// zones that are still open end with the frame
+		for (; m_current; m_current = m_current->parent) {
+			m_current->frameTicks += now - m_current->start;
+		}
+		recordNode(m_root, m_historyIndex, m_ticksPerMs);
+		m_historyIndex = (m_historyIndex + 1) % m_historySize;
+	}
+
+	bool Profiler::beginZone(const std::string& name) {
+		if (!isRecording()) {
+			return false;
+		}
+		ProfilerNode* zone = NULL;
+		std::vector<ProfilerNode*>::iterator it = m_current->children.begin();
+		for (; it != m_current->children.end(); ++it) {
+			if ((*it)->name == name) {
+				zone = *it;
+				break;
+			}
+		}
+		if (!zone) {
+			zone = new ProfilerNode(name, m_current, m_historySize);
+			m_current->children.push_back(zone);
+		}
+		++zone->frameCalls;
+		m_current = zone;
+		zone->start = SDL_GetPerformanceCounter();
+		return true;
+	}
+
+	void Profiler::endZone() {
+		if (!isRecording() || m_current == m_root) {
+			return;
+		}
+		m_current->frameTicks += SDL_GetPerformanceCounter() - m_current->start;
+		m_current = m_current->parent;
+	}
+
+	std::vector<std::string> Profiler::getZones() const {
+		std::vector<std::string> zones;
+		collectZones(m_root, m_root->name, zones);
+		return zones;
+	}
+
+	uint32_t Profiler::getCallCount(const std::string& zone) const {
+		return findZone(zone)->lastCalls;
+	}
+
+	double Profiler::getLastTime(const std::string& zone) const {
+		const ProfilerNode* node = findZone(zone);
+		return node->recorded > 0 ? getHistoryValue(node, 0) : 0.0;
+	}
+
+	double Profiler::getMinTime(const std::string& zone) const {
+		const ProfilerNode* node = findZone(zone);
+		double value = node->recorded > 0 ? getHistoryValue(node, 0) : 0.0;
+		for (uint32_t age = 1; age < node->recorded; ++age) {
+			value = std::min(value, getHistoryValue(node, age));
+		}
+		return value;
+	}
+
+	double Profiler::getAverageTime(const std::string& zone) const {
+		const ProfilerNode* node = findZone(zone);
+		if (node->recorded == 0) {
+			return 0.0;
+		}
+		double sum = 0.0;
+		for (uint32_t age = 0; age < node->recorded; ++age) {
+			sum += getHistoryValue(node, age);
+		}
+		return sum / node->recorded;
+	}
+
+	double Profiler::getMaxTime(const std::string& zone) const {
+		const ProfilerNode* node = findZone(zone);
+		double value = 0.0;
+		for (uint32_t age = 0; age < node->recorded; ++age) {
+			value = std::max(value, getHistoryValue(node, age));
+		}
+		return value;
+	}
+
+	void Profiler::reset() {
+		// a frame that is recorded right now is dropped
+		m_current = NULL;
+		delete m_root;
+		m_root = new ProfilerNode(FRAME_ZONE, NULL, m_historySize);
+		m_historyIndex = 0;
+	}
+
+	void Profiler::printStatistics() const {
+		std::vector<std::string> zones = getZones();
+		std::vector<std::string>::const_iterator it = zones.begin();
+		for (; it != zones.end(); ++it) {
+			FL_LOG(_log, LMsg("Profiler ") << *it << ": avg " << getAverageTime(*it)
+				<< " ms, min " << getMinTime(*it) << " ms, max " << getMaxTime(*it)
+				<< " ms, calls " << getCallCount(*it));
+		}
+	}
+
+	const ProfilerNode* Profiler::findZone(const std::string& zone) const {
+		std::string::size_type begin = 0;
+		std::string::size_type end = zone.find('/');
+		if (zone.substr(0, end) != m_root->name) {
+			throw NotFound("profiler zone " + zone);
+		}
+		const ProfilerNode* node = m_root;
+		while (end != std::string::npos) {
+			begin = end + 1;
+			end = zone.find('/', begin);
+			std::string name = zone.substr(begin, end == std::string::npos ? end : end - begin);
+			const ProfilerNode* child = NULL;
+			std::vector<ProfilerNode*>::const_iterator it = node->children.begin();
+			for (; it != node->children.end(); ++it) {
+				if ((*it)->name == name) {
+					child = *it;
+					break;
+				}
+			}
+			if (!child) {
+				throw NotFound("profiler zone " + zone);
+			}
+			node = child;
+		}
+		return node;
+	}
+
+	double Profiler::getHistoryValue(const ProfilerNode* node, uint32_t age) const {
+		return node->history[(m_historyIndex + m_historySize - 1 - age) % m_historySize];
+	}
+
+} //FIFE
@@ -0,0 +1,263 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_PROFILER_H
+#define FIFE_PROFILER_H
+
+// Standard C++ library includes
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/atom.h"
+#include "util/base/fife_stdint.h"
+
+#include "tracerecorder.h"
+
+namespace FIFE {
+
+	/** A node of the zone tree, see Profiler.
+	 */
+	struct ProfilerNode {
+		ProfilerNode(const std::string& name, ProfilerNode* parent, uint32_t historySize);
+		~ProfilerNode();
+
+		/// Name of the zone, unique among its siblings.
+		std::string name;
+		/// The enclosing zone, NULL for the frame.
+		ProfilerNode* parent;
+		/// Zones entered while this one was open.
+		std::vector<ProfilerNode*> children;
+		/// Performance counter value when the zone was entered.
+		uint64_t start;
+		/// Performance counter ticks spent in the zone during the current frame.
+		uint64_t frameTicks;
+		/// How often the zone was entered during the current frame.
+		uint32_t frameCalls;
+		/// How often the zone was entered during the last finished frame.
+		uint32_t lastCalls;
+		/// Milliseconds spent in the zone per frame, used as ring buffer.
+		std::vector<double> history;
+		/// Number of valid entries in the history.
+		uint32_t recorded;
+	};
+
+	/** Hierarchical CPU profiler.
+	 *
+	 * The time between beginFrame() and endFrame() is split into named zones,
+	 * zones entered while another one is open become its children. Each zone
+	 * sums up its time and calls per frame, the frame totals of the last frames
+	 * are kept to get rolling minimum, average and maximum values.
+	 *
+	 * Zones are addressed by their path, e.g. "frame/model/simulation". Zones
+	 * are only recorded on the thread that began the frame and only while the
+	 * profiler is enabled. Use the FIFE_PROFILE_ZONE macro to open a zone for the
+	 * rest of the scope, it compiles to nothing unless PROFILING_ENABLED is defined.
+	 */
+	class Profiler {
+	public:
+		/** Returns the profiler, it is created on first use.
+		 */
+		static Profiler* instance();
+
+		/** Destructor.
+		 */
+		~Profiler();
+
+		/** Enables or disables the profiler. The change takes effect with the next frame.
+		 */
+		void setEnabled(bool enabled);
+
+		/** Returns true if the profiler is enabled.
+		 */
+		bool isEnabled() const;
+
+		/** Sets the number of frames the rolling values are calculated from.
+		 * Clears the recorded values.
+		 * @param frames Number of frames, at least 1.
+		 */
+		void setHistorySize(uint32_t frames);
+
+		/** Returns the number of frames the rolling values are calculated from.
+		 */
+		uint32_t getHistorySize() const;
+
+		/** Starts a new frame, this opens the root zone "frame".
+		 */
+		void beginFrame();
+
+		/** Ends the frame, closes zones that are still open and records the frame totals.
+		 */
+		void endFrame();
+
+		/** Returns true while a frame is recorded by the calling thread.
+		 * Other threads never touch the current zone, so they can ask at any time.
+		 */
+		bool isRecording() const {
+			return std::this_thread::get_id() == m_thread.load(std::memory_order_acquire) && m_current != NULL;
+		}
+
+		/** Opens a zone inside the current zone.
+		 * @param name Name of the zone.
+		 * @return True if the zone was opened, false if nothing is recorded or it is
+		 * called from another thread. Only call endZone() for opened zones.
+		 */
+		bool beginZone(const std::string& name);
+
+		/** Closes the current zone.
+		 */
+		void endZone();
+
+		/** Returns the paths of all zones that have been recorded, parents before their children.
+		 */
+		std::vector<std::string> getZones() const;
+
+		/** Returns how often the zone was entered in the last frame.
+		 * @throws NotFound if the zone is unknown.
+		 */
+		uint32_t getCallCount(const std::string& zone) const;
+
+		/** Returns the time spent in the zone in the last frame in milliseconds.
+		 * @throws NotFound if the zone is unknown.
+		 */
+		double getLastTime(const std::string& zone) const;
+
+		/** Returns the minimum time per frame spent in the zone over the history in milliseconds.
+		 * @throws NotFound if the zone is unknown.
+		 */
+		double getMinTime(const std::string& zone) const;
+
+		/** Returns the average time per frame spent in the zone over the history in milliseconds.
+		 * @throws NotFound if the zone is unknown.
+		 */
+		double getAverageTime(const std::string& zone) const;
+
+		/** Returns the maximum time per frame spent in the zone over the history in milliseconds.
+		 * @throws NotFound if the zone is unknown.
+		 */
+		double getMaxTime(const std::string& zone) const;
+
+		/** Removes all zones and recorded values.
+		 */
+		void reset();
+
+		/** Logs the rolling values of all zones.
+		 */
+		void printStatistics() const;
+
+	private:
+		Profiler();
+
+		/** Returns the zone with the given path or throws NotFound.
+		 */
+		const ProfilerNode* findZone(const std::string& zone) const;
+
+		/** Returns the history entry that belongs to the given number of frames ago.
+		 */
+		double getHistoryValue(const ProfilerNode* node, uint32_t age) const;
+
+		/// The root zone, which spans the frame.
+		ProfilerNode* m_root;
+		/// The zone that is open right now, NULL if no frame is recorded. Only used by m_thread.
+		ProfilerNode* m_current;
+		/// The thread that records the frames, checked before m_current is touched.
+		std::atomic<std::thread::id> m_thread;
+		/// Performance counter ticks per millisecond.
+		double m_ticksPerMs;
+		/// Number of frames the rolling values are calculated from.
+		uint32_t m_historySize;
+		/// Index of the history entry of the next frame.
+		uint32_t m_historyIndex;
+		/// True if frames are recorded.
+		bool m_enabled;
+	};
+
+	/** Opens a profiler zone for the lifetime of the object.
+	 * The zone is passed to the TraceRecorder as well, if it is enabled.
+	 */
+	class ProfilerZone {
+	public:
+		ProfilerZone(const std::string& name):
+			m_start(0) {
+			Profiler* profiler = Profiler::instance();
+			m_active = profiler->isRecording() && profiler->beginZone(name);
+			if (TraceRecorder::instance()->isEnabled()) {
+				m_name = name;
+				m_start = TraceRecorder::now();
+			}
+		}
+
+		~ProfilerZone() {
+			if (m_start != 0) {
+				TraceRecorder::instance()->addEvent(m_name, m_start, TraceRecorder::now());
+			}
+			if (m_active) {
+				Profiler::instance()->endZone();
+			}
+		}
+
+	private:
+		bool m_active;
+		Atom m_name;
+		uint64_t m_start;
+	};
+
+	/** Records a profiler and trace frame for the lifetime of the object.
+	 */
+	class ProfilerFrame {
+	public:
+		ProfilerFrame() {
+			Profiler::instance()->beginFrame();
+			TraceRecorder::instance()->beginFrame();
+		}
+
+		~ProfilerFrame() {
+			Profiler::instance()->endFrame();
+			TraceRecorder::instance()->endFrame();
+		}
+	};
+
+}//FIFE
+
+#ifdef PROFILING_ENABLED
+#define FIFE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define FIFE_PROFILE_CONCAT(a, b) FIFE_PROFILE_CONCAT_IMPL(a, b)
+
+/** Opens a profiler zone with the given name until the end of the scope
+ */
+#define FIFE_PROFILE_ZONE(name) FIFE::ProfilerZone FIFE_PROFILE_CONCAT(profilerZone, __LINE__)(name)
+
+/** Records a profiler frame until the end of the scope
+ */
+#define FIFE_PROFILE_FRAME() FIFE::ProfilerFrame FIFE_PROFILE_CONCAT(profilerFrame, __LINE__)
+#else
+#define FIFE_PROFILE_ZONE(name)
+#define FIFE_PROFILE_FRAME()
+#endif
+
+#endif
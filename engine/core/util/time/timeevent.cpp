@@ -36,11 +36,17 @@ namespace FIFE {
 
 	TimeEvent::TimeEvent(int32_t period):
 		m_period(period),
-		m_last_updated(TimeManager::instance()->getTime()) {
+		m_last_updated(TimeManager::instance()->getTime()),
+		m_registered(false),
+		m_every_frame(false),
+		m_schedule_index(-1) {
 	}
 
 	TimeEvent::~TimeEvent() {
-		return;
+		// the schedule must not keep a dangling pointer
+		if (m_registered) {
+			TimeManager::instance()->unregisterEvent(this);
+		}
 	}
 
 	void TimeEvent::managerUpdateEvent(uint32_t time) {
@@ -55,6 +61,9 @@ namespace FIFE {
 
 	void TimeEvent::setPeriod(int32_t period) {
 		m_period = period;
+		if (m_registered) {
+			TimeManager::instance()->rescheduleEvent(this);
+		}
 	}
 
 	int32_t TimeEvent::getPeriod() {
@@ -67,6 +76,9 @@ namespace FIFE {
 
 	void TimeEvent::setLastUpdateTime(uint32_t ms) {
 		m_last_updated = ms;
+		if (m_registered) {
+			TimeManager::instance()->rescheduleEvent(this);
+		}
 	}
 
 
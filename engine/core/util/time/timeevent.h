@@ -43,6 +43,9 @@ namespace FIFE {
 	* of -1 will never be updated, 0 will updated every frame and a value
 	* over 0 defines the number of milliseconds between updates.
 	*
+	* Changing the period or the last update time of a registered
+	* event reschedules it with the TimeManager.
+	*
 	* @see TimeManager
 	*/
 	class TimeEvent {
@@ -95,11 +98,23 @@ namespace FIFE {
 		void setLastUpdateTime(uint32_t ms);
 
     private:
+		friend class TimeManager;
+
 		// The period of the event. See the class description.
 		int32_t m_period;
 
 		// The last time the class was updated.
 		uint32_t m_last_updated;
+
+		// True while the event is registered with the TimeManager.
+		bool m_registered;
+
+		// True if m_schedule_index refers to the every frame list of the TimeManager,
+		// otherwise it refers to its heap of timed events.
+		bool m_every_frame;
+
+		// Position in the schedule of the TimeManager, -1 if not scheduled.
+		int32_t m_schedule_index;
     };
 
 }//FIFE
@@ -20,7 +20,6 @@
  ***************************************************************************/
 
 // Standard C++ library includes
-#include <algorithm>
 #include <cassert>
 
 // 3rd party library includes
@@ -42,59 +41,220 @@ namespace FIFE {
 	TimeManager::TimeManager():
 		m_current_time (0),
 		m_time_delta(UNDEFINED_TIME_DELTA),
-		m_average_frame_time(0) {
+		m_average_frame_time(0),
+		m_precise_time(0),
+		m_precise_time_delta(0),
+		m_counter_base_time(0),
+		m_counter_start(SDL_GetPerformanceCounter()),
+		m_counter_frequency(SDL_GetPerformanceFrequency()),
+		m_firing_event(NULL) {
 	}
 
 	TimeManager::~TimeManager() {
+		// events that outlive the manager must not try to unregister
+		for (size_t i = 0; i < m_frame_events.size(); ++i) {
+			if (m_frame_events[i]) {
+				m_frame_events[i]->m_registered = false;
+				m_frame_events[i]->m_schedule_index = -1;
+			}
+		}
+		for (size_t i = 0; i < m_event_heap.size(); ++i) {
+			m_event_heap[i]->m_registered = false;
+			m_event_heap[i]->m_schedule_index = -1;
+		}
 	}
 
 	void TimeManager::update() {
 		// if first update...
 		double avg_multiplier = 0.985;
+		uint64_t counter = SDL_GetPerformanceCounter();
 		if (m_current_time == 0) {
 			m_current_time = SDL_GetTicks();
+			m_counter_base_time = m_current_time;
+			m_counter_start = counter;
+			m_precise_time = m_current_time;
+			m_precise_time_delta = 0;
 			avg_multiplier = 0;
 			m_time_delta = 0;
 		} else {
+			double previous_time = m_precise_time;
+			m_precise_time = m_counter_base_time +
+				static_cast<double>(counter - m_counter_start) * 1000.0 / static_cast<double>(m_counter_frequency);
+			m_precise_time_delta = m_precise_time - previous_time;
 			m_time_delta = m_current_time;
-			m_current_time = SDL_GetTicks();
+			m_current_time = static_cast<uint32_t>(m_precise_time);
 			m_time_delta = m_current_time - m_time_delta;
 		}
+		updateEvents(avg_multiplier);
+	}
+
+	void TimeManager::step(uint32_t delta) {
+		// the real time measured by update() continues from here
+		m_counter_base_time += delta;
+		m_current_time += delta;
+		m_time_delta = delta;
+		m_precise_time += delta;
+		m_precise_time_delta = delta;
+		updateEvents(0.985);
+	}
+
+	void TimeManager::updateEvents(double avg_multiplier) {
 		m_average_frame_time = m_average_frame_time * avg_multiplier +
 			double(m_time_delta) * (1.0 - avg_multiplier);
 
-		// Update live events.
+		// Update every frame events.
 		//
 		// It is very important to NOT use iterators (over a vector)
 		// here, as an event might add enough events to resize the vector.
 		// -> Ugly segfault
-		for (size_t i = 0; i < m_events_list.size(); ++i) {
-			TimeEvent* event = m_events_list[ i ];
-			if( event ) {
-				event->managerUpdateEvent(m_current_time);
+		for (size_t i = 0; i < m_frame_events.size(); ++i) {
+			TimeEvent* event = m_frame_events[i];
+			if (event) {
+				fireEvent(event);
 			}
 		}
 
 		// Remove dead events
-		std::vector<TimeEvent*>::iterator it;
-		it = std::remove( m_events_list.begin(), m_events_list.end(), static_cast<TimeEvent*>(0));
-		m_events_list.erase( it, m_events_list.end());
+		size_t alive = 0;
+		for (size_t i = 0; i < m_frame_events.size(); ++i) {
+			TimeEvent* event = m_frame_events[i];
+			if (event) {
+				event->m_schedule_index = static_cast<int32_t>(alive);
+				m_frame_events[alive++] = event;
+			}
+		}
+		m_frame_events.resize(alive);
+
+		// Update the timed events that are due, the rest of the heap is not touched.
+		while (!m_event_heap.empty()) {
+			TimeEvent* event = m_event_heap.front();
+			uint32_t due = event->m_last_updated + static_cast<uint32_t>(event->m_period);
+			if (static_cast<int32_t>(due - m_current_time) > 0) {
+				break;
+			}
+			unscheduleEvent(event);
+			fireEvent(event);
+		}
+	}
+
+	void TimeManager::fireEvent(TimeEvent* event) {
+		m_firing_event = event;
+		event->managerUpdateEvent(m_current_time);
+		m_firing_event = NULL;
+		// the event may have been unregistered or rescheduled while it was called
+		if (event->m_registered && event->m_schedule_index < 0) {
+			scheduleEvent(event);
+		}
 	}
 
 	void TimeManager::registerEvent(TimeEvent* event) {
 		// Register.
-		m_events_list.push_back(event);
+		if (event->m_registered) {
+			return;
+		}
+		event->m_registered = true;
+		scheduleEvent(event);
 	}
 
 	void TimeManager::unregisterEvent(TimeEvent* event) {
 		// Unregister.
-		for (size_t i = 0; i < m_events_list.size(); ++i) {
-			TimeEvent*& event_i = m_events_list[ i ];
-			if( event_i == event) {
-				event_i = 0;
-				return;
+		if (!event->m_registered) {
+			return;
+		}
+		event->m_registered = false;
+		unscheduleEvent(event);
+	}
+
+	void TimeManager::rescheduleEvent(TimeEvent* event) {
+		if (event->m_every_frame && event->m_period == 0) {
+			return;
+		}
+		unscheduleEvent(event);
+		scheduleEvent(event);
+	}
+
+	void TimeManager::scheduleEvent(TimeEvent* event) {
+		// the event that is currently called is scheduled after it returned
+		if (event == m_firing_event || event->m_period < 0) {
+			return;
+		}
+		if (event->m_period == 0) {
+			event->m_every_frame = true;
+			event->m_schedule_index = static_cast<int32_t>(m_frame_events.size());
+			m_frame_events.push_back(event);
+		} else {
+			event->m_every_frame = false;
+			event->m_schedule_index = static_cast<int32_t>(m_event_heap.size());
+			m_event_heap.push_back(event);
+			siftUp(m_event_heap.size() - 1);
+		}
+	}
+
+	void TimeManager::unscheduleEvent(TimeEvent* event) {
+		if (event->m_schedule_index < 0) {
+			return;
+		}
+		size_t index = static_cast<size_t>(event->m_schedule_index);
+		event->m_schedule_index = -1;
+		if (event->m_every_frame) {
+			// removed after the frame, the list may be iterated right now
+			m_frame_events[index] = NULL;
+			event->m_every_frame = false;
+			return;
+		}
+
+		TimeEvent* last = m_event_heap.back();
+		m_event_heap.pop_back();
+		if (last != event) {
+			m_event_heap[index] = last;
+			last->m_schedule_index = static_cast<int32_t>(index);
+			siftUp(index);
+			siftDown(static_cast<size_t>(last->m_schedule_index));
+		}
+	}
+
+	bool TimeManager::isDueBefore(TimeEvent* first, TimeEvent* second) const {
+		uint32_t first_due = first->m_last_updated + static_cast<uint32_t>(first->m_period);
+		uint32_t second_due = second->m_last_updated + static_cast<uint32_t>(second->m_period);
+		// compared as difference, so the order survives the wrap around of the time
+		return static_cast<int32_t>(first_due - second_due) < 0;
+	}
+
+	void TimeManager::siftUp(size_t index) {
+		TimeEvent* event = m_event_heap[index];
+		while (index > 0) {
+			size_t parent = (index - 1) / 2;
+			if (!isDueBefore(event, m_event_heap[parent])) {
+				break;
 			}
+			m_event_heap[index] = m_event_heap[parent];
+			m_event_heap[index]->m_schedule_index = static_cast<int32_t>(index);
+			index = parent;
 		}
+		m_event_heap[index] = event;
+		event->m_schedule_index = static_cast<int32_t>(index);
+	}
+
+	void TimeManager::siftDown(size_t index) {
+		TimeEvent* event = m_event_heap[index];
+		size_t size = m_event_heap.size();
+		while (true) {
+			size_t child = index * 2 + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && isDueBefore(m_event_heap[child + 1], m_event_heap[child])) {
+				++child;
+			}
+			if (!isDueBefore(m_event_heap[child], event)) {
+				break;
+			}
+			m_event_heap[index] = m_event_heap[child];
+			m_event_heap[index]->m_schedule_index = static_cast<int32_t>(index);
+			index = child;
+		}
+		m_event_heap[index] = event;
+		event->m_schedule_index = static_cast<int32_t>(index);
 	}
 
 	uint32_t TimeManager::getTime() const {
@@ -105,12 +265,20 @@ namespace FIFE {
 		return m_time_delta;
 	}
 
+	double TimeManager::getPreciseTime() const {
+		return m_precise_time;
+	}
+
+	double TimeManager::getPreciseTimeDelta() const {
+		return m_precise_time_delta;
+	}
+
 	double TimeManager::getAverageFrameTime() const {
 		return m_average_frame_time;
 	}
 
 	void TimeManager::printStatistics() const {
-		FL_LOG(_log, LMsg("Timers: ") << m_events_list.size());
+		FL_LOG(_log, LMsg("Timers: ") << m_frame_events.size() + m_event_heap.size());
 	}
 
 } //FIFE
@@ -45,6 +45,14 @@ namespace FIFE {
 	 * Users of this class will have to manually register and
 	 * unregister events.
 	 *
+	 * Events with a period of 0 are kept in a list that is updated every frame.
+	 * Events with a longer period are kept in a min-heap ordered by the time
+	 * they are due, so a frame only touches the events that have to be updated.
+	 * Events with a negative period are registered but not scheduled at all.
+	 *
+	 * The time is read from the high resolution performance counter, the
+	 * millisecond values are derived from it.
+	 *
 	 * @see TimeEvent
 	 */
 	class TimeManager : public DynamicSingleton<TimeManager> {
@@ -61,6 +69,14 @@ namespace FIFE {
 		 */
 		void update();
 
+		/** Advances the time by the given amount instead of reading the real
+		 * time and updates the timer objects and events.
+		 * Used to run simulations faster than real time. Later calls of update()
+		 * continue from the advanced time.
+		 * @param delta The time to advance in milliseconds.
+		 */
+		void step(uint32_t delta);
+
 		/** Adds a TimeEvent.
 		 *
 		 * The event will be updated regularly, depending on its settings.
@@ -87,6 +103,18 @@ namespace FIFE {
 		 */
 		uint32_t getTimeDelta() const;
 
+		/** Get the time with sub-millisecond resolution.
+		 *
+		 * @return The time in milliseconds.
+		 */
+		double getPreciseTime() const;
+
+		/** Get the time since the last frame with sub-millisecond resolution.
+		 *
+		 * @return Time since last frame in milliseconds.
+		 */
+		double getPreciseTimeDelta() const;
+
 		/** Gets average frame time
 		 *
 		 * @return Average frame time in milliseconds.
@@ -98,15 +126,69 @@ namespace FIFE {
 		void printStatistics() const;
 
 	private:
+		friend class TimeEvent;
+
+		/** Updates the average frame time and the events after the time changed.
+		 * @param avg_multiplier The weight of the previous average frame time.
+		 */
+		void updateEvents(double avg_multiplier);
+
+		/** Calls the event and schedules it again, if it is still registered.
+		 * @param event The TimeEvent that is due.
+		 */
+		void fireEvent(TimeEvent* event);
+
+		/** Moves a registered event to its new place after its period or last update time changed.
+		 * @param event The TimeEvent to reschedule.
+		 */
+		void rescheduleEvent(TimeEvent* event);
+
+		/** Adds the event to the every frame list or the heap, depending on its period.
+		 * @param event The TimeEvent to schedule.
+		 */
+		void scheduleEvent(TimeEvent* event);
+
+		/** Removes the event from the every frame list or the heap.
+		 * @param event The TimeEvent to unschedule.
+		 */
+		void unscheduleEvent(TimeEvent* event);
+
+		/** Returns true if the first event is due before the second one.
+		 */
+		bool isDueBefore(TimeEvent* first, TimeEvent* second) const;
+
+		/** Moves the heap entry at the given index up until the heap is ordered.
+		 */
+		void siftUp(size_t index);
+
+		/** Moves the heap entry at the given index down until the heap is ordered.
+		 */
+		void siftDown(size_t index);
+
 		/// Current time in milliseconds.
 		uint32_t m_current_time;
 		/// Time since last frame in milliseconds.
 		uint32_t m_time_delta;
 		/// Average frame time in milliseconds.
 		double m_average_frame_time;
-
-		/// List of active TimeEvents.
-		std::vector<TimeEvent*> m_events_list;
+		/// Current time in milliseconds with sub-millisecond resolution.
+		double m_precise_time;
+		/// Time since last frame in milliseconds with sub-millisecond resolution.
+		double m_precise_time_delta;
+		/// Time in milliseconds at m_counter_start, the performance counter is measured from there.
+		/// Steps move it forward.
+		double m_counter_base_time;
+		/// Performance counter value at construction, taken again at the first update.
+		uint64_t m_counter_start;
+		/// Performance counter ticks per second.
+		uint64_t m_counter_frequency;
+
+		/// TimeEvents that are updated every frame, unregistered ones are set to NULL.
+		std::vector<TimeEvent*> m_frame_events;
+		/// TimeEvents with a period, as a min-heap ordered by the time they are due.
+		std::vector<TimeEvent*> m_event_heap;
+		/// The TimeEvent that is currently called, it is scheduled again afterwards.
+		TimeEvent* m_firing_event;
 	};
 
 }//FIFE
@@ -31,8 +31,11 @@ namespace FIFE {
 		TimeManager();
 		virtual ~TimeManager();
 		void update();
+		void step(uint32_t delta);
 		uint32_t getTime() const;
 		uint32_t getTimeDelta() const;
+		double getPreciseTime() const;
+		double getPreciseTimeDelta() const;
 		double getAverageFrameTime() const;
 		void printStatistics() const;
 		void registerEvent(TimeEvent* event);
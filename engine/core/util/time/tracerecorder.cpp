@@ -0,0 +1,251 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// 3rd party library includes
+#include <SDL.h>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/log/logger.h"
+
+#include "tracerecorder.h"
+
+namespace FIFE {
+	static Logger _log(LM_UTIL);
+
+	static const uint32_t DEFAULT_CAPACITY = 65536;
+	static const Atom FRAME_EVENT("frame");
+
+	/** Returns a small number for the calling thread, which is used as thread id in the trace.
+	 */
+	static uint32_t getThreadIndex() {
+		static std::atomic<uint32_t> nextIndex(1);
+		thread_local uint32_t index = nextIndex++;
+		return index;
+	}
+
+	static void writeJsonString(std::ostream& out, const std::string& str) {
+		out << '"';
+		for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+			char c = *it;
+			if (c == '"' || c == '\\') {
+				out << '\\' << c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out << escaped;
+			} else {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+
+	TraceRecorder* TraceRecorder::instance() {
+		// zones may end on any thread, the first use has to be thread safe
+		static TraceRecorder* recorder = new TraceRecorder();
+		return recorder;
+	}
+
+	TraceRecorder::TraceRecorder():
+		m_enabled(false),
+		m_events(DEFAULT_CAPACITY),
+		m_next(0),
+		m_count(0),
+		m_origin(now()),
+		m_ticksPerMs(static_cast<double>(SDL_GetPerformanceFrequency()) / 1000.0),
+		m_frameStart(0),
+		m_slowFrameThreshold(0.0),
+		m_slowFramePrefix("slowframe"),
+		m_slowFrames(0) {
+	}
+
+	TraceRecorder::~TraceRecorder() {
+	}
+
+	uint64_t TraceRecorder::now() {
+		return SDL_GetPerformanceCounter();
+	}
+
+	void TraceRecorder::setEnabled(bool enabled) {
+		m_enabled.store(enabled, std::memory_order_relaxed);
+		if (!enabled) {
+			m_frameStart = 0;
+		}
+	}
+
+	void TraceRecorder::setCapacity(uint32_t events) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_events.assign(std::max(events, 1u), TraceEvent());
+		m_next = 0;
+		m_count = 0;
+	}
+
+	uint32_t TraceRecorder::getCapacity() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return static_cast<uint32_t>(m_events.size());
+	}
+
+	uint32_t TraceRecorder::getEventCount() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_count;
+	}
+
+	void TraceRecorder::setSlowFrameThreshold(double ms) {
+		m_slowFrameThreshold = ms;
+	}
+
+	double TraceRecorder::getSlowFrameThreshold() const {
+		return m_slowFrameThreshold;
+	}
+
+	void TraceRecorder::setSlowFrameFilePrefix(const std::string& prefix) {
+		m_slowFramePrefix = prefix;
+	}
+
+	const std::string& TraceRecorder::getSlowFrameFilePrefix() const {
+		return m_slowFramePrefix;
+	}
+
+	uint32_t TraceRecorder::getSlowFrameCount() const {
+		return m_slowFrames;
+	}
+
+	void TraceRecorder::setThreadName(const std::string& name) {
+		uint32_t thread = getThreadIndex();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threadNames[thread] = name;
+	}
+
+	void TraceRecorder::addEvent(const Atom& name, uint64_t start, uint64_t end) {
+		uint32_t thread = getThreadIndex();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		TraceEvent& event = m_events[m_next];
+		event.name = name;
+		event.start = start;
+		event.end = end;
+		event.thread = thread;
+		m_next = (m_next + 1) % m_events.size();
+		m_count = std::min(m_count + 1, static_cast<uint32_t>(m_events.size()));
+	}
+
+	void TraceRecorder::beginFrame() {
+		if (!isEnabled()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			std::map<uint32_t, std::string>::iterator it = m_threadNames.find(getThreadIndex());
+			if (it == m_threadNames.end()) {
+				m_threadNames[getThreadIndex()] = "main";
+			}
+		}
+		m_frameStart = now();
+	}
+
+	void TraceRecorder::endFrame() {
+		if (!isEnabled() || m_frameStart == 0) {
+			return;
+		}
+		uint64_t end = now();
+		addEvent(FRAME_EVENT, m_frameStart, end);
+		double frameTime = static_cast<double>(end - m_frameStart) / m_ticksPerMs;
+		m_frameStart = 0;
+		if (m_slowFrameThreshold <= 0.0 || frameTime <= m_slowFrameThreshold) {
+			return;
+		}
+
+		std::ostringstream filename;
+		filename << m_slowFramePrefix << "_" << ++m_slowFrames << ".json";
+		try {
+			dump(filename.str());
+			FL_WARN(_log, LMsg("Frame took ") << frameTime << " ms, trace written to " << filename.str());
+		} catch (const CannotOpenFile& e) {
+			FL_ERR(_log, LMsg("Failed to write the trace of a slow frame: ") << e.what());
+		}
+		// the next capture only shows what happened since this one
+		clear();
+	}
+
+	void TraceRecorder::dump(const std::string& filename) const {
+		std::vector<TraceEvent> events;
+		std::map<uint32_t, std::string> threadNames;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			events.reserve(m_count);
+			uint32_t first = (m_next + m_events.size() - m_count) % m_events.size();
+			for (uint32_t i = 0; i < m_count; ++i) {
+				events.push_back(m_events[(first + i) % m_events.size()]);
+			}
+			threadNames = m_threadNames;
+		}
+
+		std::ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
+		if (!out) {
+			throw CannotOpenFile(filename);
+		}
+		// timestamps are written in microseconds
+		double ticksPerUs = m_ticksPerMs / 1000.0;
+		out.setf(std::ios::fixed);
+		out.precision(3);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+		std::map<uint32_t, std::string>::const_iterator nameIt = threadNames.begin();
+		for (; nameIt != threadNames.end(); ++nameIt) {
+			out << (first ? "\n" : ",\n");
+			first = false;
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << nameIt->first << ",\"args\":{\"name\":";
+			writeJsonString(out, nameIt->second);
+			out << "}}";
+		}
+		std::vector<TraceEvent>::const_iterator it = events.begin();
+		for (; it != events.end(); ++it) {
+			out << (first ? "\n" : ",\n");
+			first = false;
+			out << "{\"name\":";
+			writeJsonString(out, it->name.str());
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << it->thread
+				<< ",\"ts\":" << static_cast<double>(it->start - m_origin) / ticksPerUs
+				<< ",\"dur\":" << static_cast<double>(it->end - it->start) / ticksPerUs << "}";
+		}
+		out << "\n]}\n";
+		out.close();
+		if (!out) {
+			throw CannotOpenFile(filename);
+		}
+	}
+
+	void TraceRecorder::clear() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_next = 0;
+		m_count = 0;
+	}
+
+} //FIFE
@@ -0,0 +1,183 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_TRACERECORDER_H
+#define FIFE_TRACERECORDER_H
+
+// Standard C++ library includes
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/atom.h"
+#include "util/base/fife_stdint.h"
+
+namespace FIFE {
+
+	/** A finished zone, see TraceRecorder.
+	 */
+	struct TraceEvent {
+		/// Name of the zone.
+		Atom name;
+		/// Performance counter value when the zone was entered.
+		uint64_t start;
+		/// Performance counter value when the zone was left.
+		uint64_t end;
+		/// Index of the thread that recorded the zone.
+		uint32_t thread;
+	};
+
+	/** Records the timeline of the engine in a ring buffer.
+	 *
+	 * Every profiler zone that ends while the recorder is enabled is stored as
+	 * event, together with the thread it ran on. Unlike the Profiler this works
+	 * on all threads. The most recent events can be written in the Chrome trace
+	 * event format, which chrome://tracing and Perfetto read.
+	 *
+	 * If a slow frame threshold is set, frames that take longer are written
+	 * automatically to numbered files and the buffer is cleared afterwards.
+	 */
+	class TraceRecorder {
+	public:
+		/** Returns the recorder, it is created on first use.
+		 */
+		static TraceRecorder* instance();
+
+		/** Destructor.
+		 */
+		~TraceRecorder();
+
+		/** Returns the current value of the performance counter.
+		 */
+		static uint64_t now();
+
+		/** Enables or disables the recording.
+		 */
+		void setEnabled(bool enabled);
+
+		/** Returns true if events are recorded.
+		 */
+		bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+		/** Sets the number of events that are kept, older events are overwritten.
+		 * Clears the recorded events.
+		 * @param events Number of events, at least 1.
+		 */
+		void setCapacity(uint32_t events);
+
+		/** Returns the number of events that are kept.
+		 */
+		uint32_t getCapacity() const;
+
+		/** Returns the number of events in the buffer.
+		 */
+		uint32_t getEventCount() const;
+
+		/** Sets the frame time in milliseconds above which the buffer is written automatically.
+		 * @param ms The threshold, 0 disables it.
+		 */
+		void setSlowFrameThreshold(double ms);
+
+		/** Returns the slow frame threshold in milliseconds.
+		 */
+		double getSlowFrameThreshold() const;
+
+		/** Sets the path slow frames are written to, a number and ".json" are appended.
+		 */
+		void setSlowFrameFilePrefix(const std::string& prefix);
+
+		/** Returns the path slow frames are written to.
+		 */
+		const std::string& getSlowFrameFilePrefix() const;
+
+		/** Returns the number of slow frames that have been written.
+		 */
+		uint32_t getSlowFrameCount() const;
+
+		/** Names the calling thread in the written traces.
+		 */
+		void setThreadName(const std::string& name);
+
+		/** Adds an event of the calling thread.
+		 * @param name Name of the zone.
+		 * @param start Performance counter value when the zone was entered.
+		 * @param end Performance counter value when the zone was left.
+		 */
+		void addEvent(const Atom& name, uint64_t start, uint64_t end);
+
+		/** Starts a frame.
+		 */
+		void beginFrame();
+
+		/** Ends a frame, records it as "frame" event and writes the buffer if the frame was slow.
+		 */
+		void endFrame();
+
+		/** Writes the recorded events to a file in the Chrome trace event format.
+		 * @param filename The file to write.
+		 * @throws CannotOpenFile if the file can't be written.
+		 */
+		void dump(const std::string& filename) const;
+
+		/** Removes all recorded events.
+		 */
+		void clear();
+
+	private:
+		TraceRecorder();
+
+		/// True if events are recorded.
+		std::atomic<bool> m_enabled;
+		/// Guards the buffer and the thread names.
+		mutable std::mutex m_mutex;
+		/// The ring buffer.
+		std::vector<TraceEvent> m_events;
+		/// Index the next event is written to.
+		uint32_t m_next;
+		/// Number of valid events.
+		uint32_t m_count;
+		/// Names of the threads by index.
+		std::map<uint32_t, std::string> m_threadNames;
+		/// Performance counter value the written timestamps are relative to.
+		uint64_t m_origin;
+		/// Performance counter ticks per millisecond.
+		double m_ticksPerMs;
+		/// Start of the current frame, 0 outside of frames.
+		uint64_t m_frameStart;
+		/// Slow frame threshold in milliseconds.
+		double m_slowFrameThreshold;
+		/// Path slow frames are written to.
+		std::string m_slowFramePrefix;
+		/// Number of slow frames that have been written.
+		uint32_t m_slowFrames;
+	};
+
+}//FIFE
+
+#endif
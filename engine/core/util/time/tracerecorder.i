@@ -0,0 +1,47 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+%module fife
+%{
+#include "util/time/tracerecorder.h"
+%}
+
+namespace FIFE {
+	class TraceRecorder {
+	public:
+		static TraceRecorder* instance();
+		~TraceRecorder();
+		void setEnabled(bool enabled);
+		bool isEnabled() const;
+		void setCapacity(uint32_t events);
+		uint32_t getCapacity() const;
+		uint32_t getEventCount() const;
+		void setSlowFrameThreshold(double ms);
+		double getSlowFrameThreshold() const;
+		void setSlowFrameFilePrefix(const std::string& prefix);
+		const std::string& getSlowFrameFilePrefix() const;
+		uint32_t getSlowFrameCount() const;
+		void setThreadName(const std::string& name);
+		void dump(const std::string& filename) const;
+		void clear();
+	private:
+		TraceRecorder();
+	};
+}
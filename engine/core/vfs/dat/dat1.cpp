@@ -112,6 +112,18 @@ namespace FIFE {
 		return list(pathstr, true);
 	}
 
+	bool DAT1::getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const {
+		type_filelist::const_iterator end = m_filelist.end();
+		for (type_filelist::const_iterator i = m_filelist.begin(); i != end; ++i) {
+			files.push_back(i->first);
+		}
+		return true;
+	}
+
+	bool DAT1::isCacheable(const std::string& file) const {
+		return true;
+	}
+
 	std::set<std::string> DAT1::list(const std::string& pathstr, bool dirs) const {
 		std::set<std::string> list;
 		std::string path = pathstr;
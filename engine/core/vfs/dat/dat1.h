@@ -66,6 +66,8 @@ namespace FIFE {
 
 			std::set<std::string> listFiles(const std::string& pathstr) const;
 			std::set<std::string> listDirectories(const std::string& pathstr) const;
+			bool getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const;
+			bool isCacheable(const std::string& file) const;
 
 		private:
 			std::string m_datpath;
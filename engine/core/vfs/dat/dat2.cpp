@@ -161,6 +161,10 @@ namespace FIFE {
 		return list(pathstr, true);
 	}
 
+	bool DAT2::isCacheable(const std::string& file) const {
+		return true;
+	}
+
 	std::set<std::string> DAT2::list(const std::string& pathstr, bool dirs) const {
 		std::set<std::string> list;
 		std::string path = pathstr;
@@ -77,6 +77,7 @@ namespace FIFE {
 
 			std::set<std::string> listFiles(const std::string& pathstr) const;
 			std::set<std::string> listDirectories(const std::string& pathstr) const;
+			bool isCacheable(const std::string& file) const;
 
 		private:
 			std::string m_datpath;
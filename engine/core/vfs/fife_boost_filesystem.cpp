@@ -216,4 +216,35 @@ namespace FIFE {
             }
         #endif
     }
-}
\ No newline at end of file
+
+    std::string NormalizePath(const std::string& path) {
+        std::string result;
+        result.reserve(path.size());
+
+        std::string::size_type begin = 0;
+        while (begin <= path.size()) {
+            std::string::size_type end = path.find_first_of("/\\", begin);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+
+            const std::string::size_type length = end - begin;
+            if (length == 0 || (length == 1 && path[begin] == '.')) {
+                // skip empty and "." components
+            }
+            else if (length == 2 && path[begin] == '.' && path[begin + 1] == '.') {
+                std::string::size_type slash = result.rfind('/');
+                result.erase(slash == std::string::npos ? 0 : slash);
+            }
+            else {
+                if (!result.empty()) {
+                    result += '/';
+                }
+                result.append(path, begin, length);
+            }
+            begin = end + 1;
+        }
+
+        return result;
+    }
+}
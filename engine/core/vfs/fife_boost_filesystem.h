@@ -120,6 +120,15 @@ namespace FIFE {
     *  @return the filename minus any extension
     */
     std::string GetStem(const bfs::path& path);
+
+    /** Helper function to bring a path into a canonical form for lookups
+     *  @note '\\' counts as separator, empty and "." components are dropped
+     *        and ".." components are resolved, the result has no leading or
+     *        trailing '/'
+     *  @param path the input path string
+     *  @return the normalized path, empty for the root
+     */
+    std::string NormalizePath(const std::string& path);
 }
 
 #endif
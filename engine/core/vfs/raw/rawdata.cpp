@@ -21,6 +21,7 @@
 
 // Standard C++ library includes
 #include <algorithm>
+#include <cstring>
 #include <vector>
 #include <string>
 
@@ -39,7 +40,9 @@ namespace FIFE {
 	static Logger _log(LM_VFS);
 	
 	RawData::RawData(RawDataSource* datasource) : m_datasource(datasource), m_index_current(0) {
-
+		m_size = m_datasource->getSize();
+		m_largeSize = m_datasource->getLargeSize();
+		m_view = m_datasource->getView(0, m_size);
 	}
 
 	RawData::~RawData() {
@@ -73,7 +76,15 @@ namespace FIFE {
 	}
 
 	uint32_t RawData::getDataLength() const {
-		return m_datasource->getSize();
+		return m_size;
+	}
+
+	uint64_t RawData::getLargeDataLength() const {
+		return m_largeSize;
+	}
+
+	const uint8_t* RawData::getDataView() const {
+		return m_view;
 	}
 
 	uint32_t RawData::getCurrentIndex() const {
@@ -97,10 +108,27 @@ namespace FIFE {
 			throw IndexOverflow(__FUNCTION__);
 		}
 
-		m_datasource->readInto(buffer, m_index_current, len);
+		if (m_view) {
+			std::memcpy(buffer, m_view + m_index_current, len);
+		} else {
+			m_datasource->readInto(buffer, m_index_current, len);
+		}
 		m_index_current += len;
 	}
 
+	void RawData::readAt(uint8_t* buffer, uint64_t offset, uint32_t len) {
+		if (offset + len > getLargeDataLength()) {
+			FL_LOG(_log, LMsg("RawData") << offset << " : " << len << " : " << getLargeDataLength());
+			throw IndexOverflow(__FUNCTION__);
+		}
+
+		if (m_view) {
+			std::memcpy(buffer, m_view + offset, len);
+		} else {
+			m_datasource->readLargeInto(buffer, offset, len);
+		}
+	}
+
 	uint8_t RawData::read8() {
 		return readSingle<uint8_t>();
 	}
@@ -155,6 +183,15 @@ namespace FIFE {
 		if (getCurrentIndex() >= getDataLength())
 			return false;
 
+		if (m_view) {
+			const char* begin = reinterpret_cast<const char*>(m_view) + m_index_current;
+			const char* end = reinterpret_cast<const char*>(m_view) + m_size;
+			const char* eol = std::find(begin, end, '\n');
+			buffer.assign(begin, eol);
+			m_index_current = (eol - reinterpret_cast<const char*>(m_view)) + (eol != end ? 1 : 0);
+			return true;
+		}
+
 		buffer = "";
 		char c;
 		while (getCurrentIndex() < getDataLength() && (c = read8()) != '\n')
@@ -62,10 +62,27 @@ namespace FIFE {
 
 			/** get the complete datalength
 			 *
+			 * Data beyond 4GB isn't included, see getLargeDataLength().
 			 * @return the complete datalength
 			 */
 			uint32_t getDataLength() const;
 
+			/** get the complete datalength of data that can be larger than 4GB
+			 *
+			 * Only host files can be that large, e.g. big zip archives.
+			 * The data beyond 4GB can only be read with readAt().
+			 * @return the complete datalength
+			 */
+			uint64_t getLargeDataLength() const;
+
+			/** get direct read-only access to the complete data
+			 *
+			 * Only available if the underlying source keeps the data in memory (memory mapped
+			 * files, decompressed archive entries). The pointer stays valid as long as this object lives.
+			 * @return pointer to the first byte or NULL if the data can only be read through readInto()
+			 */
+			const uint8_t* getDataView() const;
+
 			/** get the current index
 			 *
 			 * @return the current index
@@ -105,6 +122,16 @@ namespace FIFE {
 			 */
 			void readInto(uint8_t* buffer, size_t len);
 
+			/** read len bytes at a 64 bit offset into buffer
+			 *
+			 * The current index isn't used or changed.
+			 * @param buffer the data will be written into it
+			 * @param offset the offset of the first byte
+			 * @param len len bytes will be written
+			 * @throws IndexOverflow if offset + len > getLargeDataLength()
+			 */
+			void readAt(uint8_t* buffer, uint64_t offset, uint32_t len);
+
 			/** reads 1 byte */
 			uint8_t read8();
 
@@ -156,6 +183,10 @@ namespace FIFE {
 		private:
 			RawDataSource* m_datasource;
 			size_t m_index_current;
+			// cached source sizes and view, they can't change during our lifetime
+			uint32_t m_size;
+			uint64_t m_largeSize;
+			const uint8_t* m_view;
 
 			template <typename T> T littleToHost(T value) const {
 				if (littleEndian())
@@ -20,6 +20,7 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 
 // 3rd party library includes
 
@@ -32,13 +33,12 @@
 #include "rawdatafile.h"
 
 namespace FIFE {
-
 	RawDataFile::RawDataFile(const std::string& file) : m_file(file), m_stream(m_file.c_str(), std::ios::binary), m_filesize(0) {
 		if (!m_stream)
 			throw CannotOpenFile(m_file);
 
 		m_stream.seekg(0, std::ios::end);
-		m_filesize = m_stream.tellg();
+		m_filesize = static_cast<uint64_t>(m_stream.tellg());
 		m_stream.seekg(0, std::ios::beg);
 	}
 
@@ -48,11 +48,19 @@ namespace FIFE {
 
 
 	uint32_t RawDataFile::getSize( ) const {
+		return static_cast<uint32_t>(std::min<uint64_t>(m_filesize, 0xFFFFFFFF));
+	}
+
+	uint64_t RawDataFile::getLargeSize() const {
 		return m_filesize;
 	}
 
 	void RawDataFile::readInto(uint8_t* buffer, uint32_t start, uint32_t length) {
-		m_stream.seekg(start);
+		readLargeInto(buffer, start, length);
+	}
+
+	void RawDataFile::readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length) {
+		m_stream.seekg(static_cast<std::streamoff>(start));
 		m_stream.read(reinterpret_cast<char*>(buffer), length);
 	}
 
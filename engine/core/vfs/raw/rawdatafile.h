@@ -52,13 +52,15 @@ namespace FIFE {
 			virtual ~RawDataFile();
 
 			virtual uint32_t getSize() const;
+			virtual uint64_t getLargeSize() const;
 			virtual void readInto(uint8_t* buffer, uint32_t start, uint32_t length);
+			virtual void readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length);
 
 		private:
 			std::string m_file;
 			std::ifstream m_stream;
 
-			uint32_t m_filesize;
+			uint64_t m_filesize;
 
 	};
 
@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Platform specific includes
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define FIFE_HAVE_MMAP
+#endif
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+
+#include "rawdatamappedfile.h"
+
+namespace FIFE {
+
+	RawDataMappedFile::RawDataMappedFile(const std::string& file) : m_file(file), m_data(0), m_filesize(0) {
+#ifdef FIFE_HAVE_MMAP
+		int fd = ::open(m_file.c_str(), O_RDONLY);
+		if (fd == -1) {
+			throw CannotOpenFile(m_file);
+		}
+
+		struct stat st;
+		// the whole file has to fit into the address space
+		if (::fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+			static_cast<uint64_t>(st.st_size) > static_cast<uint64_t>(std::numeric_limits<size_t>::max())) {
+			::close(fd);
+			throw CannotOpenFile(m_file);
+		}
+
+		m_filesize = static_cast<uint64_t>(st.st_size);
+		// mmap refuses zero length mappings, an empty file simply has no data
+		if (m_filesize > 0) {
+			void* addr = ::mmap(0, static_cast<size_t>(m_filesize), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (addr == MAP_FAILED) {
+				::close(fd);
+				throw CannotOpenFile(m_file);
+			}
+			m_data = static_cast<uint8_t*>(addr);
+		}
+		// the mapping stays valid after the descriptor is closed
+		::close(fd);
+#else
+		throw CannotOpenFile(m_file);
+#endif
+	}
+
+	RawDataMappedFile::~RawDataMappedFile() {
+#ifdef FIFE_HAVE_MMAP
+		if (m_data) {
+			::munmap(m_data, static_cast<size_t>(m_filesize));
+		}
+#endif
+	}
+
+	uint32_t RawDataMappedFile::getSize() const {
+		return static_cast<uint32_t>(std::min<uint64_t>(m_filesize, 0xFFFFFFFF));
+	}
+
+	uint64_t RawDataMappedFile::getLargeSize() const {
+		return m_filesize;
+	}
+
+	void RawDataMappedFile::readInto(uint8_t* buffer, uint32_t start, uint32_t length) {
+		std::memcpy(buffer, m_data + start, length);
+	}
+
+	void RawDataMappedFile::readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length) {
+		std::memcpy(buffer, m_data + start, length);
+	}
+
+	const uint8_t* RawDataMappedFile::getView(uint32_t start, uint32_t length) {
+		// the view of the first 4GB reaches the rest of the mapping as well
+		if (!m_data || static_cast<uint64_t>(start) + length > m_filesize) {
+			return 0;
+		}
+		return m_data + start;
+	}
+
+	bool RawDataMappedFile::isSupported() {
+#ifdef FIFE_HAVE_MMAP
+		return true;
+#else
+		return false;
+#endif
+	}
+
+}
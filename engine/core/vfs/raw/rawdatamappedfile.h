@@ -0,0 +1,76 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VFS_RAW_RAWDATAMAPPEDFILE_H
+#define FIFE_VFS_RAW_RAWDATAMAPPEDFILE_H
+
+// Standard C++ library includes
+#include <string>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "rawdatasource.h"
+
+namespace FIFE {
+
+	/** A RawDataSource for a memory mapped file on the host system
+	 *
+	 * The whole file is mapped read-only on construction, so reads are plain memory copies
+	 * and getView() hands out pointers into the mapping without copying at all.
+	 * Files larger than 4GB can only be mapped by 64 bit builds.
+	 * Only available on POSIX systems, check isSupported() before using it.
+	 * @see RawDataFile
+	 * @see RawDataSource
+	 */
+	class RawDataMappedFile : public RawDataSource {
+
+		public:
+			/** Constructor
+			 * Maps file into memory.
+			 * @param file The path to the file to map.
+			 * @throw CannotOpenFile if the file can't be opened or mapped.
+			 */
+			RawDataMappedFile(const std::string& file);
+			virtual ~RawDataMappedFile();
+
+			virtual uint32_t getSize() const;
+			virtual uint64_t getLargeSize() const;
+			virtual void readInto(uint8_t* buffer, uint32_t start, uint32_t length);
+			virtual void readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length);
+			virtual const uint8_t* getView(uint32_t start, uint32_t length);
+
+			/** Returns true if memory mapped files are available on this platform.
+			 */
+			static bool isSupported();
+
+		private:
+			std::string m_file;
+			uint8_t* m_data;
+			uint64_t m_filesize;
+	};
+
+}
+
+#endif
@@ -47,6 +47,13 @@ namespace FIFE {
 		std::copy(m_data + start, m_data + start + length, buffer);
 	}
 
+	const uint8_t* RawDataMemSource::getView(uint32_t start, uint32_t length) {
+		if (start + length > m_datalen) {
+			return 0;
+		}
+		return m_data + start;
+	}
+
 	uint8_t* RawDataMemSource::getRawData() const {
 		return m_data;
 	}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VFS_RAW_RAWDATASHAREDSOURCE_H
+#define FIFE_VFS_RAW_RAWDATASHAREDSOURCE_H
+
+// Standard C++ library includes
+#include <memory>
+#include <vector>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "rawdatasource.h"
+
+namespace FIFE {
+
+	typedef std::shared_ptr<const std::vector<uint8_t> > SharedDataBuffer;
+
+	/** A RawDataSource over an immutable buffer shared with others
+	 *
+	 * Used by the VFS cache, every RawData opened from a cached entry
+	 * reads the same buffer without copying it.
+	 */
+	class RawDataSharedSource : public RawDataSource {
+		public:
+			/** Constructor
+			 * @param buffer The data, kept alive as long as this source exists.
+			 */
+			RawDataSharedSource(SharedDataBuffer buffer);
+			virtual ~RawDataSharedSource();
+
+			virtual uint32_t getSize() const;
+			virtual void readInto(uint8_t* buffer, uint32_t start, uint32_t length);
+			virtual const uint8_t* getView(uint32_t start, uint32_t length);
+
+		private:
+			SharedDataBuffer m_buffer;
+	};
+
+}
+
+#endif
@@ -34,4 +34,16 @@ namespace FIFE {
 	RawDataSource::RawDataSource() {}
 
 	RawDataSource::~RawDataSource() {}
+
+	uint64_t RawDataSource::getLargeSize() const {
+		return getSize();
+	}
+
+	void RawDataSource::readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length) {
+		readInto(buffer, static_cast<uint32_t>(start), length);
+	}
+
+	const uint8_t* RawDataSource::getView(uint32_t start, uint32_t length) {
+		return 0;
+	}
 }
@@ -47,9 +47,19 @@ namespace FIFE {
 			RawDataSource();
 			virtual ~RawDataSource();
 
-			/** get the complete datasize */
+			/** get the complete datasize
+			 *
+			 * Sources larger than 4GB return 0xFFFFFFFF, see getLargeSize().
+			 */
 			virtual uint32_t getSize() const = 0;
 
+			/** get the complete datasize of sources that can be larger than 4GB
+			 *
+			 * Only host files can be that large, archives read them with readLargeInto().
+			 * @return getSize() by default
+			 */
+			virtual uint64_t getLargeSize() const;
+
 			/** read data from the source
 			 *
 			 * @param buffer the data will be written into buffer
@@ -58,6 +68,23 @@ namespace FIFE {
 			 */
 			virtual void readInto(uint8_t* buffer, uint32_t start, uint32_t length) = 0;
 
+			/** read data from a 64 bit offset
+			 *
+			 * Forwards to readInto() by default.
+			 * @param buffer the data will be written into buffer
+			 * @param start the startindex inside the source, may be beyond 4GB
+			 * @param length length bytes will be written into buffer
+			 */
+			virtual void readLargeInto(uint8_t* buffer, uint64_t start, uint32_t length);
+
+			/** get direct read-only access to the data, if the source keeps it in memory
+			 *
+			 * @param start the startindex inside the source
+			 * @param length the number of bytes that will be accessed
+			 * @return pointer to the data at start or NULL if the source can't provide a view
+			 */
+			virtual const uint8_t* getView(uint32_t start, uint32_t length);
+
 	};
 
 }
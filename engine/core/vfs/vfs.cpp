@@ -24,8 +24,6 @@
 #include <regex>
 
 // 3rd party library includes
-#include <boost/functional.hpp>
-#include <boost/algorithm/string.hpp>
 
 // FIFE includes
 // These includes are split up in two parts, separated by one empty line
@@ -33,7 +31,9 @@
 // Second block: files included from the same folder
 #include "util/base/exception.h"
 #include "util/log/logger.h"
+#include "vfs/raw/rawdata.h"
 
+#include "fife_boost_filesystem.h"
 #include "vfs.h"
 #include "vfssource.h"
 #include "vfssourceprovider.h"
@@ -44,13 +44,26 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_VFS);
 
-	VFS::VFS() : m_sources() {}
+	VFS::VFS() :
+		m_sources(),
+		m_cacheBudget(0),
+		m_cacheUsage(0),
+		m_cacheHits(0),
+		m_cacheMisses(0),
+		m_cacheBytesSaved(0) {
+	}
 
 	VFS::~VFS() {
 		cleanup();
 	}
 
 	void VFS::cleanup() {
+		clearCache();
+
+		// the sources remove themselves, no need to keep the index up to date
+		m_index.clear();
+		m_indexedSources.clear();
+
 		type_sources sources = m_sources;
 		type_sources::const_iterator end = sources.end();
 		for (type_sources::iterator i = sources.begin(); i != end; ++i)
@@ -109,12 +122,19 @@ namespace FIFE {
 
 	void VFS::addSource(VFSSource* source) {
 		m_sources.push_back(source);
+		// the new source comes last, so it can't shadow anything already indexed
+		indexSource(source);
 	}
 
 	void VFS::removeSource(VFSSource* source) {
 		type_sources::iterator i = std::find(m_sources.begin(), m_sources.end(), source);
 		if (i != m_sources.end())
 			m_sources.erase(i);
+
+		removeFromCache(source);
+		if (m_indexedSources.erase(source) > 0) {
+			rebuildIndex();
+		}
 	}
 
 	void VFS::removeSource(const std::string& path) {
@@ -124,7 +144,7 @@ namespace FIFE {
 			if (provider->hasSource(path)) {
 				VFSSource* source = provider->getSource(path);
 				type_sources::iterator i = std::find(m_sources.begin(), m_sources.end(), source);
-				if (i == m_sources.end()) {
+				if (i != m_sources.end()) {
 					removeSource(*i);
 					return;
 				}
@@ -132,51 +152,168 @@ namespace FIFE {
 		}
 	}
 
-	VFSSource* VFS::getSourceForFile(const std::string& file) const {
-		type_sources::const_iterator i = std::find_if(m_sources.begin(), m_sources.end(),
-										 boost::bind2nd(boost::mem_fun(&VFSSource::fileExists), file));
-		if (i == m_sources.end()) {
-			FL_WARN(_log, LMsg("no source for ") << file << " found");
-			return 0;
+	VFSSource* VFS::getSourceForFile(const std::string& file, std::string& name) const {
+		type_index::const_iterator entry = m_index.find(NormalizePath(file));
+		VFSSource* indexed = entry != m_index.end() ? entry->second.source : 0;
+
+		// only sources before the indexed one can shadow it, and only those
+		// that aren't indexed themselves need to be asked
+		type_sources::const_iterator end = m_sources.end();
+		for (type_sources::const_iterator i = m_sources.begin(); i != end; ++i) {
+			if (*i == indexed) {
+				name = entry->second.name;
+				return indexed;
+			}
+			if (m_indexedSources.count(*i) == 0 && (*i)->fileExists(file)) {
+				name = file;
+				return *i;
+			}
 		}
 
-		return *i;
+		FL_WARN(_log, LMsg("no source for ") << file << " found");
+		return 0;
 	}
 
 	bool VFS::exists(const std::string& file) const {
-		return getSourceForFile(file) != 0;
+		std::string name;
+		return getSourceForFile(file, name) != 0;
 	}
 
 	bool VFS::isDirectory(const std::string& path) const {
-		std::vector<std::string> tokens;
-		// Add a slash in case there isn't one in the string
-		const std::string newpath = path + "/";
-		boost::algorithm::split(tokens, newpath, boost::algorithm::is_any_of("/"));
-
-		std::string currentpath = "/";
-		std::vector<std::string>::const_iterator token=tokens.begin();
-		while (token != tokens.end()) {
-			if (*token != "") {
-				if (*token != "." && *token != ".." && listDirectories(currentpath, *token).size() == 0) {
-					return false;
-				} else {
-					currentpath += *token + "/";
-				}
+		const std::string normalized = NormalizePath(path);
+		if (normalized.empty()) {
+			return true;
+		}
+
+		type_index::const_iterator entry = m_index.find(normalized);
+		if (entry != m_index.end() && entry->second.directory) {
+			return true;
+		}
+
+		type_sources::const_iterator end = m_sources.end();
+		for (type_sources::const_iterator i = m_sources.begin(); i != end; ++i) {
+			if (m_indexedSources.count(*i) == 0 && (*i)->isDirectory(normalized)) {
+				return true;
 			}
-			++token;
 		}
 
-		return true;
+		return false;
 	}
 
 	RawData* VFS::open(const std::string& path) {
 		FL_DBG(_log, LMsg("Opening: ") << path);
 
-		VFSSource* source = getSourceForFile(path);
+		std::string name;
+		VFSSource* source = getSourceForFile(path, name);
 		if (!source)
 			throw NotFound(path);
 
-		return source->open(path);
+		if (m_cacheBudget > 0 && source->isCacheable(name)) {
+			return openCached(source, name, NormalizePath(path));
+		}
+		return source->open(name);
+	}
+
+	RawData* VFS::openCached(VFSSource* source, const std::string& name, const std::string& path) {
+		std::unordered_map<std::string, type_cache::iterator>::iterator lookup = m_cacheLookup.find(path);
+		if (lookup != m_cacheLookup.end()) {
+			type_cache::iterator entry = lookup->second;
+			if (entry->source == source) {
+				m_cache.splice(m_cache.begin(), m_cache, entry);
+				++m_cacheHits;
+				m_cacheBytesSaved += entry->data->size();
+				return new RawData(new RawDataSharedSource(entry->data));
+			}
+
+			// another source shadows the cached one now
+			m_cacheUsage -= entry->data->size();
+			m_cache.erase(entry);
+			m_cacheLookup.erase(lookup);
+		}
+
+		++m_cacheMisses;
+		RawData* data = source->open(name);
+		const uint32_t size = data->getDataLength();
+		if (size == 0 || size > m_cacheBudget / 4) {
+			return data;
+		}
+
+		std::shared_ptr<std::vector<uint8_t> > buffer(new std::vector<uint8_t>(size));
+		try {
+			data->readInto(&(*buffer)[0], size);
+		} catch (...) {
+			delete data;
+			throw;
+		}
+		delete data;
+
+		shrinkCache(m_cacheBudget - size);
+		CacheEntry entry;
+		entry.path = path;
+		entry.source = source;
+		entry.data = buffer;
+		m_cache.push_front(entry);
+		m_cacheLookup[path] = m_cache.begin();
+		m_cacheUsage += size;
+
+		return new RawData(new RawDataSharedSource(buffer));
+	}
+
+	void VFS::shrinkCache(uint32_t bytes) {
+		while (m_cacheUsage > bytes && !m_cache.empty()) {
+			const CacheEntry& entry = m_cache.back();
+			m_cacheUsage -= entry.data->size();
+			m_cacheLookup.erase(entry.path);
+			m_cache.pop_back();
+		}
+	}
+
+	void VFS::removeFromCache(const VFSSource* source) {
+		type_cache::iterator i = m_cache.begin();
+		while (i != m_cache.end()) {
+			if (i->source == source) {
+				m_cacheUsage -= i->data->size();
+				m_cacheLookup.erase(i->path);
+				i = m_cache.erase(i);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	void VFS::setCacheBudget(uint32_t bytes) {
+		m_cacheBudget = bytes;
+		shrinkCache(m_cacheBudget);
+	}
+
+	uint32_t VFS::getCacheBudget() const {
+		return m_cacheBudget;
+	}
+
+	uint32_t VFS::getCacheUsage() const {
+		return m_cacheUsage;
+	}
+
+	void VFS::clearCache() {
+		shrinkCache(0);
+	}
+
+	uint32_t VFS::getCacheHits() const {
+		return m_cacheHits;
+	}
+
+	uint32_t VFS::getCacheMisses() const {
+		return m_cacheMisses;
+	}
+
+	uint64_t VFS::getCacheBytesSaved() const {
+		return m_cacheBytesSaved;
+	}
+
+	void VFS::printCacheStatistics() const {
+		FL_LOG(_log, LMsg("VFS cache: ") << m_cache.size() << " files, " << m_cacheUsage << " of " << m_cacheBudget
+			<< " bytes used, " << m_cacheHits << " hits, " << m_cacheMisses << " misses, "
+			<< m_cacheBytesSaved << " bytes saved");
 	}
 
 	std::set<std::string> VFS::listFiles(const std::string& pathstr) const {
@@ -225,6 +362,60 @@ namespace FIFE {
 		return results;
 	}
 
+	void VFS::indexSource(VFSSource* source) {
+		std::vector<std::string> files;
+		std::vector<std::string> directories;
+		if (!source->getAllEntries(files, directories)) {
+			return;
+		}
+
+		m_indexedSources.insert(source);
+		m_index.reserve(m_index.size() + files.size() + directories.size());
+		for (std::vector<std::string>::const_iterator i = directories.begin(); i != directories.end(); ++i) {
+			addIndexEntry(NormalizePath(*i), source, *i, true);
+		}
+		for (std::vector<std::string>::const_iterator i = files.begin(); i != files.end(); ++i) {
+			addIndexEntry(NormalizePath(*i), source, *i, false);
+		}
+		FL_DBG(_log, LMsg("indexed ") << files.size() << " files and " << directories.size() << " directories, index size " << m_index.size());
+	}
+
+	void VFS::addIndexEntry(const std::string& path, VFSSource* source, const std::string& name, bool directory) {
+		if (path.empty()) {
+			return;
+		}
+
+		IndexEntry entry;
+		entry.source = source;
+		entry.name = name;
+		entry.directory = directory;
+		if (!m_index.insert(std::make_pair(path, entry)).second) {
+			return;
+		}
+
+		// parents are always inserted together with their children, so we can
+		// stop at the first one that is known already
+		entry.directory = true;
+		std::string::size_type slash = path.rfind('/');
+		while (slash != std::string::npos) {
+			const std::string parent = path.substr(0, slash);
+			entry.name = parent;
+			if (!m_index.insert(std::make_pair(parent, entry)).second) {
+				break;
+			}
+			slash = parent.rfind('/');
+		}
+	}
+
+	void VFS::rebuildIndex() {
+		m_index.clear();
+		m_indexedSources.clear();
+		type_sources::const_iterator end = m_sources.end();
+		for (type_sources::const_iterator i = m_sources.begin(); i != end; ++i) {
+			indexSource(*i);
+		}
+	}
+
 	bool VFS::hasSource(const std::string& path) const {
 		type_providers::const_iterator end = m_providers.end();
 		for (type_providers::const_iterator i = m_providers.begin(); i != end; ++i) {
@@ -23,9 +23,11 @@
 #define FIFE_VFS_VFS_H
 
 // Standard C++ library includes
+#include <list>
 #include <string>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 // 3rd party library includes
 #include <boost/shared_ptr.hpp>
@@ -35,6 +37,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/base/singleton.h"
+#include "vfs/raw/rawdatasharedsource.h"
 
 
 namespace FIFE {
@@ -51,6 +54,13 @@ namespace FIFE {
 	 * VFS. Since the VFSHostSystem is added first, this implies, that host filesystem
 	 * files will override whatever might be in other VFS Sources (e.g. the DAT files)
 	 *
+	 * @note Sources that can list their content (archives) are kept in a hash index of
+	 * normalized paths, so lookups only have to ask the remaining sources (the host
+	 * filesystem) directly. The index honours the source order as well.
+	 *
+	 * @note Files from sources that decompress their data can be kept in an LRU cache,
+	 * see setCacheBudget(). It is disabled by default.
+	 *
 	 * @note All filenames have to be @b lowercase. The VFS will convert them to lowercase
 	 * and emit a warning. This is done to avoid problems with filesystems which are not
 	 * case sensitive.
@@ -158,6 +168,44 @@ namespace FIFE {
 			 */
 			bool hasSource(const std::string& path) const;
 
+			/** Sets the number of bytes the cache of decompressed files may use
+			 *
+			 * Files opened from cacheable sources (archives) are kept in memory and
+			 * shared between all RawData opened from them, the least recently used
+			 * ones are dropped when the budget is exceeded. Files bigger than a quarter
+			 * of the budget aren't cached.
+			 * @param bytes the budget, 0 disables the cache and drops its content
+			 */
+			void setCacheBudget(uint32_t bytes);
+
+			/** Returns the byte budget of the cache, 0 if it is disabled
+			 */
+			uint32_t getCacheBudget() const;
+
+			/** Returns the number of bytes currently cached
+			 */
+			uint32_t getCacheUsage() const;
+
+			/** Drops all cached files, the statistics are kept
+			 */
+			void clearCache();
+
+			/** Returns how many opens were served from the cache
+			 */
+			uint32_t getCacheHits() const;
+
+			/** Returns how many opens of cacheable files had to ask their source
+			 */
+			uint32_t getCacheMisses() const;
+
+			/** Returns the number of bytes served from the cache instead of being decompressed again
+			 */
+			uint64_t getCacheBytesSaved() const;
+
+			/** Logs the cache statistics
+			 */
+			void printCacheStatistics() const;
+
 
 		private:
 			typedef std::vector<VFSSourceProvider*> type_providers;
@@ -166,8 +214,67 @@ namespace FIFE {
 			typedef std::vector<VFSSource*> type_sources;
 			type_sources m_sources;
 
+			/** An entry of the path index
+			 */
+			struct IndexEntry {
+				// first indexed source containing the path
+				VFSSource* source;
+				// the name the source knows the entry by
+				std::string name;
+				bool directory;
+			};
+			typedef std::unordered_map<std::string, IndexEntry> type_index;
+			type_index m_index;
+			std::set<const VFSSource*> m_indexedSources;
+
 			std::set<std::string> filterList(const std::set<std::string>& list, const std::string& fregex) const;
-			VFSSource* getSourceForFile(const std::string& file) const;
+
+			/** Finds the first source containing file.
+			 * @param file the file to look for
+			 * @param name receives the name to open the file with in the returned source
+			 * @return the source or 0 if there is none
+			 */
+			VFSSource* getSourceForFile(const std::string& file, std::string& name) const;
+
+			/** Adds the entries of source to the index, if it supports listing them.
+			 */
+			void indexSource(VFSSource* source);
+
+			/** Adds a path and its parent directories to the index, unless they are known already.
+			 */
+			void addIndexEntry(const std::string& path, VFSSource* source, const std::string& name, bool directory);
+
+			void rebuildIndex();
+
+			/** A cached file
+			 */
+			struct CacheEntry {
+				std::string path;
+				// source the data was read from, the entry is only valid as long as it is the resolved one
+				VFSSource* source;
+				SharedDataBuffer data;
+			};
+			// most recently used first
+			typedef std::list<CacheEntry> type_cache;
+			type_cache m_cache;
+			std::unordered_map<std::string, type_cache::iterator> m_cacheLookup;
+			uint32_t m_cacheBudget;
+			uint32_t m_cacheUsage;
+			uint32_t m_cacheHits;
+			uint32_t m_cacheMisses;
+			uint64_t m_cacheBytesSaved;
+
+			/** Opens a file through the cache, reading it from source on a miss.
+			 */
+			RawData* openCached(VFSSource* source, const std::string& name, const std::string& path);
+
+			/** Drops least recently used files until at most bytes are cached.
+			 */
+			void shrinkCache(uint32_t bytes);
+
+			/** Drops all cached files read from source.
+			 */
+			void removeFromCache(const VFSSource* source);
 	};
 
 }
@@ -53,6 +53,15 @@ namespace FIFE {
 
 		std::set<std::string> listFiles(const std::string& path) const;
 		std::set<std::string> listDirectories(const std::string& path) const;
+
+		void setCacheBudget(uint32_t bytes);
+		uint32_t getCacheBudget() const;
+		uint32_t getCacheUsage() const;
+		void clearCache();
+		uint32_t getCacheHits() const;
+		uint32_t getCacheMisses() const;
+		uint64_t getCacheBytesSaved() const;
+		void printCacheStatistics() const;
 	};
 }
 
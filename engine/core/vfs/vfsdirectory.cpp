@@ -29,6 +29,7 @@
 // Second block: files included from the same folder
 #include "vfs/raw/rawdata.h"
 #include "vfs/raw/rawdatafile.h"
+#include "vfs/raw/rawdatamappedfile.h"
 #include "util/log/logger.h"
 #include "util/base/exception.h"
 
@@ -65,7 +66,16 @@ namespace FIFE {
 	}
 
 	RawData* VFSDirectory::open(const std::string& file) const {
-		return new RawData(new RawDataFile(m_root + file));
+		const std::string path = m_root + file;
+		if (RawDataMappedFile::isSupported()) {
+			try {
+				return new RawData(new RawDataMappedFile(path));
+			} catch (const CannotOpenFile&) {
+				// e.g. special files or filesystems without mmap support, the stream can still handle them
+				FL_DBG(_log, LMsg("VFSDirectory: can't map ") << path << ", falling back to stream reading");
+			}
+		}
+		return new RawData(new RawDataFile(path));
 	}
 
 	std::set<std::string> VFSDirectory::listFiles(const std::string& path) const {
@@ -76,6 +86,15 @@ namespace FIFE {
 		return list(path, true);
 	}
 
+	bool VFSDirectory::isDirectory(const std::string& path) const {
+		try {
+			return bfs::is_directory(bfs::path(m_root + path));
+		}
+		catch (const bfs::filesystem_error&) {
+			return false;
+		}
+	}
+
 	std::set<std::string> VFSDirectory::list(const std::string& path, bool directorys) const {
 		std::set<std::string> list;
 		std::string dir = m_root;
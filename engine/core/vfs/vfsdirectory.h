@@ -76,6 +76,11 @@ namespace FIFE {
 			 */
 			std::set<std::string> listDirectories(const std::string& path) const;
 
+			/** Tests whether a path is a directory, asking the filesystem directly.
+			 * @param path The normalized path to test.
+			 */
+			virtual bool isDirectory(const std::string& path) const;
+
 		private:
 			std::string m_root;
 
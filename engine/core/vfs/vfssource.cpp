@@ -40,6 +40,33 @@ namespace FIFE {
 		m_vfs->removeSource(this);
 	}
 
+	bool VFSSource::isDirectory(const std::string& path) const {
+		std::string currentpath;
+		std::string::size_type begin = 0;
+		while (begin <= path.size()) {
+			std::string::size_type end = path.find('/', begin);
+			if (end == std::string::npos) {
+				end = path.size();
+			}
+
+			const std::string token = path.substr(begin, end - begin);
+			if (listDirectories(currentpath).count(token) == 0) {
+				return false;
+			}
+			currentpath += (currentpath.empty() ? "" : "/") + token;
+			begin = end + 1;
+		}
+		return true;
+	}
+
+	bool VFSSource::getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const {
+		return false;
+	}
+
+	bool VFSSource::isCacheable(const std::string& file) const {
+		return false;
+	}
+
 }
 
 std::string FIFE::VFSSource::fixPath(std::string path) const
@@ -24,6 +24,7 @@
 
 // Standard C++ library includes
 #include <string>
+#include <vector>
 
 // 3rd party library includes
 
@@ -81,6 +82,33 @@ namespace FIFE {
 			 */
 			virtual std::set<std::string> listDirectories(const std::string& path) const = 0;
 
+			/** check if the given path is a directory in this source
+			 *
+			 * The default implementation walks the path with listDirectories().
+			 * @param path normalized path to check, never empty
+			 * @see NormalizePath
+			 */
+			virtual bool isDirectory(const std::string& path) const;
+
+			/** get the complete content of this source
+			 *
+			 * Sources that know all their entries up front get indexed by the VFS,
+			 * lookups in them then don't need fileExists() anymore. Parent directories
+			 * of files don't have to be reported.
+			 * @param files receives the names of all files, as accepted by open()
+			 * @param directories receives the names of all directories
+			 * @return false if the source can't list its content cheaply (the default)
+			 */
+			virtual bool getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const;
+
+			/** check if a file of this source is worth caching
+			 *
+			 * Sources that decompress the file return true, so the VFS may keep it in its cache.
+			 * @param file the file to check
+			 * @return false by default
+			 */
+			virtual bool isCacheable(const std::string& file) const;
+
 		protected:
 			std::string fixPath(std::string path) const;
 
@@ -29,14 +29,18 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "util/base/memorytracker.h"
+
 #include "zipfilesource.h"
 
 namespace FIFE {
 
 	ZipFileSource::ZipFileSource(uint8_t* data, uint32_t datalen) : m_data(data), m_datalen(datalen) {
+		MemoryTracker::instance()->add(MEMORY_ZIP, m_datalen);
 	}
 
 	ZipFileSource::~ZipFileSource() {
+		MemoryTracker::instance()->remove(MEMORY_ZIP, m_datalen);
 		delete[] m_data;
 	}
 
@@ -48,4 +52,11 @@ namespace FIFE {
 		assert(start + len <= m_datalen);
 		memcpy(target, m_data + start, len);
 	}
+
+	const uint8_t* ZipFileSource::getView(uint32_t start, uint32_t len) {
+		if (start + len > m_datalen) {
+			return 0;
+		}
+		return m_data + start;
+	}
 }
@@ -0,0 +1,214 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cassert>
+#include <string.h>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/base/memorytracker.h"
+#include "util/log/logger.h"
+
+#include "zipinflatesource.h"
+
+namespace FIFE {
+
+	static Logger _log(LM_LOADERS);
+
+	static const uint32_t WINDOW_SIZE = 64 * 1024;
+	static const uint32_t INPUT_SIZE = 16 * 1024;
+	// uncompressed bytes between two resume points
+	static const uint32_t RESUME_INTERVAL = 1024 * 1024;
+	// approximate size of a copied inflate state with its 32 KB dictionary
+	static const uint32_t RESUME_POINT_MEMORY = 40 * 1024;
+
+	ZipInflateSource::ZipInflateSource(RawDataPtr archive, uint64_t offset, uint32_t compsize, uint32_t realsize) :
+		m_archive(archive),
+		m_offset(offset),
+		m_compsize(compsize),
+		m_realsize(realsize),
+		m_compread(0),
+		m_windowStart(0),
+		m_windowLength(0) {
+
+		m_zstream.next_in = Z_NULL;
+		m_zstream.avail_in = 0;
+		m_zstream.zalloc = Z_NULL;
+		m_zstream.zfree = Z_NULL;
+		m_zstream.opaque = Z_NULL;
+		if (inflateInit2(&m_zstream, -15) != Z_OK) {
+			throw InvalidFormat("inflateInit2 failed");
+		}
+
+		m_window.resize(std::min(WINDOW_SIZE, m_realsize));
+		if (!m_archive->getDataView()) {
+			m_input.resize(std::min(INPUT_SIZE, std::max<uint32_t>(m_compsize, 1)));
+		}
+		MemoryTracker::instance()->add(MEMORY_ZIP, m_window.size() + m_input.size());
+	}
+
+	ZipInflateSource::~ZipInflateSource() {
+		MemoryTracker::instance()->remove(MEMORY_ZIP, m_window.size() + m_input.size() +
+			m_resumePoints.size() * RESUME_POINT_MEMORY);
+		std::vector<ResumePoint*>::iterator it = m_resumePoints.begin();
+		for (; it != m_resumePoints.end(); ++it) {
+			inflateEnd(&(*it)->zstream);
+			delete *it;
+		}
+		inflateEnd(&m_zstream);
+	}
+
+	uint32_t ZipInflateSource::getSize() const {
+		return m_realsize;
+	}
+
+	void ZipInflateSource::readInto(uint8_t* target, uint32_t start, uint32_t len) {
+		assert(start + len <= m_realsize);
+		const uint32_t windowEnd = m_windowStart + m_windowLength;
+		if (start < m_windowStart) {
+			restart(findResumePoint(start));
+		} else if (start >= windowEnd) {
+			// a resume point after the window saves inflating the data in between
+			ResumePoint* point = findResumePoint(start);
+			if (point && point->position > windowEnd) {
+				restart(point);
+			}
+		}
+
+		while (len > 0) {
+			while (start >= m_windowStart + m_windowLength) {
+				inflateNext();
+			}
+
+			const uint32_t windowOffset = start - m_windowStart;
+			const uint32_t count = std::min(len, m_windowLength - windowOffset);
+			memcpy(target, &m_window[windowOffset], count);
+			target += count;
+			start += count;
+			len -= count;
+		}
+	}
+
+	uint32_t ZipInflateSource::getResumePointCount() const {
+		return m_resumePoints.size();
+	}
+
+	ZipInflateSource::ResumePoint* ZipInflateSource::findResumePoint(uint32_t start) const {
+		std::vector<ResumePoint*>::const_reverse_iterator it = m_resumePoints.rbegin();
+		for (; it != m_resumePoints.rend(); ++it) {
+			if ((*it)->position <= start) {
+				return *it;
+			}
+		}
+		return NULL;
+	}
+
+	void ZipInflateSource::restart(ResumePoint* point) {
+		if (point) {
+			FL_DBG(_log, LMsg("resuming inflate of zip entry at offset ") << m_offset << " at " << point->position);
+			inflateEnd(&m_zstream);
+			if (inflateCopy(&m_zstream, &point->zstream) != Z_OK) {
+				throw InvalidFormat("inflateCopy failed");
+			}
+			m_compread = point->compread;
+			m_windowStart = point->position;
+		} else {
+			FL_DBG(_log, LMsg("restarting inflate of zip entry at offset ") << m_offset);
+			inflateReset(&m_zstream);
+			m_compread = 0;
+			m_windowStart = 0;
+		}
+		// the input is read again from m_compread
+		m_zstream.next_in = Z_NULL;
+		m_zstream.avail_in = 0;
+		m_windowLength = 0;
+	}
+
+	void ZipInflateSource::addResumePoint() {
+		const uint32_t position = m_windowStart + m_windowLength;
+		const uint32_t last = m_resumePoints.empty() ? 0 : m_resumePoints.back()->position;
+		if (position < last + RESUME_INTERVAL || position >= m_realsize) {
+			return;
+		}
+		ResumePoint* point = new ResumePoint();
+		if (inflateCopy(&point->zstream, &m_zstream) != Z_OK) {
+			FL_WARN(_log, LMsg("inflateCopy failed, zip entry at offset ") << m_offset << " has no resume point at " << position);
+			delete point;
+			return;
+		}
+		point->position = position;
+		point->compread = m_compread - m_zstream.avail_in;
+		m_resumePoints.push_back(point);
+		MemoryTracker::instance()->add(MEMORY_ZIP, RESUME_POINT_MEMORY);
+	}
+
+	void ZipInflateSource::inflateNext() {
+		m_windowStart += m_windowLength;
+		m_windowLength = 0;
+
+		const uint32_t wanted = std::min<uint32_t>(m_window.size(), m_realsize - m_windowStart);
+		m_zstream.next_out = &m_window[0];
+		m_zstream.avail_out = wanted;
+
+		while (m_zstream.avail_out > 0) {
+			if (m_zstream.avail_in == 0 && m_compread < m_compsize) {
+				const uint8_t* view = m_archive->getDataView();
+				if (view) {
+					// hand the whole remaining entry to zlib, it's already in memory
+					m_zstream.next_in = const_cast<uint8_t*>(view + m_offset + m_compread);
+					m_zstream.avail_in = m_compsize - m_compread;
+				} else {
+					const uint32_t count = std::min<uint32_t>(m_input.size(), m_compsize - m_compread);
+					m_archive->readAt(&m_input[0], m_offset + m_compread, count);
+					m_zstream.next_in = &m_input[0];
+					m_zstream.avail_in = count;
+				}
+				m_compread += m_zstream.avail_in;
+			}
+
+			const int32_t err = inflate(&m_zstream, Z_NO_FLUSH);
+			if (err == Z_STREAM_END) {
+				break;
+			}
+			if (err != Z_OK) {
+				if (m_zstream.msg) {
+					FL_ERR(_log, LMsg("inflate failed: ") << m_zstream.msg);
+				} else {
+					FL_ERR(_log, LMsg("inflate failed without msg, err: ") << err);
+				}
+				throw InvalidFormat("corrupt deflate stream in zip entry");
+			}
+		}
+
+		m_windowLength = wanted - m_zstream.avail_out;
+		if (m_windowLength == 0) {
+			throw InvalidFormat("zip entry is shorter than its recorded size");
+		}
+		addResumePoint();
+	}
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VFS_ZIP_ZIPINFLATESOURCE_H
+#define FIFE_VFS_ZIP_ZIPINFLATESOURCE_H
+
+// Standard C++ library includes
+#include <vector>
+
+// 3rd party library includes
+#include "zlib.h"
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "vfs/raw/rawdata.h"
+#include "vfs/raw/rawdatasource.h"
+
+namespace FIFE {
+
+	/** A RawDataSource that inflates a deflated zip entry on demand
+	 *
+	 * Only a small window of the uncompressed data is kept in memory. Reads inside or
+	 * after the window are cheap. While inflating, a copy of the zlib state is kept
+	 * every megabyte as resume point, so seeking back or past the inflated part only
+	 * inflates from the closest resume point before the read, not from the beginning
+	 * of the entry. This keeps the seeks of audio decoders cheap.
+	 */
+	class ZipInflateSource : public RawDataSource {
+		public:
+			/** Constructor
+			 * @param archive The archive, kept alive as long as this source exists.
+			 * @param offset Offset of the compressed data inside the archive.
+			 * @param compsize Size of the compressed data.
+			 * @param realsize Size of the uncompressed data.
+			 * @throw InvalidFormat if zlib can't be initialized.
+			 */
+			ZipInflateSource(RawDataPtr archive, uint64_t offset, uint32_t compsize, uint32_t realsize);
+			virtual ~ZipInflateSource();
+
+			virtual uint32_t getSize() const;
+
+			/** @throw InvalidFormat if the compressed data is corrupt
+			 */
+			virtual void readInto(uint8_t* target, uint32_t start, uint32_t len);
+
+			/** Returns the number of resume points taken so far.
+			 */
+			uint32_t getResumePointCount() const;
+
+		private:
+			/** Copy of the inflate state at a window boundary.
+			 */
+			struct ResumePoint {
+				z_stream zstream;
+				// uncompressed offset the state continues at
+				uint32_t position;
+				// compressed bytes consumed by the state
+				uint32_t compread;
+			};
+
+			/** Returns the closest resume point at or before start, NULL if there is none.
+			 */
+			ResumePoint* findResumePoint(uint32_t start) const;
+
+			/** Continues inflating at the resume point, or at the beginning of the entry if it is NULL.
+			 */
+			void restart(ResumePoint* point);
+
+			/** Keeps a copy of the inflate state if the window ends a resume interval behind the last point.
+			 */
+			void addResumePoint();
+
+			/** Moves the window behind the current one and fills it.
+			 */
+			void inflateNext();
+
+			RawDataPtr m_archive;
+			uint64_t m_offset;
+			uint32_t m_compsize;
+			uint32_t m_realsize;
+
+			z_stream m_zstream;
+			// compressed bytes handed to zlib so far
+			uint32_t m_compread;
+			// used when the archive isn't memory mapped
+			std::vector<uint8_t> m_input;
+
+			std::vector<uint8_t> m_window;
+			// uncompressed offset of the first byte in the window
+			uint32_t m_windowStart;
+			uint32_t m_windowLength;
+
+			// sorted by position, allocated one by one because zlib states can't be moved
+			std::vector<ResumePoint*> m_resumePoints;
+
+			ZipInflateSource(const ZipInflateSource&);
+			ZipInflateSource& operator=(const ZipInflateSource&);
+	};
+
+}
+
+#endif
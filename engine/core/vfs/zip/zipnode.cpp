@@ -65,18 +65,22 @@ namespace FIFE {
     : comp(0), crc32(0), size_comp(0), size_real(0), offset(0) { 
     }
 
-    ZipNode::ZipNode(const std::string& name, ZipNode* parent/*=0*/)
-    : m_name(name), m_parent(parent) {
+    ZipNode::ZipNode(const std::string& name, ZipNode* parent/*=0*/,
+                     ZipContentType::Enum contentType/*=ZipContentType::All*/)
+    : m_name(name), m_contentType(contentType), m_parent(parent) {
 
-        // set the content type based on whether
-        // the name has an extension
-        if (HasExtension(m_name))
+        // if no type was given set the content type
+        // based on whether the name has an extension
+        if (m_contentType == ZipContentType::All)
         {
-            m_contentType = ZipContentType::File;
-        }
-        else
-        {
-            m_contentType = ZipContentType::Directory;
+            if (HasExtension(m_name))
+            {
+                m_contentType = ZipContentType::File;
+            }
+            else
+            {
+                m_contentType = ZipContentType::Directory;
+            }
         }
     }
 
@@ -146,40 +150,31 @@ namespace FIFE {
 
     ZipNode* ZipNode::getChild(const std::string& name, 
                                ZipContentType::Enum contentType/*=ZipContentType::All*/) const {
-        bool hasExtension = HasExtension(name);
-        
         switch (contentType) {
             default:                    // fall through on purpose
             case ZipContentType::All: {
-                ZipNode* node = 0;
-                if (hasExtension) {
-                    node = FindNameInContainer(m_fileChildren, name);
-                }
-                else {
-                    node = FindNameInContainer(m_directoryChildren, name);
+                // the type of a node doesn't have to match its
+                // extension, so look in the likely container first
+                const bool hasExtension = HasExtension(name);
+                ZipNode* node = FindNameInContainer(hasExtension ? m_fileChildren : m_directoryChildren, name);
+                if (!node) {
+                    node = FindNameInContainer(hasExtension ? m_directoryChildren : m_fileChildren, name);
                 }
 
                 return node;
             }
             case ZipContentType::File: {
-                if (!hasExtension) {
-                    return 0;
-                }
-
                 return FindNameInContainer(m_fileChildren, name);
             }
             case ZipContentType::Directory: {
-                if (hasExtension) {
-                    return 0;
-                }
-
                 return FindNameInContainer(m_directoryChildren, name);
             }
         }
     }
 
-    ZipNode* ZipNode::addChild(const std::string& name) {
-        ZipNode* child = new ZipNode(name, this);
+    ZipNode* ZipNode::addChild(const std::string& name,
+                               ZipContentType::Enum contentType/*=ZipContentType::All*/) {
+        ZipNode* child = new ZipNode(name, this, contentType);
         if (child) {
             if (child->getContentType() == ZipContentType::File) {
                 m_fileChildren.push_back(child);
@@ -54,7 +54,8 @@ namespace FIFE {
         uint32_t crc32;
         uint32_t size_comp;
         uint32_t size_real;
-        uint32_t offset;
+        // offset of the local file header, the data follows it
+        uint64_t offset;
     };
 
     // convenience typedef
@@ -66,8 +67,11 @@ namespace FIFE {
         /** constructor for creating a node
          *  @param name the name of the node
          *  @param parent the parent of this node, defaults to NULL
+         *  @param contentType the type of the node, ZipContentType::All
+         *         guesses it from the extension of the name
          */
-        ZipNode(const std::string& name, ZipNode* parent=0);
+        ZipNode(const std::string& name, ZipNode* parent=0,
+                ZipContentType::Enum contentType=ZipContentType::All);
 
         /** destructor
          */
@@ -110,9 +114,12 @@ namespace FIFE {
         /** allows adding a child node to this node
          *  @note this should only be used internally by the FIFE zip classes
          *  @param child the name to add as a child node
+         *  @param contentType the type of the child, ZipContentType::All
+         *         guesses it from the extension of the name
          *  @return the newly created child ZipNode
          */
-        ZipNode* addChild(const std::string& child);
+        ZipNode* addChild(const std::string& child,
+                          ZipContentType::Enum contentType=ZipContentType::All);
 
         /** allows removing a child from this node
          *  @param child the child node to remove
@@ -21,8 +21,10 @@
 
 // Standard C++ library includes
 #include <algorithm>
+#include <cstddef>
 #include <list>
 #include <memory>
+#include <vector>
 
 // 3rd party library includes
 #include "zlib.h"
@@ -38,44 +40,111 @@
 
 #include "zipsource.h"
 #include "zipfilesource.h"
+#include "zipinflatesource.h"
 #include "zipnode.h"
+#include "zipstoredsource.h"
 
 namespace FIFE {
 
 	static const uint32_t LF_HEADER = 0x04034b50;
 	static const uint32_t DE_HEADER = 0x08064b50;
 	static const uint32_t CF_HEADER = 0x02014b50;
+	static const uint32_t EOCD_HEADER = 0x06054b50;
+	static const uint32_t ZIP64_EOCD_HEADER = 0x06064b50;
+	static const uint32_t ZIP64_LOCATOR_HEADER = 0x07064b50;
+	static const uint16_t ZIP64_EXTRA_FIELD = 0x0001;
+
+	// fixed sizes of the records, without their variable length fields
+	static const uint32_t LF_SIZE = 30;
+	static const uint32_t CF_SIZE = 46;
+	static const uint32_t EOCD_SIZE = 22;
+	static const uint32_t ZIP64_EOCD_SIZE = 56;
+	static const uint32_t ZIP64_LOCATOR_SIZE = 20;
+
+	// highest "version needed to extract" we understand (4.5 = ZIP64)
+	static const uint16_t MAX_VERSION_NEEDED = 45;
+
+	// deflated entries at least this big are inflated while reading instead of on open
+	static const uint32_t STREAMING_THRESHOLD = 256 * 1024;
 
 	static Logger _log(LM_LOADERS);
 
-	ZipSource::ZipSource(VFS* vfs, const std::string& zip_file) : VFSSource(vfs), m_zipfile(vfs->open(zip_file)) {
+	static uint16_t readLE16(const uint8_t* p) {
+		return static_cast<uint16_t>(p[0] | (p[1] << 8));
+	}
+
+	static uint32_t readLE32(const uint8_t* p) {
+		return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+			(static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	static uint64_t readLE64(const uint8_t* p) {
+		return static_cast<uint64_t>(readLE32(p)) | (static_cast<uint64_t>(readLE32(p + 4)) << 32);
+	}
+
+	/** Returns length bytes of the archive starting at offset.
+	 * Uses the view of the data if there is one, otherwise the bytes are read into buffer.
+	 */
+	static const uint8_t* readBlock(RawData* data, uint64_t offset, uint32_t length, std::vector<uint8_t>& buffer) {
+		if (data->getDataView()) {
+			return data->getDataView() + offset;
+		}
+		buffer.resize(std::max<uint32_t>(length, 1));
+		data->readAt(&buffer[0], offset, length);
+		return &buffer[0];
+	}
+
+	ZipSource::ZipSource(VFS* vfs, const std::string& zip_file) :
+		VFSSource(vfs),
+		m_zipfilename(zip_file),
+		m_zipfile(vfs->open(zip_file)) {
 		readIndex();
 	}
 
 	ZipSource::~ZipSource() {
-		delete m_zipfile;
 	}
 
 	bool ZipSource::fileExists(const std::string& file) const {
-		bfs::path path(file);
-		return (m_zipTree.getNode(path.string()) != 0);
+		return m_pathTable.find(NormalizePath(file)) != m_pathTable.end();
 	}
 
 	RawData* ZipSource::open(const std::string& path) const {
-		bfs::path filePath(path);
-		ZipNode* node = m_zipTree.getNode(filePath.string());
+		ZipNode* node = findNode(path);
 
 		assert(node != 0);
 
 		if (node) {
 			const ZipEntryData& entryData = node->getZipEntryData();
 
-			m_zipfile->setIndex(entryData.offset);
+			// the central directory only knows the local header, its name and
+			// extra field can differ from the central ones so read their lengths here
+			std::vector<uint8_t> headerBuffer;
+			const uint8_t* header = readBlock(m_zipfile.get(), entryData.offset, LF_SIZE, headerBuffer);
+			if (readLE32(header) != LF_HEADER) {
+				FL_ERR(_log, LMsg("invalid local file header for ") << path);
+				return 0;
+			}
+			const uint16_t fnamelen = readLE16(header + LF_SIZE - 4);
+			const uint16_t extralen = readLE16(header + LF_SIZE - 2);
+			const uint64_t dataOffset = entryData.offset + LF_SIZE + fnamelen + extralen;
+			if (dataOffset + entryData.size_comp > m_zipfile->getLargeDataLength()) {
+				FL_ERR(_log, LMsg("zip entry out of range: ") << path);
+				return 0;
+			}
+
+			if (entryData.comp == 0 && (m_zipfile->getDataView() || entryData.size_real >= STREAMING_THRESHOLD)) {
+				return new RawData(new ZipStoredSource(getArchiveForReader(), dataOffset, entryData.size_real));
+			}
+			if (entryData.comp == 8 && entryData.size_real >= STREAMING_THRESHOLD) {
+				FL_DBG(_log, LMsg("streaming file ") << path << " (compressed with method " << entryData.comp << ")");
+				return new RawData(new ZipInflateSource(getArchiveForReader(), dataOffset, entryData.size_comp, entryData.size_real));
+			}
+
 			uint8_t* data = new uint8_t[entryData.size_real]; // beware of me - one day i WILL cause memory leaks
 			if (entryData.comp == 8) { // compressed using deflate
 				FL_DBG(_log, LMsg("trying to uncompress file ") <<  path << " (compressed with method " << entryData.comp << ")");
 				std::unique_ptr<uint8_t[]> compdata(new uint8_t[entryData.size_comp]);
-				m_zipfile->readInto(compdata.get(), entryData.size_comp);
+				m_zipfile->readAt(compdata.get(), dataOffset, entryData.size_comp);
 
 				z_stream zstream;
 				zstream.next_in = compdata.get();
@@ -107,7 +176,7 @@ namespace FIFE {
 
 				inflateEnd(&zstream);
 			} else if (entryData.comp == 0) { // uncompressed
-				m_zipfile->readInto(data, entryData.size_real);
+				m_zipfile->readAt(data, dataOffset, entryData.size_real);
 			} else {
 				FL_ERR(_log, LMsg("unsupported compression"));
 				delete[] data;
@@ -120,13 +189,174 @@ namespace FIFE {
 		return 0;
 	}
 
+	RawDataPtr ZipSource::getArchiveForReader() const {
+		if (m_zipfile->getDataView()) {
+			return m_zipfile;
+		}
+		return RawDataPtr(getVFS()->open(m_zipfilename));
+	}
+
 	void ZipSource::readIndex() {
-		m_zipfile->setIndex(0);
+		if (readCentralDirectory()) {
+			return;
+		}
 
+		// no central directory found (e.g. truncated archive), scan the local headers instead
+		FL_WARN(_log, LMsg("no central directory found, scanning local file headers"));
+		m_zipfile->setIndex(0);
 		while (!readFileToIndex()) {}
 	}
 
+	bool ZipSource::readCentralDirectory() {
+		const uint64_t size = m_zipfile->getLargeDataLength();
+		if (size < EOCD_SIZE) {
+			return false;
+		}
+
+		// the end of central directory record is followed by a comment of up to 64k
+		const uint32_t tailSize = static_cast<uint32_t>(std::min<uint64_t>(size, EOCD_SIZE + 0xFFFF));
+		std::vector<uint8_t> tailBuffer;
+		const uint8_t* tail = readBlock(m_zipfile.get(), size - tailSize, tailSize, tailBuffer);
+
+		const uint8_t* eocd = 0;
+		for (uint32_t i = tailSize - EOCD_SIZE + 1; i > 0; --i) {
+			if (readLE32(tail + i - 1) == EOCD_HEADER) {
+				eocd = tail + i - 1;
+				break;
+			}
+		}
+		if (!eocd) {
+			return false;
+		}
+
+		uint32_t disk = readLE16(eocd + 4);
+		uint64_t entries = readLE16(eocd + 10);
+		uint64_t cdSize = readLE32(eocd + 12);
+		uint64_t cdOffset = readLE32(eocd + 16);
+
+		// saturated fields mean the real values are in the ZIP64 end of central directory record
+		if ((entries == 0xFFFF || cdSize == 0xFFFFFFFF || cdOffset == 0xFFFFFFFF) &&
+			eocd - tail >= static_cast<ptrdiff_t>(ZIP64_LOCATOR_SIZE) &&
+			readLE32(eocd - ZIP64_LOCATOR_SIZE) == ZIP64_LOCATOR_HEADER) {
+			const uint64_t eocd64Offset = readLE64(eocd - ZIP64_LOCATOR_SIZE + 8);
+			if (eocd64Offset + ZIP64_EOCD_SIZE > size) {
+				FL_ERR(_log, LMsg("invalid ZIP64 end of central directory offset: ") << eocd64Offset);
+				return true;
+			}
+
+			std::vector<uint8_t> eocd64Buffer;
+			const uint8_t* eocd64 = readBlock(m_zipfile.get(), eocd64Offset, ZIP64_EOCD_SIZE, eocd64Buffer);
+			if (readLE32(eocd64) != ZIP64_EOCD_HEADER) {
+				FL_ERR(_log, LMsg("invalid ZIP64 end of central directory header"));
+				return true;
+			}
+			disk = readLE32(eocd64 + 16);
+			entries = readLE64(eocd64 + 32);
+			cdSize = readLE64(eocd64 + 40);
+			cdOffset = readLE64(eocd64 + 48);
+		}
+
+		if (disk != 0) {
+			FL_ERR(_log, LMsg("multi volume zip archives are not supported"));
+			return true;
+		}
+		if (cdOffset + cdSize > size || cdSize > 0xFFFFFFFF) {
+			FL_ERR(_log, LMsg("central directory out of range: ") << cdOffset << " + " << cdSize);
+			return true;
+		}
+
+		// read the complete central directory in one go
+		std::vector<uint8_t> cdBuffer;
+		const uint8_t* pos = readBlock(m_zipfile.get(), cdOffset, static_cast<uint32_t>(cdSize), cdBuffer);
+		const uint8_t* end = pos + cdSize;
+
+		// bound the reservation by what could fit, the entry count isn't trustworthy
+		m_pathTable.reserve(m_pathTable.size() + std::min<uint64_t>(entries, cdSize / CF_SIZE) * 5 / 4);
+
+		for (uint64_t i = 0; i < entries; ++i) {
+			if (end - pos < static_cast<ptrdiff_t>(CF_SIZE) || readLE32(pos) != CF_HEADER) {
+				FL_ERR(_log, LMsg("invalid central directory header for entry ") << i);
+				break;
+			}
+
+			const uint16_t vneeded = readLE16(pos + 6);
+			const uint16_t gflags = readLE16(pos + 8);
+			const uint16_t comp = readLE16(pos + 10);
+			const uint32_t crc = readLE32(pos + 16);
+			uint64_t compsize = readLE32(pos + 20);
+			uint64_t realsize = readLE32(pos + 24);
+			const uint16_t fnamelen = readLE16(pos + 28);
+			const uint16_t extralen = readLE16(pos + 30);
+			const uint16_t commentlen = readLE16(pos + 32);
+			uint64_t offset = readLE32(pos + 42);
+
+			const uint8_t* name = pos + CF_SIZE;
+			const uint8_t* extra = name + fnamelen;
+			const uint8_t* next = extra + extralen + commentlen;
+			if (next > end) {
+				FL_ERR(_log, LMsg("central directory entry ") << i << " exceeds the central directory");
+				break;
+			}
+			pos = next;
+
+			// the ZIP64 extra field only holds the values saturated in the header, in this order
+			const uint8_t* field = extra;
+			while (extra + extralen - field >= 4) {
+				const uint16_t id = readLE16(field);
+				const uint16_t length = readLE16(field + 2);
+				const uint8_t* value = field + 4;
+				const uint8_t* valueEnd = value + length;
+				if (valueEnd > extra + extralen) {
+					break;
+				}
+				if (id == ZIP64_EXTRA_FIELD) {
+					if (realsize == 0xFFFFFFFF && valueEnd - value >= 8) {
+						realsize = readLE64(value);
+						value += 8;
+					}
+					if (compsize == 0xFFFFFFFF && valueEnd - value >= 8) {
+						compsize = readLE64(value);
+						value += 8;
+					}
+					if (offset == 0xFFFFFFFF && valueEnd - value >= 8) {
+						offset = readLE64(value);
+					}
+				}
+				field = valueEnd;
+			}
+
+			const std::string filename(reinterpret_cast<const char*>(name), fnamelen);
+
+			if (vneeded > MAX_VERSION_NEEDED) {
+				FL_WARN(_log, LMsg("skipping ") << filename << ", unsupported zip version required: " << vneeded);
+				continue;
+			}
+			if (gflags & 0x01) {
+				FL_WARN(_log, LMsg("skipping ") << filename << ", encrypted entries are not supported");
+				continue;
+			}
+			// the entries themselves are RawData, so they are limited to 4GB
+			if (offset + LF_SIZE + compsize > size || compsize > 0xFFFFFFFF || realsize > 0xFFFFFFFF) {
+				FL_WARN(_log, LMsg("skipping ") << filename << ", entry out of range");
+				continue;
+			}
+
+			FL_DBG(_log, LMsg("found file: ") << filename << " (" << compsize << "/" << realsize << ") on offset " << offset);
+
+			ZipEntryData data;
+			data.comp = comp;
+			data.size_real = static_cast<uint32_t>(realsize);
+			data.size_comp = static_cast<uint32_t>(compsize);
+			data.offset = offset;
+			data.crc32 = crc;
+			addEntry(filename, data);
+		}
+
+		return true;
+	}
+
 	bool ZipSource::readFileToIndex() {
+		const uint32_t headerOffset = m_zipfile->getCurrentIndex();
 		uint32_t header   = m_zipfile->read32Little();
 		if (header == DE_HEADER || header == CF_HEADER) { // decryption header or central directory header - we are finished
 			return true;
@@ -153,11 +383,11 @@ namespace FIFE {
 			return true;
 		}
 
-		bfs::path filePath = bfs::path(m_zipfile->readString(fnamelen));
+		std::string filename = m_zipfile->readString(fnamelen);
 
 		m_zipfile->moveIndex(extralen);
 		uint32_t offset = m_zipfile->getCurrentIndex();
-		FL_DBG(_log, LMsg("found file: ") << filePath.string() << " (" << compsize << "/" << realsize << ") on offset " << offset);
+		FL_DBG(_log, LMsg("found file: ") << filename << " (" << compsize << "/" << realsize << ") on offset " << offset);
 
 		m_zipfile->moveIndex(compsize);
 		if (gflags & (0x01 << 3)) {
@@ -172,52 +402,123 @@ namespace FIFE {
 		data.comp = comp;
 		data.size_real = realsize;
 		data.size_comp = compsize;
-		data.offset = offset;
+		data.offset = headerOffset;
 		data.crc32 = crc;
 
-		std::string filename = filePath.string();
-		ZipNode* node = m_zipTree.addNode(filename);
+		addEntry(filename, data);
 
-		if (node) {
-			// store the zip entry information in the node
-			node->setZipEntryData(data);
+		return false;
+	}
+
+	ZipNode* ZipSource::addEntry(const std::string& name, const ZipEntryData& data) {
+		const std::string path = NormalizePath(name);
+		if (path.empty()) {
+			return 0;
 		}
 
-		return false;
+		if (name[name.size() - 1] == '/') {
+			return getDirectoryNode(path);
+		}
+
+		ZipNode* node = 0;
+		ZipPathTable::iterator it = m_pathTable.find(path);
+		if (it != m_pathTable.end()) {
+			// duplicate entry, the last one wins
+			node = it->second;
+		} else {
+			const std::string::size_type slash = path.rfind('/');
+			if (slash == std::string::npos) {
+				node = m_zipTree.getRootNode()->addChild(path, ZipContentType::File);
+			} else {
+				node = getDirectoryNode(path.substr(0, slash))->addChild(path.substr(slash + 1), ZipContentType::File);
+			}
+			m_pathTable.insert(std::make_pair(path, node));
+		}
+
+		node->setZipEntryData(data);
+		return node;
+	}
+
+	ZipNode* ZipSource::getDirectoryNode(const std::string& path) {
+		if (path.empty()) {
+			return m_zipTree.getRootNode();
+		}
+
+		ZipPathTable::iterator it = m_pathTable.find(path);
+		if (it != m_pathTable.end()) {
+			return it->second;
+		}
+
+		const std::string::size_type slash = path.rfind('/');
+		ZipNode* node = 0;
+		if (slash == std::string::npos) {
+			node = m_zipTree.getRootNode()->addChild(path, ZipContentType::Directory);
+		} else {
+			node = getDirectoryNode(path.substr(0, slash))->addChild(path.substr(slash + 1), ZipContentType::Directory);
+		}
+		m_pathTable.insert(std::make_pair(path, node));
+		return node;
+	}
+
+	ZipNode* ZipSource::findNode(const std::string& path) const {
+		const std::string key = NormalizePath(path);
+		if (key.empty()) {
+			return m_zipTree.getRootNode();
+		}
+
+		ZipPathTable::const_iterator it = m_pathTable.find(key);
+		return it != m_pathTable.end() ? it->second : 0;
+	}
+
+	bool ZipSource::getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const {
+		ZipPathTable::const_iterator end = m_pathTable.end();
+		for (ZipPathTable::const_iterator it = m_pathTable.begin(); it != end; ++it) {
+			if (it->second->getContentType() == ZipContentType::Directory) {
+				directories.push_back(it->first);
+			} else {
+				files.push_back(it->first);
+			}
+		}
+		return true;
 	}
 
+	bool ZipSource::isCacheable(const std::string& file) const {
+		// stored entries are read in place and big deflated ones are streamed,
+		// only the ones inflated as a whole are worth keeping
+		ZipNode* node = findNode(file);
+		if (!node || node->getContentType() != ZipContentType::File) {
+			return false;
+		}
+		const ZipEntryData& entryData = node->getZipEntryData();
+		return entryData.comp == 8 && entryData.size_real < STREAMING_THRESHOLD;
+	}
 
 	std::set<std::string> ZipSource::listFiles(const std::string& path) const {
 		std::set<std::string> result;
 
-		bfs::path fixedPath(path);
-
-		ZipNode* node = m_zipTree.getNode(fixedPath.string());
+		ZipNode* node = findNode(path);
 		
 		if (node) {
 			ZipNodeContainer files = node->getChildren(ZipContentType::File);
 			ZipNodeContainer::iterator iter;
 			for (iter = files.begin(); iter != files.end(); ++iter) {
-				result.insert((*iter)->getFullName());
+				result.insert((*iter)->getName());
 			}
 		}
 
 		return result;
 	}
 
-	// FIXME: quick&very dirty..
 	std::set<std::string> ZipSource::listDirectories(const std::string& path) const {
 		std::set<std::string> result;
 
-		bfs::path fixedPath(path);
-
-		ZipNode* node = m_zipTree.getNode(fixedPath.string());
+		ZipNode* node = findNode(path);
 
 		if (node) {
 			ZipNodeContainer files = node->getChildren(ZipContentType::Directory);
 			ZipNodeContainer::iterator iter;
 			for (iter = files.begin(); iter != files.end(); ++iter) {
-				result.insert((*iter)->getFullName());
+				result.insert((*iter)->getName());
 			}
 		}
 
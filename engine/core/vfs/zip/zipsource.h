@@ -25,6 +25,7 @@
 // Standard C++ library includes
 //
 #include <map>
+#include <unordered_map>
 
 // 3rd party library includes
 //
@@ -35,11 +36,26 @@
 // Second block: files included from the same folder
 #include "util/base/fife_stdint.h"
 #include "vfs/vfssource.h"
+#include "vfs/raw/rawdata.h"
 
+#include "zipnode.h"
 #include "ziptree.h"
 
 namespace FIFE {
 	/**  Implements a Zip archive file source.
+	 *
+	 * The index is built from the central directory at the end of the archive.
+	 * Lookups go through a flat hash table of normalized paths, the ZipTree is only
+	 * used for listing directories.
+	 *
+	 * Stored entries are opened as views into the archive, large deflated entries
+	 * are inflated on demand while they are read. Small deflated entries are
+	 * inflated completely when they are opened.
+	 *
+	 * ZIP64 records are read, so archives can have more than 65535 entries and be
+	 * larger than 4GB. The archive is read with 64 bit offsets, only the entries
+	 * themselves are limited to 4GB. Archives without a central directory are
+	 * scanned from the front, that fallback only reaches the first 4GB.
 	 *
 	 * @see FIFE::VFSSource
 	 */
@@ -56,14 +72,40 @@ namespace FIFE {
         std::set<std::string> listDirectories(const std::string& path) const;
 
         virtual RawData* open(const std::string& path) const;
+        virtual bool getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const;
+        virtual bool isCacheable(const std::string& file) const;
 
     private:
         void readIndex();
+        bool readCentralDirectory();
         bool readFileToIndex();
 
+        /** Adds an archive entry to the tree and the path table.
+         *  Names ending with a '/' are directories.
+         */
+        ZipNode* addEntry(const std::string& name, const ZipEntryData& data);
+
+        /** Returns the directory node for a normalized path, missing parents are created.
+         */
+        ZipNode* getDirectoryNode(const std::string& path);
+
+        /** Looks up a node, the root node is returned for an empty path.
+         */
+        ZipNode* findNode(const std::string& path) const;
+
     private:
+        typedef std::unordered_map<std::string, ZipNode*> ZipPathTable;
+
+        /** Returns the archive for a source that reads it after open() returned.
+         *  Memory mapped archives are shared, otherwise every reader gets its own
+         *  handle as the read position of a RawData isn't shared safely.
+         */
+        RawDataPtr getArchiveForReader() const;
+
+        std::string m_zipfilename;
         ZipTree m_zipTree;
-		RawData* m_zipfile;
+        ZipPathTable m_pathTable;
+		RawDataPtr m_zipfile;
 
 	};
 
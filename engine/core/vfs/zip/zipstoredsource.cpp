@@ -0,0 +1,67 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cassert>
+#include <string.h>
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+
+#include "zipstoredsource.h"
+
+namespace FIFE {
+
+	ZipStoredSource::ZipStoredSource(RawDataPtr archive, uint64_t offset, uint32_t size) :
+		m_archive(archive),
+		m_offset(offset),
+		m_size(size) {
+	}
+
+	ZipStoredSource::~ZipStoredSource() {
+	}
+
+	uint32_t ZipStoredSource::getSize() const {
+		return m_size;
+	}
+
+	void ZipStoredSource::readInto(uint8_t* target, uint32_t start, uint32_t len) {
+		assert(start + len <= m_size);
+		const uint8_t* view = m_archive->getDataView();
+		if (view) {
+			memcpy(target, view + m_offset + start, len);
+		} else {
+			m_archive->readAt(target, m_offset + start, len);
+		}
+	}
+
+	const uint8_t* ZipStoredSource::getView(uint32_t start, uint32_t len) {
+		const uint8_t* view = m_archive->getDataView();
+		if (!view || start + len > m_size) {
+			return 0;
+		}
+		return view + m_offset + start;
+	}
+}
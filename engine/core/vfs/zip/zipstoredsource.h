@@ -0,0 +1,65 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_VFS_ZIP_ZIPSTOREDSOURCE_H
+#define FIFE_VFS_ZIP_ZIPSTOREDSOURCE_H
+
+// Standard C++ library includes
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "vfs/raw/rawdata.h"
+#include "vfs/raw/rawdatasource.h"
+
+namespace FIFE {
+
+	/** A RawDataSource for an uncompressed zip entry
+	 *
+	 * Reads straight from the archive. If the archive is memory mapped the entry
+	 * is a view into the mapping and nothing gets copied.
+	 */
+	class ZipStoredSource : public RawDataSource {
+		public:
+			/** Constructor
+			 * @param archive The archive, kept alive as long as this source exists.
+			 * @param offset Offset of the entry data inside the archive.
+			 * @param size Size of the entry.
+			 */
+			ZipStoredSource(RawDataPtr archive, uint64_t offset, uint32_t size);
+			virtual ~ZipStoredSource();
+
+			virtual uint32_t getSize() const;
+			virtual void readInto(uint8_t* target, uint32_t start, uint32_t len);
+			virtual const uint8_t* getView(uint32_t start, uint32_t len);
+
+		private:
+			RawDataPtr m_archive;
+			uint64_t m_offset;
+			uint32_t m_size;
+	};
+
+}
+
+#endif
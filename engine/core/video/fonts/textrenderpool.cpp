@@ -31,6 +31,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "video/image.h"
+#include "util/base/memorytracker.h"
 #include "util/time/timemanager.h"
 
 #include "fontbase.h"
@@ -49,6 +50,7 @@ namespace FIFE {
 	TextRenderPool::~TextRenderPool() {
 		type_pool::iterator it= m_pool.begin();
 		for(;it != m_pool.end(); ++it) {
+			MemoryTracker::instance()->remove(MEMORY_TEXT, it->size);
 			delete it->image;
 		}
 	}
@@ -92,8 +94,10 @@ namespace FIFE {
 		centry.text = text;
 		centry.color = fontbase->getColor();
 		centry.image = image;
+		centry.size = image->getSize();
 		centry.timestamp = TimeManager::instance()->getTime();
 		m_pool.push_front( centry );
+		MemoryTracker::instance()->add(MEMORY_TEXT, centry.size);
 
 		// Some minimal amount of entries -> start collection timer
 		// Don't have a timer active if only _some_ text is pooled.
@@ -105,6 +109,7 @@ namespace FIFE {
 			m_poolSize++;
 			return;
 		} else {
+			MemoryTracker::instance()->remove(MEMORY_TEXT, m_pool.back().size);
 			delete m_pool.back().image;
 			m_pool.pop_back();
 		}
@@ -116,6 +121,7 @@ namespace FIFE {
 		uint32_t now = TimeManager::instance()->getTime();
 		while (it != m_pool.end()) {
 			if( (now - it->timestamp) > 1000*60 ) {
+				MemoryTracker::instance()->remove(MEMORY_TEXT, it->size);
 				delete it->image;
 				it = m_pool.erase(it);
 				--m_poolSize;
@@ -88,6 +88,8 @@ namespace FIFE {
 				uint32_t timestamp;
 
 				Image* image;
+				// size of the image when it was pooled
+				size_t size;
 			} s_pool_entry;
 
 			typedef std::list<s_pool_entry> type_pool;
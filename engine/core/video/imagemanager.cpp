@@ -20,7 +20,10 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <algorithm>
 #include <map>
+#include <set>
+#include <vector>
 
 // 3rd party library includes
 #include <tinyxml.h>
@@ -29,6 +32,10 @@
 // These includes are split up in two parts, separated by one empty line
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
+#include "loaders/native/video/imageloader.h"
+#include "util/base/exception.h"
+#include "util/base/memorytracker.h"
+#include "util/concurrency/jobsystem.h"
 #include "util/log/logger.h"
 #include "util/resource/resourcemanager.h"
 #include "util/resource/resource.h"
@@ -43,8 +50,17 @@ namespace FIFE {
 	 */
 	static Logger _log(LM_RESMGR);
 
-	ImageManager::~ImageManager() {
+	/** Number of image files that are read before they are decoded, limits the memory of loadAll().
+	 */
+	static const uint32_t LOAD_BATCH_SIZE = 64;
+
+	ImageManager::ImageManager() : IResourceManager() {
+		// the images are already accounted here, the tracker asks for it
+		MemoryTracker::instance()->setUsageCallback(MEMORY_IMAGES, std::bind(&ImageManager::getMemoryUsed, this));
+	}
 
+	ImageManager::~ImageManager() {
+		MemoryTracker::instance()->setUsageCallback(MEMORY_IMAGES, std::function<size_t()>());
 	}
 
 	size_t ImageManager::getMemoryUsed() const {
@@ -244,6 +260,84 @@ namespace FIFE {
 		FL_DBG(_log, LMsg("ImageManager::loadUnreferenced() - ") << "Loaded " << count << " unreferenced resources.");
 	}
 
+	void ImageManager::loadAll() {
+		std::vector<ImagePtr> images;
+		images.reserve(m_imgHandleMap.size());
+		ImageHandleMapIterator it = m_imgHandleMap.begin(),
+			itend = m_imgHandleMap.end();
+		for ( ; it != itend; ++it) {
+			images.push_back(it->second);
+		}
+		loadImages(images);
+	}
+
+	void ImageManager::loadImages(const std::vector<ImagePtr>& images) {
+		std::vector<ImagePtr> decodable;
+		std::vector<ImagePtr> others;
+		std::set<ResourceHandle> handles;
+		std::vector<ImagePtr>::const_iterator it = images.begin();
+		for ( ; it != images.end(); ++it) {
+			const ImagePtr& image = *it;
+			if (!image || image->getState() == IResource::RES_LOADED || !handles.insert(image->getHandle()).second) {
+				continue;
+			}
+			if (!image->isSharedImage() && !image->getLoader()) {
+				decodable.push_back(image);
+			} else {
+				others.push_back(image);
+			}
+		}
+
+		uint32_t count = static_cast<uint32_t>(decodable.size());
+		std::vector<std::vector<uint8_t> > files(std::min(count, LOAD_BATCH_SIZE));
+		std::vector<SDL_Surface*> surfaces(files.size());
+		for (uint32_t start = 0; start < count; start += LOAD_BATCH_SIZE) {
+			uint32_t batch = std::min(count - start, LOAD_BATCH_SIZE);
+			// the VFS is not thread safe, so only the decoding runs in parallel
+			for (uint32_t i = 0; i < batch; ++i) {
+				files[i].clear();
+				surfaces[i] = NULL;
+				try {
+					ImageLoader::readFile(decodable[start + i]->getName(), files[i]);
+				} catch (Exception&) {
+					// load() below reports the error
+				}
+			}
+			JobSystem::instance()->parallelFor(batch, [&files, &surfaces](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i) {
+					if (files[i].empty()) {
+						continue;
+					}
+					try {
+						surfaces[i] = ImageLoader::decode(files[i]);
+					} catch (Exception&) {
+						// load() below reports the error
+					}
+				}
+			}, 1);
+			// the images take their surfaces before anything can throw
+			for (uint32_t i = 0; i < batch; ++i) {
+				if (surfaces[i]) {
+					ImageLoader::setSurface(decodable[start + i].get(), surfaces[i]);
+					decodable[start + i]->setState(IResource::RES_LOADED);
+				}
+			}
+			for (uint32_t i = 0; i < batch; ++i) {
+				if (!surfaces[i]) {
+					decodable[start + i]->load();
+				}
+			}
+		}
+
+		// shared images and images with their own loader
+		for (it = others.begin(); it != others.end(); ++it) {
+			if ((*it)->getState() != IResource::RES_LOADED) {
+				(*it)->load();
+			}
+		}
+		FL_DBG(_log, LMsg("ImageManager::loadImages() - ") << "Decoded " << count << " images in parallel.");
+	}
+
 	void ImageManager::free(const std::string& name) {
 		ImageNameMapIterator nit = m_imgNameMap.find(name);
 
@@ -56,7 +56,7 @@ namespace FIFE {
 
 		/** Default constructor.
 		 */
-		ImageManager() : IResourceManager() { }
+		ImageManager();
 
 		/** Destructor.
 		 */
@@ -214,6 +214,23 @@ namespace FIFE {
 		 */
 		virtual void loadUnreferenced();
 
+		/** Loads all Images that are not loaded yet
+		 *
+		 * @see loadImages()
+		 *
+		 */
+		virtual void loadAll();
+
+		/** Loads the given Images that are not loaded yet
+		 *
+		 * The files of Images without a custom loader are read
+		 * one after another and decoded in parallel by the JobSystem.
+		 * The other Images are loaded as usual.
+		 *
+		 * @param images The Images to load.
+		 */
+		virtual void loadImages(const std::vector<ImagePtr>& images);
+
 		/** Frees an Image from memory
 		 *
 		 * The Image is not deleted but it's data is freed.
@@ -29,6 +29,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "util/structures/rect.h"
+#include "util/time/profiler.h"
 #include "video/imagemanager.h"
 #include "video/sdl/sdlimage.h"
 #include "video/renderbackend.h"
@@ -224,6 +225,7 @@ namespace FIFE {
 	}
 
 	void GLImage::generateGLTexture() {
+		FIFE_PROFILE_ZONE("textureUpload");
 		if (m_shared) {
 			// First make sure we loaded big image to opengl
 			validateShared();
@@ -109,6 +109,7 @@ namespace FIFE {
 		virtual void reload(ResourceHandle handle);
 		virtual void reloadAll();
 		virtual void loadUnreferenced();
+		virtual void loadAll();
 
 		virtual void free(const std::string& name);
 		virtual void free(ResourceHandle handle);
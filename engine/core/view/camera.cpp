@@ -36,9 +36,11 @@
 #include "model/structures/instancetree.h"
 #include "model/structures/instance.h"
 #include "model/structures/location.h"
+#include "util/concurrency/jobsystem.h"
 #include "util/log/logger.h"
 #include "util/math/fife_math.h"
 #include "util/math/angles.h"
+#include "util/time/profiler.h"
 #include "util/time/timemanager.h"
 #include "video/renderbackend.h"
 #include "video/image.h"
@@ -430,6 +432,10 @@ namespace FIFE {
 		return pt;
 	}
 
+	void Camera::toVirtualScreenCoordinates(const DoublePoint3DArray& map_coords, DoublePoint3DArray& screen_coords) {
+		transformPoints(m_vs_matrix, map_coords, screen_coords);
+	}
+
 	ScreenPoint Camera::virtualScreenToScreen(const DoublePoint3D& p) {
 		return doublePt2intPt(m_vscreen_2_screen * p);
 	}
@@ -960,6 +966,8 @@ namespace FIFE {
 			return;
 		}
 
+		std::vector<LayerCache*> caches;
+		std::vector<RenderList*> renderLists;
 		const std::list<Layer*>& layers = m_map->getLayers();
 		std::list<Layer*>::const_iterator layer_it = layers.begin();
 		for (;layer_it != layers.end(); ++layer_it) {
@@ -974,7 +982,16 @@ namespace FIFE {
 				continue;
 			}
 			cache->update(m_transform, instancesToRender);
+			caches.push_back(cache);
+			renderLists.push_back(&instancesToRender);
 		}
+		// the update touches shared resources and listeners, only the sorting runs in parallel
+		JobSystem::instance()->parallelFor(static_cast<uint32_t>(caches.size()),
+			[&caches, &renderLists](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i) {
+					caches[i]->finishUpdate(*renderLists[i]);
+				}
+			}, 1);
 		resetUpdates();
 	}
 
@@ -1007,6 +1024,7 @@ namespace FIFE {
 
 		layer_it = layers.begin();
 		for ( ; layer_it != layers.end(); ++layer_it) {
+			FIFE_PROFILE_ZONE((*layer_it)->getId());
 			// layer with static flag will rendered as one texture
 			if ((*layer_it)->isStatic()) {
 				m_cache[*layer_it]->getCacheImage()->render(m_viewport);
@@ -1025,6 +1043,7 @@ namespace FIFE {
 					std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
 					for (; r_it != m_pipeline.end(); ++r_it) {
 						if ((*r_it)->isActivedLayer(*layer_it)) {
+							FIFE_PROFILE_ZONE((*r_it)->getName());
 							(*r_it)->render(this, *layer_it, tempList);
 							m_renderbackend->renderVertexArrays();
 						}
@@ -1034,6 +1053,7 @@ namespace FIFE {
 				std::list<RendererBase*>::iterator r_it = m_pipeline.begin();
 				for (; r_it != m_pipeline.end(); ++r_it) {
 					if ((*r_it)->isActivedLayer(*layer_it)) {
+						FIFE_PROFILE_ZONE((*r_it)->getName());
 						(*r_it)->render(this, *layer_it, instancesToRender);
 						m_renderbackend->renderVertexArrays();
 					}
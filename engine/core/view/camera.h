@@ -36,6 +36,7 @@
 // Second block: files included from the same folder
 #include "model/structures/location.h"
 #include "util/structures/rect.h"
+#include "util/math/batchtransform.h"
 #include "util/math/matrix.h"
 #include "video/animation.h"
 
@@ -259,6 +260,12 @@ namespace FIFE {
 		 */
 		DoublePoint3D toVirtualScreenCoordinates(const ExactModelCoordinate& map_coords);
 
+		/** Transforms all given points from map coordinates to virtual screen coordinates
+		 *  @param map_coords points in map coordinates
+		 *  @param screen_coords receives the points in virtual screen coordinates, can be the same array as map_coords
+		 */
+		void toVirtualScreenCoordinates(const DoublePoint3DArray& map_coords, DoublePoint3DArray& screen_coords);
+
 		/** Transforms given point from virtual screen coordinates to screen coordinates
 		 *  @return point in screen coordinates
 		 */
@@ -33,8 +33,10 @@
 #include "model/metamodel/action.h"
 #include "model/structures/layer.h"
 #include "model/structures/instance.h"
+#include "model/structures/map.h"
 #include "model/structures/location.h"
 #include "util/base/exception.h"
+#include "util/base/memorytracker.h"
 #include "util/log/logger.h"
 #include "util/math/fife_math.h"
 #include "util/math/angles.h"
@@ -72,6 +74,10 @@ namespace FIFE {
 			m_cache->addInstance(instance);
 		}
 
+		virtual void onInstancesCreate(Layer* layer, std::vector<Instance*>& instances) {
+			m_cache->addInstances(instances);
+		}
+
 		virtual void onInstanceDelete(Layer* layer, Instance* instance)	{
 			m_cache->removeInstance(instance);
 		}
@@ -178,6 +184,9 @@ namespace FIFE {
 		m_tree = 0;
 		m_zMin = 0.0;
 		m_zMax = 0.0;
+		m_sortPending = false;
+		m_tick = 0;
+		m_interpolation = 1.0;
 		m_zoom = camera->getZoom();
 		m_zoomed = !Mathd::Equal(m_zoom, 1.0);
 		m_straightZoom = Mathd::Equal(fmod(m_zoom, 1.0), 0.0);
@@ -194,6 +203,7 @@ namespace FIFE {
 		for (std::vector<Entry*>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
 			delete *it;
 		}
+		MemoryTracker::instance()->remove(MEMORY_LAYER_CACHE, sizeof(Entry) * m_entries.size(), m_entries.size());
 		// removes all RenderItems
 		for (std::vector<RenderItem*>::iterator it = m_renderItems.begin(); it != m_renderItems.end(); ++it) {
 			delete *it;
@@ -221,6 +231,7 @@ namespace FIFE {
 		for (std::vector<Entry*>::iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
 			delete *it;
 		}
+		MemoryTracker::instance()->remove(MEMORY_LAYER_CACHE, sizeof(Entry) * m_entries.size(), m_entries.size());
 		m_entries.clear();
 		// removes all RenderItems
 		for (std::vector<RenderItem*>::iterator it = m_renderItems.begin(); it != m_renderItems.end(); ++it) {
@@ -229,6 +240,7 @@ namespace FIFE {
 		m_renderItems.clear();
 		m_instance_map.clear();
 		m_entriesToUpdate.clear();
+		m_interpolatedEntries.clear();
 		m_freeEntries.clear();
 		m_cacheImage.reset();
 
@@ -254,6 +266,7 @@ namespace FIFE {
 			// creates new Entry
 			entry = new Entry();
 			m_entries.push_back(entry);
+			MemoryTracker::instance()->add(MEMORY_LAYER_CACHE, sizeof(Entry));
 			entry->instanceIndex = m_renderItems.size() - 1;
 			entry->entryIndex = m_entries.size() - 1;
 		} else {
@@ -273,10 +286,26 @@ namespace FIFE {
 		entry->forceUpdate = true;
 		entry->visible = true;
 		entry->updateInfo = EntryFullUpdate;
+		entry->prevCoords = instance->getLocationRef().getMapCoordinates();
+		entry->tickCoords = entry->prevCoords;
+		entry->tick = 0;
 
 		m_entriesToUpdate.insert(entry->entryIndex);
 	}
 
+	void LayerCache::addInstances(const std::vector<Instance*>& instances) {
+		// free entries are used first, only the rest needs new storage
+		if (instances.size() > m_freeEntries.size()) {
+			size_t required = m_renderItems.size() + instances.size() - m_freeEntries.size();
+			m_renderItems.reserve(required);
+			m_entries.reserve(required);
+		}
+		std::vector<Instance*>::const_iterator it = instances.begin();
+		for (; it != instances.end(); ++it) {
+			addInstance(*it);
+		}
+	}
+
 	void LayerCache::removeInstance(Instance* instance) {
 		assert(m_instance_map.find(instance) != m_instance_map.end());
 
@@ -288,6 +317,7 @@ namespace FIFE {
 		if (it != m_entriesToUpdate.end()) {
 			m_entriesToUpdate.erase(it);
 		}
+		m_interpolatedEntries.erase(entry->entryIndex);
 		// removes entry from CacheTree
 		if (entry->node) {
 			entry->node->data().erase(entry->entryIndex);
@@ -321,6 +351,17 @@ namespace FIFE {
 		const InstanceChangeInfo ici = instance->getChangeInfo();
 		if ((ici & ICHANGE_LOC) == ICHANGE_LOC) {
 			entry->updateInfo |= EntryPositionUpdate;
+			// remember the positions of the last two ticks, if the map is drawn between them
+			Map* map = m_layer->getMap();
+			if (map->getInterpolation() < 1.0) {
+				uint32_t tick = map->getTickCount();
+				if (entry->tick != tick) {
+					entry->prevCoords = entry->tickCoords;
+					entry->tick = tick;
+				}
+				entry->tickCoords = instance->getLocationRef().getMapCoordinates();
+				m_interpolatedEntries.insert(entry->entryIndex);
+			}
 		}
 		if ((ici & ICHANGE_ROTATION) == ICHANGE_ROTATION ||
 			(ici & ICHANGE_ACTION) == ICHANGE_ACTION ||
@@ -367,6 +408,14 @@ namespace FIFE {
 	}
 
 	void LayerCache::update(Camera::Transform transform, RenderList& renderlist) {
+		m_sortPending = false;
+		m_sortList.clear();
+		Map* map = m_layer->getMap();
+		m_tick = map->getTickCount();
+		m_interpolation = map->getInterpolation();
+		if (!m_interpolatedEntries.empty()) {
+			updateInterpolatedEntries();
+		}
 		// this is only a bit faster, but works without this block too.
 		if(!m_layer->areInstancesVisible()) {
 			FL_DBG(_log, "Layer instances hidden");
@@ -436,9 +485,7 @@ namespace FIFE {
 				}
 			}
 
-			if (m_needSorting) {
-				sortRenderList(renderlist);
-			} else {
+			if (!m_needSorting) {
 				// calculates zmin and zmax of the current viewport
 				Rect r = m_camera->getMapViewPort();
 				std::vector<ExactModelCoordinate> coords;
@@ -451,11 +498,24 @@ namespace FIFE {
 					m_zMin = std::min(z, m_zMin);
 					m_zMax = std::max(z, m_zMax);
 				}
-
-				sortRenderList(renderlist);
 			}
+			m_sortPending = true;
+			m_sortList.clear();
 		}
 	}
+
+	void LayerCache::finishUpdate(RenderList& renderlist) {
+		if (!m_sortPending) {
+			return;
+		}
+		if (m_sortList.empty()) {
+			sortRenderList(renderlist);
+		} else {
+			sortRenderList(m_sortList);
+			m_sortList.clear();
+		}
+		m_sortPending = false;
+	}
 	
 	void LayerCache::fullUpdate(Camera::Transform transform) {
 		bool rotationChange = (transform & Camera::RotationTransform) == Camera::RotationTransform;
@@ -475,9 +535,11 @@ namespace FIFE {
 						m_entriesToUpdate.insert(entry->entryIndex);
 					}
 				}
-				updatePosition(entry);
+				m_batchEntries.push_back(entry);
+				m_batchCoords.push_back(getMapCoordinates(entry));
 			}
 		}
+		updateBatchPositions();
 	}
 
 	void LayerCache::fullCoordinateUpdate(Camera::Transform transform) {
@@ -487,7 +549,8 @@ namespace FIFE {
 			if (entry->instanceIndex != -1) {
 				if (entry->forceUpdate) {
 					updateVisual(entry);
-					updatePosition(entry);
+					m_batchEntries.push_back(entry);
+					m_batchCoords.push_back(getMapCoordinates(entry));
 					if (!entry->forceUpdate) {
 						// no action
 						entry->updateInfo = EntryNoneUpdate;
@@ -498,6 +561,7 @@ namespace FIFE {
 				updateScreenCoordinate(m_renderItems[entry->instanceIndex], zoomChange);
 			}
 		}
+		updateBatchPositions();
 	}
 
 	void LayerCache::updateEntries(std::set<int32_t>& removes, RenderList& renderlist) {
@@ -551,10 +615,10 @@ namespace FIFE {
 		}
 
 		if (!needSorting.empty()) {
-			if (m_needSorting) {
-				sortRenderList(renderlist);
-			} else {
-				sortRenderList(needSorting);
+			// without sorting only the z values of the changed items are needed
+			m_sortPending = true;
+			if (!m_needSorting) {
+				m_sortList.swap(needSorting);
 			}
 		}
 	}
@@ -692,11 +756,49 @@ namespace FIFE {
 		return newPosition;
 	}
 
+	void LayerCache::updateBatchPositions() {
+		if (m_batchEntries.empty()) {
+			return;
+		}
+		// transform all collected positions in one go
+		m_camera->toVirtualScreenCoordinates(m_batchCoords, m_batchCoords);
+		for (uint32_t i = 0; i != m_batchEntries.size(); ++i) {
+			updatePosition(m_batchEntries[i], m_batchCoords.get(i));
+		}
+		m_batchEntries.clear();
+		m_batchCoords.clear();
+	}
+
+	void LayerCache::updateInterpolatedEntries() {
+		std::set<int32_t>::iterator it = m_interpolatedEntries.begin();
+		while (it != m_interpolatedEntries.end()) {
+			Entry* entry = m_entries[*it];
+			// the position changes every frame while the instance moves between two ticks
+			entry->updateInfo |= EntryPositionUpdate;
+			entry->forceUpdate = true;
+			m_entriesToUpdate.insert(*it);
+			// the instance did not move during the latest tick, so this is the last update
+			if (entry->tick != m_tick || m_interpolation >= 1.0) {
+				m_interpolatedEntries.erase(it++);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	ExactModelCoordinate LayerCache::getMapCoordinates(Entry* entry) const {
+		if (entry->tick == m_tick && m_interpolation < 1.0) {
+			return entry->prevCoords + (entry->tickCoords - entry->prevCoords) * m_interpolation;
+		}
+		return m_renderItems[entry->instanceIndex]->instance->getLocationRef().getMapCoordinates();
+	}
+
 	void LayerCache::updatePosition(Entry* entry) {
+		updatePosition(entry, m_camera->toVirtualScreenCoordinates(getMapCoordinates(entry)));
+	}
+
+	void LayerCache::updatePosition(Entry* entry, DoublePoint3D screenPosition) {
 		RenderItem* item = m_renderItems[entry->instanceIndex];
-		Instance* instance = item->instance;
-		ExactModelCoordinate mapCoords = instance->getLocationRef().getMapCoordinates();
-		DoublePoint3D screenPosition = m_camera->toVirtualScreenCoordinates(mapCoords);
 		ImagePtr image = item->image;
 
 		if (image) {
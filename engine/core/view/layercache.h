@@ -55,9 +55,19 @@ namespace FIFE {
 
 		void setLayer(Layer* layer);
 
+		/** Updates the entries and the renderlist.
+		 * The sorting of the renderlist is left to finishUpdate().
+		 */
 		void update(Camera::Transform transform, RenderList& renderlist);
 
+		/** Sorts the renderlist or calculates the z values, as requested by update().
+		 * Only touches the render items of this cache, so the caches of different
+		 * layers can be finished in parallel.
+		 */
+		void finishUpdate(RenderList& renderlist);
+
 		void addInstance(Instance* instance);
+		void addInstances(const std::vector<Instance*>& instances);
 		void removeInstance(Instance* instance);
 		void updateInstance(Instance* instance);
 		
@@ -86,6 +96,11 @@ namespace FIFE {
 			bool visible;
 			// Update info
 			RenderEntryUpdate updateInfo;
+			// Map coordinates before and after the latest simulation tick that moved the instance
+			ExactModelCoordinate prevCoords;
+			ExactModelCoordinate tickCoords;
+			// Simulation tick of tickCoords
+			uint32_t tick;
 		};
 
 		void collect(const Rect& viewport, std::vector<int32_t>& indices);
@@ -95,6 +110,10 @@ namespace FIFE {
 		void updateEntries(std::set<int32_t>& removes, RenderList& renderlist);
 		bool updateVisual(Entry* entry);
 		void updatePosition(Entry* entry);
+		void updatePosition(Entry* entry, DoublePoint3D screenPosition);
+		void updateBatchPositions();
+		void updateInterpolatedEntries();
+		ExactModelCoordinate getMapCoordinates(Entry* entry) const;
 		void updateScreenCoordinate(RenderItem* item, bool changedZoom = true);
 		void sortRenderList(RenderList& renderlist);
 
@@ -108,12 +127,24 @@ namespace FIFE {
 		std::vector<Entry*> m_entries;
 		std::vector<RenderItem*> m_renderItems;
 		std::set<int32_t> m_entriesToUpdate;
+		// entries that are drawn between two simulation ticks
+		std::set<int32_t> m_interpolatedEntries;
 		std::deque<int32_t> m_freeEntries;
+		// scratch buffers for the batched position update
+		std::vector<Entry*> m_batchEntries;
+		DoublePoint3DArray m_batchCoords;
 
 		bool m_needSorting;
+		// finishUpdate() has to sort, the whole renderlist if m_sortList is empty
+		bool m_sortPending;
+		RenderList m_sortList;
 		double m_zMin;
 		double m_zMax;
 
+		// simulation tick and interpolation of the current update
+		uint32_t m_tick;
+		double m_interpolation;
+
 		double m_zoom;
 		bool m_zoomed;
 		bool m_straightZoom;
@@ -28,6 +28,7 @@
 // First block: files included from the FIFE root src directory
 // Second block: files included from the same folder
 #include "model/structures/instance.h"
+#include "util/base/memorytracker.h"
 #include "model/metamodel/object.h"
 #include "model/metamodel/action.h"
 
@@ -60,9 +61,11 @@ namespace FIFE {
 		m_overlay(0),
 		m_cachedStaticImgId(STATIC_IMAGE_NOT_INITIALIZED),
 		m_cachedStaticImgAngle(0) {
+		MemoryTracker::instance()->add(MEMORY_RENDER_ITEMS, sizeof(RenderItem));
 	}
 	
 	RenderItem::~RenderItem() {
+		MemoryTracker::instance()->remove(MEMORY_RENDER_ITEMS, sizeof(RenderItem));
 		delete m_overlay;
 	}
 
@@ -33,6 +33,7 @@
 #include "model/metamodel/ivisual.h"
 #include "util/math/angles.h"
 #include "util/structures/rect.h"
+#include "util/structures/objectpool.h"
 #include "video/animation.h"
 #include "video/color.h"
 
@@ -165,6 +166,9 @@ namespace FIFE {
 		 */
 		virtual ~InstanceVisual();
 
+		static void* operator new(std::size_t size) { return ObjectPool<InstanceVisual>::allocate(size); }
+		static void operator delete(void* ptr, std::size_t size) { ObjectPool<InstanceVisual>::deallocate(ptr, size); }
+
 		/** Sets transparency value for object to be visualized
 		 *  @param transparency set the transparency
 		 */
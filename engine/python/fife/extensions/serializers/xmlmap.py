@@ -226,6 +226,7 @@ class XMLMapLoader(object):
 			y_offset = layer.get('y_offset')
 			z_offset = layer.get('z_offset')
 			pathing = layer.get('pathing')
+			spatial_index = layer.get('spatial_index')
 			transparency = layer.get('transparency')
 
 			layer_type = layer.get('layer_type')
@@ -267,6 +268,8 @@ class XMLMapLoader(object):
 				strgy = fife.CELL_EDGES_AND_DIAGONALS
 
 			layer_obj.setPathingStrategy(strgy)
+			if spatial_index == "grid":
+				layer_obj.setSpatialIndexStrategy(fife.SPATIAL_GRID)
 			layer_obj.setLayerTransparency(transparency)
 
 			if layer_type:
@@ -154,6 +154,11 @@ class XMLMapSaver(object):
 			return "freeform"
 		return "cell_edges_only"
 
+	def spatial_index_to_str(self, val):
+		if val == fife.SPATIAL_GRID:
+			return "grid"
+		return "quadtree"
+
 	def layer_type_to_str(self, layer):
 		if layer.isWalkable(): return "walkable"
 		elif layer.isInteract(): return "interact"
@@ -172,6 +177,7 @@ class XMLMapSaver(object):
 				(None, 'y_offset'): str(cellgrid.getYShift()),
 				(None, 'z_offset'): str(cellgrid.getZShift()),
 				(None, 'pathing'): self.pathing_val_to_str(layer.getPathingStrategy()),
+				(None, 'spatial_index'): self.spatial_index_to_str(layer.getSpatialIndexStrategy()),
 				(None, 'transparency'): str(layer.getLayerTransparency()),
 				(None, 'layer_type'): str(self.layer_type_to_str(layer)),
 				(None, 'layer_type_id'): str(layer.getWalkableId()),
@@ -185,6 +191,7 @@ class XMLMapSaver(object):
 				(None, 'y_offset'): 'y_offset',
 				(None, 'z_offset'): 'z_offset',
 				(None, 'pathing'): 'pathing',
+				(None, 'spatial_index'): 'spatial_index',
 				(None, 'layer_type'): 'layer_type',
 				(None, 'layer_type_id'): 'layer_type_id',
 			}
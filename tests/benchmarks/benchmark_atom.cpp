@@ -0,0 +1,124 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/atom.h"
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/location.h"
+#include "pathfinder/route.h"
+#include "pathfinder/routepather/singlelayersearch.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+static const uint32_t BENCHMARK_LOOKUPS = 1000000;
+static const int32_t BENCHMARK_SIDE = 100;
+static const uint32_t BENCHMARK_SEARCHES = 200;
+
+static void benchmark_atom_lookups() {
+	WalkableMapEnvironment env;
+	Object* object = env.object.get();
+	const char* names[] = { "stand", "walk", "run", "attack", "die", "talk", "use", "pick" };
+	std::vector<std::string> ids;
+	for (uint32_t i = 0; i < 8; ++i) {
+		object->createAction(names[i]);
+		ids.push_back(names[i]);
+	}
+	std::vector<Atom> atoms(ids.begin(), ids.end());
+
+	uint32_t found = 0;
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+		found += object->getAction(ids[i & 7]) != NULL;
+	}
+	std::chrono::duration<double, std::milli> strings = std::chrono::high_resolution_clock::now() - begin;
+	begin = std::chrono::high_resolution_clock::now();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+		found += object->getAction(atoms[i & 7]) != NULL;
+	}
+	std::chrono::duration<double, std::milli> interned = std::chrono::high_resolution_clock::now() - begin;
+	std::cout << BENCHMARK_LOOKUPS << " action lookups by string: " << std::fixed << std::setprecision(3)
+		<< strings.count() << " ms, by atom: " << interned.count() << " ms (" << found << ")" << std::endl;
+
+	// area limited searches check the areas of every expanded neighbor
+	object->addWalkableArea("meadow");
+	env.squareGrid->setAllowDiagonals(true);
+	Layer* layer = env.createWalkableLayer("layer", env.squareGrid.get(), BENCHMARK_SIDE);
+	env.createCellCaches();
+	CellCache* cache = layer->getCellCache();
+	cache->registerCost("road", 0.5);
+	for (int32_t x = 0; x < BENCHMARK_SIDE; ++x) {
+		for (int32_t y = 0; y < BENCHMARK_SIDE; ++y) {
+			Cell* cell = cache->getCell(ModelCoordinate(x, y));
+			cache->addCellToArea((x + y) % 3 ? "meadow" : "forest", cell);
+			if (x % 5 == 0) {
+				cache->addCellToCost("road", cell);
+			}
+		}
+	}
+
+	Location start(layer);
+	Location end(layer);
+	uint64_t expansions = 0;
+	std::chrono::duration<double, std::milli> duration(0);
+	for (uint32_t s = 0; s < BENCHMARK_SEARCHES; ++s) {
+		start.setLayerCoordinates(ModelCoordinate(s % 7, (s * 3) % 11));
+		end.setLayerCoordinates(ModelCoordinate(BENCHMARK_SIDE - 1 - s % 13, BENCHMARK_SIDE - 2 - s % 5));
+		Route route(start, end);
+		route.setObject(object);
+		route.setCostId("road");
+		SingleLayerSearch search(&route, s);
+		begin = std::chrono::high_resolution_clock::now();
+		while (search.getSearchStatus() == RoutePatherSearch::search_status_incomplete) {
+			search.updateSearch();
+			++expansions;
+		}
+		duration += std::chrono::high_resolution_clock::now() - begin;
+	}
+	std::cout << "Area limited searches with a special cost: " << expansions / BENCHMARK_SEARCHES << " nodes per search, "
+		<< std::fixed << std::setprecision(3) << duration.count() / BENCHMARK_SEARCHES << " ms per search" << std::endl;
+}
+
+int main() {
+	benchmark_atom_lookups();
+	return 0;
+}
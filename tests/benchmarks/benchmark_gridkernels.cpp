@@ -0,0 +1,114 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/location.h"
+#include "pathfinder/route.h"
+#include "pathfinder/routepather/singlelayersearch.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+static const int32_t BENCHMARK_SIDE = 200;
+static const uint32_t BENCHMARK_SEARCHES = 500;
+
+static void benchmark_search() {
+	WalkableMapEnvironment env;
+	boost::shared_ptr<Object> blocker(new Object("blocker", "test"));
+	blocker->setBlocking(true);
+	env.squareGrid->setAllowDiagonals(true);
+	srand(5);
+	Layer* layers[] = {
+		env.createWalkableLayer("square", env.squareGrid.get(), BENCHMARK_SIDE),
+		env.createWalkableLayer("hex", env.hexGrid.get(), BENCHMARK_SIDE)
+	};
+	const char* names[] = { "square", "hex" };
+
+	for (uint32_t l = 0; l < 2; ++l) {
+		std::vector<InstanceCreationInfo> infos;
+		for (int32_t i = 0; i < BENCHMARK_SIDE * BENCHMARK_SIDE / 10; ++i) {
+			int32_t x = 1 + rand() % (BENCHMARK_SIDE - 2);
+			int32_t y = 1 + rand() % (BENCHMARK_SIDE - 2);
+			infos.push_back(InstanceCreationInfo(blocker.get(), ExactModelCoordinate(x, y)));
+		}
+		layers[l]->createInstances(infos);
+	}
+	std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+	env.createCellCaches();
+	std::chrono::duration<double, std::milli> creation = std::chrono::high_resolution_clock::now() - begin;
+	std::cout << "Cell cache creation for two " << BENCHMARK_SIDE << "x" << BENCHMARK_SIDE << " layers: "
+		<< std::fixed << std::setprecision(3) << creation.count() << " ms" << std::endl;
+
+	std::cout << "A* searches across a " << BENCHMARK_SIDE << "x" << BENCHMARK_SIDE << " layer with 10% blockers" << std::endl;
+	for (uint32_t l = 0; l < 2; ++l) {
+		Location start(layers[l]);
+		Location end(layers[l]);
+		uint64_t expansions = 0;
+		uint32_t found = 0;
+		std::chrono::duration<double, std::milli> duration(0);
+		srand(7);
+		for (uint32_t s = 0; s < BENCHMARK_SEARCHES; ++s) {
+			start.setLayerCoordinates(ModelCoordinate(rand() % BENCHMARK_SIDE, rand() % BENCHMARK_SIDE));
+			end.setLayerCoordinates(ModelCoordinate(rand() % BENCHMARK_SIDE, rand() % BENCHMARK_SIDE));
+			Route route(start, end);
+			SingleLayerSearch search(&route, s);
+			begin = std::chrono::high_resolution_clock::now();
+			while (search.getSearchStatus() == RoutePatherSearch::search_status_incomplete) {
+				search.updateSearch();
+				++expansions;
+			}
+			duration += std::chrono::high_resolution_clock::now() - begin;
+			if (search.getSearchStatus() == RoutePatherSearch::search_status_complete) {
+				++found;
+			}
+		}
+		std::cout << std::setw(7) << names[l] << ": " << found << " of " << BENCHMARK_SEARCHES << " found, "
+			<< expansions / BENCHMARK_SEARCHES << " nodes per search, "
+			<< std::fixed << std::setprecision(3) << duration.count() / BENCHMARK_SEARCHES << " ms per search, "
+			<< std::setprecision(0) << expansions / duration.count() * 1000.0 << " nodes/s" << std::endl;
+	}
+}
+
+int main() {
+	benchmark_search();
+	return 0;
+}
@@ -0,0 +1,123 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+// counts every allocation that reaches the global heap
+static uint64_t s_allocations = 0;
+
+void* operator new(std::size_t size) {
+	++s_allocations;
+	void* ptr = std::malloc(size ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+static const uint32_t STRESS_ROUNDS = 20;
+
+// the pool fixture with the stress steps
+struct environment : public InstancePoolEnvironment {
+	// creates count instances with a running action, updates them and removes them again
+	void spawn(uint32_t count) {
+		std::vector<Instance*> instances;
+		for (uint32_t i = 0; i < count; ++i) {
+			Instance* instance = layer->createInstance(object.get(), ModelCoordinate(i % 100, i / 100), "");
+			instance->actRepeat("fly");
+			instances.push_back(instance);
+		}
+		layer->update();
+		for (uint32_t i = 0; i < count; ++i) {
+			layer->deleteInstance(instances[i]);
+		}
+		layer->update();
+	}
+
+	// switches the instances between idle and active
+	void flip(const std::vector<Instance*>& instances) {
+		for (uint32_t i = 0; i < instances.size(); ++i) {
+			instances[i]->setRotation(instances[i]->getRotation() + 90);
+		}
+		// first update reports the change, second one finds the instances idle
+		layer->update();
+		layer->update();
+	}
+};
+
+static void benchmark_allocations() {
+	environment env;
+	std::vector<Instance*> instances;
+	for (uint32_t i = 0; i < 10000; ++i) {
+		instances.push_back(env.layer->createInstance(env.object.get(), ModelCoordinate(i % 100, i / 100), ""));
+	}
+	// warm up the pools
+	env.spawn(1000);
+	env.flip(instances);
+
+	uint64_t start = s_allocations;
+	for (uint32_t i = 0; i < STRESS_ROUNDS; ++i) {
+		env.spawn(1000);
+	}
+	uint64_t spawn = s_allocations - start;
+
+	start = s_allocations;
+	for (uint32_t i = 0; i < STRESS_ROUNDS; ++i) {
+		env.flip(instances);
+	}
+	uint64_t flip = s_allocations - start;
+
+	std::cout << "heap allocations per round" << std::endl;
+	std::cout << "  spawn and remove 1000 instances:  " << std::setw(8) << spawn / STRESS_ROUNDS << std::endl;
+	std::cout << "  idle/active flip of 10000 instances: " << std::setw(8) << flip / STRESS_ROUNDS << std::endl;
+}
+
+int main() {
+	benchmark_allocations();
+	return 0;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/instancetree.h"
+#include "model/structures/location.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+static const uint32_t BENCHMARK_ROUNDS = 5;
+
+static void benchmark_spatial_index() {
+	const uint32_t counts[] = { 10000, 100000 };
+	const SpatialIndexStrategy strategies[] = { SPATIAL_QUADTREE, SPATIAL_GRID };
+	const char* names[] = { "quadtree", "grid" };
+
+	std::cout << "InstanceTree, average over " << BENCHMARK_ROUNDS << " rounds" << std::endl;
+	for (uint32_t c = 0; c < 2; ++c) {
+		for (uint32_t s = 0; s < 2; ++s) {
+			srand(7);
+			InstanceTreeEnvironment env(strategies[s]);
+			env.createInstances(counts[c]);
+
+			// every instance moves one cell per round, like walking agents do
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (uint32_t r = 0; r < BENCHMARK_ROUNDS; ++r) {
+				for (uint32_t i = 0; i < env.instances.size(); ++i) {
+					ModelCoordinate mc = env.instances[i]->getLocationRef().getLayerCoordinates();
+					mc.x += (r % 2 == 0) ? 1 : -1;
+					env.moveInstance(env.instances[i], mc);
+				}
+			}
+			std::chrono::duration<double, std::milli> move = std::chrono::high_resolution_clock::now() - start;
+
+			// single cell queries, like the cellcache and the pather do
+			uint32_t found = 0;
+			start = std::chrono::high_resolution_clock::now();
+			for (uint32_t r = 0; r < BENCHMARK_ROUNDS; ++r) {
+				for (uint32_t i = 0; i < env.instances.size(); ++i) {
+					found += env.query(env.layer, env.randomCoordinate(), 0, 0).size();
+				}
+			}
+			std::chrono::duration<double, std::milli> cell = std::chrono::high_resolution_clock::now() - start;
+
+			// view sized queries
+			start = std::chrono::high_resolution_clock::now();
+			for (uint32_t r = 0; r < BENCHMARK_ROUNDS; ++r) {
+				for (uint32_t i = 0; i < 100; ++i) {
+					found += env.query(env.layer, env.randomCoordinate(), 40, 30).size();
+				}
+			}
+			std::chrono::duration<double, std::milli> view = std::chrono::high_resolution_clock::now() - start;
+
+			std::cout << std::setw(7) << counts[c] << " instances, " << std::setw(8) << names[s] << ": "
+				<< std::setw(9) << std::fixed << std::setprecision(2) << move.count() / BENCHMARK_ROUNDS << " ms move all, "
+				<< std::setw(9) << cell.count() / BENCHMARK_ROUNDS << " ms cell queries, "
+				<< std::setw(9) << view.count() / BENCHMARK_ROUNDS << " ms 100 view queries"
+				<< " (" << found << ")" << std::endl;
+		}
+	}
+}
+
+int main() {
+	benchmark_spatial_index();
+	return 0;
+}
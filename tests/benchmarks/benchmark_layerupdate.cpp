@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+static const uint32_t BENCHMARK_ROUNDS = 50;
+
+static void benchmark_create_instances() {
+	const uint32_t counts[] = { 1000, 10000, 100000 };
+
+	std::cout << "Instance creation on a walkable layer with a cell cache" << std::endl;
+	for (uint32_t c = 0; c < 3; ++c) {
+		std::vector<InstanceCreationInfo> infos;
+		uint32_t side = 1;
+		while (side * side < counts[c]) {
+			++side;
+		}
+		for (uint32_t i = 0; i < counts[c]; ++i) {
+			std::ostringstream id;
+			id << i;
+			infos.push_back(InstanceCreationInfo(NULL, ExactModelCoordinate(i % side, i / side), id.str()));
+		}
+
+		double single = 0;
+		double batch = 0;
+		for (uint32_t mode = 0; mode < 2; ++mode) {
+			LayerUpdateEnvironment env;
+			env.createCellCache();
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			if (mode == 0) {
+				for (uint32_t i = 0; i < infos.size(); ++i) {
+					env.layer->createInstance(env.object.get(), infos[i].coordinate, infos[i].id);
+				}
+			} else {
+				for (uint32_t i = 0; i < infos.size(); ++i) {
+					infos[i].object = env.object.get();
+				}
+				env.layer->createInstances(infos);
+			}
+			std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - start;
+			(mode == 0 ? single : batch) = duration.count();
+		}
+		std::cout << std::setw(7) << counts[c] << " instances: "
+			<< std::setw(10) << std::fixed << std::setprecision(1) << single << " ms createInstance, "
+			<< std::setw(10) << batch << " ms createInstances" << std::endl;
+	}
+}
+
+static void benchmark_layer_update() {
+	const uint32_t counts[] = { 1000, 10000, 100000 };
+	// every n-th instance is active
+	const uint32_t steps[] = { 100, 10, 2, 1 };
+
+	std::cout << "Layer::update, average over " << BENCHMARK_ROUNDS << " rounds" << std::endl;
+	for (uint32_t c = 0; c < 3; ++c) {
+		for (uint32_t s = 0; s < 4; ++s) {
+			LayerUpdateEnvironment env;
+			env.createInstances(counts[c]);
+			env.activate(steps[s]);
+			// first round records the say text change
+			env.layer->update();
+
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < BENCHMARK_ROUNDS; ++i) {
+				env.layer->update();
+			}
+			std::chrono::duration<double, std::micro> steady = std::chrono::high_resolution_clock::now() - start;
+
+			// activity flips: deactivate and activate all again
+			start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < BENCHMARK_ROUNDS; ++i) {
+				env.deactivate(steps[s]);
+				env.layer->update();
+				env.activate(steps[s]);
+				env.layer->update();
+			}
+			std::chrono::duration<double, std::micro> flip = std::chrono::high_resolution_clock::now() - start;
+
+			std::cout << std::setw(7) << counts[c] << " instances, "
+				<< std::setw(3) << 100 / steps[s] << "% active: "
+				<< std::setw(10) << std::fixed << std::setprecision(1) << steady.count() / BENCHMARK_ROUNDS << " us steady, "
+				<< std::setw(10) << flip.count() / BENCHMARK_ROUNDS << " us flip" << std::endl;
+		}
+	}
+}
+
+static void benchmark_offscreen_update() {
+	const uint32_t counts[] = { 1000, 10000, 100000 };
+	// frame time and update intervals of off-screen instances in milliseconds
+	const uint32_t frame = 16;
+	const uint32_t intervals[] = { 0, 100, 1000 };
+
+	std::cout << "Layer::update of off-screen instances, average over " << BENCHMARK_ROUNDS << " rounds" << std::endl;
+	for (uint32_t c = 0; c < 3; ++c) {
+		std::cout << std::setw(7) << counts[c] << " instances:";
+		for (uint32_t n = 0; n < 3; ++n) {
+			LayerUpdateEnvironment env;
+			env.createInstances(counts[c]);
+			env.object->createAction("idle")->setDuration(500);
+			for (uint32_t i = 0; i < env.instances.size(); ++i) {
+				env.instances[i]->actRepeat("idle");
+			}
+			env.layer->setOffscreenUpdateInterval(intervals[n]);
+			env.layer->update();
+
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			for (uint32_t i = 0; i < BENCHMARK_ROUNDS; ++i) {
+				env.timemanager->step(frame);
+				env.layer->update();
+			}
+			std::chrono::duration<double, std::micro> duration = std::chrono::high_resolution_clock::now() - start;
+			std::cout << std::setw(10) << std::fixed << std::setprecision(1)
+				<< duration.count() / BENCHMARK_ROUNDS << " us (" << intervals[n] << " ms)";
+		}
+		std::cout << std::endl;
+	}
+}
+
+int main() {
+	benchmark_create_instances();
+	benchmark_layer_update();
+	benchmark_offscreen_update();
+	return 0;
+}
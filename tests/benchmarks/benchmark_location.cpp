@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/location.h"
+#include "pathfinder/routepather/routepather.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+static const uint32_t BENCHMARK_FRAMES = 200;
+static const uint32_t BENCHMARK_LOOKUPS = 1000000;
+
+static void benchmark_location_getters() {
+	LocationEnvironment env;
+	Layer* layers[] = { env.squareLayer, env.hexLayer };
+	const char* names[] = { "square", "hex" };
+
+	std::cout << "Location getters, " << BENCHMARK_LOOKUPS << " calls" << std::endl;
+	for (uint32_t l = 0; l < 2; ++l) {
+		Location loc(layers[l]);
+		loc.setExactLayerCoordinates(ExactModelCoordinate(12.3, 45.6));
+		int32_t sum = 0;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+			sum += loc.getLayerCoordinates().x;
+		}
+		std::chrono::duration<double, std::milli> layerCoords = std::chrono::high_resolution_clock::now() - start;
+		double mapSum = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; ++i) {
+			mapSum += loc.getMapCoordinates().x;
+		}
+		std::chrono::duration<double, std::milli> mapCoords = std::chrono::high_resolution_clock::now() - start;
+		std::cout << std::setw(7) << names[l] << ": "
+			<< std::setw(8) << std::fixed << std::setprecision(2) << layerCoords.count() << " ms getLayerCoordinates, "
+			<< std::setw(8) << mapCoords.count() << " ms getMapCoordinates"
+			<< " (" << sum << ", " << mapSum << ")" << std::endl;
+	}
+}
+
+static void benchmark_movement() {
+	const uint32_t counts[] = { 100, 1000 };
+	const int32_t side = 300;
+
+	std::cout << "Walking instances on a " << side << "x" << side << " walkable layer, "
+		<< BENCHMARK_FRAMES << " frames" << std::endl;
+	for (uint32_t c = 0; c < 2; ++c) {
+		srand(3);
+		LocationEnvironment env;
+		std::vector<InstanceCreationInfo> infos;
+		// the corners make sure that the cell cache covers the whole area
+		infos.push_back(InstanceCreationInfo(env.object.get(), ExactModelCoordinate(0, 0)));
+		infos.push_back(InstanceCreationInfo(env.object.get(), ExactModelCoordinate(side - 1, side - 1)));
+		for (uint32_t i = 0; i < counts[c]; ++i) {
+			infos.push_back(InstanceCreationInfo(env.object.get(), ExactModelCoordinate(rand() % side, rand() % side)));
+		}
+		env.squareLayer->setWalkable(true);
+		std::vector<Instance*> instances = env.squareLayer->createInstances(infos);
+		env.map->initializeCellCaches();
+		env.map->finalizeCellCaches();
+
+		std::vector<ModelCoordinate> starts;
+		for (uint32_t i = 0; i < instances.size(); ++i) {
+			starts.push_back(instances[i]->getLocationRef().getLayerCoordinates());
+		}
+		Location target(env.squareLayer);
+		for (uint32_t i = 2; i < instances.size(); ++i) {
+			target.setLayerCoordinates(ModelCoordinate(rand() % side, rand() % side));
+			instances[i]->move("walk", target, 5.0);
+		}
+
+		// search all routes first, only the walking is measured
+		int32_t maxTicks = env.pather->getMaxTicks();
+		env.pather->setMaxTicks(100000000);
+		env.map->update();
+		env.pather->update();
+		env.pather->setMaxTicks(maxTicks);
+
+		// the game time comes from the system clock, so the frames have to take some time
+		std::chrono::duration<double, std::milli> duration(0);
+		for (uint32_t f = 0; f < BENCHMARK_FRAMES; ++f) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			env.timemanager->update();
+			env.pather->update();
+			env.map->update();
+			duration += std::chrono::high_resolution_clock::now() - start;
+		}
+		uint32_t moved = 0;
+		for (uint32_t i = 0; i < instances.size(); ++i) {
+			if (starts[i] != instances[i]->getLocationRef().getLayerCoordinates()) {
+				++moved;
+			}
+		}
+		std::cout << std::setw(7) << counts[c] << " instances: "
+			<< std::setw(8) << std::fixed << std::setprecision(3) << duration.count() / BENCHMARK_FRAMES << " ms per frame, "
+			<< moved << " moved" << std::endl;
+	}
+}
+
+static void benchmark_batch_transforms() {
+	SquareGrid square;
+	HexGrid hex;
+	CellGrid* grids[] = { &square, &hex };
+	const char* names[] = { "square", "hex" };
+	const uint32_t count = 10000;
+	const uint32_t rounds = 100;
+
+	DoublePoint3DArray points;
+	for (uint32_t i = 0; i < count; ++i) {
+		points.push_back(DoublePoint3D((rand() % 2000) / 7.0, (rand() % 2000) / 3.0, 0.0));
+	}
+
+	std::cout << "Batch transforms, " << rounds << " x " << count << " points, "
+		<< (isAVX2TransformSupported() ? "AVX2" : "SSE2 or scalar") << std::endl;
+	for (uint32_t g = 0; g < 2; ++g) {
+		CellGrid* grid = grids[g];
+		grid->setRotation(45);
+		double sum = 0;
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (uint32_t r = 0; r < rounds; ++r) {
+			for (uint32_t i = 0; i < count; ++i) {
+				sum += grid->toMapCoordinates(points.get(i)).x;
+			}
+		}
+		std::chrono::duration<double, std::milli> scalar = std::chrono::high_resolution_clock::now() - start;
+
+		DoublePoint3DArray result;
+		start = std::chrono::high_resolution_clock::now();
+		for (uint32_t r = 0; r < rounds; ++r) {
+			grid->toMapCoordinatesBatch(points, result);
+			sum += result.x[r];
+		}
+		std::chrono::duration<double, std::milli> batch = std::chrono::high_resolution_clock::now() - start;
+		std::cout << std::setw(8) << names[g] << ": scalar " << std::fixed << std::setprecision(2) << scalar.count()
+			<< " ms toMapCoordinates, " << batch.count() << " ms toMapCoordinatesBatch (" << sum << ")" << std::endl;
+	}
+}
+
+int main() {
+	benchmark_location_getters();
+	benchmark_movement();
+	benchmark_batch_transforms();
+	return 0;
+}
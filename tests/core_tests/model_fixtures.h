@@ -0,0 +1,237 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+#ifndef FIFE_MODEL_FIXTURES_H
+#define FIFE_MODEL_FIXTURES_H
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/instancetree.h"
+#include "model/structures/location.h"
+#include "pathfinder/routepather/routepather.h"
+
+// Fixtures shared by the core tests and the benchmarks
+namespace FIFE {
+
+	/** A square layer with instances that can be switched between idle and active.
+	 */
+	struct LayerUpdateEnvironment {
+		boost::shared_ptr<TimeManager> timemanager;
+		boost::shared_ptr<Object> object;
+		boost::shared_ptr<SquareGrid> grid;
+		boost::shared_ptr<Map> map;
+		Layer* layer;
+		std::vector<Instance*> instances;
+
+		LayerUpdateEnvironment()
+			: timemanager(new TimeManager()),
+			object(new Object("object", "test")),
+			grid(new SquareGrid()),
+			map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)),
+			layer(map->createLayer("layer", grid.get())) {
+		}
+
+		void createInstances(uint32_t count) {
+			uint32_t side = 1;
+			while (side * side < count) {
+				++side;
+			}
+			for (uint32_t i = 0; i < count; ++i) {
+				std::ostringstream id;
+				id << i;
+				ModelCoordinate mc(i % side, i / side);
+				instances.push_back(layer->createInstance(object.get(), mc, id.str()));
+			}
+		}
+
+		// a permanent say text keeps the instance active without changing it
+		void activate(uint32_t step) {
+			for (uint32_t i = 0; i < instances.size(); i += step) {
+				instances[i]->say("active", 0);
+			}
+		}
+
+		void createCellCache() {
+			layer->setWalkable(true);
+			map->initializeCellCaches();
+			map->finalizeCellCaches();
+		}
+
+		void deactivate(uint32_t step) {
+			for (uint32_t i = 0; i < instances.size(); i += step) {
+				instances[i]->say("");
+			}
+		}
+	};
+
+	/** A square layer with an object that has an action, used to spawn and remove instances.
+	 */
+	struct InstancePoolEnvironment {
+		boost::shared_ptr<TimeManager> timemanager;
+		boost::shared_ptr<Object> object;
+		boost::shared_ptr<SquareGrid> grid;
+		boost::shared_ptr<Map> map;
+		Layer* layer;
+
+		InstancePoolEnvironment()
+			: timemanager(new TimeManager()),
+			object(new Object("projectile", "test")),
+			grid(new SquareGrid()),
+			map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)),
+			layer(map->createLayer("layer", grid.get())) {
+			object->createAction("fly");
+		}
+	};
+
+	/** A square layer with randomly placed instances and a selectable spatial index.
+	 */
+	struct InstanceTreeEnvironment {
+		boost::shared_ptr<TimeManager> timemanager;
+		boost::shared_ptr<Object> object;
+		boost::shared_ptr<SquareGrid> grid;
+		boost::shared_ptr<Map> map;
+		Layer* layer;
+		std::vector<Instance*> instances;
+		int32_t side;
+
+		InstanceTreeEnvironment(SpatialIndexStrategy strategy = SPATIAL_QUADTREE)
+			: timemanager(new TimeManager()),
+			object(new Object("object", "test")),
+			grid(new SquareGrid()),
+			map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)),
+			layer(map->createLayer("layer", grid.get())),
+			side(1) {
+			layer->setSpatialIndexStrategy(strategy);
+		}
+
+		// instances are spread randomly over a square, centered around the origin
+		void createInstances(uint32_t count) {
+			while (static_cast<uint32_t>(side * side) < count) {
+				++side;
+			}
+			for (uint32_t i = 0; i < count; ++i) {
+				std::ostringstream id;
+				id << i;
+				instances.push_back(layer->createInstance(object.get(), randomCoordinate(), id.str()));
+			}
+		}
+
+		ModelCoordinate randomCoordinate() const {
+			return ModelCoordinate(rand() % side - side / 2, rand() % side - side / 2);
+		}
+
+		void moveInstance(Instance* instance, const ModelCoordinate& mc) {
+			Location loc(instance->getLocationRef());
+			loc.setLayerCoordinates(mc);
+			instance->setLocation(loc);
+		}
+
+		// the instances inside the given area of the layer, sorted so results can be compared
+		static std::vector<Instance*> query(Layer* layer, const ModelCoordinate& mc, int32_t w, int32_t h) {
+			InstanceTree::InstanceList list;
+			layer->getInstanceTree()->findInstances(mc, w, h, list);
+			std::vector<Instance*> result(list.begin(), list.end());
+			std::sort(result.begin(), result.end());
+			return result;
+		}
+	};
+
+	/** A square and a hex layer on one map, with a walking object that uses the route pather.
+	 */
+	struct LocationEnvironment {
+		boost::shared_ptr<TimeManager> timemanager;
+		boost::shared_ptr<RoutePather> pather;
+		boost::shared_ptr<Object> object;
+		boost::shared_ptr<SquareGrid> squareGrid;
+		boost::shared_ptr<HexGrid> hexGrid;
+		boost::shared_ptr<Map> map;
+		Layer* squareLayer;
+		Layer* hexLayer;
+
+		LocationEnvironment()
+			: timemanager(new TimeManager()),
+			pather(new RoutePather()),
+			object(new Object("object", "test")),
+			squareGrid(new SquareGrid()),
+			hexGrid(new HexGrid()),
+			map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)),
+			squareLayer(map->createLayer("square", squareGrid.get())),
+			hexLayer(map->createLayer("hex", hexGrid.get())) {
+			object->setPather(pather.get());
+			object->createAction("walk");
+		}
+	};
+
+	/** A map with a square and a hex grid to create walkable layers with cell caches on.
+	 */
+	struct WalkableMapEnvironment {
+		boost::shared_ptr<TimeManager> timemanager;
+		boost::shared_ptr<Object> object;
+		boost::shared_ptr<SquareGrid> squareGrid;
+		boost::shared_ptr<HexGrid> hexGrid;
+		boost::shared_ptr<Map> map;
+
+		WalkableMapEnvironment()
+			: timemanager(new TimeManager()),
+			object(new Object("object", "test")),
+			squareGrid(new SquareGrid()),
+			hexGrid(new HexGrid()),
+			map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)) {
+		}
+
+		// instances in the corners make sure that the cell cache covers side x side cells
+		Layer* createWalkableLayer(const std::string& name, CellGrid* grid, int32_t side) {
+			Layer* layer = map->createLayer(name, grid);
+			layer->createInstance(object.get(), ModelCoordinate(0, 0));
+			layer->createInstance(object.get(), ModelCoordinate(side - 1, side - 1));
+			layer->setWalkable(true);
+			return layer;
+		}
+
+		void createCellCaches() {
+			map->initializeCellCaches();
+			map->finalizeCellCaches();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <string>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/atom.h"
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+TEST(test_atom_interning) {
+	Atom empty;
+	CHECK(empty.empty());
+	CHECK(empty == Atom(""));
+	CHECK(empty == Atom(std::string()));
+
+	Atom walk("atom_test_walk");
+	std::string text("atom_test_");
+	text += "walk";
+	CHECK(walk == Atom(text));
+	CHECK(&walk.str() == &Atom(text).str());
+	CHECK_EQUAL(walk.hash(), Atom(text).hash());
+	CHECK(walk != Atom("atom_test_run"));
+	CHECK_EQUAL(std::string("atom_test_walk"), walk.str());
+
+	Atom found;
+	CHECK(Atom::find("atom_test_walk", found));
+	CHECK(found == walk);
+	size_t count = Atom::getInternedCount();
+	CHECK(!Atom::find("atom_test_unknown", found));
+	CHECK_EQUAL(count, Atom::getInternedCount());
+	CHECK(found == walk);
+}
+
+TEST(test_atom_actions) {
+	boost::shared_ptr<Object> object(new Object("object", "test"));
+	Action* walk = object->createAction("walk");
+	Action* run = object->createAction(Atom("run"), true);
+	object->createAction("attack");
+	CHECK_EQUAL(std::string("walk"), walk->getId());
+	CHECK(object->getAction("walk") == walk);
+	CHECK(object->getAction(std::string("run")) == run);
+	CHECK(object->getAction(Atom("run")) == run);
+	CHECK(object->getAction("fly") == NULL);
+	CHECK(object->getDefaultAction() == run);
+	object->setDefaultAction("walk");
+	CHECK(object->getDefaultAction() == walk);
+
+	bool clash = false;
+	try {
+		object->createAction("walk");
+	} catch (const NameClash&) {
+		clash = true;
+	}
+	CHECK(clash);
+
+	// ids are reported in alphabetical order
+	std::list<std::string> ids = object->getActionIds();
+	CHECK_EQUAL(3u, ids.size());
+	CHECK_EQUAL(std::string("attack"), ids.front());
+	CHECK_EQUAL(std::string("walk"), ids.back());
+
+	// inherited actions are found by the atom too
+	boost::shared_ptr<Object> child(new Object("child", "test", object.get()));
+	CHECK(child->getAction(Atom("walk")) == walk);
+	CHECK(child->getAction("walk", false) == NULL);
+}
+
+TEST_FIXTURE(WalkableMapEnvironment, test_atom_cellcache) {
+	Layer* layer = createWalkableLayer("layer", squareGrid.get(), 5);
+	createCellCaches();
+
+	CellCache* cache = layer->getCellCache();
+	Cell* cell = cache->getCell(ModelCoordinate(1, 1));
+	CHECK(cell != NULL);
+	cache->addCellToArea("water", cell);
+	cache->addCellToArea(Atom("forest"), cell);
+	CHECK(cache->isCellInArea("water", cell));
+	CHECK(cache->isCellInArea(std::string("forest"), cell));
+	CHECK(!cache->isCellInArea("desert", cell));
+	CHECK(cache->existsArea("forest"));
+
+	// area ids are reported in alphabetical order
+	std::vector<std::string> areas = cache->getAreas();
+	CHECK_EQUAL(2u, areas.size());
+	CHECK_EQUAL(std::string("forest"), areas[0]);
+	CHECK_EQUAL(std::string("water"), areas[1]);
+	CHECK(areas == cache->getCellAreas(cell));
+
+	cache->registerCost("road", 0.5);
+	cache->addCellToCost("road", cell);
+	CHECK(cache->existsCostForCell(Atom("road"), cell));
+	CHECK_EQUAL(0.5, cache->getAdjacentCostMultiplier(cell, "road"));
+	CHECK_EQUAL(1.0, cache->getAdjacentCostMultiplier(cell, "swamp"));
+	cache->removeArea("water");
+	CHECK(!cache->isCellInArea("water", cell));
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/metamodel/grids/gridkernels.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+
+using namespace FIFE;
+
+template<typename Kernel>
+static void checkKernel(const Kernel& kernel, CellGrid* grid) {
+	CHECK_EQUAL(grid->getCellSideCount(), kernel.getCellSideCount());
+	std::vector<ModelCoordinate> coordinates;
+	std::vector<ModelCoordinate> expected;
+	for (int32_t x = -3; x <= 3; ++x) {
+		for (int32_t y = -3; y <= 3; ++y) {
+			ModelCoordinate curpos(x, y);
+			for (int32_t dx = -2; dx <= 2; ++dx) {
+				for (int32_t dy = -2; dy <= 2; ++dy) {
+					ModelCoordinate target(x + dx, y + dy);
+					CHECK_EQUAL(grid->isAccessible(curpos, target), kernel.isAccessible(curpos, target));
+					CHECK_EQUAL(grid->getAdjacentCost(curpos, target), kernel.getAdjacentCost(curpos, target));
+					CHECK_EQUAL(grid->getHeuristicCost(curpos, target), kernel.getHeuristicCost(curpos, target));
+				}
+			}
+			expected.clear();
+			for (int32_t dx = -1; dx <= 1; ++dx) {
+				for (int32_t dy = -1; dy <= 1; ++dy) {
+					if (grid->isAccessible(curpos, ModelCoordinate(x + dx, y + dy))) {
+						expected.push_back(ModelCoordinate(x + dx, y + dy));
+					}
+				}
+			}
+			getAccessibleCoordinates(kernel, curpos, coordinates);
+			CHECK(expected == coordinates);
+		}
+	}
+}
+
+template<typename Kernel>
+static uint32_t countAccessible(const Kernel& kernel, const ModelCoordinate& curpos) {
+	std::vector<ModelCoordinate> coordinates;
+	getAccessibleCoordinates(kernel, curpos, coordinates);
+	return coordinates.size();
+}
+
+TEST(test_kernel_values) {
+	// the grids forward to the kernels, so they are checked against known values
+	SquareGrid square;
+	HexGrid hex;
+	HexGrid axial(true);
+	ModelCoordinate origin(0, 0);
+	ModelCoordinate odd(0, 1);
+
+	CHECK_EQUAL(5u, countAccessible(SquareGridKernel(&square), origin));
+	CHECK(!square.isAccessible(origin, ModelCoordinate(1, 1)));
+	CHECK_EQUAL(1.0, square.getAdjacentCost(origin, ModelCoordinate(0, 1)));
+	CHECK_EQUAL(1.4, square.getAdjacentCost(origin, ModelCoordinate(1, 1)));
+	CHECK_EQUAL(0.0, square.getAdjacentCost(origin, origin));
+	CHECK_EQUAL(5.0, square.getHeuristicCost(origin, ModelCoordinate(2, -3)));
+	square.setAllowDiagonals(true);
+	CHECK_EQUAL(9u, countAccessible(SquareGridKernel(&square), origin));
+	CHECK(square.isAccessible(origin, ModelCoordinate(1, 1)));
+
+	CHECK_EQUAL(7u, countAccessible(HexGridKernel(&hex), origin));
+	CHECK_EQUAL(7u, countAccessible(HexGridKernel(&hex), odd));
+	CHECK(hex.isAccessible(origin, ModelCoordinate(-1, 1)));
+	CHECK(!hex.isAccessible(origin, ModelCoordinate(1, 1)));
+	CHECK(hex.isAccessible(odd, ModelCoordinate(1, 2)));
+	CHECK(!hex.isAccessible(odd, ModelCoordinate(-1, 2)));
+	CHECK_EQUAL(1.0, hex.getAdjacentCost(origin, ModelCoordinate(-1, 1)));
+	CHECK_EQUAL(0.0, hex.getAdjacentCost(origin, origin));
+
+	CHECK_EQUAL(7u, countAccessible(HexGridKernel(&axial), origin));
+	CHECK(axial.isAccessible(origin, ModelCoordinate(1, -1)));
+	CHECK(!axial.isAccessible(origin, ModelCoordinate(1, 1)));
+	CHECK_EQUAL(3.0, axial.getHeuristicCost(origin, ModelCoordinate(1, -2)));
+}
+
+TEST(test_grid_kernels) {
+	SquareGrid square;
+	HexGrid hex;
+	HexGrid axial(true);
+	CHECK_EQUAL(GRID_KERNEL_SQUARE, getGridKernelType(&square));
+	CHECK_EQUAL(GRID_KERNEL_HEX, getGridKernelType(&hex));
+	CHECK_EQUAL(GRID_KERNEL_HEX, getGridKernelType(&axial));
+
+	checkKernel(SquareGridKernel(&square), &square);
+	square.setAllowDiagonals(true);
+	checkKernel(SquareGridKernel(&square), &square);
+	checkKernel(HexGridKernel(&hex), &hex);
+	checkKernel(HexGridKernel(&axial), &axial);
+	checkKernel(GenericGridKernel(&axial), &axial);
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <sstream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "util/structures/objectpool.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+TEST_FIXTURE(InstancePoolEnvironment, test_pool_reuse) {
+	uint32_t used = ObjectPool<Instance>::getUsedCount();
+	std::vector<Instance*> instances;
+	for (uint32_t i = 0; i < 10; ++i) {
+		instances.push_back(layer->createInstance(object.get(), ModelCoordinate(i, 0), ""));
+	}
+	CHECK_EQUAL(used + 10, ObjectPool<Instance>::getUsedCount());
+	uint32_t chunks = ObjectPool<Instance>::getChunkCount();
+
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		layer->deleteInstance(instances[i]);
+	}
+	CHECK_EQUAL(used, ObjectPool<Instance>::getUsedCount());
+
+	// the released memory is used again
+	instances.clear();
+	for (uint32_t i = 0; i < 10; ++i) {
+		instances.push_back(layer->createInstance(object.get(), ModelCoordinate(i, 0), ""));
+	}
+	CHECK_EQUAL(chunks, ObjectPool<Instance>::getChunkCount());
+}
+
+TEST_FIXTURE(InstancePoolEnvironment, test_idle_activity) {
+	Instance* instance = layer->createInstance(object.get(), ModelCoordinate(0, 0), "");
+	instance->setRotation(90);
+	CHECK(instance->isActive());
+	layer->update();
+	CHECK_EQUAL(ICHANGE_ROTATION, instance->getChangeInfo());
+	layer->update();
+	CHECK(!instance->isActive());
+
+	// a reused activity starts without old changes
+	instance->setRotation(180);
+	CHECK(instance->isActive());
+	CHECK_EQUAL(180, instance->getRotation());
+	CHECK_EQUAL(90, instance->getOldRotation());
+	layer->update();
+	CHECK_EQUAL(ICHANGE_ROTATION, instance->getChangeInfo());
+	CHECK_EQUAL(90, instance->getOldRotation());
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
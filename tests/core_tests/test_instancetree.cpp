@@ -0,0 +1,133 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/instancetree.h"
+#include "model/structures/location.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+TEST(test_strategy_switch) {
+	InstanceTreeEnvironment env;
+	env.createInstances(100);
+	CHECK_EQUAL(SPATIAL_QUADTREE, env.layer->getSpatialIndexStrategy());
+	std::vector<Instance*> all = env.query(env.layer, ModelCoordinate(-10, -10), 20, 20);
+	CHECK_EQUAL(100, all.size());
+
+	env.layer->setSpatialIndexStrategy(SPATIAL_GRID);
+	CHECK_EQUAL(SPATIAL_GRID, env.layer->getSpatialIndexStrategy());
+	CHECK(all == env.query(env.layer, ModelCoordinate(-10, -10), 20, 20));
+
+	env.layer->setSpatialIndexStrategy(SPATIAL_QUADTREE);
+	CHECK(all == env.query(env.layer, ModelCoordinate(-10, -10), 20, 20));
+}
+
+TEST(test_empty_buckets) {
+	InstanceTreeEnvironment env(SPATIAL_GRID);
+	env.createInstances(1);
+	Instance* instance = env.instances[0];
+	CHECK_EQUAL(1u, env.layer->getInstanceTree()->getBucketCount());
+
+	// a walking instance leaves no empty buckets behind
+	for (int32_t x = 0; x < 100; ++x) {
+		env.moveInstance(instance, ModelCoordinate(x, x / 2));
+	}
+	CHECK_EQUAL(1u, env.layer->getInstanceTree()->getBucketCount());
+	CHECK_EQUAL(1, env.query(env.layer, ModelCoordinate(99, 49), 0, 0).size());
+
+	env.layer->deleteInstance(instance);
+	CHECK_EQUAL(0u, env.layer->getInstanceTree()->getBucketCount());
+}
+
+TEST_FIXTURE(InstanceTreeEnvironment, test_same_results) {
+	srand(42);
+	createInstances(2000);
+	// a second layer with the grid index and instances at the same positions
+	Layer* gridLayer = map->createLayer("grid", grid.get());
+	gridLayer->setSpatialIndexStrategy(SPATIAL_GRID);
+	std::vector<Instance*> gridInstances;
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		gridInstances.push_back(gridLayer->createInstance(object.get(),
+			instances[i]->getLocationRef().getLayerCoordinates(), instances[i]->getId()));
+	}
+
+	for (uint32_t round = 0; round < 3; ++round) {
+		for (uint32_t i = 0; i < 200; ++i) {
+			ModelCoordinate mc = randomCoordinate();
+			int32_t w = rand() % 20;
+			int32_t h = rand() % 20;
+			std::vector<Instance*> a = query(layer, mc, w, h);
+			std::vector<Instance*> b = query(gridLayer, mc, w, h);
+			CHECK_EQUAL(a.size(), b.size());
+			// compare by identifier, the instances are different objects
+			std::vector<std::string> aIds;
+			std::vector<std::string> bIds;
+			for (uint32_t j = 0; j < a.size(); ++j) {
+				aIds.push_back(a[j]->getId());
+			}
+			for (uint32_t j = 0; j < b.size(); ++j) {
+				bIds.push_back(b[j]->getId());
+			}
+			std::sort(aIds.begin(), aIds.end());
+			std::sort(bIds.begin(), bIds.end());
+			CHECK(aIds == bIds);
+		}
+		// move half of the instances and check again
+		for (uint32_t i = 0; i < instances.size(); i += 2) {
+			ModelCoordinate mc = randomCoordinate();
+			moveInstance(instances[i], mc);
+			moveInstance(gridInstances[i], mc);
+		}
+	}
+
+	// removed instances must not be found anymore
+	ModelCoordinate mc = gridInstances[0]->getLocationRef().getLayerCoordinates();
+	gridLayer->deleteInstance(gridInstances[0]);
+	std::vector<Instance*> found = query(gridLayer, mc, 0, 0);
+	CHECK(std::find(found.begin(), found.end(), gridInstances[0]) == found.end());
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
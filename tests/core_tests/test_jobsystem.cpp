@@ -0,0 +1,201 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/concurrency/jobsystem.h"
+
+using namespace FIFE;
+
+TEST(test_parallel_for) {
+	JobSystem jobs(3);
+	CHECK_EQUAL(3u, jobs.getThreadCount());
+	std::vector<uint32_t> values(10000, 0);
+	jobs.parallelFor(static_cast<uint32_t>(values.size()), [&values](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++i) {
+			values[i] += i;
+		}
+	}, 16);
+	for (uint32_t i = 0; i < values.size(); ++i) {
+		CHECK_EQUAL(i, values[i]);
+	}
+}
+
+TEST(test_parallel_for_exception) {
+	JobSystem jobs(2);
+	std::atomic<uint32_t> processed(0);
+	bool thrown = false;
+	try {
+		jobs.parallelFor(1000, [&processed](uint32_t begin, uint32_t end) {
+			if (begin == 0) {
+				throw std::runtime_error("chunk failed");
+			}
+			processed += end - begin;
+		}, 10);
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+	// the other chunks still run
+	CHECK(processed.load() > 0);
+}
+
+TEST(test_dependencies) {
+	JobSystem jobs(4);
+	std::atomic<uint32_t> step(0);
+	std::atomic<bool> ordered(true);
+	// a diamond: first -> (left, right) -> last
+	JobPtr first = jobs.createJob([&step]() { step = 1; });
+	JobPtr left = jobs.createJob([&step, &ordered]() { if (step.load() < 1) ordered = false; ++step; });
+	JobPtr right = jobs.createJob([&step, &ordered]() { if (step.load() < 1) ordered = false; ++step; });
+	JobPtr last = jobs.createJob([&step, &ordered]() { if (step.load() != 3) ordered = false; });
+	jobs.addDependency(left, first);
+	jobs.addDependency(right, first);
+	jobs.addDependency(last, left);
+	jobs.addDependency(last, right);
+	// submitted in reverse order, the dependencies hold them back
+	jobs.submit(last);
+	jobs.submit(right);
+	jobs.submit(left);
+	CHECK(!last->isFinished());
+	jobs.submit(first);
+	jobs.wait(last);
+	CHECK(first->isFinished() && left->isFinished() && right->isFinished() && last->isFinished());
+	CHECK(ordered.load());
+}
+
+TEST(test_wait_rethrows) {
+	JobSystem jobs(1);
+	JobPtr job = jobs.run([]() { throw std::runtime_error("job failed"); });
+	CHECK_THROW(jobs.wait(job), std::runtime_error);
+	CHECK(job->isFinished());
+}
+
+TEST(test_nested_jobs) {
+	// jobs that wait for other jobs help running them instead of blocking a worker
+	JobSystem jobs(2);
+	std::atomic<uint32_t> count(0);
+	std::vector<JobPtr> outer;
+	for (uint32_t i = 0; i < 8; ++i) {
+		outer.push_back(jobs.run([&jobs, &count]() {
+			jobs.parallelFor(256, [&count](uint32_t begin, uint32_t end) {
+				count += end - begin;
+			}, 8);
+		}));
+	}
+	for (uint32_t i = 0; i < outer.size(); ++i) {
+		jobs.wait(outer[i]);
+	}
+	CHECK_EQUAL(8u * 256u, count.load());
+}
+
+TEST(test_completions) {
+	JobSystem jobs(2);
+	std::vector<uint32_t> order;
+	std::vector<JobPtr> list;
+	for (uint32_t i = 0; i < 4; ++i) {
+		JobPtr job = jobs.createJob([]() {});
+		jobs.setCompletion(job, [&order, i]() { order.push_back(i); });
+		jobs.submit(job);
+		list.push_back(job);
+	}
+	for (uint32_t i = 0; i < list.size(); ++i) {
+		jobs.wait(list[i]);
+	}
+	// completions only run on the thread that processes them
+	CHECK(order.empty());
+	CHECK_EQUAL(4u, jobs.processCompletions());
+	CHECK_EQUAL(4u, order.size());
+	CHECK_EQUAL(0u, jobs.processCompletions());
+}
+
+TEST(test_inline_without_threads) {
+	JobSystem jobs(0);
+	bool ran = false;
+	JobPtr job = jobs.run([&ran]() { ran = true; });
+	CHECK(ran);
+	CHECK(job->isFinished());
+	uint32_t sum = 0;
+	jobs.parallelFor(100, [&sum](uint32_t begin, uint32_t end) { sum += end - begin; });
+	CHECK_EQUAL(100u, sum);
+}
+
+TEST(test_scratch_arena) {
+	ScratchArena arena(256);
+	uint8_t* a = static_cast<uint8_t*>(arena.allocate(10, 1));
+	int64_t* b = arena.allocateArray<int64_t>(4);
+	CHECK(reinterpret_cast<uintptr_t>(b) % alignof(int64_t) == 0);
+	CHECK(reinterpret_cast<uint8_t*>(b) >= a + 10);
+	ScratchArena::Marker marker = arena.getMarker();
+	size_t used = arena.getUsed();
+	// larger than a block
+	void* big = arena.allocate(1000);
+	CHECK(big != NULL);
+	CHECK(arena.getCapacity() >= 1256u);
+	arena.rewind(marker);
+	CHECK_EQUAL(used, arena.getUsed());
+	// the memory after the marker is reused
+	CHECK(arena.allocateArray<int64_t>(4) == b + 4);
+	arena.reset();
+	CHECK_EQUAL(0u, arena.getUsed());
+	CHECK(arena.allocate(10, 1) == a);
+}
+
+TEST(test_scratch_scope) {
+	JobSystem jobs(2);
+	std::atomic<uint32_t> failures(0);
+	jobs.parallelFor(64, [&failures](uint32_t begin, uint32_t end) {
+		ScratchScope scope;
+		uint32_t* values = scope.getArena().allocateArray<uint32_t>(end - begin);
+		for (uint32_t i = begin; i < end; ++i) {
+			values[i - begin] = i;
+		}
+		for (uint32_t i = begin; i < end; ++i) {
+			if (values[i - begin] != i) {
+				++failures;
+			}
+		}
+	}, 1);
+	CHECK_EQUAL(0u, failures.load());
+	size_t used = JobSystem::getScratchArena().getUsed();
+	{
+		ScratchScope scope;
+		scope.getArena().allocate(128);
+		CHECK(JobSystem::getScratchArena().getUsed() > used);
+	}
+	CHECK_EQUAL(used, JobSystem::getScratchArena().getUsed());
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,430 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <sstream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "pathfinder/routepather/routepather.h"
+#include "util/concurrency/jobsystem.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+TEST_FIXTURE(LayerUpdateEnvironment, test_active_list) {
+	createInstances(100);
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		CHECK(!instances[i]->isActive());
+		CHECK_EQUAL(-1, instances[i]->getActiveIndex());
+	}
+
+	activate(1);
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		CHECK_EQUAL(static_cast<int32_t>(i), instances[i]->getActiveIndex());
+	}
+	layer->update();
+
+	// every second instance becomes inactive, the others keep their order
+	deactivate(2);
+	layer->update();
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		if (i % 2 == 0) {
+			CHECK(!instances[i]->isActive());
+			CHECK_EQUAL(-1, instances[i]->getActiveIndex());
+		} else {
+			CHECK(instances[i]->isActive());
+			CHECK_EQUAL(static_cast<int32_t>(i / 2), instances[i]->getActiveIndex());
+		}
+	}
+
+	// removing outside of the update swaps the last entry into the hole
+	layer->deleteInstance(instances[1]);
+	CHECK_EQUAL(0, instances[99]->getActiveIndex());
+	layer->update();
+	CHECK_EQUAL(0, instances[99]->getActiveIndex());
+}
+
+// counts the notifications of the layer
+class CountingListener : public LayerChangeListener {
+public:
+	CountingListener(): changes(0), creates(0), batches(0), logs(0), logged(0) {}
+	virtual void onLayerChanged(Layer* layer, std::vector<Instance*>& changedInstances) { ++changes; }
+	virtual void onInstanceCreate(Layer* layer, Instance* instance) { ++creates; }
+	virtual void onInstancesCreate(Layer* layer, std::vector<Instance*>& instances) {
+		++batches;
+		LayerChangeListener::onInstancesCreate(layer, instances);
+	}
+	virtual void onInstanceDelete(Layer* layer, Instance* instance) {}
+	virtual void onLayerChangeLog(Layer* layer, const std::vector<InstanceChangeRecord>& changes) {
+		++logs;
+		logged += changes.size();
+	}
+
+	uint32_t changes;
+	uint32_t creates;
+	uint32_t batches;
+	uint32_t logs;
+	uint32_t logged;
+};
+
+TEST_FIXTURE(LayerUpdateEnvironment, test_create_instances) {
+	CountingListener listener;
+	layer->addChangeListener(&listener);
+	createCellCache();
+
+	std::vector<InstanceCreationInfo> infos;
+	for (int32_t i = 0; i < 50; ++i) {
+		std::ostringstream id;
+		id << "batch" << i;
+		infos.push_back(InstanceCreationInfo(object.get(), ExactModelCoordinate(i % 10, i / 10), id.str()));
+	}
+	std::vector<Instance*> created = layer->createInstances(infos);
+	CHECK_EQUAL(50, created.size());
+	CHECK_EQUAL(50, layer->getInstances().size());
+	CHECK_EQUAL(1, listener.batches);
+	CHECK_EQUAL(50, listener.creates);
+	for (uint32_t i = 0; i < created.size(); ++i) {
+		CHECK_EQUAL(infos[i].id, created[i]->getId());
+		CHECK(created[i]->getLocationRef().getLayerCoordinates() == ModelCoordinate(i % 10, i / 10));
+		// the cell cache grew once and knows the instance
+		Cell* cell = layer->getCellCache()->getCell(created[i]->getLocationRef().getLayerCoordinates());
+		CHECK(cell != NULL);
+		if (cell) {
+			CHECK(cell->getInstances().count(created[i]) == 1);
+		}
+	}
+	CHECK(layer->createInstances(std::vector<InstanceCreationInfo>()).empty());
+	CHECK_EQUAL(1, listener.batches);
+	layer->removeChangeListener(&listener);
+}
+
+TEST_FIXTURE(LayerUpdateEnvironment, test_change_log) {
+	CountingListener listener;
+	CountingListener plain;
+	layer->addChangeListener(&listener, true);
+	layer->addChangeListener(&plain);
+	createInstances(10);
+	CHECK_EQUAL(10, listener.creates);
+	CHECK(!layer->isChangeLogEnabled());
+	activate(1);
+	layer->update();
+	CHECK(layer->getChangeLog().empty());
+	CHECK_EQUAL(0, listener.logs);
+	CHECK_EQUAL(0, listener.changes);
+	uint32_t changes = plain.changes;
+
+	layer->setChangeLogEnabled(true);
+	Location target(instances[3]->getLocation());
+	target.setLayerCoordinates(ModelCoordinate(7, 8));
+	instances[3]->setLocation(target);
+	instances[5]->setRotation(90);
+	layer->update();
+
+	// one record per changed instance, the listener gets the whole log at once
+	const std::vector<InstanceChangeRecord>& log = layer->getChangeLog();
+	CHECK_EQUAL(2, log.size());
+	CHECK_EQUAL(1, listener.logs);
+	CHECK_EQUAL(2, listener.logged);
+	// each listener gets either the log or the changed instances
+	CHECK_EQUAL(0, listener.changes);
+	CHECK_EQUAL(changes + 1, plain.changes);
+	CHECK_EQUAL(0, plain.logs);
+	CHECK(log[0].instance == instances[3]);
+	CHECK_EQUAL(instances[3]->getFifeId(), log[0].instanceId);
+	CHECK(log[0].changes & ICHANGE_CELL);
+	CHECK(log[0].oldCell == ModelCoordinate(3, 0));
+	CHECK(log[0].newCell == ModelCoordinate(7, 8));
+	CHECK(log[1].instance == instances[5]);
+	CHECK(log[1].changes & ICHANGE_ROTATION);
+	CHECK(!(log[1].changes & ICHANGE_CELL));
+	CHECK(log[1].oldCell == log[1].newCell);
+
+	// array views for scripts
+	CHECK(layer->getChangeLogInstances() == std::vector<Instance*>({ instances[3], instances[5] }));
+	CHECK_EQUAL(log[1].changes, layer->getChangeLogChanges()[1]);
+	std::vector<int32_t> oldCells = layer->getChangeLogCells(true);
+	std::vector<int32_t> newCells = layer->getChangeLogCells(false);
+	CHECK_EQUAL(6, oldCells.size());
+	CHECK_EQUAL(3, oldCells[0]);
+	CHECK_EQUAL(0, oldCells[1]);
+	CHECK_EQUAL(7, newCells[0]);
+	CHECK_EQUAL(8, newCells[1]);
+
+	// records of deleted instances are dropped
+	layer->deleteInstance(instances[3]);
+	CHECK_EQUAL(1, layer->getChangeLog().size());
+
+	layer->update();
+	CHECK(layer->getChangeLog().empty());
+	layer->setChangeLogEnabled(false);
+	layer->removeChangeListener(&plain);
+	layer->removeChangeListener(&listener);
+
+	// a removed listener is no change log listener anymore
+	layer->addChangeListener(&listener);
+	instances[5]->setRotation(180);
+	layer->update();
+	CHECK_EQUAL(1, listener.changes);
+	layer->removeChangeListener(&listener);
+}
+
+TEST_FIXTURE(LayerUpdateEnvironment, test_split_update) {
+	CountingListener listener;
+	layer->addChangeListener(&listener, true);
+	createInstances(10);
+	layer->setChangeLogEnabled(true);
+	CHECK_EQUAL(0, map->getTickCount());
+	CHECK_EQUAL(1.0, map->getInterpolation());
+
+	// a simulation tick updates the layers without touching the cameras
+	instances[2]->setRotation(90);
+	map->updateSimulation();
+	CHECK_EQUAL(1, map->getTickCount());
+	CHECK_EQUAL(1, listener.logs);
+	CHECK_EQUAL(1, listener.logged);
+
+	// drawing between the ticks doesn't advance the simulation
+	map->updateCameras(0.25);
+	map->updateCameras(0.5);
+	CHECK_EQUAL(1, map->getTickCount());
+	CHECK_EQUAL(0.5, map->getInterpolation());
+	CHECK_EQUAL(1, listener.logs);
+
+	// a full update is a tick followed by a camera update without interpolation
+	map->update();
+	CHECK_EQUAL(2, map->getTickCount());
+	CHECK_EQUAL(1.0, map->getInterpolation());
+	layer->setChangeLogEnabled(false);
+	layer->removeChangeListener(&listener);
+}
+
+TEST_FIXTURE(LayerUpdateEnvironment, test_offscreen_updates) {
+	createInstances(4);
+	object->createAction("wave")->setDuration(300);
+	object->createAction("idle")->setDuration(100);
+	layer->setOffscreenUpdateInterval(1000);
+	instances[0]->say("bye", 500);
+	instances[1]->actRepeat("idle");
+	instances[2]->actOnce("wave");
+	instances[3]->say("active", 0);
+	layer->update();
+
+	// without a camera all instances are off-screen, the ends limit the delay
+	CHECK_EQUAL(499, instances[0]->getUpdateDelay(1000));
+	CHECK_EQUAL(100, instances[2]->getUpdateDelay(100));
+	timemanager->step(100);
+	CHECK_EQUAL(199, instances[2]->getUpdateDelay(1000));
+	CHECK_EQUAL(399, instances[0]->getUpdateDelay(1000));
+	CHECK_EQUAL(1000, instances[1]->getUpdateDelay(1000));
+
+	// the repeating action is not restarted while the instance sleeps
+	timemanager->step(50);
+	layer->update();
+	CHECK_EQUAL(150, instances[1]->getActionRuntime());
+
+	// the action and the say text still end in time
+	timemanager->step(149);
+	layer->update();
+	CHECK(instances[2]->getCurrentAction());
+	timemanager->step(1);
+	layer->update();
+	CHECK(!instances[2]->getCurrentAction());
+	timemanager->step(199);
+	layer->update();
+	CHECK(instances[0]->getSayText());
+	timemanager->step(1);
+	layer->update();
+	CHECK(!instances[0]->getSayText());
+
+	// changes from outside are never delayed
+	instances[3]->setRotation(90);
+	std::vector<Instance*>& changed = layer->getChangedInstances();
+	layer->update();
+	CHECK_EQUAL(1, changed.size());
+	CHECK(changed[0] == instances[3]);
+
+	// the sleeping instance wakes up after the interval
+	CHECK_EQUAL(500, instances[1]->getActionRuntime());
+	timemanager->step(500);
+	layer->update();
+	CHECK(instances[1]->getActionRuntime() < 100);
+}
+
+// drops a blocker into a cell during the update, when the instance reaches the trigger cell
+class BlockerDropper : public InstanceChangeListener {
+public:
+	BlockerDropper(Object* object, const ModelCoordinate& trigger, const ModelCoordinate& cell)
+		: m_object(object), m_trigger(trigger), m_cell(cell), m_dropped(false) {}
+	virtual void onInstanceChanged(Instance* instance, InstanceChangeInfo info) {
+		if (!m_dropped && instance->getLocationRef().getLayerCoordinates() == m_trigger) {
+			instance->getLocationRef().getLayer()->createInstance(m_object, m_cell, "dropped");
+			m_dropped = true;
+		}
+	}
+
+private:
+	Object* m_object;
+	ModelCoordinate m_trigger;
+	ModelCoordinate m_cell;
+	bool m_dropped;
+};
+
+// pairs of blocking instances whose paths cross, both reach the crossing cell in the same round
+struct MovingMap {
+	RoutePather pather;
+	Object object;
+	SquareGrid grid;
+	Map map;
+	Layer* layer;
+	std::vector<Instance*> instances;
+	// blocks the next node of the fourth instance after its step was prepared
+	BlockerDropper dropper;
+
+	MovingMap(uint32_t threads)
+		: object("walker", "test"),
+		map("moving", NULL, std::vector<RendererBase*>(), NULL),
+		layer(map.createLayer("layer", &grid)),
+		dropper(&object, ModelCoordinate(2, 2), ModelCoordinate(8, 8)) {
+		pather.setMaxTicks(1000000);
+		object.setPather(&pather);
+		object.setBlocking(true);
+		object.createAction("walk");
+		map.setUpdateThreadCount(threads);
+		layer->setWalkable(true);
+		std::vector<Location> targets;
+		for (uint32_t i = 0; i < 160; ++i) {
+			ModelCoordinate base((i % 16) * 6, (i / 16) * 6);
+			for (uint32_t j = 0; j < 2; ++j) {
+				std::ostringstream id;
+				id << i << "_" << j;
+				ModelCoordinate start = j == 0 ? ModelCoordinate(base.x, base.y + 2) : ModelCoordinate(base.x + 2, base.y + 4);
+				instances.push_back(layer->createInstance(&object, start, id.str()));
+				Location target(layer);
+				target.setLayerCoordinates(j == 0 ? ModelCoordinate(base.x + 4, base.y + 2) : ModelCoordinate(base.x + 2, base.y));
+				targets.push_back(target);
+			}
+		}
+		// the cell cache only covers the area of the instances
+		layer->createInstance(&object, ModelCoordinate(-1, -1), "corner1");
+		layer->createInstance(&object, ModelCoordinate(96, 96), "corner2");
+		map.initializeCellCaches();
+		map.finalizeCellCaches();
+		for (uint32_t i = 0; i < instances.size(); ++i) {
+			instances[i]->move("walk", targets[i], 4.0);
+		}
+		instances[0]->addChangeListener(&dropper);
+	}
+
+	~MovingMap() {
+		instances[0]->removeChangeListener(&dropper);
+	}
+
+	void update() {
+		pather.update();
+		layer->update();
+	}
+};
+
+TEST(test_parallel_movement) {
+	TimeManager timemanager;
+	JobSystem jobsystem(3);
+	MovingMap serial(1);
+	MovingMap parallel(4);
+
+	std::vector<ModelCoordinate> start;
+	for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+		start.push_back(serial.instances[i]->getLocationRef().getLayerCoordinates());
+	}
+	// the prepared steps must give exactly the positions of the serial update
+	for (uint32_t round = 0; round < 200; ++round) {
+		timemanager.step(33);
+		serial.update();
+		parallel.update();
+		for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+			const Location& expected = serial.instances[i]->getLocationRef();
+			const Location& actual = parallel.instances[i]->getLocationRef();
+			CHECK(expected.getExactLayerCoordinates() == actual.getExactLayerCoordinates());
+			CHECK_EQUAL(serial.instances[i]->getRotation(), parallel.instances[i]->getRotation());
+		}
+	}
+	uint32_t moved = 0;
+	for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+		if (serial.instances[i]->getLocationRef().getLayerCoordinates() != start[i]) {
+			++moved;
+		}
+	}
+	CHECK(moved > 0);
+	// the step prepared before the blocker was dropped is not used
+	CHECK(parallel.instances[3]->getLocationRef().getLayerCoordinates() != ModelCoordinate(8, 8));
+}
+
+TEST(test_update_threads_without_jobsystem) {
+	// a model used without an engine has no job system, the layers update serially
+	TimeManager timemanager;
+	CHECK(!JobSystem::isCreated());
+	MovingMap serial(1);
+	MovingMap threaded(4);
+
+	std::vector<ModelCoordinate> start;
+	for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+		start.push_back(serial.instances[i]->getLocationRef().getLayerCoordinates());
+	}
+	for (uint32_t round = 0; round < 20; ++round) {
+		timemanager.step(33);
+		serial.update();
+		threaded.update();
+		for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+			CHECK(serial.instances[i]->getLocationRef().getExactLayerCoordinates() ==
+				threaded.instances[i]->getLocationRef().getExactLayerCoordinates());
+		}
+	}
+	uint32_t moved = 0;
+	for (uint32_t i = 0; i < serial.instances.size(); ++i) {
+		if (serial.instances[i]->getLocationRef().getLayerCoordinates() != start[i]) {
+			++moved;
+		}
+	}
+	CHECK(moved > 0);
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
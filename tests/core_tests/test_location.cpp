@@ -0,0 +1,164 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstdlib>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/hexgrid.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+#include "model/structures/location.h"
+#include "pathfinder/routepather/routepather.h"
+
+#include "model_fixtures.h"
+
+using namespace FIFE;
+
+TEST_FIXTURE(LocationEnvironment, test_coordinates) {
+	Location loc(hexLayer);
+	loc.setExactLayerCoordinates(ExactModelCoordinate(2.6, 3.2));
+	CHECK(loc.getLayerCoordinates() == hexGrid->toLayerCoordinatesFromExactLayerCoordinates(ExactModelCoordinate(2.6, 3.2)));
+	CHECK(loc.getMapCoordinates() == hexGrid->toMapCoordinates(ExactModelCoordinate(2.6, 3.2)));
+
+	// changes of the coordinates, the layer and the grid are seen by the getters
+	loc.setLayerCoordinates(ModelCoordinate(5, 7));
+	CHECK(loc.getLayerCoordinates() == ModelCoordinate(5, 7));
+	CHECK(loc.getMapCoordinates() == hexGrid->toMapCoordinates(ExactModelCoordinate(5, 7)));
+
+	hexGrid->setXShift(10);
+	CHECK(loc.getMapCoordinates() == hexGrid->toMapCoordinates(ExactModelCoordinate(5, 7)));
+
+	loc.setLayer(squareLayer);
+	CHECK(loc.getMapCoordinates() == squareGrid->toMapCoordinates(ExactModelCoordinate(5, 7)));
+
+	squareLayer->setCellGrid(hexGrid.get());
+	CHECK(loc.getMapCoordinates() == hexGrid->toMapCoordinates(ExactModelCoordinate(5, 7)));
+	squareLayer->setCellGrid(squareGrid.get());
+
+	loc.setExactLayerCoordinates(ExactModelCoordinate(1, 7));
+	CHECK(loc.getLayerCoordinates() == ModelCoordinate(1, 7));
+
+	Location copy(loc);
+	CHECK(copy.getLayerCoordinates() == ModelCoordinate(1, 7));
+	copy.setMapCoordinates(squareGrid->toMapCoordinates(ExactModelCoordinate(3, 4)));
+	CHECK(copy.getLayerCoordinates() == ModelCoordinate(3, 4));
+	CHECK(loc.getLayerCoordinates() == ModelCoordinate(1, 7));
+	loc = copy;
+	CHECK(loc.getLayerCoordinates() == ModelCoordinate(3, 4));
+}
+
+TEST(test_batch_transforms) {
+	SquareGrid square;
+	HexGrid hex;
+	HexGrid axial(true);
+	CellGrid* grids[] = { &square, &hex, &axial };
+
+	DoublePoint3DArray points;
+	for (int32_t i = 0; i < 101; ++i) {
+		points.push_back(DoublePoint3D((rand() % 2000 - 1000) / 7.0, (rand() % 2000 - 1000) / 3.0, (rand() % 10) / 4.0));
+	}
+
+	for (uint32_t g = 0; g < 3; ++g) {
+		CellGrid* grid = grids[g];
+		grid->setRotation(30 * g + 15);
+		grid->setXScale(1.5);
+		grid->setYScale(0.75);
+		grid->setXShift(3);
+		grid->setYShift(-2);
+
+		DoublePoint3DArray mapCoords;
+		DoublePoint3DArray layerCoords;
+		std::vector<ModelCoordinate> cells;
+		grid->toMapCoordinatesBatch(points, mapCoords);
+		grid->toExactLayerCoordinatesBatch(points, layerCoords);
+		grid->toLayerCoordinatesBatch(points, cells);
+		CHECK_EQUAL(points.size(), mapCoords.size());
+		CHECK_EQUAL(points.size(), layerCoords.size());
+		CHECK_EQUAL(points.size(), cells.size());
+		for (uint32_t i = 0; i < points.size(); ++i) {
+			ExactModelCoordinate map = grid->toMapCoordinates(points.get(i));
+			CHECK_CLOSE(map.x, mapCoords.x[i], 1e-9);
+			CHECK_CLOSE(map.y, mapCoords.y[i], 1e-9);
+			CHECK_CLOSE(map.z, mapCoords.z[i], 1e-9);
+			ExactModelCoordinate layer = grid->toExactLayerCoordinates(points.get(i));
+			CHECK_CLOSE(layer.x, layerCoords.x[i], 1e-9);
+			CHECK_CLOSE(layer.y, layerCoords.y[i], 1e-9);
+			CHECK_CLOSE(layer.z, layerCoords.z[i], 1e-9);
+			CHECK(grid->toLayerCoordinates(points.get(i)) == cells[i]);
+		}
+
+		// in place transform
+		DoublePoint3DArray inPlace(points);
+		grid->toMapCoordinatesBatch(inPlace, inPlace);
+		for (uint32_t i = 0; i < points.size(); ++i) {
+			CHECK_CLOSE(mapCoords.x[i], inPlace.x[i], 1e-9);
+			CHECK_CLOSE(mapCoords.y[i], inPlace.y[i], 1e-9);
+		}
+	}
+
+	// the camera side uses the same kernel with an arbitrary matrix
+	DoubleMatrix matrix;
+	matrix.loadRotate(35, 0.0, 0.0, 1.0);
+	matrix.applyScale(2.0, 0.5, 1.0);
+	matrix.applyTranslate(4.0, -7.0, 1.0);
+	DoublePoint3DArray transformed;
+	transformPoints(matrix, points, transformed);
+	for (uint32_t i = 0; i < points.size(); ++i) {
+		DoublePoint3D expected = matrix * points.get(i);
+		CHECK_CLOSE(expected.x, transformed.x[i], 1e-9);
+		CHECK_CLOSE(expected.y, transformed.y[i], 1e-9);
+		CHECK_CLOSE(expected.z, transformed.z[i], 1e-9);
+	}
+
+	// short arrays end in the remainder loops of the vector paths
+	for (size_t count = 1; count < 10; ++count) {
+		DoublePoint3DArray part;
+		for (size_t i = 0; i < count; ++i) {
+			part.push_back(points.get(i));
+		}
+		transformPoints(matrix, part, part);
+		for (size_t i = 0; i < count; ++i) {
+			CHECK_CLOSE(transformed.x[i], part.x[i], 1e-9);
+			CHECK_CLOSE(transformed.y[i], part.y[i], 1e-9);
+			CHECK_CLOSE(transformed.z[i], part.z[i], 1e-9);
+		}
+	}
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
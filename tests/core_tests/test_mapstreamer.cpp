@@ -0,0 +1,264 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <sstream>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timemanager.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/map.h"
+#include "model/structures/mapstreamer.h"
+#include "model/structures/layer.h"
+#include "model/structures/instance.h"
+
+using namespace FIFE;
+
+static const uint32_t CHUNK_SIZE = 10;
+
+// Environment
+struct environment {
+	boost::shared_ptr<TimeManager> timemanager;
+	boost::shared_ptr<Object> object;
+	boost::shared_ptr<SquareGrid> grid;
+	boost::shared_ptr<Map> map;
+	Layer* layer;
+	MemoryChunkSource* source;
+	MapStreamer* streamer;
+
+	// one instance in the middle of each chunk from 0,0 to 9,9
+	environment()
+		: timemanager(new TimeManager()),
+		object(new Object("object", "test")),
+		grid(new SquareGrid()),
+		map(new Map("map", NULL, std::vector<RendererBase*>(), NULL)),
+		layer(map->createLayer("layer", grid.get())),
+		source(new MemoryChunkSource()),
+		streamer(new MapStreamer(map.get(), source, CHUNK_SIZE)) {
+
+		map->setStreamer(streamer);
+		streamer->addLayer(layer);
+		for (int32_t y = 0; y < 10; ++y) {
+			for (int32_t x = 0; x < 10; ++x) {
+				StreamedInstance instance;
+				instance.object = object.get();
+				instance.coordinate = ExactModelCoordinate(x * CHUNK_SIZE + 5, y * CHUNK_SIZE + 5);
+				instance.id = getId(x, y);
+				source->addInstance(layer->getId(), ModelCoordinate(x, y), instance);
+			}
+		}
+	}
+
+	static std::string getId(int32_t x, int32_t y) {
+		std::ostringstream id;
+		id << x << "_" << y;
+		return id.str();
+	}
+
+	void focus(int32_t x, int32_t y) {
+		streamer->clearFocusAreas();
+		streamer->addFocusArea(Rect(x, y, 1, 1));
+		map->updateSimulation();
+		streamer->finishLoading();
+	}
+};
+
+TEST_FIXTURE(environment, test_chunk) {
+	CHECK(streamer->getChunk(ExactModelCoordinate(0, 0)) == ModelCoordinate(0, 0));
+	CHECK(streamer->getChunk(ExactModelCoordinate(9.9, 10)) == ModelCoordinate(0, 1));
+	CHECK(streamer->getChunk(ExactModelCoordinate(-0.5, -10)) == ModelCoordinate(-1, -1));
+	CHECK(streamer->getChunk(ExactModelCoordinate(-10.5, 25)) == ModelCoordinate(-2, 2));
+}
+
+TEST_FIXTURE(environment, test_radius) {
+	CHECK_EQUAL(CHUNK_SIZE, streamer->getLoadRadius());
+	CHECK_EQUAL(CHUNK_SIZE * 2, streamer->getUnloadRadius());
+	// the unload radius never falls below the load radius
+	streamer->setUnloadRadius(5);
+	CHECK_EQUAL(CHUNK_SIZE, streamer->getUnloadRadius());
+	streamer->setLoadRadius(50);
+	CHECK_EQUAL(50u, streamer->getUnloadRadius());
+}
+
+TEST_FIXTURE(environment, test_load) {
+	// nothing is loaded without viewports or focus areas
+	map->updateSimulation();
+	CHECK_EQUAL(0u, streamer->getLoadedChunkCount());
+	CHECK_EQUAL(0u, streamer->getPendingChunkCount());
+
+	streamer->addFocusArea(Rect(0, 0, 1, 1));
+	streamer->update();
+	// chunks -1,-1 to 1,1 are requested, the instances are created after the thread read them
+	CHECK_EQUAL(9u, streamer->getPendingChunkCount() + streamer->getLoadedChunkCount());
+	streamer->finishLoading();
+	CHECK_EQUAL(0u, streamer->getPendingChunkCount());
+	CHECK_EQUAL(9u, streamer->getLoadedChunkCount());
+	CHECK(streamer->isChunkLoaded(layer, ModelCoordinate(-1, -1)));
+	CHECK(streamer->isChunkLoaded(layer, ModelCoordinate(1, 1)));
+	CHECK(!streamer->isChunkLoaded(layer, ModelCoordinate(2, 0)));
+
+	CHECK_EQUAL(4u, layer->getInstances().size());
+	Instance* instance = layer->getInstance(getId(1, 1));
+	CHECK(instance);
+	if (instance) {
+		CHECK(instance->getLocationRef().getLayerCoordinates() == ModelCoordinate(15, 15));
+	}
+	CHECK(!layer->getInstance(getId(2, 0)));
+
+	// loaded chunks are not requested again
+	streamer->update();
+	CHECK_EQUAL(0u, streamer->getPendingChunkCount());
+	CHECK_EQUAL(4u, layer->getInstances().size());
+}
+
+TEST_FIXTURE(environment, test_unload) {
+	focus(0, 0);
+	// instances created by scripts stay on the layer
+	Instance* scripted = layer->createInstance(object.get(), ModelCoordinate(3, 3), "scripted");
+
+	// chunks within the unload radius stay loaded
+	focus(15, 15);
+	CHECK(streamer->isChunkLoaded(layer, ModelCoordinate(-1, -1)));
+	// 0,0 to 2,2 and the scripted instance
+	CHECK_EQUAL(10u, layer->getInstances().size());
+
+	focus(55, 55);
+	CHECK(!streamer->isChunkLoaded(layer, ModelCoordinate(0, 0)));
+	CHECK(!layer->getInstance(getId(0, 0)));
+	CHECK(layer->getInstance(getId(5, 5)));
+	CHECK_EQUAL(scripted, layer->getInstance("scripted"));
+	// 4,4 to 6,6 and the scripted instance
+	CHECK_EQUAL(10u, layer->getInstances().size());
+	CHECK_EQUAL(9u, streamer->getLoadedChunkCount());
+
+	// without saving, the records are kept as they are
+	CHECK_EQUAL(1u, source->getInstanceCount(layer->getId(), ModelCoordinate(0, 0)));
+}
+
+TEST_FIXTURE(environment, test_unload_moved_instance) {
+	focus(0, 0);
+	Instance* instance = layer->getInstance(getId(0, 0));
+	CHECK(instance);
+	if (!instance) {
+		return;
+	}
+	// moved into the neighbour chunk, which stays loaded while its home chunk is unloaded
+	instance->getLocationRef().setExactLayerCoordinates(ExactModelCoordinate(12, 4));
+	focus(35, 5);
+	CHECK(!streamer->isChunkLoaded(layer, ModelCoordinate(0, 0)));
+	CHECK(streamer->isChunkLoaded(layer, ModelCoordinate(1, 0)));
+	CHECK_EQUAL(instance, layer->getInstance(getId(0, 0)));
+
+	// the record of the home chunk is skipped while the instance exists
+	focus(0, 0);
+	CHECK(streamer->isChunkLoaded(layer, ModelCoordinate(0, 0)));
+	uint32_t count = 0;
+	std::vector<Instance*> instances = layer->getInstances();
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		if (instances[i]->getId() == getId(0, 0)) {
+			++count;
+		}
+	}
+	CHECK_EQUAL(1u, count);
+
+	// once the instance is gone, the home chunk creates it again
+	layer->deleteInstance(instance);
+	focus(55, 55);
+	focus(0, 0);
+	instance = layer->getInstance(getId(0, 0));
+	CHECK(instance);
+	if (instance) {
+		CHECK(instance->getLocationRef().getLayerCoordinates() == ModelCoordinate(5, 5));
+	}
+}
+
+TEST_FIXTURE(environment, test_save_on_unload) {
+	streamer->setSaveOnUnload(true);
+	focus(0, 0);
+	Instance* instance = layer->getInstance(getId(0, 0));
+	CHECK(instance);
+	if (!instance) {
+		return;
+	}
+	instance->setRotation(90);
+	instance->setCellStackPosition(3);
+	// moved into the neighbour chunk, so it is saved with it
+	instance->setLocation(Location(layer));
+	instance->getLocationRef().setExactLayerCoordinates(ExactModelCoordinate(12, 4));
+	layer->deleteInstance(layer->getInstance(getId(0, 1)));
+
+	focus(55, 55);
+	CHECK_EQUAL(0u, source->getInstanceCount(layer->getId(), ModelCoordinate(0, 0)));
+	CHECK_EQUAL(0u, source->getInstanceCount(layer->getId(), ModelCoordinate(0, 1)));
+	CHECK_EQUAL(2u, source->getInstanceCount(layer->getId(), ModelCoordinate(1, 0)));
+
+	focus(0, 0);
+	CHECK_EQUAL(3u, layer->getInstances().size());
+	CHECK(!layer->getInstance(getId(0, 1)));
+	instance = layer->getInstance(getId(0, 0));
+	CHECK(instance);
+	if (instance) {
+		CHECK_EQUAL(90, instance->getRotation());
+		CHECK_EQUAL(3, instance->getCellStackPosition());
+		CHECK(instance->getLocationRef().getExactLayerCoordinates() == ExactModelCoordinate(12, 4));
+	}
+}
+
+TEST_FIXTURE(environment, test_remove_layer) {
+	streamer->addFocusArea(Rect(0, 0, 1, 1));
+	streamer->update();
+	// chunks that are read while the layer is deleted are dropped
+	map->deleteLayer(layer);
+	streamer->finishLoading();
+	CHECK_EQUAL(0u, streamer->getLoadedChunkCount());
+	CHECK_EQUAL(0u, streamer->getPendingChunkCount());
+}
+
+TEST_FIXTURE(environment, test_delete_instances) {
+	focus(0, 0);
+	std::vector<Instance*> instances = layer->getInstances();
+	instances.pop_back();
+	std::vector<std::string> ids;
+	for (uint32_t i = 0; i < instances.size(); ++i) {
+		ids.push_back(instances[i]->getId());
+	}
+	layer->deleteInstances(instances);
+	CHECK_EQUAL(1u, layer->getInstances().size());
+	for (uint32_t i = 0; i < ids.size(); ++i) {
+		CHECK(!layer->getInstance(ids[i]));
+	}
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
+
@@ -0,0 +1,178 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <thread>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "model/model.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "util/base/memorytracker.h"
+#include "util/time/timemanager.h"
+
+using namespace FIFE;
+
+// records the budget notifications and frees the memory like a cache would do
+class TestBudgetListener : public IMemoryBudgetListener {
+public:
+	TestBudgetListener() : calls(0), lastUsage(0) {}
+
+	virtual void onBudgetExceeded(MemoryCategory category, size_t usage, size_t budget) {
+		++calls;
+		lastUsage = usage;
+		MemoryTracker::instance()->remove(category, usage - budget, 0);
+	}
+
+	uint32_t calls;
+	size_t lastUsage;
+};
+
+// Environment
+struct environment {
+	MemoryTracker* tracker;
+
+	environment()
+		: tracker(MemoryTracker::instance()) {
+	}
+
+	~environment() {
+		tracker->setBudget(MEMORY_TEXT, 0);
+		tracker->setUsageCallback(MEMORY_TEXT, std::function<size_t()>());
+	}
+};
+
+TEST_FIXTURE(environment, test_counters) {
+	size_t usage = tracker->getUsage(MEMORY_TEXT);
+	uint32_t count = tracker->getCount(MEMORY_TEXT);
+	tracker->add(MEMORY_TEXT, 100);
+	tracker->add(MEMORY_TEXT, 50, 2);
+	CHECK_EQUAL(usage + 150, tracker->getUsage(MEMORY_TEXT));
+	CHECK_EQUAL(count + 3, tracker->getCount(MEMORY_TEXT));
+	tracker->remove(MEMORY_TEXT, 150, 3);
+	CHECK_EQUAL(usage, tracker->getUsage(MEMORY_TEXT));
+	CHECK_EQUAL(count, tracker->getCount(MEMORY_TEXT));
+	CHECK_EQUAL("text", MemoryTracker::getCategoryName(MEMORY_TEXT));
+}
+
+TEST_FIXTURE(environment, test_threads) {
+	size_t usage = tracker->getUsage(MEMORY_TEXT);
+	std::vector<std::thread> threads;
+	for (int32_t i = 0; i < 4; ++i) {
+		threads.push_back(std::thread([this]() {
+			for (int32_t j = 0; j < 10000; ++j) {
+				tracker->add(MEMORY_TEXT, 3);
+				tracker->remove(MEMORY_TEXT, 1);
+			}
+		}));
+	}
+	for (size_t i = 0; i < threads.size(); ++i) {
+		threads[i].join();
+	}
+	CHECK_EQUAL(usage + 4 * 10000 * 2, tracker->getUsage(MEMORY_TEXT));
+	tracker->remove(MEMORY_TEXT, 4 * 10000 * 2, 0);
+}
+
+TEST_FIXTURE(environment, test_usage_callback) {
+	size_t usage = tracker->getUsage(MEMORY_TEXT);
+	size_t total = tracker->getTotalUsage();
+	tracker->setUsageCallback(MEMORY_TEXT, []() { return size_t(4096); });
+	CHECK_EQUAL(4096u, tracker->getUsage(MEMORY_TEXT));
+	CHECK_EQUAL(0u, tracker->getCount(MEMORY_TEXT));
+	CHECK_EQUAL(total - usage + 4096, tracker->getTotalUsage());
+	tracker->setUsageCallback(MEMORY_TEXT, std::function<size_t()>());
+	CHECK_EQUAL(usage, tracker->getUsage(MEMORY_TEXT));
+}
+
+TEST_FIXTURE(environment, test_budget) {
+	size_t usage = tracker->getUsage(MEMORY_TEXT);
+	TestBudgetListener listener;
+	tracker->addBudgetListener(&listener);
+	tracker->setBudget(MEMORY_TEXT, usage + 1000);
+	CHECK_EQUAL(usage + 1000, tracker->getBudget(MEMORY_TEXT));
+
+	tracker->checkBudgets();
+	CHECK(!tracker->isOverBudget(MEMORY_TEXT));
+	CHECK_EQUAL(0u, listener.calls);
+
+	// the listener evicts down to the budget
+	tracker->add(MEMORY_TEXT, 1500);
+	tracker->checkBudgets();
+	CHECK(tracker->isOverBudget(MEMORY_TEXT));
+	CHECK_EQUAL(1u, listener.calls);
+	CHECK_EQUAL(usage + 1500, listener.lastUsage);
+	CHECK_EQUAL(usage + 1000, tracker->getUsage(MEMORY_TEXT));
+
+	tracker->checkBudgets();
+	CHECK(!tracker->isOverBudget(MEMORY_TEXT));
+	CHECK_EQUAL(1u, listener.calls);
+
+	// removed listeners are not called
+	tracker->removeBudgetListener(&listener);
+	tracker->add(MEMORY_TEXT, 10);
+	tracker->checkBudgets();
+	CHECK(tracker->isOverBudget(MEMORY_TEXT));
+	CHECK_EQUAL(1u, listener.calls);
+	tracker->remove(MEMORY_TEXT, 1010, 0);
+}
+
+TEST_FIXTURE(environment, test_model_accounting) {
+	boost::shared_ptr<TimeManager> timemanager(new TimeManager());
+	size_t cells = tracker->getUsage(MEMORY_CELLS);
+	uint32_t instances = tracker->getCount(MEMORY_INSTANCES);
+	{
+		Model model(NULL, std::vector<RendererBase*>());
+		model.adoptCellGrid(new SquareGrid());
+		Object* object = model.createObject("object", "test");
+		Map* map = model.createMap("map");
+		Layer* layer = map->createLayer("ground", model.getCellGrid("square"));
+		layer->setWalkable(true);
+		layer->createInstance(object, ModelCoordinate(0, 0), "first");
+		layer->createInstance(object, ModelCoordinate(3, 2), "second");
+		CHECK_EQUAL(instances + 2, tracker->getCount(MEMORY_INSTANCES));
+
+		map->initializeCellCaches();
+		map->finalizeCellCaches();
+		// a 4x3 layer
+		CHECK_EQUAL(cells + 12 * sizeof(Cell), tracker->getUsage(MEMORY_CELLS));
+		CHECK_EQUAL(instances + 2, tracker->getCount(MEMORY_INSTANCES));
+	}
+	CHECK_EQUAL(cells, tracker->getUsage(MEMORY_CELLS));
+	CHECK_EQUAL(instances, tracker->getCount(MEMORY_INSTANCES));
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <string>
+#include <thread>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/base/exception.h"
+#include "util/time/profiler.h"
+
+using namespace FIFE;
+
+// Environment
+struct environment {
+	Profiler* profiler;
+
+	environment()
+		: profiler(Profiler::instance()) {
+		profiler->reset();
+		profiler->setHistorySize(4);
+		profiler->setEnabled(true);
+	}
+
+	~environment() {
+		profiler->setEnabled(false);
+		profiler->reset();
+	}
+
+	void frame(uint32_t mapCalls) {
+		ProfilerFrame frame;
+		ProfilerZone model("model");
+		for (uint32_t i = 0; i < mapCalls; ++i) {
+			ProfilerZone map("map");
+		}
+	}
+};
+
+TEST_FIXTURE(environment, test_zone_tree) {
+	frame(3);
+	std::vector<std::string> zones = profiler->getZones();
+	CHECK_EQUAL(3u, zones.size());
+	CHECK_EQUAL("frame", zones[0]);
+	CHECK_EQUAL("frame/model", zones[1]);
+	CHECK_EQUAL("frame/model/map", zones[2]);
+	CHECK_EQUAL(1u, profiler->getCallCount("frame"));
+	CHECK_EQUAL(3u, profiler->getCallCount("frame/model/map"));
+	CHECK(profiler->getLastTime("frame") >= profiler->getLastTime("frame/model"));
+	CHECK(profiler->getLastTime("frame/model") >= profiler->getLastTime("frame/model/map"));
+	CHECK_THROW(profiler->getLastTime("frame/gui"), NotFound);
+	CHECK_THROW(profiler->getLastTime("model"), NotFound);
+}
+
+TEST_FIXTURE(environment, test_rolling_values) {
+	frame(1);
+	frame(0);
+	CHECK_EQUAL(0u, profiler->getCallCount("frame/model/map"));
+	CHECK_EQUAL(0.0, profiler->getLastTime("frame/model/map"));
+	CHECK_EQUAL(0.0, profiler->getMinTime("frame/model/map"));
+	double max = profiler->getMaxTime("frame/model/map");
+	CHECK_CLOSE(max / 2.0, profiler->getAverageTime("frame/model/map"), 0.000001);
+
+	// the first frame leaves the history
+	for (int32_t i = 0; i < 4; ++i) {
+		frame(0);
+	}
+	CHECK_EQUAL(0.0, profiler->getMaxTime("frame/model/map"));
+}
+
+TEST_FIXTURE(environment, test_disabled) {
+	profiler->setEnabled(false);
+	frame(2);
+	CHECK(!profiler->isRecording());
+	CHECK_EQUAL(1u, profiler->getZones().size());
+	CHECK_EQUAL(0.0, profiler->getAverageTime("frame"));
+}
+
+TEST_FIXTURE(environment, test_other_threads) {
+	profiler->beginFrame();
+	bool opened = true;
+	std::thread worker([&]() {
+		opened = profiler->beginZone("worker");
+	});
+	worker.join();
+	profiler->endFrame();
+	CHECK(!opened);
+	CHECK_EQUAL(1u, profiler->getZones().size());
+}
+
+TEST_FIXTURE(environment, test_open_zones_end_with_frame) {
+	profiler->beginFrame();
+	profiler->beginZone("model");
+	profiler->beginZone("map");
+	profiler->endFrame();
+	CHECK(!profiler->isRecording());
+	CHECK_EQUAL(1u, profiler->getCallCount("frame/model/map"));
+	frame(1);
+	CHECK_EQUAL(1u, profiler->getCallCount("frame/model/map"));
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
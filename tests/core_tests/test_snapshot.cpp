@@ -0,0 +1,197 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstdio>
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "loaders/native/map/snapshotloader.h"
+#include "model/model.h"
+#include "model/metamodel/action.h"
+#include "model/metamodel/object.h"
+#include "model/metamodel/grids/squaregrid.h"
+#include "model/structures/cell.h"
+#include "model/structures/cellcache.h"
+#include "model/structures/instance.h"
+#include "model/structures/layer.h"
+#include "model/structures/map.h"
+#include "model/structures/trigger.h"
+#include "model/structures/triggercontroller.h"
+#include "savers/native/map/snapshotsaver.h"
+#include "util/base/exception.h"
+#include "util/time/timemanager.h"
+#include "vfs/vfs.h"
+#include "vfs/vfsdirectory.h"
+
+using namespace FIFE;
+
+static const std::string SNAPSHOT_FILE = "fifetestsnapshot.bin";
+
+// Environment
+struct environment {
+	boost::shared_ptr<TimeManager> timemanager;
+	boost::shared_ptr<VFS> vfs;
+	boost::shared_ptr<Model> model;
+	Object* object;
+
+	environment()
+		: timemanager(new TimeManager()),
+		vfs(new VFS()),
+		model(new Model(NULL, std::vector<RendererBase*>())),
+		object(NULL) {
+
+		vfs->addSource(new VFSDirectory(vfs.get()));
+		model->adoptCellGrid(new SquareGrid());
+		object = model->createObject("object", "test");
+		Action* action = object->createAction("walk");
+		action->setDuration(1000);
+	}
+
+	~environment() {
+		std::remove(SNAPSHOT_FILE.c_str());
+	}
+
+	// saves the map, removes it from the model and loads it back
+	Map* reload(Map* map) {
+		SnapshotSaver saver;
+		saver.save(*map, SNAPSHOT_FILE);
+		model->deleteMap(map);
+		SnapshotLoader loader(model.get(), vfs.get());
+		CHECK(loader.isLoadable(SNAPSHOT_FILE));
+		return loader.load(SNAPSHOT_FILE);
+	}
+};
+
+TEST_FIXTURE(environment, test_layers_and_instances) {
+	Map* map = model->createMap("map");
+	Layer* layer = map->createLayer("ground", model->getCellGrid("square"));
+	layer->setLayerTransparency(40);
+	layer->setStatic(true);
+	Instance* first = layer->createInstance(object, ExactModelCoordinate(1.5, 2.0), "first");
+	first->setRotation(90);
+	first->setOverrideBlocking(true);
+	first->setBlocking(true);
+	first->setCost("road", 0.5);
+	layer->createInstance(object, ModelCoordinate(4, 4), "second");
+	map->createLayer("empty", model->getCellGrid("square"));
+
+	map = reload(map);
+	CHECK_EQUAL("map", map->getId());
+	CHECK_EQUAL(2u, map->getLayerCount());
+	layer = map->getLayer("ground");
+	CHECK(layer);
+	CHECK_EQUAL(40, layer->getLayerTransparency());
+	CHECK(layer->isStatic());
+	CHECK_EQUAL(2u, layer->getInstances().size());
+
+	first = layer->getInstance("first");
+	CHECK(first);
+	CHECK_EQUAL(object, first->getObject());
+	CHECK(first->getLocationRef().getExactLayerCoordinates() == ExactModelCoordinate(1.5, 2.0));
+	CHECK_EQUAL(90, first->getRotation());
+	CHECK(first->isOverrideBlocking());
+	CHECK(first->isBlocking());
+	CHECK(first->isSpecialCost());
+	CHECK_EQUAL("road", first->getCostId());
+	CHECK_CLOSE(0.5, first->getCost(), 0.0001);
+	CHECK(layer->getInstance("second"));
+	CHECK(map->getLayer("empty")->getInstances().empty());
+}
+
+TEST_FIXTURE(environment, test_cell_caches_and_triggers) {
+	Map* map = model->createMap("map");
+	Layer* layer = map->createLayer("ground", model->getCellGrid("square"));
+	layer->setWalkable(true);
+	Instance* instance = layer->createInstance(object, ModelCoordinate(0, 0), "instance");
+	layer->createInstance(object, ModelCoordinate(5, 5), "corner");
+	map->initializeCellCaches();
+	map->finalizeCellCaches();
+	CellCache* cache = layer->getCellCache();
+	cache->registerCost("mud", 3.0);
+	cache->addCellToCost("mud", cache->getCell(ModelCoordinate(2, 2)));
+	cache->addCellToArea("house", cache->getCell(ModelCoordinate(3, 3)));
+	cache->getCell(ModelCoordinate(1, 1))->setSpeedMultiplier(2.0);
+
+	Trigger* trigger = map->getTriggerController()->createTrigger("door");
+	trigger->addTriggerCondition(CELL_TRIGGER_ENTER);
+	trigger->enableForInstance(instance);
+	trigger->assign(layer, ModelCoordinate(3, 3));
+
+	map = reload(map);
+	layer = map->getLayer("ground");
+	cache = layer->getCellCache();
+	CHECK(cache);
+	CHECK_CLOSE(3.0, cache->getCost("mud"), 0.0001);
+	std::vector<Cell*> cells = cache->getCostCells("mud");
+	CHECK_EQUAL(1u, cells.size());
+	CHECK(cells[0]->getLayerCoordinates() == ModelCoordinate(2, 2));
+	cells = cache->getAreaCells("house");
+	CHECK_EQUAL(1u, cells.size());
+	CHECK(cells[0]->getLayerCoordinates() == ModelCoordinate(3, 3));
+	CHECK_CLOSE(2.0, cache->getCell(ModelCoordinate(1, 1))->getSpeedMultiplier(), 0.0001);
+
+	trigger = map->getTriggerController()->getTrigger("door");
+	CHECK(trigger);
+	CHECK_EQUAL(1u, trigger->getTriggerConditions().size());
+	CHECK_EQUAL(1u, trigger->getEnabledInstances().size());
+	CHECK_EQUAL(layer->getInstance("instance"), trigger->getEnabledInstances()[0]);
+	CHECK_EQUAL(1u, trigger->getAssignedCells().size());
+}
+
+TEST_FIXTURE(environment, test_running_action) {
+	Map* map = model->createMap("map");
+	Layer* layer = map->createLayer("ground", model->getCellGrid("square"));
+	Instance* instance = layer->createInstance(object, ModelCoordinate(0, 0), "instance");
+	instance->actRepeat("walk", 180);
+	instance->setActionRuntime(250);
+
+	map = reload(map);
+	instance = map->getLayer("ground")->getInstance("instance");
+	CHECK(instance->getCurrentAction());
+	CHECK_EQUAL("walk", instance->getCurrentAction()->getId());
+	CHECK(instance->isActionRepeating());
+	CHECK(instance->getActionRuntime() >= 250);
+}
+
+TEST_FIXTURE(environment, test_invalid_file) {
+	FILE* file = std::fopen(SNAPSHOT_FILE.c_str(), "wb");
+	std::fputs("<map/>", file);
+	std::fclose(file);
+
+	SnapshotLoader loader(model.get(), vfs.get());
+	CHECK(!loader.isLoadable(SNAPSHOT_FILE));
+	CHECK_THROW(loader.load(SNAPSHOT_FILE), InvalidFormat);
+	CHECK_EQUAL(0u, model->getMapCount());
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
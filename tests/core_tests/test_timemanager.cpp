@@ -0,0 +1,186 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <vector>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+#include <boost/shared_ptr.hpp>
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/timeevent.h"
+#include "util/time/timemanager.h"
+
+using namespace FIFE;
+
+// Counts its updates and optionally changes its registration from inside the update
+class CountingEvent : public TimeEvent {
+public:
+	CountingEvent(int32_t period)
+		: TimeEvent(period),
+		calls(0),
+		unregisterOnUpdate(false),
+		newPeriod(-2) {
+	}
+
+	virtual void updateEvent(uint32_t time) {
+		++calls;
+		if (unregisterOnUpdate) {
+			TimeManager::instance()->unregisterEvent(this);
+		}
+		if (newPeriod != -2) {
+			setPeriod(newPeriod);
+		}
+	}
+
+	int32_t calls;
+	bool unregisterOnUpdate;
+	int32_t newPeriod;
+};
+
+// Environment
+struct environment {
+	boost::shared_ptr<TimeManager> timemanager;
+
+	environment()
+		: timemanager(new TimeManager()) {
+	}
+};
+
+TEST_FIXTURE(environment, test_periods) {
+	CountingEvent never(-1);
+	CountingEvent frame(0);
+	CountingEvent timed(100);
+	timemanager->registerEvent(&never);
+	timemanager->registerEvent(&frame);
+	timemanager->registerEvent(&timed);
+
+	for (int32_t i = 0; i < 10; ++i) {
+		timemanager->step(30);
+	}
+	CHECK_EQUAL(0, never.calls);
+	CHECK_EQUAL(10, frame.calls);
+	// fires at 120 and 240
+	CHECK_EQUAL(2, timed.calls);
+
+	timemanager->unregisterEvent(&frame);
+	timemanager->unregisterEvent(&timed);
+	timemanager->step(200);
+	CHECK_EQUAL(10, frame.calls);
+	CHECK_EQUAL(2, timed.calls);
+}
+
+TEST_FIXTURE(environment, test_due_order) {
+	std::vector<CountingEvent*> events;
+	for (int32_t i = 1; i <= 100; ++i) {
+		events.push_back(new CountingEvent(i * 10));
+		timemanager->registerEvent(events.back());
+	}
+	timemanager->step(55);
+	for (int32_t i = 0; i < 100; ++i) {
+		CHECK_EQUAL(i < 5 ? 1 : 0, events[i]->calls);
+	}
+	// a late frame updates each due event once
+	timemanager->step(1000);
+	for (int32_t i = 0; i < 100; ++i) {
+		CHECK_EQUAL(i < 5 ? 2 : 1, events[i]->calls);
+	}
+	for (int32_t i = 0; i < 100; ++i) {
+		delete events[i];
+	}
+	// deleted events unregistered themselves
+	timemanager->step(1000);
+}
+
+TEST_FIXTURE(environment, test_reschedule) {
+	CountingEvent event(-1);
+	timemanager->registerEvent(&event);
+	timemanager->step(50);
+	CHECK_EQUAL(0, event.calls);
+
+	event.setPeriod(100);
+	timemanager->step(60);
+	CHECK_EQUAL(1, event.calls);
+
+	// moving the last update time into the future delays the event
+	event.setLastUpdateTime(timemanager->getTime() + 500);
+	timemanager->step(500);
+	CHECK_EQUAL(1, event.calls);
+	timemanager->step(100);
+	CHECK_EQUAL(2, event.calls);
+}
+
+TEST_FIXTURE(environment, test_changes_during_update) {
+	CountingEvent once(10);
+	once.unregisterOnUpdate = true;
+	CountingEvent slower(0);
+	slower.newPeriod = 100;
+	timemanager->registerEvent(&once);
+	timemanager->registerEvent(&slower);
+
+	timemanager->step(20);
+	CHECK_EQUAL(1, once.calls);
+	CHECK_EQUAL(1, slower.calls);
+	timemanager->step(20);
+	CHECK_EQUAL(1, once.calls);
+	CHECK_EQUAL(1, slower.calls);
+	timemanager->step(80);
+	CHECK_EQUAL(2, slower.calls);
+
+	// registering again after the event removed itself works
+	timemanager->registerEvent(&once);
+	timemanager->step(10);
+	CHECK_EQUAL(2, once.calls);
+}
+
+TEST_FIXTURE(environment, test_precise_time) {
+	timemanager->step(16);
+	CHECK_CLOSE(16.0, timemanager->getPreciseTime(), 0.0001);
+	CHECK_CLOSE(16.0, timemanager->getPreciseTimeDelta(), 0.0001);
+	CHECK_EQUAL(16u, timemanager->getTime());
+}
+
+TEST_FIXTURE(environment, test_step_then_update) {
+	// the real time continues from the stepped time, without a jump
+	timemanager->step(1000);
+	timemanager->update();
+	CHECK(timemanager->getPreciseTime() >= 1000.0);
+	CHECK(timemanager->getPreciseTime() < 2000.0);
+	CHECK(timemanager->getTimeDelta() < 1000u);
+
+	// a step between two updates is not lost
+	double before = timemanager->getPreciseTime();
+	timemanager->step(500);
+	timemanager->update();
+	CHECK(timemanager->getPreciseTime() >= before + 500.0);
+	CHECK(timemanager->getPreciseTime() < before + 1500.0);
+	CHECK(timemanager->getTimeDelta() < 1000u);
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
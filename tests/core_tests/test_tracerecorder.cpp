@@ -0,0 +1,141 @@
+/***************************************************************************
+ *   Copyright (C) 2005-2019 by the FIFE team                              *
+ *   http://www.fifengine.net                                              *
+ *   This file is part of FIFE.                                            *
+ *                                                                         *
+ *   FIFE is free software; you can redistribute it and/or                 *
+ *   modify it under the terms of the GNU Lesser General Public            *
+ *   License as published by the Free Software Foundation; either          *
+ *   version 2.1 of the License, or (at your option) any later version.    *
+ *                                                                         *
+ *   This library is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ *   Lesser General Public License for more details.                       *
+ *                                                                         *
+ *   You should have received a copy of the GNU Lesser General Public      *
+ *   License along with this library; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA          *
+ ***************************************************************************/
+
+// Standard C++ library includes
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Platform specific includes
+#include "fife_unittest.h"
+
+// 3rd party library includes
+
+// FIFE includes
+// These includes are split up in two parts, separated by one empty line
+// First block: files included from the FIFE root src directory
+// Second block: files included from the same folder
+#include "util/time/profiler.h"
+#include "util/time/tracerecorder.h"
+
+using namespace FIFE;
+
+static const std::string TRACE_FILE = "fifetesttrace.json";
+static const std::string SLOW_FRAME_PREFIX = "fifetestslowframe";
+
+static std::string readFile(const std::string& filename) {
+	std::ifstream in(filename.c_str());
+	std::stringstream content;
+	content << in.rdbuf();
+	return content.str();
+}
+
+static uint32_t countOf(const std::string& text, const std::string& part) {
+	uint32_t count = 0;
+	for (std::string::size_type pos = text.find(part); pos != std::string::npos; pos = text.find(part, pos + 1)) {
+		++count;
+	}
+	return count;
+}
+
+// Environment
+struct environment {
+	TraceRecorder* recorder;
+
+	environment()
+		: recorder(TraceRecorder::instance()) {
+		recorder->setCapacity(16);
+		recorder->setSlowFrameThreshold(0.0);
+		recorder->setEnabled(true);
+	}
+
+	~environment() {
+		recorder->setEnabled(false);
+		recorder->clear();
+		std::remove(TRACE_FILE.c_str());
+		std::remove((SLOW_FRAME_PREFIX + "_1.json").c_str());
+	}
+};
+
+TEST_FIXTURE(environment, test_dump_events) {
+	{
+		ProfilerFrame frame;
+		ProfilerZone zone("model");
+		std::thread worker([]() {
+			TraceRecorder::instance()->setThreadName("test \"worker\"");
+			ProfilerZone job("job");
+		});
+		worker.join();
+	}
+	CHECK_EQUAL(3u, recorder->getEventCount());
+	recorder->dump(TRACE_FILE);
+
+	std::string trace = readFile(TRACE_FILE);
+	CHECK_EQUAL(0u, trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+	CHECK_EQUAL(3u, countOf(trace, "\"ph\":\"X\""));
+	CHECK_EQUAL(1u, countOf(trace, "\"name\":\"frame\""));
+	CHECK_EQUAL(1u, countOf(trace, "\"name\":\"model\""));
+	CHECK_EQUAL(1u, countOf(trace, "\"name\":\"job\""));
+	CHECK_EQUAL(1u, countOf(trace, "\"args\":{\"name\":\"main\"}"));
+	CHECK_EQUAL(1u, countOf(trace, "\"args\":{\"name\":\"test \\\"worker\\\"\"}"));
+	CHECK(trace.find("\n]}") != std::string::npos);
+}
+
+TEST_FIXTURE(environment, test_ring_buffer) {
+	for (int32_t i = 0; i < 20; ++i) {
+		ProfilerZone zone("zone");
+	}
+	CHECK_EQUAL(16u, recorder->getEventCount());
+	recorder->clear();
+	CHECK_EQUAL(0u, recorder->getEventCount());
+
+	recorder->setEnabled(false);
+	{
+		ProfilerZone zone("zone");
+	}
+	CHECK_EQUAL(0u, recorder->getEventCount());
+}
+
+TEST_FIXTURE(environment, test_slow_frame) {
+	recorder->setSlowFrameFilePrefix(SLOW_FRAME_PREFIX);
+	recorder->setSlowFrameThreshold(1000.0);
+	{
+		ProfilerFrame frame;
+	}
+	CHECK_EQUAL(0u, recorder->getSlowFrameCount());
+
+	recorder->setSlowFrameThreshold(0.001);
+	{
+		ProfilerFrame frame;
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	CHECK_EQUAL(1u, recorder->getSlowFrameCount());
+	// the buffer starts over after the capture
+	CHECK_EQUAL(0u, recorder->getEventCount());
+	std::string trace = readFile(SLOW_FRAME_PREFIX + "_1.json");
+	CHECK_EQUAL(2u, countOf(trace, "\"name\":\"frame\""));
+}
+
+int main() {
+	return UnitTest::RunAllTests();
+}
@@ -20,6 +20,9 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <cstring>
+#include <fstream>
+#include <map>
 
 // Platform specific includes
 #include "fife_unittest.h"
@@ -38,6 +41,9 @@
 #include "vfs/vfs.h"
 #include "vfs/vfsdirectory.h"
 #include "vfs/raw/rawdata.h"
+#include "vfs/raw/rawdatafile.h"
+#include "vfs/raw/rawdatamappedfile.h"
+#include "vfs/raw/rawdatamemsource.h"
 #include "util/base/exception.h"
 #include "vfs/directoryprovider.h"
 
@@ -68,6 +74,273 @@ TEST(test_is_directory)
 
 }
 
+static void writeTestFile(const std::string& name, const std::string& content) {
+	std::ofstream out(name.c_str(), std::ios::binary);
+	out.write(content.data(), content.size());
+}
+
+TEST(test_mapped_file)
+{
+	if (!RawDataMappedFile::isSupported()) {
+		return;
+	}
+
+	const std::string name = "fifetestmapped.txt";
+	const std::string content = "first line\nsecond line\nlast";
+	writeTestFile(name, content);
+	{
+		RawDataMappedFile source(name);
+		CHECK_EQUAL(content.size(), source.getSize());
+		CHECK(source.getView(0, source.getSize()) != 0);
+		CHECK(source.getView(0, source.getSize() + 1) == 0);
+
+		uint8_t buffer[5];
+		source.readInto(buffer, 0, 5);
+		CHECK_EQUAL(std::string("first"), std::string(buffer, buffer + 5));
+	}
+
+	boost::shared_ptr<VFS> vfs(new VFS());
+	vfs->addSource(new VFSDirectory(vfs.get()));
+	boost::scoped_ptr<RawData> data(vfs->open(name));
+	CHECK(data->getDataView() != 0);
+	CHECK(std::memcmp(data->getDataView(), content.data(), content.size()) == 0);
+
+	std::string line;
+	CHECK(data->getLine(line));
+	CHECK_EQUAL(std::string("first line"), line);
+	CHECK(data->getLine(line));
+	CHECK_EQUAL(std::string("second line"), line);
+	CHECK(data->getLine(line));
+	CHECK_EQUAL(std::string("last"), line);
+	CHECK(!data->getLine(line));
+
+	data->setIndex(6);
+	CHECK_EQUAL(std::string("line"), data->readString(4));
+	CHECK_THROW(data->readString(content.size()), IndexOverflow);
+
+	boost::filesystem::remove(name);
+}
+
+TEST(test_mapped_file_matches_stream)
+{
+	if (!RawDataMappedFile::isSupported()) {
+		return;
+	}
+
+	const std::string name = "fifetestmapped.bin";
+	std::string content;
+	for (int32_t i = 0; i < 70000; ++i) {
+		content += static_cast<char>(i * 31);
+	}
+	writeTestFile(name, content);
+
+	RawData mapped(new RawDataMappedFile(name));
+	RawData streamed(new RawDataFile(name));
+	CHECK(streamed.getDataView() == 0);
+	CHECK_EQUAL(streamed.getDataLength(), mapped.getDataLength());
+	CHECK(mapped.getDataInBytes() == streamed.getDataInBytes());
+
+	mapped.setIndex(4096);
+	streamed.setIndex(4096);
+	CHECK_EQUAL(streamed.read32Little(), mapped.read32Little());
+	CHECK_EQUAL(streamed.read16Big(), mapped.read16Big());
+
+	boost::filesystem::remove(name);
+}
+
+TEST(test_mapped_file_empty_and_missing)
+{
+	if (!RawDataMappedFile::isSupported()) {
+		return;
+	}
+
+	const std::string name = "fifetestmapped.empty";
+	writeTestFile(name, "");
+	{
+		RawData data(new RawDataMappedFile(name));
+		CHECK_EQUAL(0u, data.getDataLength());
+		CHECK(data.getDataView() == 0);
+		std::string line;
+		CHECK(!data.getLine(line));
+	}
+	boost::filesystem::remove(name);
+
+	CHECK_THROW(RawDataMappedFile("fifetestmapped.missing"), CannotOpenFile);
+}
+
+// A source that can list its content, so the VFS indexes it
+class TestIndexedSource : public VFSSource {
+public:
+	TestIndexedSource(VFS* vfs) : VFSSource(vfs), m_lookups(0), m_opens(0) {}
+
+	void add(const std::string& name, const std::string& content) {
+		m_files[name] = content;
+	}
+
+	bool fileExists(const std::string& file) const {
+		++m_lookups;
+		return m_files.count(file) > 0;
+	}
+
+	RawData* open(const std::string& file) const {
+		std::map<std::string, std::string>::const_iterator it = m_files.find(file);
+		if (it == m_files.end()) {
+			throw NotFound(file);
+		}
+		++m_opens;
+		RawDataMemSource* source = new RawDataMemSource(it->second.size());
+		std::copy(it->second.begin(), it->second.end(), source->getRawData());
+		return new RawData(source);
+	}
+
+	std::set<std::string> listFiles(const std::string& path) const {
+		return std::set<std::string>();
+	}
+
+	std::set<std::string> listDirectories(const std::string& path) const {
+		return std::set<std::string>();
+	}
+
+	bool getAllEntries(std::vector<std::string>& files, std::vector<std::string>& directories) const {
+		std::map<std::string, std::string>::const_iterator it;
+		for (it = m_files.begin(); it != m_files.end(); ++it) {
+			files.push_back(it->first);
+		}
+		return true;
+	}
+
+	bool isCacheable(const std::string& file) const {
+		return true;
+	}
+
+	mutable int32_t m_lookups;
+	mutable int32_t m_opens;
+
+private:
+	std::map<std::string, std::string> m_files;
+};
+
+static std::string readAll(VFS* vfs, const std::string& file) {
+	boost::scoped_ptr<RawData> data(vfs->open(file));
+	return data->readString(data->getDataLength());
+}
+
+TEST(test_path_index)
+{
+	boost::shared_ptr<VFS> vfs(new VFS());
+	TestIndexedSource* first = new TestIndexedSource(vfs.get());
+	first->add("data/shared.txt", "first");
+	TestIndexedSource* second = new TestIndexedSource(vfs.get());
+	second->add("data/shared.txt", "second");
+	second->add("data/sub/only.txt", "only");
+	vfs->addSource(first);
+	vfs->addSource(second);
+
+	CHECK(vfs->exists("data/shared.txt"));
+	CHECK(vfs->exists("./data//sub/../shared.txt"));
+	CHECK(!vfs->exists("data/missing.txt"));
+	CHECK_EQUAL(std::string("first"), readAll(vfs.get(), "data/shared.txt"));
+	CHECK_EQUAL(std::string("only"), readAll(vfs.get(), "data\\sub\\only.txt"));
+
+	CHECK(vfs->isDirectory("data"));
+	CHECK(vfs->isDirectory("data/sub/"));
+	CHECK(!vfs->isDirectory("data/shared.txt"));
+	CHECK(!vfs->isDirectory("data/other"));
+
+	// indexed sources are never asked
+	CHECK_EQUAL(0, first->m_lookups);
+	CHECK_EQUAL(0, second->m_lookups);
+
+	// removing a source rebuilds the index
+	vfs->removeSource(first);
+	delete first;
+	CHECK_EQUAL(std::string("second"), readAll(vfs.get(), "data/shared.txt"));
+}
+
+TEST(test_path_index_host_shadowing)
+{
+	const std::string name = "fifetestindex.txt";
+	writeTestFile(name, "host");
+
+	boost::shared_ptr<VFS> vfs(new VFS());
+	vfs->addSource(new VFSDirectory(vfs.get()));
+	TestIndexedSource* archive = new TestIndexedSource(vfs.get());
+	archive->add(name, "archive");
+	vfs->addSource(archive);
+
+	// the host filesystem comes first and still wins
+	CHECK_EQUAL(std::string("host"), readAll(vfs.get(), name));
+	boost::filesystem::remove(name);
+	CHECK_EQUAL(std::string("archive"), readAll(vfs.get(), name));
+	CHECK_EQUAL(0, archive->m_lookups);
+}
+
+TEST(test_cache)
+{
+	boost::shared_ptr<VFS> vfs(new VFS());
+	TestIndexedSource* archive = new TestIndexedSource(vfs.get());
+	archive->add("a.txt", std::string(10, 'a'));
+	archive->add("b.txt", std::string(20, 'b'));
+	archive->add("c.txt", std::string(20, 'c'));
+	archive->add("d.txt", std::string(20, 'd'));
+	archive->add("e.txt", std::string(20, 'e'));
+	archive->add("big.txt", std::string(30, 'x'));
+	vfs->addSource(archive);
+
+	// disabled by default
+	readAll(vfs.get(), "a.txt");
+	readAll(vfs.get(), "a.txt");
+	CHECK_EQUAL(2, archive->m_opens);
+	CHECK_EQUAL(0u, vfs->getCacheMisses());
+
+	vfs->setCacheBudget(100);
+	{
+		boost::scoped_ptr<RawData> first(vfs->open("a.txt"));
+		boost::scoped_ptr<RawData> second(vfs->open("./a.txt"));
+		CHECK_EQUAL(3, archive->m_opens);
+		// hits share the buffer
+		CHECK(first->getDataView() != 0);
+		CHECK(first->getDataView() == second->getDataView());
+		CHECK_EQUAL(std::string(10, 'a'), second->readString(10));
+	}
+	CHECK_EQUAL(1u, vfs->getCacheHits());
+	CHECK_EQUAL(1u, vfs->getCacheMisses());
+	CHECK_EQUAL(10u, vfs->getCacheBytesSaved());
+	CHECK_EQUAL(10u, vfs->getCacheUsage());
+
+	// bigger than a quarter of the budget
+	readAll(vfs.get(), "big.txt");
+	readAll(vfs.get(), "big.txt");
+	CHECK_EQUAL(5, archive->m_opens);
+	CHECK_EQUAL(10u, vfs->getCacheUsage());
+
+	// least recently used entries go first
+	vfs->setCacheBudget(80);
+	readAll(vfs.get(), "b.txt");
+	readAll(vfs.get(), "c.txt");
+	readAll(vfs.get(), "a.txt");
+	readAll(vfs.get(), "d.txt");
+	CHECK_EQUAL(70u, vfs->getCacheUsage());
+	readAll(vfs.get(), "e.txt");
+	CHECK_EQUAL(70u, vfs->getCacheUsage());
+	const int32_t opens = archive->m_opens;
+	readAll(vfs.get(), "a.txt");
+	readAll(vfs.get(), "c.txt");
+	readAll(vfs.get(), "d.txt");
+	readAll(vfs.get(), "e.txt");
+	CHECK_EQUAL(opens, archive->m_opens);
+	readAll(vfs.get(), "b.txt");
+	CHECK_EQUAL(opens + 1, archive->m_opens);
+
+	// removing the source drops its entries
+	vfs->removeSource(archive);
+	CHECK_EQUAL(0u, vfs->getCacheUsage());
+	delete archive;
+
+	vfs->setCacheBudget(0);
+	CHECK_EQUAL(0u, vfs->getCacheBudget());
+}
+
 int main() {
 	return UnitTest::RunAllTests();
 }
@@ -20,8 +20,10 @@
  ***************************************************************************/
 
 // Standard C++ library includes
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 
 // Platform specific includes
 #include "fife_unittest.h"
@@ -37,9 +39,17 @@
 #include "vfs/vfs.h"
 #include "vfs/vfsdirectory.h"
 #include "vfs/zip/zipsource.h"
+#include "vfs/zip/zipinflatesource.h"
+#include "vfs/zip/zipstoredsource.h"
 #include "vfs/raw/rawdata.h"
+#include "vfs/raw/rawdatafile.h"
+#include "vfs/raw/rawdatamappedfile.h"
+#include "vfs/raw/rawdatamemsource.h"
 #include "util/base/exception.h"
 
+#include <boost/filesystem/convenience.hpp>
+#include <boost/scoped_ptr.hpp>
+
 using namespace FIFE;
 
 // Environment
@@ -115,6 +125,234 @@ TEST(test_decoder) {
 	delete fcomp;
 }
 
+// Writes a zip archive with stored entries, names ending with '/' are directories.
+// The archive can start behind a hole of padding bytes, the file stays sparse then.
+class TestZipWriter {
+public:
+	TestZipWriter(bool zip64, uint64_t padding = 0) : m_zip64(zip64), m_padding(padding), m_count(0) {}
+
+	void add(const std::string& name, const std::string& content) {
+		const uint64_t offset = m_padding + m_data.size();
+		// local header, with an extra field the central directory doesn't have
+		put32(m_data, 0x04034b50);
+		put16(m_data, 20); put16(m_data, 0); put16(m_data, 0); put32(m_data, 0);
+		put32(m_data, 0); put32(m_data, content.size()); put32(m_data, content.size());
+		put16(m_data, name.size()); put16(m_data, 4);
+		m_data.insert(m_data.end(), name.begin(), name.end());
+		put16(m_data, 0xCAFE); put16(m_data, 0);
+		m_data.insert(m_data.end(), content.begin(), content.end());
+
+		put32(m_central, 0x02014b50);
+		put16(m_central, 45); put16(m_central, m_zip64 ? 45 : 20); put16(m_central, 0); put16(m_central, 0);
+		put32(m_central, 0); put32(m_central, 0);
+		put32(m_central, m_zip64 ? 0xFFFFFFFF : content.size());
+		put32(m_central, m_zip64 ? 0xFFFFFFFF : content.size());
+		put16(m_central, name.size()); put16(m_central, m_zip64 ? 28 : 0); put16(m_central, 0);
+		put16(m_central, 0); put16(m_central, 0); put32(m_central, 0);
+		put32(m_central, m_zip64 ? 0xFFFFFFFF : offset);
+		m_central.insert(m_central.end(), name.begin(), name.end());
+		if (m_zip64) {
+			put16(m_central, 0x0001); put16(m_central, 24);
+			put64(m_central, content.size()); put64(m_central, content.size()); put64(m_central, offset);
+		}
+		++m_count;
+	}
+
+	void write(const std::string& file) {
+		std::vector<uint8_t> out = m_data;
+		const uint64_t cdOffset = m_padding + out.size();
+		out.insert(out.end(), m_central.begin(), m_central.end());
+		if (m_zip64) {
+			const uint64_t eocd64Offset = m_padding + out.size();
+			put32(out, 0x06064b50); put64(out, 44); put16(out, 45); put16(out, 45);
+			put32(out, 0); put32(out, 0); put64(out, m_count); put64(out, m_count);
+			put64(out, m_central.size()); put64(out, cdOffset);
+			put32(out, 0x07064b50); put32(out, 0); put64(out, eocd64Offset); put32(out, 1);
+		}
+		put32(out, 0x06054b50); put16(out, 0); put16(out, 0);
+		put16(out, m_zip64 ? 0xFFFF : m_count); put16(out, m_zip64 ? 0xFFFF : m_count);
+		put32(out, m_zip64 ? 0xFFFFFFFF : m_central.size()); put32(out, m_zip64 ? 0xFFFFFFFF : cdOffset);
+		const std::string comment = "archive comment";
+		put16(out, comment.size());
+		out.insert(out.end(), comment.begin(), comment.end());
+
+		std::ofstream stream(file.c_str(), std::ios::binary);
+		stream.seekp(m_padding);
+		stream.write(reinterpret_cast<const char*>(&out[0]), out.size());
+	}
+
+private:
+	static void put16(std::vector<uint8_t>& v, uint32_t x) { v.push_back(x & 0xFF); v.push_back((x >> 8) & 0xFF); }
+	static void put32(std::vector<uint8_t>& v, uint32_t x) { put16(v, x & 0xFFFF); put16(v, x >> 16); }
+	static void put64(std::vector<uint8_t>& v, uint64_t x) { put32(v, x & 0xFFFFFFFF); put32(v, x >> 32); }
+
+	bool m_zip64;
+	uint64_t m_padding;
+	uint32_t m_count;
+	std::vector<uint8_t> m_data;
+	std::vector<uint8_t> m_central;
+};
+
+static void checkGeneratedArchive(bool zip64) {
+	const std::string file = zip64 ? "fifetest64.zip" : "fifetest.zip";
+	TestZipWriter writer(zip64);
+	writer.add("data/", "");
+	writer.add("data/readme.txt", "hello zip");
+	writer.add("data/sub.dir/noext", "no extension");
+	writer.add("top.xml", "<xml/>");
+	writer.write(file);
+
+	boost::shared_ptr<VFS> vfs(new VFS());
+	vfs->setCacheBudget(1024 * 1024);
+	vfs->addSource(new VFSDirectory(vfs.get()));
+	ZipSource* source = new ZipSource(vfs.get(), file);
+	vfs->addSource(source);
+	// stored entries bypass the cache
+	CHECK(!source->isCacheable("data/readme.txt"));
+	CHECK(!source->isCacheable("data"));
+
+	CHECK(vfs->exists("data/readme.txt"));
+	CHECK(vfs->exists("./data//sub.dir/../readme.txt"));
+	CHECK(vfs->exists("data/sub.dir/noext"));
+	CHECK(!vfs->exists("data/missing.txt"));
+
+	boost::scoped_ptr<RawData> readme(vfs->open("data/readme.txt"));
+	CHECK_EQUAL(std::string("hello zip"), readme->readString(readme->getDataLength()));
+	// stored entries of a mapped archive aren't copied
+	CHECK(!RawDataMappedFile::isSupported() || readme->getDataView() != 0);
+	boost::scoped_ptr<RawData> top(vfs->open("top.xml"));
+	CHECK_EQUAL(std::string("<xml/>"), top->readString(top->getDataLength()));
+	CHECK_EQUAL(0u, vfs->getCacheMisses());
+	CHECK_EQUAL(0u, vfs->getCacheUsage());
+
+	std::set<std::string> dirs = vfs->listDirectories("data");
+	CHECK(dirs.size() == 1 && dirs.count("sub.dir") == 1);
+	std::set<std::string> files = vfs->listFiles("data/sub.dir");
+	CHECK(files.size() == 1 && files.count("noext") == 1);
+
+	vfs.reset();
+	boost::filesystem::remove(file);
+}
+
+TEST(test_central_directory) {
+	checkGeneratedArchive(false);
+}
+
+TEST(test_zip64) {
+	checkGeneratedArchive(true);
+}
+
+TEST(test_archive_larger_than_4gb) {
+	const std::string file = "fifetestlarge.zip";
+	const uint64_t padding = 5ull * 1024 * 1024 * 1024;
+	TestZipWriter writer(true, padding);
+	writer.add("data/readme.txt", "hello zip");
+	writer.add("top.xml", "<xml/>");
+	writer.write(file);
+
+	{
+		boost::shared_ptr<VFS> vfs(new VFS());
+		vfs->addSource(new VFSDirectory(vfs.get()));
+		vfs->addSource(new ZipSource(vfs.get(), file));
+
+		CHECK(vfs->exists("data/readme.txt"));
+		boost::scoped_ptr<RawData> readme(vfs->open("data/readme.txt"));
+		CHECK_EQUAL(std::string("hello zip"), readme->readString(readme->getDataLength()));
+		boost::scoped_ptr<RawData> top(vfs->open("top.xml"));
+		CHECK_EQUAL(std::string("<xml/>"), top->readString(top->getDataLength()));
+	}
+
+	// the stream fallback reads beyond 4GB as well
+	RawDataPtr archive(new RawData(new RawDataFile(file)));
+	CHECK(archive->getLargeDataLength() > padding);
+	CHECK_EQUAL(0xFFFFFFFFu, archive->getDataLength());
+	// local header, name and extra field of the first entry come before its data
+	const uint64_t dataOffset = padding + 30 + std::string("data/readme.txt").size() + 4;
+	RawData stored(new ZipStoredSource(archive, dataOffset, 9));
+	CHECK_EQUAL(std::string("hello zip"), stored.readString(stored.getDataLength()));
+	std::vector<uint8_t> header(4);
+	archive->readAt(&header[0], padding, header.size());
+	CHECK(header[0] == 'P' && header[1] == 'K' && header[2] == 3 && header[3] == 4);
+	CHECK_THROW(archive->readAt(&header[0], archive->getLargeDataLength() - 2, header.size()), IndexOverflow);
+
+	archive.reset();
+	boost::filesystem::remove(file);
+}
+
+TEST(test_streamed_not_cacheable) {
+	boost::shared_ptr<VFS> vfs(new VFS());
+	vfs->setCacheBudget(4 * 1024 * 1024);
+	vfs->addSource(new VFSDirectory(vfs.get()));
+	ZipSource* source = new ZipSource(vfs.get(), COMPRESSED_FILE);
+	vfs->addSource(source);
+
+	// big deflated entries are streamed, caching them would inflate them whole
+	CHECK(!source->isCacheable("ziptest_content/maps/test.map"));
+	boost::scoped_ptr<RawData> map(vfs->open("ziptest_content/maps/test.map"));
+	CHECK(map->getDataView() == 0);
+	CHECK_EQUAL(0u, vfs->getCacheMisses());
+	CHECK_EQUAL(0u, vfs->getCacheUsage());
+}
+
+static void checkInflateSource(RawDataPtr archive, uint32_t compsize, const std::vector<uint8_t>& expected) {
+	ZipInflateSource* source = new ZipInflateSource(archive, 0, compsize, expected.size());
+	RawData data(source);
+	CHECK_EQUAL(expected.size(), data.getDataLength());
+	CHECK(data.getDataView() == 0);
+	CHECK(data.getDataInBytes() == expected);
+	// one resume point per inflated megabyte, none at the end
+	CHECK_EQUAL(2u, source->getResumePointCount());
+
+	// forward and backward seeks, inside and outside of the window and across resume points
+	const uint32_t offsets[] = { 300000, 300100, 299000, 10, 2900000, 1048570, 150000, 2999990, 2097150, 1500000 };
+	for (uint32_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+		std::vector<uint8_t> chunk(10);
+		data.setIndex(offsets[i]);
+		data.readInto(&chunk[0], chunk.size());
+		CHECK(std::equal(chunk.begin(), chunk.end(), expected.begin() + offsets[i]));
+	}
+}
+
+TEST(test_inflate_source) {
+	std::vector<uint8_t> expected(3000000);
+	for (uint32_t i = 0; i < expected.size(); ++i) {
+		expected[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+	}
+
+	// raw deflate stream like it is stored in zip archives
+	std::vector<uint8_t> compressed(compressBound(expected.size()));
+	z_stream zstream;
+	zstream.zalloc = Z_NULL;
+	zstream.zfree = Z_NULL;
+	zstream.opaque = Z_NULL;
+	CHECK(deflateInit2(&zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	zstream.next_in = &expected[0];
+	zstream.avail_in = expected.size();
+	zstream.next_out = &compressed[0];
+	zstream.avail_out = compressed.size();
+	CHECK(deflate(&zstream, Z_FINISH) == Z_STREAM_END);
+	const uint32_t compsize = zstream.total_out;
+	deflateEnd(&zstream);
+
+	// archive in memory, inflated straight from its view
+	RawDataMemSource* memsource = new RawDataMemSource(compsize);
+	std::copy(compressed.begin(), compressed.begin() + compsize, memsource->getRawData());
+	checkInflateSource(RawDataPtr(new RawData(memsource)), compsize, expected);
+
+	// archive without view, read in chunks
+	const std::string file = "fifetestinflate.bin";
+	{
+		std::ofstream stream(file.c_str(), std::ios::binary);
+		stream.write(reinterpret_cast<const char*>(&compressed[0]), compsize);
+	}
+	checkInflateSource(RawDataPtr(new RawData(new RawDataFile(file))), compsize, expected);
+	boost::filesystem::remove(file);
+
+	// a truncated stream fails on read, not on open
+	RawData truncated(new ZipInflateSource(RawDataPtr(new RawData(new RawDataFile("tests/data/test.map"))), 0, 0, 100));
+	CHECK_THROW(truncated.getDataInBytes(), InvalidFormat);
+}
+
 int main() {
 	return UnitTest::RunAllTests();
 }
@@ -25,6 +25,7 @@
 from __future__ import print_function
 from __future__ import absolute_import
 from builtins import range
+import time
 from .swig_test_utils import *
 
 class TestController(unittest.TestCase):
@@ -58,7 +59,90 @@ class TestController(unittest.TestCase):
 			self.engine.pump()
 		self.engine.finalizePumping()
 
-TEST_CLASSES = [TestController]
+class TestHeadlessController(unittest.TestCase):
+
+	def setUp(self):
+		self.engine = getEngine(headless=True)
+
+	def tearDown(self):
+		self.engine.destroy()
+
+	def testInstances(self):
+		self.assertFalse(self.engine.getSoundManager())
+		self.assertFalse(self.engine.getEventManager())
+		self.assertFalse(self.engine.getCursor())
+		self.assertTrue(self.engine.getTimeManager())
+		self.assertTrue(self.engine.getImageManager())
+		self.assertTrue(self.engine.getModel())
+		self.assertTrue(self.engine.getVFS())
+
+	def testStep(self):
+		model = self.engine.getModel()
+		map = model.createMap("map")
+		layer = map.createLayer("layer", model.getCellGrid("square"))
+		layer.setWalkable(True)
+		obj = model.createObject("walker", "test")
+		obj.setPather(model.getPather("RoutePather"))
+		obj.createAction("walk")
+		ground = model.createObject("ground", "test")
+		for x in range(10):
+			layer.createInstance(ground, fife.ModelCoordinate(x, 0))
+		inst = layer.createInstance(obj, fife.ModelCoordinate(0, 0))
+		map.initializeCellCaches()
+		map.finalizeCellCaches()
+
+		target = fife.Location(layer)
+		target.setLayerCoordinates(fife.ModelCoordinate(9, 0))
+		timemanager = self.engine.getTimeManager()
+		start = timemanager.getTime()
+		inst.move("walk", target, 1.0)
+		# ten seconds of game time, without waiting for them
+		for i in range(100):
+			self.engine.step(100)
+		self.assertEqual(start + 10000, timemanager.getTime())
+		self.assertEqual(target.getLayerCoordinates(), inst.getLocation().getLayerCoordinates())
+
+	def testPumping(self):
+		self.engine.initializePumping()
+		for i in range(10):
+			self.engine.pump()
+		self.engine.finalizePumping()
+
+class TestFixedTickController(unittest.TestCase):
+
+	def setUp(self):
+		self.engine = fife.Engine()
+		settings = self.engine.getSettings()
+		settings.setHeadless(True)
+		settings.setModelTickRate(50)
+		settings.setMaxModelTicksPerFrame(2)
+		self.engine.init()
+
+	def tearDown(self):
+		self.engine.destroy()
+
+	def testSettings(self):
+		settings = self.engine.getSettings()
+		self.assertEqual(50, settings.getModelTickRate())
+		self.assertEqual(2, settings.getMaxModelTicksPerFrame())
+
+	def testPumping(self):
+		map = self.engine.getModel().createMap("map")
+		timemanager = self.engine.getTimeManager()
+		self.engine.initializePumping()
+		self.engine.pump()
+		start = timemanager.getTime()
+		for i in range(5):
+			time.sleep(0.1)
+			self.engine.pump()
+		self.engine.finalizePumping()
+		# the model time moves in whole ticks and never more than two per frame
+		elapsed = timemanager.getTime() - start
+		self.assertEqual(0, elapsed % 20)
+		self.assertTrue(elapsed <= 5 * 2 * 20)
+		self.assertEqual(elapsed // 20, map.getTickCount())
+
+TEST_CLASSES = [TestController, TestHeadlessController, TestFixedTickController]
 
 if __name__ == '__main__':
 	unittest.main()
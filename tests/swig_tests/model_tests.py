@@ -70,6 +70,18 @@ class TestModel(unittest.TestCase):
         self.assertEqual(len(query), 0)
         self.assertEqual(self.model.getMapCount(), 0)
 
+    def testUpdateThreads(self):
+        self.assertEqual(self.model.getUpdateThreadCount(), 1)
+        map1 = self.model.createMap("map001")
+        self.model.setUpdateThreadCount(4)
+        self.assertEqual(self.model.getUpdateThreadCount(), 4)
+        map2 = self.model.createMap("map002")
+        self.model.update()
+
+        self.model.setUpdateThreadCount(0)
+        self.assertEqual(self.model.getUpdateThreadCount(), 1)
+        self.model.update()
+
     def testMaps(self):
         map = self.model.createMap("map005")
 
@@ -114,6 +126,26 @@ class TestModel(unittest.TestCase):
         # self.assertEqual(len(query), 2)
         self.assertEqual(len(layer.getInstances()), 3)
 
+        infos = fife.InstanceCreationInfoVector()
+        for i in range(10):
+            infos.append(fife.InstanceCreationInfo(obj1, fife.ExactModelCoordinate(i, 0), "batch%d" % i))
+        created = layer.createInstances(infos)
+        self.assertEqual(len(created), 10)
+        self.assertEqual(created[3].getId(), "batch3")
+        self.assertEqual(len(layer.getInstances()), 13)
+
+        layer.setChangeLogEnabled(True)
+        self.assertTrue(layer.isChangeLogEnabled())
+        loc = inst.getLocation()
+        loc.setLayerCoordinates(fife.ModelCoordinate(2, 3))
+        inst.setLocation(loc)
+        self.model.update()
+        self.assertEqual(len(layer.getChangeLog()), 1)
+        self.assertEqual(layer.getChangeLogInstances()[0].getFifeId(), inst.getFifeId())
+        self.assertTrue(layer.getChangeLogChanges()[0] & fife.ICHANGE_CELL)
+        self.assertEqual(tuple(layer.getChangeLogCells(True)), (4, 4, 0))
+        self.assertEqual(tuple(layer.getChangeLogCells(False)), (2, 3, 0))
+
     # self.assertEqual(query[0].get("Name"), "Goon")
     # p1 = fife.ModelCoordinate(4,4)
     # print p1.x, p1.y
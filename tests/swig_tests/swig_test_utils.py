@@ -34,7 +34,7 @@ print("Using the FIFE python module found here: ", os.path.dirname(fife.__file__
 
 from fife.extensions import fifelog
 
-def getEngine(minimized=False):
+def getEngine(minimized=False, headless=False):
 	e = fife.Engine()
 	log = fifelog.LogManager(e, promptlog=False, filelog=True)
 	log.setVisibleModules('all')
@@ -47,6 +47,7 @@ def getEngine(minimized=False):
 		s.setScreenWidth(1)
 		s.setScreenHeight(1)
 	s.setDefaultFontSize(12)
+	s.setHeadless(headless)
 	e.init()
 	return e
 